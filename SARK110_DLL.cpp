@@ -1,6 +1,19 @@
 // SARKCLIENT.cpp : Defines the exported functions for the DLL application.
 //
 #include "sark_rem_client.h"
+#include "sark_sweep.h"
+#include "sark_monitor.h"
+#include "sark_alarm.h"
+#include "sark_spectrum.h"
+#include "sark_thru.h"
+#include "sark_tdr.h"
+#include "sark_split.h"
+#include "sark_jobs.h"
+#include "sark_proxy.h"
+#include "shm_cli.h"
+#include "sark_pub.h"
+#include "sark_plan.h"
+#include "sark_cancel.h"
 
 extern "C"
 {
@@ -14,6 +27,11 @@ __declspec(dllexport) int SARK110_Close(int16 num)
 	return Sark_Close(num);
 }
 
+__declspec(dllexport) int SARK110_Net_Loop(bool bOn)
+{
+	return Sark_Net_Loop(bOn);
+}
+
 __declspec(dllexport) int SARK110_Version(int16 num, uint16 *pu16Ver, uint8 *pu8FW)
 {
 	return Sark_Version (num, pu16Ver, pu8FW);
@@ -38,6 +56,12 @@ __declspec(dllexport) int SARK110_Meas_Rx_Eff(int16 num, uint32 u32Freq, uint32
 		pfR4, pfX4
 		);
 }
+
+__declspec(dllexport) int SARK110_Meas_Rx_Bulk(int16 num, uint32 u32Freq, uint32 u32Step, uint16 u16Points, bool bCal, uint8 u8Samples,
+	bool bFloat, float *pfR, float *pfX)
+{
+	return Sark_Meas_Rx_Bulk (num, u32Freq, u32Step, u16Points, bCal, u8Samples, bFloat, pfR, pfX);
+}
 __declspec(dllexport) int SARK110_Meas_Vect(int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV,
 										   float *pfMagI, float *pfPhI )
 {
@@ -106,4 +130,404 @@ __declspec(dllexport) int SARK110_GetSetting(int16 num, uint8 u8Reg, uint8 *pu8V
 	return Sark_GetSetting (num, u8Reg, pu8Val);
 }
 
+__declspec(dllexport) T_SARK_SWEEP *SARK110_Sweep_Create(const uint32 *pu32Freq, int iPoints, bool bCal, uint8 u8Samples)
+{
+	return Sark_Sweep_Create (pu32Freq, iPoints, bCal, u8Samples);
+}
+
+__declspec(dllexport) void SARK110_Sweep_Destroy(T_SARK_SWEEP *pSweep)
+{
+	Sark_Sweep_Destroy (pSweep);
+}
+
+__declspec(dllexport) int SARK110_Sweep_Adaptive(T_SARK_SWEEP *pSweep, float fNoise, uint8 u8MinSamples, uint8 u8MaxSamples, int iRegionPoints)
+{
+	return Sark_Sweep_Adaptive (pSweep, fNoise, u8MinSamples, u8MaxSamples, iRegionPoints);
+}
+
+__declspec(dllexport) int SARK110_Sweep_GetSamples(T_SARK_SWEEP *pSweep, uint8 *pu8Samples)
+{
+	return Sark_Sweep_GetSamples (pSweep, pu8Samples);
+}
+
+__declspec(dllexport) int SARK110_Sweep_GetFreq(T_SARK_SWEEP *pSweep, uint32 *pu32Freq)
+{
+	return Sark_Sweep_GetFreq (pSweep, pu32Freq);
+}
+
+__declspec(dllexport) int SARK110_Sweep_SetCancel(T_SARK_SWEEP *pSweep, T_SARK_CANCEL *ptCancel)
+{
+	return Sark_Sweep_SetCancel (pSweep, ptCancel);
+}
+
+__declspec(dllexport) int SARK110_Sweep_SetProgress(T_SARK_SWEEP *pSweep, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	return Sark_Sweep_SetProgress (pSweep, pfCallback, pvUser, u32Ms, iPoints);
+}
+
+__declspec(dllexport) int SARK110_Sweep_Run(int16 num, T_SARK_SWEEP *pSweep, float *pfR, float *pfX)
+{
+	return Sark_Sweep_Run (num, pSweep, pfR, pfX);
+}
+
+__declspec(dllexport) int SARK110_Sweep_Points(T_SARK_SWEEP *pSweep)
+{
+	return Sark_Sweep_Points (pSweep);
+}
+
+__declspec(dllexport) int SARK110_Sweep_SetTiming(T_SARK_SWEEP *pSweep, T_SARK_TIMING *ptTiming)
+{
+	return Sark_Sweep_SetTiming (pSweep, ptTiming);
+}
+
+__declspec(dllexport) T_SARK_MONITOR *SARK110_Monitor_Start(int16 num, T_SARK_SWEEP *pSweep, int iSlots, uint32 u32Interval)
+{
+	return Sark_Monitor_Start (num, pSweep, iSlots, u32Interval);
+}
+
+__declspec(dllexport) void SARK110_Monitor_Stop(T_SARK_MONITOR *pMon)
+{
+	Sark_Monitor_Stop (pMon);
+}
+
+__declspec(dllexport) int SARK110_Monitor_Latest(T_SARK_MONITOR *pMon, uint32 *pu32Seq, float *pfR, float *pfX)
+{
+	return Sark_Monitor_Latest (pMon, pu32Seq, pfR, pfX);
+}
+
+__declspec(dllexport) int SARK110_Monitor_Read(T_SARK_MONITOR *pMon, uint32 u32Seq, float *pfR, float *pfX)
+{
+	return Sark_Monitor_Read (pMon, u32Seq, pfR, pfX);
+}
+
+__declspec(dllexport) int SARK110_Monitor_Status(T_SARK_MONITOR *pMon, uint32 *pu32Sweeps, uint32 *pu32Errors, int *piLastRc)
+{
+	return Sark_Monitor_Status (pMon, pu32Sweeps, pu32Errors, piLastRc);
+}
+
+__declspec(dllexport) T_SARK_ALARM *SARK110_Alarm_Create(int iPoints, int iWarmup, float fAlpha, float fSigmas, float fMinDelta, int iQueue)
+{
+	return Sark_Alarm_Create (iPoints, iWarmup, fAlpha, fSigmas, fMinDelta, iQueue);
+}
+
+__declspec(dllexport) void SARK110_Alarm_Destroy(T_SARK_ALARM *pAlarm)
+{
+	Sark_Alarm_Destroy (pAlarm);
+}
+
+__declspec(dllexport) void SARK110_Alarm_Reset(T_SARK_ALARM *pAlarm)
+{
+	Sark_Alarm_Reset (pAlarm);
+}
+
+__declspec(dllexport) int SARK110_Alarm_Update(T_SARK_ALARM *pAlarm, uint32 u32Seq, const float *pfR, const float *pfX)
+{
+	return Sark_Alarm_Update (pAlarm, u32Seq, pfR, pfX);
+}
+
+__declspec(dllexport) int SARK110_Alarm_GetEvents(T_SARK_ALARM *pAlarm, T_SARK_ALARM_EVENT *ptEvents, int iMax, uint32 *pu32Lost)
+{
+	return Sark_Alarm_GetEvents (pAlarm, ptEvents, iMax, pu32Lost);
+}
+
+__declspec(dllexport) int SARK110_Monitor_SetAlarm(T_SARK_MONITOR *pMon, T_SARK_ALARM *pAlarm)
+{
+	return Sark_Monitor_SetAlarm (pMon, pAlarm);
+}
+
+__declspec(dllexport) int SARK110_Monitor_SetPub(T_SARK_MONITOR *pMon, T_SARK_PUB *pPub)
+{
+	return Sark_Monitor_SetPub (pMon, pPub);
+}
+
+__declspec(dllexport) int SARK110_Monitor_SetCancel(T_SARK_MONITOR *pMon, T_SARK_CANCEL *ptCancel)
+{
+	return Sark_Monitor_SetCancel (pMon, ptCancel);
+}
+
+__declspec(dllexport) T_SARK_SPECTRUM *SARK110_Spectrum_Create(uint32 u32Start, uint32 u32Step, int iPoints, int iRows)
+{
+	return Sark_Spectrum_Create (u32Start, u32Step, iPoints, iRows);
+}
+
+__declspec(dllexport) void SARK110_Spectrum_Destroy(T_SARK_SPECTRUM *pSpec)
+{
+	Sark_Spectrum_Destroy (pSpec);
+}
+
+__declspec(dllexport) void SARK110_Spectrum_Reset(T_SARK_SPECTRUM *pSpec)
+{
+	Sark_Spectrum_Reset (pSpec);
+}
+
+__declspec(dllexport) int SARK110_Spectrum_Scan(int16 num, T_SARK_SPECTRUM *pSpec, int iScans)
+{
+	return Sark_Spectrum_Scan (num, pSpec, iScans);
+}
+
+__declspec(dllexport) int SARK110_Spectrum_Traces(T_SARK_SPECTRUM *pSpec, float *pfLast, float *pfPeak, float *pfMin, float *pfAvg, uint32 *pu32Scans)
+{
+	return Sark_Spectrum_Traces (pSpec, pfLast, pfPeak, pfMin, pfAvg, pu32Scans);
+}
+
+__declspec(dllexport) int SARK110_Spectrum_Waterfall(T_SARK_SPECTRUM *pSpec, uint32 u32Scan, float *pfLevel)
+{
+	return Sark_Spectrum_Waterfall (pSpec, u32Scan, pfLevel);
+}
+
+__declspec(dllexport) T_SARK_THRU *SARK110_Thru_Create(const uint32 *pu32Freq, int iPoints)
+{
+	return Sark_Thru_Create (pu32Freq, iPoints);
+}
+
+__declspec(dllexport) void SARK110_Thru_Destroy(T_SARK_THRU *pThru)
+{
+	Sark_Thru_Destroy (pThru);
+}
+
+__declspec(dllexport) int SARK110_Thru_Reference(int16 num, T_SARK_THRU *pThru)
+{
+	return Sark_Thru_Reference (num, pThru);
+}
+
+__declspec(dllexport) int SARK110_Thru_GetReference(T_SARK_THRU *pThru, float *pfMag, float *pfPh)
+{
+	return Sark_Thru_GetReference (pThru, pfMag, pfPh);
+}
+
+__declspec(dllexport) int SARK110_Thru_SetReference(T_SARK_THRU *pThru, const float *pfMag, const float *pfPh)
+{
+	return Sark_Thru_SetReference (pThru, pfMag, pfPh);
+}
+
+__declspec(dllexport) int SARK110_Thru_SetCancel(T_SARK_THRU *pThru, T_SARK_CANCEL *ptCancel)
+{
+	return Sark_Thru_SetCancel (pThru, ptCancel);
+}
+
+__declspec(dllexport) int SARK110_Thru_SetProgress(T_SARK_THRU *pThru, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	return Sark_Thru_SetProgress (pThru, pfCallback, pvUser, u32Ms, iPoints);
+}
+
+__declspec(dllexport) int SARK110_Thru_Run(int16 num, T_SARK_THRU *pThru, float *pfMagDb, float *pfPhase, float *pfDelay)
+{
+	return Sark_Thru_Run (num, pThru, pfMagDb, pfPhase, pfDelay);
+}
+
+__declspec(dllexport) T_SARK_TDR *SARK110_Tdr_Create(int iPoints, uint32 u32Step, int iFftSize, uint8 u8Window, float fVf, float fZ0)
+{
+	return Sark_Tdr_Create (iPoints, u32Step, iFftSize, u8Window, fVf, fZ0);
+}
+
+__declspec(dllexport) void SARK110_Tdr_Destroy(T_SARK_TDR *pTdr)
+{
+	Sark_Tdr_Destroy (pTdr);
+}
+
+__declspec(dllexport) int SARK110_Tdr_Size(T_SARK_TDR *pTdr)
+{
+	return Sark_Tdr_Size (pTdr);
+}
+
+__declspec(dllexport) int SARK110_Tdr_Process(T_SARK_TDR *pTdr, const float *pfR, const float *pfX, float *pfDist, float *pfImpulse, float *pfStep)
+{
+	return Sark_Tdr_Process (pTdr, pfR, pfX, pfDist, pfImpulse, pfStep);
+}
+
+__declspec(dllexport) T_SARK_SWEEP *SARK110_Sweep_Slice(T_SARK_SWEEP *pSweep, int iFirst, int iPoints)
+{
+	return Sark_Sweep_Slice (pSweep, iFirst, iPoints);
+}
+
+__declspec(dllexport) T_SARK_SPLIT *SARK110_Split_Create(T_SARK_SWEEP *pSweep, const int16 *pi16Dev, int iDevs)
+{
+	return Sark_Split_Create (pSweep, pi16Dev, iDevs);
+}
+
+__declspec(dllexport) void SARK110_Split_Destroy(T_SARK_SPLIT *pSplit)
+{
+	Sark_Split_Destroy (pSplit);
+}
+
+__declspec(dllexport) int SARK110_Split_SetOffset(T_SARK_SPLIT *pSplit, int16 num, const float *pfR, const float *pfX)
+{
+	return Sark_Split_SetOffset (pSplit, num, pfR, pfX);
+}
+
+__declspec(dllexport) int SARK110_Split_Run(T_SARK_SPLIT *pSplit, float *pfR, float *pfX)
+{
+	return Sark_Split_Run (pSplit, pfR, pfX);
+}
+
+__declspec(dllexport) T_SARK_JOBS *SARK110_Jobs_Create(const int16 *pi16Dev, int iDevs)
+{
+	return Sark_Jobs_Create (pi16Dev, iDevs);
+}
+
+__declspec(dllexport) void SARK110_Jobs_Destroy(T_SARK_JOBS *pJobs)
+{
+	Sark_Jobs_Destroy (pJobs);
+}
+
+__declspec(dllexport) int SARK110_Jobs_Run(T_SARK_JOBS *pJobs, T_SARK_JOB *ptJob, int iCount)
+{
+	return Sark_Jobs_Run (pJobs, ptJob, iCount);
+}
+
+__declspec(dllexport) int SARK110_Jobs_SetTiming(T_SARK_JOBS *pJobs, T_SARK_TIMING *ptTiming)
+{
+	return Sark_Jobs_SetTiming (pJobs, ptTiming);
+}
+
+__declspec(dllexport) int SARK110_Jobs_SetCancel(T_SARK_JOBS *pJobs, T_SARK_CANCEL *ptCancel)
+{
+	return Sark_Jobs_SetCancel (pJobs, ptCancel);
+}
+
+__declspec(dllexport) int SARK110_Jobs_SetProgress(T_SARK_JOBS *pJobs, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	return Sark_Jobs_SetProgress (pJobs, pfCallback, pvUser, u32Ms, iPoints);
+}
+
+__declspec(dllexport) int SARK110_Jobs_Stats(T_SARK_JOBS *pJobs, int16 num, uint32 *pu32Done, uint32 *pu32Stolen, float *pfLatency)
+{
+	return Sark_Jobs_Stats (pJobs, num, pu32Done, pu32Stolen, pfLatency);
+}
+
+__declspec(dllexport) T_SARK_PROXY *SARK110_Proxy_Start(uint16 u16Port, int iDevs)
+{
+	return Sark_Proxy_Start (u16Port, iDevs);
+}
+
+__declspec(dllexport) void SARK110_Proxy_Stop(T_SARK_PROXY *pProxy)
+{
+	Sark_Proxy_Stop (pProxy);
+}
+
+__declspec(dllexport) int SARK110_Proxy_Stats(T_SARK_PROXY *pProxy, int16 num, uint32 *pu32Served, uint32 *pu32Coalesced, uint32 *pu32Clients)
+{
+	return Sark_Proxy_Stats (pProxy, num, pu32Served, pu32Coalesced, pu32Clients);
+}
+
+__declspec(dllexport) int SARK110_Proxy_Shm(T_SARK_PROXY *pProxy, const char *pszName)
+{
+	return Sark_Proxy_Shm (pProxy, pszName);
+}
+
+__declspec(dllexport) T_SHM_SERVER *SARK110_Shm_Server_Create(const char *pszName)
+{
+	return Shm_Server_Create (pszName);
+}
+
+__declspec(dllexport) void SARK110_Shm_Server_Destroy(T_SHM_SERVER *pSrv)
+{
+	Shm_Server_Destroy (pSrv);
+}
+
+__declspec(dllexport) int SARK110_Shm_Server_Recv(T_SHM_SERVER *pSrv, uint8 *tx, uint32 *pu32Seq, DWORD dwTimeout)
+{
+	return Shm_Server_Recv (pSrv, tx, pu32Seq, dwTimeout);
+}
+
+__declspec(dllexport) int SARK110_Shm_Server_Send(T_SHM_SERVER *pSrv, uint32 u32Seq, const uint8 *rx)
+{
+	return Shm_Server_Send (pSrv, u32Seq, rx);
+}
+
+__declspec(dllexport) T_SARK_PUB *SARK110_Pub_Start(uint16 u16Port, int16 num, T_SARK_SWEEP *pSweep, uint8 u8Format)
+{
+	return Sark_Pub_Start (u16Port, num, pSweep, u8Format);
+}
+
+__declspec(dllexport) void SARK110_Pub_Stop(T_SARK_PUB *pPub)
+{
+	Sark_Pub_Stop (pPub);
+}
+
+__declspec(dllexport) int SARK110_Pub_Post(T_SARK_PUB *pPub, uint32 u32Seq, const float *pfR, const float *pfX)
+{
+	return Sark_Pub_Post (pPub, u32Seq, pfR, pfX);
+}
+
+__declspec(dllexport) int SARK110_Pub_Stats(T_SARK_PUB *pPub, uint32 *pu32Subs, uint32 *pu32Sent, uint32 *pu32Skipped, uint32 *pu32Dropped)
+{
+	return Sark_Pub_Stats (pPub, pu32Subs, pu32Sent, pu32Skipped, pu32Dropped);
+}
+
+__declspec(dllexport) T_SARK_PLAN *SARK110_Plan_Create(const uint32 *pu32Freq, int iPoints, bool bCal, uint8 u8Samples, bool bFloat)
+{
+	return Sark_Plan_Create (pu32Freq, iPoints, bCal, u8Samples, bFloat);
+}
+
+__declspec(dllexport) void SARK110_Plan_Destroy(T_SARK_PLAN *pPlan)
+{
+	Sark_Plan_Destroy (pPlan);
+}
+
+__declspec(dllexport) int SARK110_Plan_Points(T_SARK_PLAN *pPlan)
+{
+	return Sark_Plan_Points (pPlan);
+}
+
+__declspec(dllexport) int SARK110_Plan_SetTiming(T_SARK_PLAN *pPlan, T_SARK_TIMING *ptTiming)
+{
+	return Sark_Plan_SetTiming (pPlan, ptTiming);
+}
+
+__declspec(dllexport) int SARK110_Plan_SetCancel(T_SARK_PLAN *pPlan, T_SARK_CANCEL *ptCancel)
+{
+	return Sark_Plan_SetCancel (pPlan, ptCancel);
+}
+
+__declspec(dllexport) int SARK110_Plan_SetProgress(T_SARK_PLAN *pPlan, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	return Sark_Plan_SetProgress (pPlan, pfCallback, pvUser, u32Ms, iPoints);
+}
+
+__declspec(dllexport) int SARK110_Plan_Run(int16 num, T_SARK_PLAN *pPlan, float *pfR, float *pfX)
+{
+	return Sark_Plan_Run (num, pPlan, pfR, pfX);
+}
+
+__declspec(dllexport) int SARK110_Plan_Save(T_SARK_PLAN *pPlan, const char *pszFile)
+{
+	return Sark_Plan_Save (pPlan, pszFile);
+}
+
+__declspec(dllexport) T_SARK_PLAN *SARK110_Plan_Load(const char *pszFile)
+{
+	return Sark_Plan_Load (pszFile);
+}
+
+__declspec(dllexport) T_SARK_CANCEL *SARK110_Cancel_Create(void)
+{
+	return Sark_Cancel_Create ();
+}
+
+__declspec(dllexport) void SARK110_Cancel_Destroy(T_SARK_CANCEL *ptCancel)
+{
+	Sark_Cancel_Destroy (ptCancel);
+}
+
+__declspec(dllexport) int SARK110_Cancel_Set(T_SARK_CANCEL *ptCancel)
+{
+	return Sark_Cancel_Set (ptCancel);
+}
+
+__declspec(dllexport) int SARK110_Cancel_Reset(T_SARK_CANCEL *ptCancel)
+{
+	return Sark_Cancel_Reset (ptCancel);
+}
+
+__declspec(dllexport) int SARK110_Cancel_SetDeadline(T_SARK_CANCEL *ptCancel, LONGLONG llDeadline)
+{
+	return Sark_Cancel_SetDeadline (ptCancel, llDeadline);
+}
+
+__declspec(dllexport) bool SARK110_Cancel_Expired(T_SARK_CANCEL *ptCancel)
+{
+	return Sark_Cancel_Expired (ptCancel);
+}
+
 }
\ No newline at end of file
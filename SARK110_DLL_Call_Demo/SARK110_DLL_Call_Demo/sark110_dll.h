@@ -45,14 +45,92 @@ typedef enum
 {
 	ITFZ_HID,
 	ITFZ_BT,
-	ITFZ_SOCK
+	ITFZ_SOCK,
+	ITFZ_UNIX,
+	ITFZ_SHM,
+	ITFZ_SIM
 } T_ITFZ;
 
+typedef struct sark_sweep T_SARK_SWEEP;
+typedef struct sark_monitor T_SARK_MONITOR;
+typedef struct sark_alarm T_SARK_ALARM;
+
+typedef struct
+{
+	uint32 u32Seq;			/* sweep sequence number */
+	int32 i32Point;			/* point index in the sweep */
+	uint8 u8Type;			/* ALARM_RAISE, ALARM_CLEAR */
+	float fR;				/* measured R */
+	float fX;				/* measured X */
+	float fDev;				/* deviation from baseline in sigmas */
+} T_SARK_ALARM_EVENT;
+typedef struct sark_spectrum T_SARK_SPECTRUM;
+typedef struct sark_thru T_SARK_THRU;
+typedef struct sark_tdr T_SARK_TDR;
+typedef struct sark_split T_SARK_SPLIT;
+typedef struct sark_jobs T_SARK_JOBS;
+typedef struct sark_proxy T_SARK_PROXY;
+typedef struct shm_server T_SHM_SERVER;
+typedef struct sark_pub T_SARK_PUB;
+typedef struct sark_plan T_SARK_PLAN;
+typedef struct sark_cancel T_SARK_CANCEL;
+
+/* Progress callback: points iFirst to iEnd-1 newly completed */
+typedef void (*SARK_PROGRESS) (void *pvUser, int iFirst, int iEnd);
+
+typedef struct
+{
+	uint32 u32Freq;			/* frequency */
+	uint8 u8Type;			/* JOB_MEAS_RX, JOB_MEAS_VECT, JOB_MEAS_THRU, JOB_MEAS_RF */
+	uint8 u8Cal;			/* JOB_MEAS_RX: {1: OSL calibrated; 0: not calibrated} */
+	uint8 u8Samples;		/* JOB_MEAS_RX: number of samples to average */
+	int8 i8Rc;				/* return: result of the measurement */
+	int16 i16Dev;			/* return: device that measured it */
+	float tfVal[4];			/* return: values in the order of SARK110_Meas_xx */
+} T_SARK_JOB;
+
+typedef struct
+{
+	LONGLONG *pllSend;		/* performance counter when the request of every point was sent */
+	LONGLONG *pllRecv;		/* performance counter when the answer of every point was received */
+	int iPoints;			/* entries of pllSend and pllRecv */
+	LONGLONG llFreq;		/* return: counter ticks per second */
+	LONGLONG llStart;		/* return: counter at the start of the run */
+	double dTotal;			/* return: duration of the run (ms) */
+	double dExchange;		/* return: time waiting for device answers (ms) */
+	double dProbe;			/* return: part of dExchange probing adaptive averaging (ms) */
+	double dHost;			/* return: dTotal - dExchange (ms) */
+} T_SARK_TIMING;
+
 /* Exported constants --------------------------------------------------------*/
+#define ALARM_RAISE			1
+#define ALARM_CLEAR			2
+
+#define TDR_WIN_RECT		0
+#define TDR_WIN_HANN		1
+#define TDR_WIN_HAMMING		2
+#define TDR_WIN_BLACKMAN	3
+
+#define JOB_MEAS_RX			0
+#define JOB_MEAS_VECT		1
+#define JOB_MEAS_THRU		2
+#define JOB_MEAS_RF			3
+
+#define SARK_CANCELLED		-5	/* return code: cancelled or deadline passed */
+
+/* Publisher wire format, described in sark_pub.h */
+#define PUB_PREFIX_SIZE		8
+#define PUB_FW_SIZE			16
+#define PUB_MSG_PLAN		'P'
+#define PUB_MSG_SWEEP		'S'
+#define PUB_FMT_FLOAT		0
+#define PUB_FMT_HALF		1
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 extern int SARK110_Connect(int16 itfz, int16 maxDev, char *serverAddr);
 extern int SARK110_Close(int16 num);
+extern int SARK110_Net_Loop(bool bOn);
 extern int SARK110_Version(int16 num, uint16 *pu16Ver, uint8 *pu8FW);
 extern int SARK110_Meas_Rx(int16 num, uint32 u32Freq, bool bCal, uint8 u8Samples, float *pfR, float *pfX, float *pfS21re, float *pfS21im);
 extern int SARK110_Meas_Rx_Eff (int16 num, uint32 u32Freq, uint32 u32Step, bool bCal, uint8 u8Samples,
@@ -61,6 +139,8 @@ extern int SARK110_Meas_Rx_Eff (int16 num, uint32 u32Freq, uint32 u32Step, bool
 	float *pfR3, float *pfX3,
 	float *pfR4, float *pfX4
 	);
+extern int SARK110_Meas_Rx_Bulk(int16 num, uint32 u32Freq, uint32 u32Step, uint16 u16Points, bool bCal, uint8 u8Samples,
+	bool bFloat, float *pfR, float *pfX);
 extern int SARK110_Meas_Vect(int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV,
 										   float *pfMagI, float *pfPhI );
 extern int SARK110_Meas_RF(int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV,
@@ -77,6 +157,84 @@ extern int SARK110_Device_Reset (int16 num);
 extern int SARK110_GPIO(int16 num, uint8 u8Cmd, uint8 u8Port, uint8 u8In, uint8 *pu8Out);
 extern int SARK110_SetSetting (int16 num, uint8 u8Reg, uint8 u8Val);
 extern int SARK110_GetSetting (int16 num, uint8 u8Reg, uint8 *pu8Val);
+extern T_SARK_SWEEP *SARK110_Sweep_Create(const uint32 *pu32Freq, int iPoints, bool bCal, uint8 u8Samples);
+extern void SARK110_Sweep_Destroy(T_SARK_SWEEP *pSweep);
+extern int SARK110_Sweep_Adaptive(T_SARK_SWEEP *pSweep, float fNoise, uint8 u8MinSamples, uint8 u8MaxSamples, int iRegionPoints);
+extern int SARK110_Sweep_GetSamples(T_SARK_SWEEP *pSweep, uint8 *pu8Samples);
+extern int SARK110_Sweep_GetFreq(T_SARK_SWEEP *pSweep, uint32 *pu32Freq);
+extern int SARK110_Sweep_SetCancel(T_SARK_SWEEP *pSweep, T_SARK_CANCEL *ptCancel);
+extern int SARK110_Sweep_SetProgress(T_SARK_SWEEP *pSweep, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints);
+extern int SARK110_Sweep_Run(int16 num, T_SARK_SWEEP *pSweep, float *pfR, float *pfX);
+extern int SARK110_Sweep_Points(T_SARK_SWEEP *pSweep);
+extern int SARK110_Sweep_SetTiming(T_SARK_SWEEP *pSweep, T_SARK_TIMING *ptTiming);
+extern T_SARK_MONITOR *SARK110_Monitor_Start(int16 num, T_SARK_SWEEP *pSweep, int iSlots, uint32 u32Interval);
+extern void SARK110_Monitor_Stop(T_SARK_MONITOR *pMon);
+extern int SARK110_Monitor_Latest(T_SARK_MONITOR *pMon, uint32 *pu32Seq, float *pfR, float *pfX);
+extern int SARK110_Monitor_Read(T_SARK_MONITOR *pMon, uint32 u32Seq, float *pfR, float *pfX);
+extern int SARK110_Monitor_Status(T_SARK_MONITOR *pMon, uint32 *pu32Sweeps, uint32 *pu32Errors, int *piLastRc);
+extern T_SARK_ALARM *SARK110_Alarm_Create(int iPoints, int iWarmup, float fAlpha, float fSigmas, float fMinDelta, int iQueue);
+extern void SARK110_Alarm_Destroy(T_SARK_ALARM *pAlarm);
+extern void SARK110_Alarm_Reset(T_SARK_ALARM *pAlarm);
+extern int SARK110_Alarm_Update(T_SARK_ALARM *pAlarm, uint32 u32Seq, const float *pfR, const float *pfX);
+extern int SARK110_Alarm_GetEvents(T_SARK_ALARM *pAlarm, T_SARK_ALARM_EVENT *ptEvents, int iMax, uint32 *pu32Lost);
+extern int SARK110_Monitor_SetAlarm(T_SARK_MONITOR *pMon, T_SARK_ALARM *pAlarm);
+extern int SARK110_Monitor_SetPub(T_SARK_MONITOR *pMon, T_SARK_PUB *pPub);
+extern int SARK110_Monitor_SetCancel(T_SARK_MONITOR *pMon, T_SARK_CANCEL *ptCancel);
+extern T_SARK_SPECTRUM *SARK110_Spectrum_Create(uint32 u32Start, uint32 u32Step, int iPoints, int iRows);
+extern void SARK110_Spectrum_Destroy(T_SARK_SPECTRUM *pSpec);
+extern void SARK110_Spectrum_Reset(T_SARK_SPECTRUM *pSpec);
+extern int SARK110_Spectrum_Scan(int16 num, T_SARK_SPECTRUM *pSpec, int iScans);
+extern int SARK110_Spectrum_Traces(T_SARK_SPECTRUM *pSpec, float *pfLast, float *pfPeak, float *pfMin, float *pfAvg, uint32 *pu32Scans);
+extern int SARK110_Spectrum_Waterfall(T_SARK_SPECTRUM *pSpec, uint32 u32Scan, float *pfLevel);
+extern T_SARK_THRU *SARK110_Thru_Create(const uint32 *pu32Freq, int iPoints);
+extern void SARK110_Thru_Destroy(T_SARK_THRU *pThru);
+extern int SARK110_Thru_Reference(int16 num, T_SARK_THRU *pThru);
+extern int SARK110_Thru_GetReference(T_SARK_THRU *pThru, float *pfMag, float *pfPh);
+extern int SARK110_Thru_SetReference(T_SARK_THRU *pThru, const float *pfMag, const float *pfPh);
+extern int SARK110_Thru_Run(int16 num, T_SARK_THRU *pThru, float *pfMagDb, float *pfPhase, float *pfDelay);
+extern T_SARK_TDR *SARK110_Tdr_Create(int iPoints, uint32 u32Step, int iFftSize, uint8 u8Window, float fVf, float fZ0);
+extern void SARK110_Tdr_Destroy(T_SARK_TDR *pTdr);
+extern int SARK110_Tdr_Size(T_SARK_TDR *pTdr);
+extern int SARK110_Tdr_Process(T_SARK_TDR *pTdr, const float *pfR, const float *pfX, float *pfDist, float *pfImpulse, float *pfStep);
+extern T_SARK_SWEEP *SARK110_Sweep_Slice(T_SARK_SWEEP *pSweep, int iFirst, int iPoints);
+extern T_SARK_SPLIT *SARK110_Split_Create(T_SARK_SWEEP *pSweep, const int16 *pi16Dev, int iDevs);
+extern void SARK110_Split_Destroy(T_SARK_SPLIT *pSplit);
+extern int SARK110_Split_SetOffset(T_SARK_SPLIT *pSplit, int16 num, const float *pfR, const float *pfX);
+extern int SARK110_Split_Run(T_SARK_SPLIT *pSplit, float *pfR, float *pfX);
+extern T_SARK_JOBS *SARK110_Jobs_Create(const int16 *pi16Dev, int iDevs);
+extern void SARK110_Jobs_Destroy(T_SARK_JOBS *pJobs);
+extern int SARK110_Jobs_Run(T_SARK_JOBS *pJobs, T_SARK_JOB *ptJob, int iCount);
+extern int SARK110_Jobs_SetTiming(T_SARK_JOBS *pJobs, T_SARK_TIMING *ptTiming);
+extern int SARK110_Jobs_SetCancel(T_SARK_JOBS *pJobs, T_SARK_CANCEL *ptCancel);
+extern int SARK110_Jobs_SetProgress(T_SARK_JOBS *pJobs, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints);
+extern int SARK110_Jobs_Stats(T_SARK_JOBS *pJobs, int16 num, uint32 *pu32Done, uint32 *pu32Stolen, float *pfLatency);
+extern T_SARK_PROXY *SARK110_Proxy_Start(uint16 u16Port, int iDevs);
+extern void SARK110_Proxy_Stop(T_SARK_PROXY *pProxy);
+extern int SARK110_Proxy_Stats(T_SARK_PROXY *pProxy, int16 num, uint32 *pu32Served, uint32 *pu32Coalesced, uint32 *pu32Clients);
+extern int SARK110_Proxy_Shm(T_SARK_PROXY *pProxy, const char *pszName);
+extern T_SHM_SERVER *SARK110_Shm_Server_Create(const char *pszName);
+extern void SARK110_Shm_Server_Destroy(T_SHM_SERVER *pSrv);
+extern int SARK110_Shm_Server_Recv(T_SHM_SERVER *pSrv, uint8 *tx, uint32 *pu32Seq, DWORD dwTimeout);
+extern int SARK110_Shm_Server_Send(T_SHM_SERVER *pSrv, uint32 u32Seq, const uint8 *rx);
+extern T_SARK_PUB *SARK110_Pub_Start(uint16 u16Port, int16 num, T_SARK_SWEEP *pSweep, uint8 u8Format);
+extern void SARK110_Pub_Stop(T_SARK_PUB *pPub);
+extern int SARK110_Pub_Post(T_SARK_PUB *pPub, uint32 u32Seq, const float *pfR, const float *pfX);
+extern int SARK110_Pub_Stats(T_SARK_PUB *pPub, uint32 *pu32Subs, uint32 *pu32Sent, uint32 *pu32Skipped, uint32 *pu32Dropped);
+extern T_SARK_PLAN *SARK110_Plan_Create(const uint32 *pu32Freq, int iPoints, bool bCal, uint8 u8Samples, bool bFloat);
+extern void SARK110_Plan_Destroy(T_SARK_PLAN *pPlan);
+extern int SARK110_Plan_Points(T_SARK_PLAN *pPlan);
+extern int SARK110_Plan_SetTiming(T_SARK_PLAN *pPlan, T_SARK_TIMING *ptTiming);
+extern int SARK110_Plan_SetCancel(T_SARK_PLAN *pPlan, T_SARK_CANCEL *ptCancel);
+extern int SARK110_Plan_SetProgress(T_SARK_PLAN *pPlan, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints);
+extern int SARK110_Plan_Run(int16 num, T_SARK_PLAN *pPlan, float *pfR, float *pfX);
+extern int SARK110_Plan_Save(T_SARK_PLAN *pPlan, const char *pszFile);
+extern T_SARK_PLAN *SARK110_Plan_Load(const char *pszFile);
+extern T_SARK_CANCEL *SARK110_Cancel_Create(void);
+extern void SARK110_Cancel_Destroy(T_SARK_CANCEL *ptCancel);
+extern int SARK110_Cancel_Set(T_SARK_CANCEL *ptCancel);
+extern int SARK110_Cancel_Reset(T_SARK_CANCEL *ptCancel);
+extern int SARK110_Cancel_SetDeadline(T_SARK_CANCEL *ptCancel, LONGLONG llDeadline);
+extern bool SARK110_Cancel_Expired(T_SARK_CANCEL *ptCancel);
 
 #endif	 /* __SARK110_DLL_H__ */
 
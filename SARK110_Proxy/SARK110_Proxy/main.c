@@ -0,0 +1,91 @@
+// main.c : Local proxy sharing the SARK-110 devices with several programs.
+//
+// Usage: SARK110_Proxy [itfz [devices [port [address [shm]]]]]
+//
+// The devices are connected with SARK110_Connect(itfz, devices, address) and
+// device n is served on port + n of the loopback address. The programs then
+// connect with SARK110_Connect(2, 1, "127.0.0.1:port"); the default port is
+// the default of the socket interface, so "127.0.0.1" reaches device 0.
+// Interface 5 (simulator) takes the simulation mode as address. When a shared
+// memory name is given, device n is also served on that name followed by n,
+// for programs using SARK110_Connect(4, 1, "name0").
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <conio.h>
+#include "sark110_dll.h"
+
+#define PROXY_PORT		8888	/* default port of the socket interface */
+#define STATS_TICKS		50		/* statistics every 50 x 100 ms */
+
+int main(int argc, char* argv[])
+{
+	int16 i16Itfz = 0;
+	int iDevs = 1;
+	uint16 u16Port = PROXY_PORT;
+	char *pszAddr = NULL;
+	char *pszShm = NULL;
+	T_SARK_PROXY *pProxy;
+	uint32 u32Served, u32Coalesced, u32Clients;
+	int iTick;
+	int ii;
+	int rc;
+
+	if (argc > 1)
+		i16Itfz = (int16)atoi(argv[1]);
+	if (argc > 2)
+		iDevs = atoi(argv[2]);
+	if (argc > 3)
+		u16Port = (uint16)atoi(argv[3]);
+	if (argc > 4)
+		pszAddr = argv[4];
+	if (argc > 5)
+		pszShm = argv[5];
+
+	rc = SARK110_Connect(i16Itfz, (int16)iDevs, pszAddr);
+	if (rc <= 0)
+	{
+		printf("Cannot connect to SARK-110\n");
+		return -1;
+	}
+	if (rc < iDevs)
+		iDevs = rc;
+
+	pProxy = SARK110_Proxy_Start(u16Port, iDevs);
+	if (pProxy == NULL)
+	{
+		printf("Cannot listen on port %u\n", u16Port);
+		for (ii = 0; ii < iDevs; ii++)
+			SARK110_Close((int16)ii);
+		return -1;
+	}
+	if (pszShm != NULL && SARK110_Proxy_Shm(pProxy, pszShm) < 0)
+	{
+		printf("Cannot serve on shared memory %s\n", pszShm);
+		SARK110_Proxy_Stop(pProxy);
+		for (ii = 0; ii < iDevs; ii++)
+			SARK110_Close((int16)ii);
+		return -1;
+	}
+	printf("Serving %d device(s) from 127.0.0.1:%u, press a key to stop\n", iDevs, u16Port);
+
+	for (iTick = 1; !_kbhit(); iTick++)
+	{
+		Sleep(100);
+		if (iTick % STATS_TICKS != 0)
+			continue;
+		for (ii = 0; ii < iDevs; ii++)
+		{
+			SARK110_Proxy_Stats(pProxy, (int16)ii, &u32Served, &u32Coalesced, &u32Clients);
+			printf("Device %d: clients:%lu, requests:%lu, coalesced:%lu\n", ii, u32Clients, u32Served, u32Coalesced);
+		}
+	}
+
+	SARK110_Proxy_Stop(pProxy);
+	for (ii = 0; ii < iDevs; ii++)
+		SARK110_Close((int16)ii);
+	printf("** End **\n");
+
+	return 0;
+}
@@ -53,11 +53,20 @@
 
 typedef unsigned char           uint8;
 typedef unsigned short          uint16;
+#ifdef _WIN32
 typedef unsigned long           uint32;
+#else
+/* long is 64 bits on LP64 hosts, as in the tests built on Linux */
+typedef unsigned int            uint32;
+#endif
 
 typedef signed char             int8;
 typedef signed short            int16;
+#ifdef _WIN32
 typedef signed long             int32;
+#else
+typedef signed int              int32;
+#endif
 
 //typedef unsigned char           bool;
 
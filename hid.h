@@ -36,9 +36,14 @@
 #ifndef __HID_H__
 #define __HID_H__
 
+#define HID_MAX_DEVICES	64	/* maximum number of devices opened */
+
 int rawhid_open(int max, int vid, int pid, int usage_page, int usage);
 int rawhid_recv(int num, void *buf, int len, int timeout);
 int rawhid_send(int num, void *buf, int len, int timeout);
+int rawhid_resend(int num, void *buf, int len, int timeout);
+int rawhid_recv_report(int num, void *report, int len, int timeout);
+int rawhid_send_report(int num, void *report, int len, int timeout, int retry);
 void rawhid_close(int num);
 
 #endif	 /* __HID_H__ */
@@ -5,6 +5,7 @@
  *  rawhid_open - open 1 or more devices
  *  rawhid_recv - receive a packet
  *  rawhid_send - send a packet
+ *  rawhid_resend - send a packet again
  *  rawhid_close - close a device
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
@@ -33,6 +34,7 @@
 //#include <stdint.h>
 #include <windows.h>
 #include <setupapi.h>
+#include <cfgmgr32.h>
 
 extern "C"
 {
@@ -41,30 +43,61 @@ extern "C"
 //#include <hidclass.h>
 
 #include "hid.h"
+#include "hid_rx.h"
 
 
-// a list of all opened HID devices, so the caller can
-// simply refer to them by number
+// a table of all opened HID devices, so the caller can
+// simply refer to them by number; each device has its own
+// I/O state, so transfers on different devices overlap.
+// Reports are received by a thread per device that keeps
+// a read always posted (see hid_rx.cpp)
+// The devices live in a pool and the table points to them,
+// so numbers are given again without moving their I/O state
 typedef struct hid_struct hid_t;
-static hid_t *first_hid = NULL;
-static hid_t *last_hid = NULL;
 struct hid_struct {
 	HANDLE handle;
 	int open;
-	struct hid_struct *prev;
-	struct hid_struct *next;
+	int gone;
+	WCHAR path[MAX_PATH];
+	T_HID_RX *rx;
+	HANDLE rx_event;
+	HANDLE tx_event;
+	OVERLAPPED rx_ov;
+	OVERLAPPED tx_ov;
+	CRITICAL_SECTION rx_mutex;
+	CRITICAL_SECTION tx_mutex;
+	unsigned char tx_buf[516];
 };
-static HANDLE rx_event=NULL;
-static HANDLE tx_event=NULL;
-static CRITICAL_SECTION rx_mutex;
-static CRITICAL_SECTION tx_mutex;
+static hid_t hid_pool[HID_MAX_DEVICES];
+static hid_t *hid_table[HID_MAX_DEVICES];
+static int hid_count = 0;
+static int hid_init = 0;
+
+// paths of the devices matching the last filter given to
+// rawhid_open, kept current by hotplug notifications
+static WCHAR cache_path[HID_MAX_DEVICES][MAX_PATH];
+static int cache_count = 0;
+static int cache_valid = 0;
+static int cache_filter[4];	// vid, pid, usage_page, usage
+static HCMNOTIFICATION cache_notify = NULL;
+static CRITICAL_SECTION cache_mutex;
 
 
 // private functions, not intended to be used from outside this file
-static void add_hid(hid_t *h);
+static void init_hid_table(void);
 static hid_t * get_hid(int num);
 static void free_all_hid(void);
 static void hid_close(hid_t *hid);
+static hid_t * hid_open_path(const WCHAR *path);
+static int hid_match(const WCHAR *path);
+static void cache_scan(void);
+static void cache_watch(void);
+static DWORD CALLBACK cache_notify_cb(HCMNOTIFICATION notify, PVOID context,
+	CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA data, DWORD size);
+static int hid_wait(hid_t *hid, OVERLAPPED *ov, DWORD *n, int timeout);
+static int hid_write(int num, void *buf, int len, int timeout, bool retry, bool in_place);
+static int hid_read(void *dev, uint8 *buf, int len);
+static void hid_cancel(void *dev);
 void print_win32_err(void);
 
 
@@ -77,43 +110,52 @@ void print_win32_err(void);
 //	len = buffer's size
 //	timeout = time to wait, in milliseconds
 //    Output:
-//	number of bytes received, or -1 on error
+//	number of bytes received, 0 on timeout, or -1 on error
+//
+//  Answers to earlier packets that arrive late are skipped,
+//  unless the packet was sent again with rawhid_resend
 //
 int rawhid_recv(int num, void *buf, int len, int timeout)
 {
 	hid_t *hid;
-	unsigned char tmpbuf[516];
-	OVERLAPPED ov;
-	DWORD n, r;
+	unsigned char tmpbuf[HIDRX_REPORT_MAX];
+	int n;
 
-	if (sizeof(tmpbuf) < len + 1) return -1;
 	hid = get_hid(num);
 	if (!hid || !hid->open) return -1;
-	EnterCriticalSection(&rx_mutex);
-	ResetEvent(&rx_event);
-	memset(&ov, 0, sizeof(ov));
-	ov.hEvent = rx_event;
-	if (!ReadFile(hid->handle, tmpbuf, len + 1, NULL, &ov)) {
-		if (GetLastError() != ERROR_IO_PENDING) goto return_error;
-		r = WaitForSingleObject(rx_event, timeout);
-		if (r == WAIT_TIMEOUT) goto return_timeout;
-		if (r != WAIT_OBJECT_0) goto return_error;
-	}
-	if (!GetOverlappedResult(hid->handle, &ov, &n, FALSE)) goto return_error;
-	LeaveCriticalSection(&rx_mutex);
-	if (n <= 0) return -1;
+	EnterCriticalSection(&hid->rx_mutex);
+	n = HidRx_Recv(hid->rx, tmpbuf, sizeof(tmpbuf), timeout);
+	LeaveCriticalSection(&hid->rx_mutex);
+	if (n <= 0) return n;
 	n--;
 	if (n > len) n = len;
 	memcpy(buf, tmpbuf + 1, n);
 	return n;
-return_timeout:
-	CancelIo(hid->handle);
-	LeaveCriticalSection(&rx_mutex);
-	return 0;
-return_error:
-	print_win32_err();
-	LeaveCriticalSection(&rx_mutex);
-	return -1;
+}
+
+//  rawhid_recv_report - receive a packet into a whole report buffer
+//    Inputs:
+//	num = device to receive from (zero based)
+//	report = buffer to receive the report, byte 0 is the report ID
+//	len = buffer's size, report ID included
+//	timeout = time to wait, in milliseconds
+//    Output:
+//	number of bytes received with the report ID, 0 on timeout, or -1 on error
+//
+//  The report is stored straight into the caller's buffer,
+//  so the packet is decoded from report + 1 without copies
+//
+int rawhid_recv_report(int num, void *report, int len, int timeout)
+{
+	hid_t *hid;
+	int n;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+	EnterCriticalSection(&hid->rx_mutex);
+	n = HidRx_Recv(hid->rx, (uint8 *)report, len, timeout);
+	LeaveCriticalSection(&hid->rx_mutex);
+	return n;
 }
 
 //  rawhid_send - send a packet
@@ -127,38 +169,43 @@ return_error:
 //
 int rawhid_send(int num, void *buf, int len, int timeout)
 {
-	hid_t *hid;
-	unsigned char tmpbuf[516];
-	OVERLAPPED ov;
-	DWORD n, r;
+	return hid_write(num, buf, len, timeout, false, false);
+}
 
-	if (sizeof(tmpbuf) < len + 1) return -1;
-	hid = get_hid(num);
-	if (!hid || !hid->open) return -1;
-	EnterCriticalSection(&tx_mutex);
-	ResetEvent(&tx_event);
-	memset(&ov, 0, sizeof(ov));
-	ov.hEvent = tx_event;
-	tmpbuf[0] = 0;
-	memcpy(tmpbuf + 1, buf, len);
-	if (!WriteFile(hid->handle, tmpbuf, len + 1, NULL, &ov)) {
-		if (GetLastError() != ERROR_IO_PENDING) goto return_error;
-		r = WaitForSingleObject(tx_event, timeout);
-		if (r == WAIT_TIMEOUT) goto return_timeout;
-		if (r != WAIT_OBJECT_0) goto return_error;
-	}
-	if (!GetOverlappedResult(hid->handle, &ov, &n, FALSE)) goto return_error;
-	LeaveCriticalSection(&tx_mutex);
-	if (n <= 0) return -1;
-	return n - 1;
-return_timeout:
-	CancelIo(hid->handle);
-	LeaveCriticalSection(&tx_mutex);
-	return 0;
-return_error:
-	print_win32_err();
-	LeaveCriticalSection(&tx_mutex);
-	return -1;
+//  rawhid_resend - send a packet again after its answer timed out
+//    Inputs:
+//	num = device to transmit to (zero based)
+//	buf = buffer containing packet to send
+//	len = number of bytes to transmit
+//	timeout = time to wait, in milliseconds
+//    Output:
+//	number of bytes sent, or -1 on error
+//
+//  A late answer to an earlier attempt is then taken by
+//  rawhid_recv as the answer instead of being discarded
+//
+int rawhid_resend(int num, void *buf, int len, int timeout)
+{
+	return hid_write(num, buf, len, timeout, true, false);
+}
+
+//  rawhid_send_report - send a packet from a whole report buffer
+//    Inputs:
+//	num = device to transmit to (zero based)
+//	report = report to send, byte 0 is reserved for the report ID
+//	len = number of bytes to transmit, report ID included
+//	timeout = time to wait, in milliseconds
+//	retry = non-zero if the packet is sent again, as rawhid_resend
+//    Output:
+//	number of bytes sent, or -1 on error
+//
+//  The report ID is written in place and the report is sent
+//  from the caller's buffer, which is not used after return
+//
+int rawhid_send_report(int num, void *report, int len, int timeout, int retry)
+{
+	if (len < 1) return -1;
+	return hid_write(num, report, len - 1, timeout, retry != 0, true);
 }
 
 //  rawhid_open - open 1 or more devices
@@ -172,81 +219,60 @@ return_error:
 //    Output:
 //	actual number of devices opened
 //
+//  The paths of the matching devices are cached and kept
+//  current by hotplug notifications, so the HID class is
+//  walked only the first time or when the filter changes.
+//  Devices already open stay open, with their I/O state
+//
 int rawhid_open(int max, int vid, int pid, int usage_page, int usage)
 {
-        GUID guid;
-        HDEVINFO info;
-        DWORD index=0, reqd_size;
-        SP_DEVICE_INTERFACE_DATA iface;
-        SP_DEVICE_INTERFACE_DETAIL_DATA *details;
-        HIDD_ATTRIBUTES attrib;
-        PHIDP_PREPARSED_DATA hid_data;
-        HIDP_CAPS capabilities;
-        HANDLE h;
-        BOOL ret;
+	hid_t *table[HID_MAX_DEVICES];
 	hid_t *hid;
 	int count=0;
+	int i, j;
 
-	if (first_hid) free_all_hid();
-	if (max < 1) return 0;
-	if (!rx_event) {
-		rx_event = CreateEvent(NULL, TRUE, TRUE, NULL);
-		tx_event = CreateEvent(NULL, TRUE, TRUE, NULL);
-		InitializeCriticalSection(&rx_mutex);
-		InitializeCriticalSection(&tx_mutex);
+	init_hid_table();
+	if (max > HID_MAX_DEVICES) max = HID_MAX_DEVICES;
+	if (max < 1) {
+		free_all_hid();
+		return 0;
 	}
-	HidD_GetHidGuid(&guid);
-	info = SetupDiGetClassDevs(&guid, NULL, NULL, DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
-	if (info == INVALID_HANDLE_VALUE) return 0;
-	for (index=0; 1 ;index++) {
-		iface.cbSize = sizeof(SP_DEVICE_INTERFACE_DATA);
-		ret = SetupDiEnumDeviceInterfaces(info, NULL, &guid, index, &iface);
-		if (!ret) return count;
-		SetupDiGetInterfaceDeviceDetail(info, &iface, NULL, 0, &reqd_size, NULL);
-		details = (SP_DEVICE_INTERFACE_DETAIL_DATA *)malloc(reqd_size);
-		if (details == NULL) continue;
-
-		memset(details, 0, reqd_size);
-		details->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA);
-		ret = SetupDiGetDeviceInterfaceDetail(info, &iface, details,
-			reqd_size, NULL, NULL);
-		if (!ret) {
-			free(details);
-			continue;
-		}
-		h = CreateFile(details->DevicePath, GENERIC_READ|GENERIC_WRITE,
-			FILE_SHARE_READ|FILE_SHARE_WRITE, NULL,
-			OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
-		free(details);
-		if (h == INVALID_HANDLE_VALUE) continue;
-		attrib.Size = sizeof(HIDD_ATTRIBUTES);
-		ret = HidD_GetAttributes(h, &attrib);
-		//printf("vid: %4x\n", attrib.VendorID);
-		if (!ret || (vid > 0 && attrib.VendorID != vid) ||
-		  (pid > 0 && attrib.ProductID != pid) ||
-		  !HidD_GetPreparsedData(h, &hid_data)) {
-			CloseHandle(h);
-			continue;
-		}
-		if (!HidP_GetCaps(hid_data, &capabilities) ||
-		  (usage_page > 0 && capabilities.UsagePage != usage_page) ||
-		  (usage > 0 && capabilities.Usage != usage)) {
-			HidD_FreePreparsedData(hid_data);
-			CloseHandle(h);
-			continue;
-		}
-		HidD_FreePreparsedData(hid_data);
-		hid = (struct hid_struct *)malloc(sizeof(struct hid_struct));
-		if (!hid) {
-			CloseHandle(h);
-			continue;
+	EnterCriticalSection(&cache_mutex);
+	if (!cache_notify) cache_watch();
+	if (!cache_notify || !cache_valid || cache_filter[0] != vid
+	  || cache_filter[1] != pid || cache_filter[2] != usage_page
+	  || cache_filter[3] != usage) {
+		cache_filter[0] = vid;
+		cache_filter[1] = pid;
+		cache_filter[2] = usage_page;
+		cache_filter[3] = usage;
+		cache_scan();
+	}
+	for (i = 0; i < cache_count && count < max; i++) {
+		// a device still open on the same path is kept
+		hid = NULL;
+		for (j = 0; j < hid_count; j++) {
+			if (hid_table[j] && hid_table[j]->open && !hid_table[j]->gone
+			  && lstrcmpiW(hid_table[j]->path, cache_path[i]) == 0) {
+				hid = hid_table[j];
+				hid_table[j] = NULL;
+				break;
+			}
 		}
-		hid->handle = h;
-		hid->open = 1;
-		add_hid(hid);
-		count++;
-		if (count >= max) return count;
+		if (!hid) hid = hid_open_path(cache_path[i]);
+		if (hid) table[count++] = hid;
+	}
+	// devices unplugged or beyond max; an entry closed by
+	// rawhid_close may have been given to a device just opened
+	for (j = 0; j < hid_count; j++) {
+		hid = hid_table[j];
+		if (!hid || !hid->open) continue;
+		for (i = 0; i < count && table[i] != hid; i++) ;
+		if (i == count) hid_close(hid);
 	}
+	memcpy(hid_table, table, count * sizeof(hid_t *));
+	hid_count = count;
+	LeaveCriticalSection(&cache_mutex);
 	return count;
 }
 
@@ -265,53 +291,362 @@ void rawhid_close(int num)
 	hid = get_hid(num);
 	if (!hid || !hid->open) return;
 	hid_close(hid);
+	// the entry is free for the next rawhid_open
+	EnterCriticalSection(&cache_mutex);
+	if (hid_table[num] == hid) hid_table[num] = NULL;
+	LeaveCriticalSection(&cache_mutex);
 }
 
 
 
-static void add_hid(hid_t *h)
+static void init_hid_table(void)
 {
-	if (!first_hid || !last_hid) {
-		first_hid = last_hid = h;
-		h->next = h->prev = NULL;
-		return;
+	hid_t *p;
+
+	if (hid_init) return;
+	for (p = hid_pool; p < hid_pool + HID_MAX_DEVICES; p++) {
+		p->handle = NULL;
+		p->open = 0;
+		p->rx_event = CreateEvent(NULL, TRUE, TRUE, NULL);
+		p->tx_event = CreateEvent(NULL, TRUE, TRUE, NULL);
+		InitializeCriticalSection(&p->rx_mutex);
+		InitializeCriticalSection(&p->tx_mutex);
 	}
-	last_hid->next = h;
-	h->prev = last_hid;
-	h->next = NULL;
-	last_hid = h;
+	InitializeCriticalSection(&cache_mutex);
+	hid_init = 1;
 }
 
 
 static hid_t * get_hid(int num)
 {
-	hid_t *p;
-	for (p = first_hid; p && num > 0; p = p->next, num--) ;
-	return p;
+	if (num < 0 || num >= hid_count) return NULL;
+	return hid_table[num];
 }
 
 
 static void free_all_hid(void)
 {
-	hid_t *p, *q;
+	int i;
+
+	for (i = 0; i < hid_count; i++) {
+		if (hid_table[i] && hid_table[i]->open) hid_close(hid_table[i]);
+		hid_table[i] = NULL;
+	}
+	hid_count = 0;
+}
+
+
+//  hid_open_path - open a device for I/O in a free entry
+//    Inputs:
+//	path = device interface path
+//    Output:
+//	device, or NULL on error
+//
+static hid_t * hid_open_path(const WCHAR *path)
+{
+	PHIDP_PREPARSED_DATA hid_data;
+	HIDP_CAPS capabilities;
+	hid_t *hid;
+	HANDLE h;
 
-	for (p = first_hid; p; p = p->next) {
-		hid_close(p);
+	for (hid = hid_pool; hid < hid_pool + HID_MAX_DEVICES; hid++) {
+		if (!hid->open) break;
+	}
+	if (hid == hid_pool + HID_MAX_DEVICES) return NULL;
+	h = CreateFileW(path, GENERIC_READ|GENERIC_WRITE,
+		FILE_SHARE_READ|FILE_SHARE_WRITE, NULL,
+		OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+	if (h == INVALID_HANDLE_VALUE) return NULL;
+	if (!HidD_GetPreparsedData(h, &hid_data)) {
+		CloseHandle(h);
+		return NULL;
 	}
-	p = first_hid;
-	while (p) {
-		q = p;
-		p = p->next;
-		free(q);
+	if (!HidP_GetCaps(hid_data, &capabilities)) {
+		HidD_FreePreparsedData(hid_data);
+		CloseHandle(h);
+		return NULL;
 	}
-	first_hid = last_hid = NULL;
+	HidD_FreePreparsedData(hid_data);
+	hid->handle = h;
+	hid->gone = 0;
+	lstrcpynW(hid->path, path, MAX_PATH);
+	hid->rx = HidRx_Start(hid_read, hid_cancel, hid,
+		capabilities.InputReportByteLength);
+	if (!hid->rx) {
+		CloseHandle(h);
+		return NULL;
+	}
+	hid->open = 1;
+	return hid;
+}
+
+
+//  hid_match - check a device against the filter of the cache
+//    Inputs:
+//	path = device interface path
+//    Output:
+//	1 if the device matches, 0 if not
+//
+static int hid_match(const WCHAR *path)
+{
+	HIDD_ATTRIBUTES attrib;
+	PHIDP_PREPARSED_DATA hid_data;
+	HIDP_CAPS capabilities;
+	HANDLE h;
+	BOOL ret;
+
+	// no access is needed to query the device
+	h = CreateFileW(path, 0, FILE_SHARE_READ|FILE_SHARE_WRITE, NULL,
+		OPEN_EXISTING, 0, NULL);
+	if (h == INVALID_HANDLE_VALUE) return 0;
+	attrib.Size = sizeof(HIDD_ATTRIBUTES);
+	ret = HidD_GetAttributes(h, &attrib);
+	//printf("vid: %4x\n", attrib.VendorID);
+	if (!ret || (cache_filter[0] > 0 && attrib.VendorID != cache_filter[0]) ||
+	  (cache_filter[1] > 0 && attrib.ProductID != cache_filter[1]) ||
+	  !HidD_GetPreparsedData(h, &hid_data)) {
+		CloseHandle(h);
+		return 0;
+	}
+	ret = HidP_GetCaps(hid_data, &capabilities) &&
+	  (cache_filter[2] <= 0 || capabilities.UsagePage == cache_filter[2]) &&
+	  (cache_filter[3] <= 0 || capabilities.Usage == cache_filter[3]);
+	HidD_FreePreparsedData(hid_data);
+	CloseHandle(h);
+	return ret ? 1 : 0;
+}
+
+
+//  cache_scan - walk the HID class and cache the matching devices
+//
+static void cache_scan(void)
+{
+	GUID guid;
+	HDEVINFO info;
+	DWORD index=0, reqd_size;
+	SP_DEVICE_INTERFACE_DATA iface;
+	SP_DEVICE_INTERFACE_DETAIL_DATA_W *details;
+	BOOL ret;
+
+	cache_count = 0;
+	cache_valid = 0;
+	HidD_GetHidGuid(&guid);
+	info = SetupDiGetClassDevsW(&guid, NULL, NULL, DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
+	if (info == INVALID_HANDLE_VALUE) return;
+	for (index=0; cache_count < HID_MAX_DEVICES; index++) {
+		iface.cbSize = sizeof(SP_DEVICE_INTERFACE_DATA);
+		ret = SetupDiEnumDeviceInterfaces(info, NULL, &guid, index, &iface);
+		if (!ret) break;
+		SetupDiGetDeviceInterfaceDetailW(info, &iface, NULL, 0, &reqd_size, NULL);
+		details = (SP_DEVICE_INTERFACE_DETAIL_DATA_W *)malloc(reqd_size);
+		if (details == NULL) continue;
+
+		memset(details, 0, reqd_size);
+		details->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_W);
+		ret = SetupDiGetDeviceInterfaceDetailW(info, &iface, details,
+			reqd_size, NULL, NULL);
+		if (ret && lstrlenW(details->DevicePath) < MAX_PATH
+		  && hid_match(details->DevicePath)) {
+			lstrcpynW(cache_path[cache_count++], details->DevicePath, MAX_PATH);
+		}
+		free(details);
+	}
+	SetupDiDestroyDeviceInfoList(info);
+	cache_valid = 1;
+}
+
+
+//  cache_watch - register for HID arrival and removal notifications
+//
+//  CM_Register_Notification needs Windows 8; it is looked up
+//  at run time, and without it the cache is not used
+//
+static void cache_watch(void)
+{
+	typedef CONFIGRET (WINAPI *register_fn)(PCM_NOTIFY_FILTER,
+		PVOID, PCM_NOTIFY_CALLBACK, PHCMNOTIFICATION);
+	CM_NOTIFY_FILTER filter;
+	register_fn reg;
+	HMODULE lib;
+
+	lib = LoadLibraryA("cfgmgr32.dll");
+	if (!lib) return;
+	reg = (register_fn)GetProcAddress(lib, "CM_Register_Notification");
+	if (!reg) return;
+	memset(&filter, 0, sizeof(filter));
+	filter.cbSize = sizeof(filter);
+	filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+	HidD_GetHidGuid(&filter.u.DeviceInterface.ClassGuid);
+	if (reg(&filter, NULL, cache_notify_cb, &cache_notify) != CR_SUCCESS)
+		cache_notify = NULL;
+}
+
+
+//  cache_notify_cb - keep the cache current as devices come and go
+//
+static DWORD CALLBACK cache_notify_cb(HCMNOTIFICATION notify, PVOID context,
+	CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA data, DWORD size)
+{
+	const WCHAR *path = data->u.DeviceInterface.SymbolicLink;
+	int i, j;
+
+	EnterCriticalSection(&cache_mutex);
+	for (i = 0; i < cache_count; i++) {
+		if (lstrcmpiW(cache_path[i], path) == 0) break;
+	}
+	if (action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL) {
+		if (cache_valid && i == cache_count && cache_count < HID_MAX_DEVICES
+		  && lstrlenW(path) < MAX_PATH && hid_match(path)) {
+			lstrcpynW(cache_path[cache_count++], path, MAX_PATH);
+		}
+	} else if (action == CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL) {
+		if (i < cache_count) {
+			for (cache_count--; i < cache_count; i++)
+				memcpy(cache_path[i], cache_path[i + 1], sizeof(cache_path[i]));
+		}
+		// an open handle is dead even if the device comes back
+		for (j = 0; j < hid_count; j++) {
+			if (hid_table[j] && lstrcmpiW(hid_table[j]->path, path) == 0)
+				hid_table[j]->gone = 1;
+		}
+	}
+	LeaveCriticalSection(&cache_mutex);
+	return ERROR_SUCCESS;
 }
 
 
 static void hid_close(hid_t *hid)
 {
+	// wait for any transfer in progress on the device
+	EnterCriticalSection(&hid->rx_mutex);
+	EnterCriticalSection(&hid->tx_mutex);
+	HidRx_Stop(hid->rx);
+	hid->rx = NULL;
 	CloseHandle(hid->handle);
 	hid->handle = NULL;
+	hid->open = 0;
+	LeaveCriticalSection(&hid->tx_mutex);
+	LeaveCriticalSection(&hid->rx_mutex);
+}
+
+
+//  hid_write - send a packet, accounting for its answer
+//    Inputs:
+//	num = device to transmit to (zero based)
+//	buf = buffer containing packet to send
+//	len = number of bytes to transmit
+//	timeout = time to wait, in milliseconds
+//	retry = the packet is sent again after its answer timed out
+//	in_place = buf is a whole report with the report ID slot in
+//	  byte 0, else the packet is copied behind the ID in tx_buf
+//    Output:
+//	number of bytes sent, or -1 on error
+//
+static int hid_write(int num, void *buf, int len, int timeout, bool retry, bool in_place)
+{
+	hid_t *hid;
+	unsigned char *report;
+	DWORD n;
+	int r;
+
+	hid = get_hid(num);
+	if (!hid || !hid->open) return -1;
+	if (len < 0) return -1;
+	if (!in_place && len + 1 > (int)sizeof(hid->tx_buf)) return -1;
+	EnterCriticalSection(&hid->rx_mutex);
+	HidRx_Begin(hid->rx, retry);
+	LeaveCriticalSection(&hid->rx_mutex);
+	EnterCriticalSection(&hid->tx_mutex);
+	ResetEvent(hid->tx_event);
+	memset(&hid->tx_ov, 0, sizeof(hid->tx_ov));
+	hid->tx_ov.hEvent = hid->tx_event;
+	if (in_place) {
+		report = (unsigned char *)buf;
+	} else {
+		report = hid->tx_buf;
+		memcpy(report + 1, buf, len);
+	}
+	report[0] = 0;
+	if (!WriteFile(hid->handle, report, len + 1, NULL, &hid->tx_ov)
+	  && GetLastError() != ERROR_IO_PENDING) {
+		print_win32_err();
+		LeaveCriticalSection(&hid->tx_mutex);
+		return -1;
+	}
+	r = hid_wait(hid, &hid->tx_ov, &n, timeout);
+	LeaveCriticalSection(&hid->tx_mutex);
+	if (r <= 0) return r;
+	return n - 1;
+}
+
+
+//  hid_read - read one report, for the receive thread of a device
+//    Inputs:
+//	dev = device
+//	buf = buffer to receive the report, report ID included
+//	len = report length
+//    Output:
+//	number of bytes received, 0 if cancelled, or -1 on error
+//
+static int hid_read(void *dev, uint8 *buf, int len)
+{
+	hid_t *hid = (hid_t *)dev;
+	DWORD n;
+
+	ResetEvent(hid->rx_event);
+	memset(&hid->rx_ov, 0, sizeof(hid->rx_ov));
+	hid->rx_ov.hEvent = hid->rx_event;
+	if (!ReadFile(hid->handle, buf, len, NULL, &hid->rx_ov)
+	  && GetLastError() != ERROR_IO_PENDING) {
+		print_win32_err();
+		return -1;
+	}
+	if (!GetOverlappedResult(hid->handle, &hid->rx_ov, &n, TRUE)) {
+		if (GetLastError() == ERROR_OPERATION_ABORTED) return 0;
+		print_win32_err();
+		return -1;
+	}
+	return n;
+}
+
+
+//  hid_cancel - make the read in progress on a device return
+//
+static void hid_cancel(void *dev)
+{
+	hid_t *hid = (hid_t *)dev;
+
+	CancelIoEx(hid->handle, &hid->rx_ov);
+}
+
+
+//  hid_wait - complete an overlapped transfer started on a device
+//    Inputs:
+//	hid = device
+//	ov = transfer started by WriteFile
+//	n = number of bytes transferred, including the report ID
+//	timeout = time to wait, in milliseconds
+//    Output:
+//	1 if done, 0 on timeout, or -1 on error
+//
+static int hid_wait(hid_t *hid, OVERLAPPED *ov, DWORD *n, int timeout)
+{
+	DWORD r;
+
+	r = WaitForSingleObject(ov->hEvent, timeout);
+	if (r == WAIT_TIMEOUT) {
+		// the buffer and OVERLAPPED are reused, so wait
+		// for the cancelled transfer to come back
+		CancelIoEx(hid->handle, ov);
+		GetOverlappedResult(hid->handle, ov, n, TRUE);
+		return 0;
+	}
+	if (r != WAIT_OBJECT_0 || !GetOverlappedResult(hid->handle, ov, n, FALSE)) {
+		print_win32_err();
+		return -1;
+	}
+	if (*n <= 0) return -1;
+	return 1;
 }
 
 
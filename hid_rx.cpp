@@ -0,0 +1,267 @@
+/**
+  ******************************************************************************
+  * @file    hid_rx.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - HID receive queue
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "hid_rx.h"
+#include "sark_cancel.h"
+
+/* Private define ------------------------------------------------------------*/
+#define HIDRX_SLOTS			32			/* queued reports; power of two */
+#define HIDRX_LATE_MAX		2000		/* in ms; answers to earlier requests arrive before this */
+#define HIDRX_STOP_POLL		100			/* in ms; the read is cancelled again this often when stopping */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Received report */
+typedef struct
+{
+	DWORD dwTick;			/* arrival time */
+	int iLen;				/* report length */
+	uint8 tu8Data[HIDRX_REPORT_MAX];
+} T_HIDRX_SLOT;
+
+/* Receive side of a device */
+struct hid_rx
+{
+	HIDRX_READ pfRead;
+	HIDRX_CANCEL pfCancel;
+	void *pvDev;
+	int iLen;				/* report length given to the reads */
+	volatile LONG lHead;	/* next report to take; written by the consumer only */
+	volatile LONG lTail;	/* next slot to fill; written by the receive thread only */
+	volatile LONG lStop;	/* set when stopped or the device is gone */
+	HANDLE hData;			/* signaled when a report is queued */
+	HANDLE hThread;
+	int iOwed;				/* answers due for the current request and its retries */
+	int iStale;				/* answers due for earlier requests, to be skipped */
+	DWORD dwStaleUntil;		/* answers received later are not skipped */
+	T_HIDRX_SLOT tSlot[HIDRX_SLOTS];
+};
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static DWORD WINAPI RxThread (LPVOID lpParam);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Starts receiving from a device
+  *
+  *	A dedicated thread keeps a read always posted on the device and queues
+  *	each report as it arrives, so answers are never missed between
+  *	requests, even when they come after the caller stopped waiting. The
+  *	queue has a single producer, the thread, and a single consumer, the
+  *	caller of HidRx_Recv and HidRx_Begin, which must not be called from
+  *	several threads at once.
+  *
+  * @param  pfRead		reads one report from the device
+  * @param  pfCancel	cancels the read in progress
+  * @param  pvDev		device, given to pfRead and pfCancel
+  * @param  iLen		report length, up to HIDRX_REPORT_MAX
+  * @retval	receive handle, NULL if failed
+  */
+T_HID_RX *HidRx_Start (HIDRX_READ pfRead, HIDRX_CANCEL pfCancel, void *pvDev, int iLen)
+{
+	T_HID_RX *pRx;
+
+	if (pfRead == NULL || pfCancel == NULL || iLen <= 0 || iLen > HIDRX_REPORT_MAX)
+		return NULL;
+	pRx = (T_HID_RX *)calloc(1, sizeof(T_HID_RX));
+	if (pRx == NULL)
+		return NULL;
+	pRx->pfRead = pfRead;
+	pRx->pfCancel = pfCancel;
+	pRx->pvDev = pvDev;
+	pRx->iLen = iLen;
+	pRx->hData = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (pRx->hData != NULL)
+		pRx->hThread = CreateThread(NULL, 0, RxThread, pRx, 0, NULL);
+	if (pRx->hThread == NULL)
+	{
+		if (pRx->hData != NULL)
+			CloseHandle(pRx->hData);
+		free(pRx);
+		return NULL;
+	}
+
+	return pRx;
+}
+
+/**
+  * @brief Stops receiving and frees the receive handle
+  *
+  *	The device must be kept open until this returns.
+  */
+void HidRx_Stop (T_HID_RX *pRx)
+{
+	if (pRx == NULL)
+		return;
+	InterlockedExchange(&pRx->lStop, 1);
+	/* The thread may post a new read right after one is cancelled */
+	do
+	{
+		pRx->pfCancel(pRx->pvDev);
+	} while (WaitForSingleObject(pRx->hThread, HIDRX_STOP_POLL) == WAIT_TIMEOUT);
+	CloseHandle(pRx->hThread);
+	CloseHandle(pRx->hData);
+	free(pRx);
+}
+
+/**
+  * @brief Accounts for a request about to be sent
+  *
+  *	Answers still due for earlier requests will be skipped when they arrive.
+  *	A retry of the current request instead accepts the answer to any of its
+  *	attempts: a late answer to the first one completes the request, and the
+  *	answers to the other attempts are skipped afterwards.
+  *
+  * @param  pRx			receive handle
+  * @param  bRetry		{TRUE: retry of the current request; FALSE: new request}
+  */
+void HidRx_Begin (T_HID_RX *pRx, bool bRetry)
+{
+	if (!bRetry && pRx->iOwed > 0)
+	{
+		pRx->iStale += pRx->iOwed;
+		pRx->iOwed = 0;
+		pRx->dwStaleUntil = GetTickCount() + HIDRX_LATE_MAX;
+	}
+	pRx->iOwed++;
+}
+
+/**
+  * @brief Takes the answer to the current request
+  *
+  *	Answers to earlier requests are skipped first. If a request sent to the
+  *	device was lost, its answer is expected until HIDRX_LATE_MAX has passed;
+  *	an answer to a new request received before then is skipped in its
+  *	place, and the request times out and is retried.
+  *
+  * @param  pRx			receive handle
+  * @param  pu8Buf		return report
+  * @param  iLen		buffer size
+  * @param  dwTimeout	maximum wait (ms)
+  * @retval
+  *			@li >0: report length
+  *			@li 0: timeout, or the operation of the calling thread cancelled
+  *			@li -1: device gone
+  */
+int HidRx_Recv (T_HID_RX *pRx, uint8 *pu8Buf, int iLen, DWORD dwTimeout)
+{
+	T_HIDRX_SLOT *ptSlot;
+	DWORD dwStart = GetTickCount();
+	DWORD dwElapsed;
+	int iCopy;
+
+	for (;;)
+	{
+		while (pRx->lHead != pRx->lTail)
+		{
+			ptSlot = &pRx->tSlot[(DWORD)pRx->lHead % HIDRX_SLOTS];
+			if (pRx->iStale > 0 && (LONG)(ptSlot->dwTick - pRx->dwStaleUntil) < 0)
+			{
+				pRx->iStale--;
+				InterlockedIncrement(&pRx->lHead);
+				continue;
+			}
+			pRx->iStale = 0;
+			iCopy = (ptSlot->iLen < iLen) ? ptSlot->iLen : iLen;
+			memcpy(pu8Buf, ptSlot->tu8Data, iCopy);
+			/* The slot is given back to the receive thread */
+			InterlockedIncrement(&pRx->lHead);
+			/* The other attempts of this request will be answered too */
+			if (pRx->iOwed > 1)
+			{
+				pRx->iStale = pRx->iOwed - 1;
+				pRx->dwStaleUntil = GetTickCount() + HIDRX_LATE_MAX;
+			}
+			pRx->iOwed = 0;
+			return iCopy;
+		}
+		if (pRx->lStop != 0)
+			return -1;
+		dwElapsed = GetTickCount() - dwStart;
+		if (dwElapsed >= dwTimeout
+			|| Sark_Cancel_Wait(pRx->hData, dwTimeout - dwElapsed) == WAIT_TIMEOUT)
+			return 0;
+	}
+}
+
+/**
+  * @brief Receive thread
+  *
+  *	Reads straight into the next free slot and posts the next read as soon
+  *	as one completes. Reports arriving while the queue is full are dropped.
+  */
+static DWORD WINAPI RxThread (LPVOID lpParam)
+{
+	T_HID_RX *pRx = (T_HID_RX *)lpParam;
+	T_HIDRX_SLOT tSpare;
+	T_HIDRX_SLOT *ptSlot;
+	int iLen;
+
+	while (pRx->lStop == 0)
+	{
+		if ((DWORD)(pRx->lTail - pRx->lHead) >= HIDRX_SLOTS)
+			ptSlot = &tSpare;
+		else
+			ptSlot = &pRx->tSlot[(DWORD)pRx->lTail % HIDRX_SLOTS];
+		iLen = pRx->pfRead(pRx->pvDev, ptSlot->tu8Data, pRx->iLen);
+		if (iLen < 0)
+			break;
+		if (iLen == 0 || ptSlot == &tSpare)
+			continue;
+		ptSlot->iLen = iLen;
+		ptSlot->dwTick = GetTickCount();
+		/* Publishes the slot */
+		InterlockedIncrement(&pRx->lTail);
+		SetEvent(pRx->hData);
+	}
+	/* Wakes up the consumer if the device is gone */
+	InterlockedExchange(&pRx->lStop, 1);
+	SetEvent(pRx->hData);
+
+	return 0;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @file    hid_rx.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - HID receive queue
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HID_RX_H__
+#define __HID_RX_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct hid_rx T_HID_RX;
+
+/*
+ * Reads one report from the device, waiting for it
+ * Returns the report length, 0 if cancelled or -1 if the device is gone
+ */
+typedef int (*HIDRX_READ) (void *pvDev, uint8 *pu8Buf, int iLen);
+
+/* Makes a read in progress on the device return */
+typedef void (*HIDRX_CANCEL) (void *pvDev);
+
+/* Exported constants --------------------------------------------------------*/
+#define HIDRX_REPORT_MAX	64		/* maximum report length, report ID included */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+T_HID_RX *HidRx_Start (HIDRX_READ pfRead, HIDRX_CANCEL pfCancel, void *pvDev, int iLen);
+void HidRx_Stop (T_HID_RX *pRx);
+void HidRx_Begin (T_HID_RX *pRx, bool bRetry);
+int HidRx_Recv (T_HID_RX *pRx, uint8 *pu8Buf, int iLen, DWORD dwTimeout);
+
+#endif	 /* __HID_RX_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
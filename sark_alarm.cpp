@@ -0,0 +1,314 @@
+/**
+  ******************************************************************************
+  * @file    sark_alarm.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Sweep change detection
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <math.h>
+#include "sark_alarm.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Baseline of one point */
+typedef struct
+{
+	float fMeanR;
+	float fMeanX;
+	float fVar;				/* variance of the distance to the mean */
+	bool bRaised;			/* alarm active */
+} T_ALARM_POINT;
+
+struct sark_alarm
+{
+	int iPoints;
+	int iWarmup;			/* sweeps used to build the initial baseline */
+	float fAlpha;			/* EWMA weight after warm up */
+	float fSigmas;			/* raise threshold in sigmas */
+	float fMinDelta;		/* minimum deviation in ohms to raise */
+	uint32 u32Sweeps;		/* sweeps in the baseline */
+	volatile LONG lReset;	/* reset requested */
+	T_ALARM_POINT *ptPoint;
+
+	/* Event queue, single producer (Update) single consumer (GetEvents) */
+	T_SARK_ALARM_EVENT *ptQueue;
+	int iQueue;				/* slots, one more than the events held */
+	volatile LONG lHead;	/* next event to write */
+	volatile LONG lTail;	/* next event to read */
+	volatile LONG lLost;	/* events dropped because the queue was full */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define ALARM_CLEAR_RATIO	0.5f	/* clear threshold relative to raise threshold */
+#define ALARM_MIN_VAR		1e-12f
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static int PushEvent (T_SARK_ALARM *pAlarm, uint32 u32Seq, int iPoint, uint8 u8Type, float fR, float fX, float fDev);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Creates a change detector for sweeps of iPoints
+  *
+  *	Each point keeps a baseline of the impedance (mean R, X and the variance
+  *	of the distance to it). The first iWarmup sweeps build the baseline with
+  *	plain averages; later sweeps update it as an EWMA while the point is not
+  *	in alarm, so the baseline stays on the last good value during a fault.
+  *
+  * @param  iPoints		points per sweep
+  * @param  iWarmup		sweeps to build the initial baseline (>= 2)
+  * @param  fAlpha		EWMA weight of a new sweep (0..1)
+  * @param  fSigmas		deviation that raises an alarm, in sigmas
+  * @param  fMinDelta	minimum deviation to raise an alarm, in ohms
+  * @param  iQueue		events the queue holds
+  * @retval
+  *			@li alarm handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_ALARM *Sark_Alarm_Create (int iPoints, int iWarmup, float fAlpha, float fSigmas, float fMinDelta, int iQueue)
+{
+	T_SARK_ALARM *pAlarm;
+
+	if (iPoints <= 0 || iWarmup < 2 || fAlpha <= 0 || fAlpha > 1 || fSigmas <= 0 || iQueue <= 0)
+		return NULL;
+	pAlarm = (T_SARK_ALARM *)calloc(1, sizeof(T_SARK_ALARM));
+	if (pAlarm == NULL)
+		return NULL;
+	pAlarm->ptPoint = (T_ALARM_POINT *)calloc(iPoints, sizeof(T_ALARM_POINT));
+	/* The ring is full when the head is one slot behind the tail */
+	pAlarm->ptQueue = (T_SARK_ALARM_EVENT *)calloc(iQueue + 1, sizeof(T_SARK_ALARM_EVENT));
+	if (pAlarm->ptPoint == NULL || pAlarm->ptQueue == NULL)
+	{
+		Sark_Alarm_Destroy(pAlarm);
+		return NULL;
+	}
+	pAlarm->iPoints = iPoints;
+	pAlarm->iWarmup = iWarmup;
+	pAlarm->fAlpha = fAlpha;
+	pAlarm->fSigmas = fSigmas;
+	pAlarm->fMinDelta = fMinDelta;
+	pAlarm->iQueue = iQueue + 1;
+
+	return pAlarm;
+}
+
+/**
+  * @brief Releases a change detector
+  *
+  * @param  pAlarm		alarm handle
+  * @retval None
+  */
+void Sark_Alarm_Destroy (T_SARK_ALARM *pAlarm)
+{
+	if (pAlarm == NULL)
+		return;
+	free(pAlarm->ptQueue);
+	free(pAlarm->ptPoint);
+	free(pAlarm);
+}
+
+/**
+  * @brief Discards the baselines; they are rebuilt from the next sweeps
+  *
+  *	May be called from any thread, takes effect on the next update.
+  *
+  * @param  pAlarm		alarm handle
+  * @retval None
+  */
+void Sark_Alarm_Reset (T_SARK_ALARM *pAlarm)
+{
+	if (pAlarm == NULL)
+		return;
+	InterlockedExchange(&pAlarm->lReset, 1);
+}
+
+/**
+  * @brief Gets the number of points of the sweeps fed to the detector
+  *
+  * @param  pAlarm		alarm handle
+  * @retval
+  *			@li number of points
+  *			@li -3: invalid parameters
+  */
+int Sark_Alarm_Points (T_SARK_ALARM *pAlarm)
+{
+	if (pAlarm == NULL)
+		return -3;
+	return pAlarm->iPoints;
+}
+
+/**
+  * @brief Feeds a sweep to the detector
+  *
+  * @param  pAlarm		alarm handle
+  * @param  u32Seq		sweep sequence number, reported in the events
+  * @param  pfR			R (real Z), one per point
+  * @param  pfX			X (imag Z), one per point
+  * @retval
+  *			@li >=0: number of events generated
+  *			@li -3: invalid parameters
+  */
+int Sark_Alarm_Update (T_SARK_ALARM *pAlarm, uint32 u32Seq, const float *pfR, const float *pfX)
+{
+	T_ALARM_POINT *ptPoint;
+	float fDR, fDX, fD2;
+	float fDev;
+	float fW;
+	int iEvents = 0;
+	int ii;
+
+	if (pAlarm == NULL || pfR == NULL || pfX == NULL)
+		return -3;
+
+	if (InterlockedExchange(&pAlarm->lReset, 0))
+	{
+		for (ii = 0; ii < pAlarm->iPoints; ii++)
+		{
+			if (pAlarm->ptPoint[ii].bRaised)
+				iEvents += PushEvent(pAlarm, u32Seq, ii, ALARM_CLEAR, pfR[ii], pfX[ii], 0);
+		}
+		memset(pAlarm->ptPoint, 0, pAlarm->iPoints * sizeof(T_ALARM_POINT));
+		pAlarm->u32Sweeps = 0;
+	}
+
+	pAlarm->u32Sweeps++;
+	if (pAlarm->u32Sweeps <= (uint32)pAlarm->iWarmup)
+		fW = 1.0f / pAlarm->u32Sweeps;		/* running average */
+	else
+		fW = pAlarm->fAlpha;
+
+	for (ii = 0; ii < pAlarm->iPoints; ii++)
+	{
+		ptPoint = &pAlarm->ptPoint[ii];
+		fDR = pfR[ii] - ptPoint->fMeanR;
+		fDX = pfX[ii] - ptPoint->fMeanX;
+		fD2 = fDR * fDR + fDX * fDX;
+
+		if (pAlarm->u32Sweeps > (uint32)pAlarm->iWarmup)
+		{
+			fDev = sqrtf(fD2 / (ptPoint->fVar + ALARM_MIN_VAR));
+			if (!ptPoint->bRaised)
+			{
+				if (fDev > pAlarm->fSigmas && sqrtf(fD2) > pAlarm->fMinDelta)
+				{
+					ptPoint->bRaised = TRUE;
+					iEvents += PushEvent(pAlarm, u32Seq, ii, ALARM_RAISE, pfR[ii], pfX[ii], fDev);
+				}
+			}
+			else if (fDev < pAlarm->fSigmas * ALARM_CLEAR_RATIO || sqrtf(fD2) < pAlarm->fMinDelta * ALARM_CLEAR_RATIO)
+			{
+				ptPoint->bRaised = FALSE;
+				iEvents += PushEvent(pAlarm, u32Seq, ii, ALARM_CLEAR, pfR[ii], pfX[ii], fDev);
+			}
+			if (ptPoint->bRaised)
+				continue;	/* keep the baseline of the last good state */
+		}
+		if (pAlarm->u32Sweeps > 1)
+			ptPoint->fVar += fW * ((1 - fW) * fD2 - ptPoint->fVar);
+		ptPoint->fMeanR += fW * fDR;
+		ptPoint->fMeanX += fW * fDX;
+	}
+
+	return iEvents;
+}
+
+/**
+  * @brief Retrieves pending change events
+  *
+  * @param  pAlarm		alarm handle
+  * @param  ptEvents	return events
+  * @param  iMax		maximum number of events to return
+  * @param  pu32Lost	return events dropped since last call (queue full), may be NULL
+  * @retval
+  *			@li >=0: number of events returned
+  *			@li -3: invalid parameters
+  */
+int Sark_Alarm_GetEvents (T_SARK_ALARM *pAlarm, T_SARK_ALARM_EVENT *ptEvents, int iMax, uint32 *pu32Lost)
+{
+	LONG lTail;
+	int iCount = 0;
+
+	if (pAlarm == NULL || ptEvents == NULL)
+		return -3;
+	lTail = pAlarm->lTail;
+	while (iCount < iMax && lTail != pAlarm->lHead)
+	{
+		MemoryBarrier();
+		ptEvents[iCount++] = pAlarm->ptQueue[lTail];
+		lTail = (lTail + 1) % pAlarm->iQueue;
+	}
+	InterlockedExchange(&pAlarm->lTail, lTail);
+	if (pu32Lost != NULL)
+		*pu32Lost = (uint32)InterlockedExchange(&pAlarm->lLost, 0);
+
+	return iCount;
+}
+
+/**
+  * @brief Queues an event
+  *
+  * @retval
+  *			@li 1: queued
+  *			@li 0: queue full, event dropped
+  */
+static int PushEvent (T_SARK_ALARM *pAlarm, uint32 u32Seq, int iPoint, uint8 u8Type, float fR, float fX, float fDev)
+{
+	T_SARK_ALARM_EVENT *ptEvent;
+	LONG lHead = pAlarm->lHead;
+	LONG lNext = (lHead + 1) % pAlarm->iQueue;
+
+	if (lNext == pAlarm->lTail)
+	{
+		InterlockedIncrement(&pAlarm->lLost);
+		return 0;
+	}
+	ptEvent = &pAlarm->ptQueue[lHead];
+	ptEvent->u32Seq = u32Seq;
+	ptEvent->i32Point = iPoint;
+	ptEvent->u8Type = u8Type;
+	ptEvent->fR = fR;
+	ptEvent->fX = fX;
+	ptEvent->fDev = fDev;
+	InterlockedExchange(&pAlarm->lHead, lNext);
+
+	return 1;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
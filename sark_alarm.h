@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file    sark_alarm.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Sweep change detection
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_ALARM_H__
+#define __SARK_ALARM_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_alarm T_SARK_ALARM;
+
+/* Change event */
+typedef struct
+{
+	uint32 u32Seq;			/* sweep sequence number */
+	int32 i32Point;			/* point index in the sweep */
+	uint8 u8Type;			/* ALARM_RAISE, ALARM_CLEAR */
+	float fR;				/* measured R */
+	float fX;				/* measured X */
+	float fDev;				/* deviation from baseline in sigmas */
+} T_SARK_ALARM_EVENT;
+
+/* Exported constants --------------------------------------------------------*/
+#define ALARM_RAISE			1	/* point left its baseline */
+#define ALARM_CLEAR			2	/* point is back within its baseline */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_ALARM *Sark_Alarm_Create (int iPoints, int iWarmup, float fAlpha, float fSigmas, float fMinDelta, int iQueue);
+extern void Sark_Alarm_Destroy (T_SARK_ALARM *pAlarm);
+extern void Sark_Alarm_Reset (T_SARK_ALARM *pAlarm);
+extern int Sark_Alarm_Points (T_SARK_ALARM *pAlarm);
+extern int Sark_Alarm_Update (T_SARK_ALARM *pAlarm, uint32 u32Seq, const float *pfR, const float *pfX);
+extern int Sark_Alarm_GetEvents (T_SARK_ALARM *pAlarm, T_SARK_ALARM_EVENT *ptEvents, int iMax, uint32 *pu32Lost);
+
+#endif	 /* __SARK_ALARM_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,348 @@
+/**
+  ******************************************************************************
+  * @file    sark_cancel.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Cancellation of long running operations
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "sark_timing.h"
+#include "sark_cancel.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct sark_cancel
+{
+	HANDLE hEvent;				/* manual reset; signaled when cancelled */
+	volatile LONG lSet;			/* cancelled; avoids waiting on hEvent to check it */
+	volatile LONGLONG llDeadline;	/* performance counter deadline; 0: none */
+	LONGLONG llFreq;			/* performance counter ticks per second */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define CANCEL_MAX_WAIT		8		/* nested tokens a transport wait watches */
+#define CANCEL_NAN			0x7fc00000	/* quiet NaN, marks points not measured */
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+
+/* Innermost scope of the operation running on each thread */
+static __declspec(thread) T_CANCEL_SCOPE *gptScope;
+
+/* Private function prototypes -----------------------------------------------*/
+static DWORD TimeLeft (T_SARK_CANCEL *ptCancel);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Creates a cancellation token
+  *
+  *	A token is attached to sweeps, plans, job pools and monitors, and can be
+  *	shared by all of them to abort everything at once. It is checked between
+  *	frames and also wakes the transport waiting for an answer.
+  *
+  * @param  None
+  * @retval
+  *			@li token handle
+  *			@li NULL: out of resources
+  */
+T_SARK_CANCEL *Sark_Cancel_Create (void)
+{
+	T_SARK_CANCEL *ptCancel;
+	LARGE_INTEGER liFreq;
+
+	ptCancel = (T_SARK_CANCEL *)calloc(1, sizeof(T_SARK_CANCEL));
+	if (ptCancel == NULL)
+		return NULL;
+	ptCancel->hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (ptCancel->hEvent == NULL)
+	{
+		free(ptCancel);
+		return NULL;
+	}
+	QueryPerformanceFrequency(&liFreq);
+	ptCancel->llFreq = liFreq.QuadPart;
+
+	return ptCancel;
+}
+
+/**
+  * @brief Releases a token
+  *
+  *	The operations it is attached to must have been detached or released.
+  *
+  * @param  ptCancel	token handle
+  * @retval None
+  */
+void Sark_Cancel_Destroy (T_SARK_CANCEL *ptCancel)
+{
+	if (ptCancel == NULL)
+		return;
+	CloseHandle(ptCancel->hEvent);
+	free(ptCancel);
+}
+
+/**
+  * @brief Cancels the operations running under the token
+  *
+  *	Can be called from any thread. Operations started later are cancelled
+  *	at once until the token is reset.
+  *
+  * @param  ptCancel	token handle
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Cancel_Set (T_SARK_CANCEL *ptCancel)
+{
+	if (ptCancel == NULL)
+		return -3;
+	InterlockedExchange(&ptCancel->lSet, 1);
+	SetEvent(ptCancel->hEvent);
+	return 1;
+}
+
+/**
+  * @brief Clears the cancellation and the deadline of a token
+  *
+  * @param  ptCancel	token handle
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Cancel_Reset (T_SARK_CANCEL *ptCancel)
+{
+	if (ptCancel == NULL)
+		return -3;
+	ResetEvent(ptCancel->hEvent);
+	InterlockedExchange(&ptCancel->lSet, 0);
+	InterlockedExchange64(&ptCancel->llDeadline, 0);
+	return 1;
+}
+
+/**
+  * @brief Sets the absolute deadline of the operations running under the token
+  *
+  * @param  ptCancel	token handle
+  * @param  llDeadline	performance counter (QueryPerformanceCounter) value; 0: none
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Cancel_SetDeadline (T_SARK_CANCEL *ptCancel, LONGLONG llDeadline)
+{
+	if (ptCancel == NULL || llDeadline < 0)
+		return -3;
+	InterlockedExchange64(&ptCancel->llDeadline, llDeadline);
+	return 1;
+}
+
+/**
+  * @brief Tells if a token is cancelled or its deadline has passed
+  *
+  * @param  ptCancel	token handle; NULL is never expired
+  * @retval TRUE if expired
+  */
+bool Sark_Cancel_Expired (T_SARK_CANCEL *ptCancel)
+{
+	LONGLONG llDeadline;
+
+	if (ptCancel == NULL)
+		return FALSE;
+	if (ptCancel->lSet != 0)
+		return TRUE;
+	llDeadline = InterlockedCompareExchange64(&ptCancel->llDeadline, 0, 0);
+	return llDeadline != 0 && Sark_Timing_Now() >= llDeadline;
+}
+
+/**
+  * @brief Runs the rest of the calling thread under a token
+  *
+  *	Tokens of the operations the thread is already running stay in force,
+  *	so an operation nested in another one is also cancelled by the outer
+  *	token. Every call is paired with Sark_Cancel_Leave.
+  *
+  * @param  ptScope		scope kept by the caller until it leaves
+  * @param  ptCancel	token handle; NULL adds none
+  * @retval None
+  */
+void Sark_Cancel_Enter (T_CANCEL_SCOPE *ptScope, T_SARK_CANCEL *ptCancel)
+{
+	ptScope->ptCancel = ptCancel;
+	ptScope->ptOuter = gptScope;
+	gptScope = ptScope;
+}
+
+/**
+  * @brief Runs the rest of the calling thread under no token
+  *
+  *	For the steps that must complete even if the operation is cancelled.
+  *	Paired with Sark_Cancel_Leave, which brings back the tokens in force.
+  *
+  * @param  ptScope		scope kept by the caller until it leaves
+  * @retval None
+  */
+void Sark_Cancel_Shield (T_CANCEL_SCOPE *ptScope)
+{
+	ptScope->ptCancel = NULL;
+	ptScope->ptOuter = gptScope;
+	gptScope = NULL;
+}
+
+/**
+  * @brief Leaves the scope entered last by the calling thread
+  *
+  * @param  ptScope		scope given to Sark_Cancel_Enter
+  * @retval None
+  */
+void Sark_Cancel_Leave (T_CANCEL_SCOPE *ptScope)
+{
+	gptScope = ptScope->ptOuter;
+}
+
+/**
+  * @brief Tells if the operation running on the calling thread is cancelled
+  *
+  * @param  None
+  * @retval TRUE if any of its tokens is expired
+  */
+bool Sark_Cancel_Pending (void)
+{
+	T_CANCEL_SCOPE *ptScope;
+
+	for (ptScope = gptScope; ptScope != NULL; ptScope = ptScope->ptOuter)
+	{
+		if (Sark_Cancel_Expired(ptScope->ptCancel))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/**
+  * @brief Waits for an event of a transport, or for the operation to be cancelled
+  *
+  *	Replaces WaitForSingleObject in the transport waits. The wait also ends
+  *	when a token of the operation running on the calling thread is cancelled
+  *	or reaches its deadline, which is reported as a timeout.
+  *
+  * @param  hEvent		event; NULL just waits
+  * @param  dwTimeout	maximum wait (ms)
+  * @retval
+  *			@li WAIT_OBJECT_0: hEvent signaled
+  *			@li WAIT_TIMEOUT: timeout, cancelled or deadline passed
+  */
+DWORD Sark_Cancel_Wait (HANDLE hEvent, DWORD dwTimeout)
+{
+	HANDLE thWait[CANCEL_MAX_WAIT + 1];
+	T_CANCEL_SCOPE *ptScope;
+	DWORD dwLeft;
+	DWORD dwRc;
+	int iWait = 0;
+
+	if (hEvent != NULL)
+		thWait[iWait++] = hEvent;
+	for (ptScope = gptScope; ptScope != NULL; ptScope = ptScope->ptOuter)
+	{
+		if (ptScope->ptCancel == NULL)
+			continue;
+		dwLeft = TimeLeft(ptScope->ptCancel);
+		if (dwLeft == 0)
+			return WAIT_TIMEOUT;
+		if (dwLeft < dwTimeout)
+			dwTimeout = dwLeft;
+		if (iWait <= CANCEL_MAX_WAIT)
+			thWait[iWait++] = ptScope->ptCancel->hEvent;
+	}
+	if (iWait == 0)
+	{
+		Sleep(dwTimeout);
+		return WAIT_TIMEOUT;
+	}
+
+	dwRc = WaitForMultipleObjects(iWait, thWait, FALSE, dwTimeout);
+	if (hEvent != NULL && dwRc == WAIT_OBJECT_0)
+		return WAIT_OBJECT_0;
+	return WAIT_TIMEOUT;
+}
+
+/**
+  * @brief Marks the points a cancelled operation did not measure
+  *
+  *	They are set to NaN, so partial results are told apart from measured
+  *	ones.
+  *
+  * @param  pfR			R, one per point
+  * @param  pfX			X, one per point
+  * @param  iFirst		first point not measured
+  * @param  iEnd		number of points
+  * @retval None
+  */
+void Sark_Cancel_Unmeasured (float *pfR, float *pfX, int iFirst, int iEnd)
+{
+	uint32 u32NaN = CANCEL_NAN;
+	int ii;
+
+	for (ii = iFirst; ii < iEnd; ii++)
+	{
+		memcpy(&pfR[ii], &u32NaN, sizeof(float));
+		memcpy(&pfX[ii], &u32NaN, sizeof(float));
+	}
+}
+
+/**
+  * @brief Time left before a token expires
+  *
+  * @retval ms, rounded up; 0 if expired, INFINITE if no deadline
+  */
+static DWORD TimeLeft (T_SARK_CANCEL *ptCancel)
+{
+	LONGLONG llDeadline;
+	LONGLONG llLeft;
+
+	if (ptCancel->lSet != 0)
+		return 0;
+	/* A plain 64-bit load may tear on x86 */
+	llDeadline = InterlockedCompareExchange64(&ptCancel->llDeadline, 0, 0);
+	if (llDeadline == 0)
+		return INFINITE;
+	llLeft = llDeadline - Sark_Timing_Now();
+	if (llLeft <= 0)
+		return 0;
+	llLeft = (llLeft * 1000 + ptCancel->llFreq - 1) / ptCancel->llFreq;
+	return (llLeft >= INFINITE) ? INFINITE - 1 : (DWORD)llLeft;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file    sark_cancel.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Cancellation of long running operations
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_CANCEL_H__
+#define __SARK_CANCEL_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_cancel T_SARK_CANCEL;
+
+/* Tokens an operation runs under, innermost first; kept by the caller */
+typedef struct cancel_scope
+{
+	T_SARK_CANCEL *ptCancel;
+	struct cancel_scope *ptOuter;
+} T_CANCEL_SCOPE;
+
+/* Exported constants --------------------------------------------------------*/
+#define SARK_CANCELLED		-5	/* return code: cancelled or deadline passed */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_CANCEL *Sark_Cancel_Create (void);
+extern void Sark_Cancel_Destroy (T_SARK_CANCEL *ptCancel);
+extern int Sark_Cancel_Set (T_SARK_CANCEL *ptCancel);
+extern int Sark_Cancel_Reset (T_SARK_CANCEL *ptCancel);
+extern int Sark_Cancel_SetDeadline (T_SARK_CANCEL *ptCancel, LONGLONG llDeadline);
+extern bool Sark_Cancel_Expired (T_SARK_CANCEL *ptCancel);
+
+/* Used by the operations and the transports */
+extern void Sark_Cancel_Enter (T_CANCEL_SCOPE *ptScope, T_SARK_CANCEL *ptCancel);
+extern void Sark_Cancel_Shield (T_CANCEL_SCOPE *ptScope);
+extern void Sark_Cancel_Leave (T_CANCEL_SCOPE *ptScope);
+extern bool Sark_Cancel_Pending (void);
+extern DWORD Sark_Cancel_Wait (HANDLE hEvent, DWORD dwTimeout);
+extern void Sark_Cancel_Unmeasured (float *pfR, float *pfX, int iFirst, int iEnd);
+
+#endif	 /* __SARK_CANCEL_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -52,6 +52,7 @@
 #define CMD_SET_SETTING			10	/* Sets device setting */
 #define CMD_GET_SETTING			11	/* Gets device setting */
 #define CMD_SARK_MEAS_RX_EFF	12	/* Measures R and X; efficient (x4 samples) */
+#define CMD_SARK_MEAS_RX_BULK	13	/* Measures R and X; several answer frames */
 #define CMD_BUZZER				20	/* Sounds buzzer */
 #define CMD_GET_KEY				21	/* Get key */
 #define CMD_DEV_RST				50	/* Reset */
@@ -83,6 +84,19 @@
 #define SARKCMD_TX_SIZE			18	/* transmit command size */
 #define SARKCMD_RX_SIZE			18	/* receive command size  */
 
+/* Protocol version reported by CMD_SARK_VERSION */
+#define SARK_PROTO_BULK			2	/* first version with CMD_SARK_MEAS_RX_BULK */
+
+/* CMD_SARK_MEAS_RX_BULK: freq at 1, cal at 5, samples at 6 and step at 7 as
+   in CMD_SARK_MEAS_RX_EFF, points at 11 and format at 13. It is answered by
+   one frame per BULK_PER_xx points, with the frame number at position 1 and
+   the points from position 2; an error is answered with a single frame */
+#define BULK_FMT_HALF			0	/* R and X as half floats */
+#define BULK_FMT_FLOAT			1	/* R and X as floats */
+#define BULK_PER_HALF			4	/* points per answer frame */
+#define BULK_PER_FLOAT			2
+#define BULK_MAX_FRAMES			64	/* answer frames per request */
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 
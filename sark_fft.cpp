@@ -0,0 +1,210 @@
+/**
+  ******************************************************************************
+  * @file    sark_fft.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Radix-2 FFT with cached plans
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <math.h>
+#include "sark_fft.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct fft_plan
+{
+	int iSize;				/* number of points, power of two */
+	float *pfCos;			/* twiddles, iSize/2 entries */
+	float *pfSin;
+	uint32 *pu32Rev;		/* bit reversed index, iSize entries */
+	struct fft_plan *pNext;
+};
+
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+
+/* Plans are built once per size and kept for the life of the process */
+static SRWLOCK gPlanLock = SRWLOCK_INIT;
+static T_FFT_PLAN *gpPlans = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+static T_FFT_PLAN *BuildPlan (int iSize);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Get the plan for a transform size
+  *
+  * @param  iSize		number of points, power of two up to FFT_MAX_SIZE
+  * @retval
+  *			@li plan
+  *			@li NULL: invalid size or out of memory
+  */
+const T_FFT_PLAN *Fft_Plan (int iSize)
+{
+	T_FFT_PLAN *ptPlan;
+
+	if (iSize < 2 || iSize > FFT_MAX_SIZE || (iSize & (iSize - 1)) != 0)
+		return NULL;
+
+	AcquireSRWLockShared(&gPlanLock);
+	for (ptPlan = gpPlans; ptPlan != NULL; ptPlan = ptPlan->pNext)
+	{
+		if (ptPlan->iSize == iSize)
+			break;
+	}
+	ReleaseSRWLockShared(&gPlanLock);
+	if (ptPlan != NULL)
+		return ptPlan;
+
+	AcquireSRWLockExclusive(&gPlanLock);
+	for (ptPlan = gpPlans; ptPlan != NULL; ptPlan = ptPlan->pNext)
+	{
+		if (ptPlan->iSize == iSize)
+			break;
+	}
+	if (ptPlan == NULL)
+	{
+		ptPlan = BuildPlan(iSize);
+		if (ptPlan != NULL)
+		{
+			ptPlan->pNext = gpPlans;
+			gpPlans = ptPlan;
+		}
+	}
+	ReleaseSRWLockExclusive(&gPlanLock);
+
+	return ptPlan;
+}
+
+/**
+  * @brief In-place complex FFT
+  *
+  *	The inverse transform is not scaled by 1/N.
+  *
+  * @param  ptPlan		plan from Fft_Plan
+  * @param  pfRe		real parts, plan size entries
+  * @param  pfIm		imaginary parts, plan size entries
+  * @param  bInverse	TRUE for the inverse transform
+  * @retval None
+  */
+void Fft_Transform (const T_FFT_PLAN *ptPlan, float *pfRe, float *pfIm, bool bInverse)
+{
+	int iSize = ptPlan->iSize;
+	int iHalf, iStride;
+	int ii, jj, kk;
+	float fSign = bInverse ? 1.0f : -1.0f;
+	float fWr, fWi, fTr, fTi;
+	float fT;
+
+	for (ii = 0; ii < iSize; ii++)
+	{
+		jj = (int)ptPlan->pu32Rev[ii];
+		if (jj > ii)
+		{
+			fT = pfRe[ii]; pfRe[ii] = pfRe[jj]; pfRe[jj] = fT;
+			fT = pfIm[ii]; pfIm[ii] = pfIm[jj]; pfIm[jj] = fT;
+		}
+	}
+
+	for (iHalf = 1, iStride = iSize / 2; iHalf < iSize; iHalf *= 2, iStride /= 2)
+	{
+		for (ii = 0; ii < iSize; ii += 2 * iHalf)
+		{
+			for (kk = 0; kk < iHalf; kk++)
+			{
+				fWr = ptPlan->pfCos[kk * iStride];
+				fWi = fSign * ptPlan->pfSin[kk * iStride];
+				jj = ii + kk + iHalf;
+				fTr = pfRe[jj] * fWr - pfIm[jj] * fWi;
+				fTi = pfRe[jj] * fWi + pfIm[jj] * fWr;
+				pfRe[jj] = pfRe[ii + kk] - fTr;
+				pfIm[jj] = pfIm[ii + kk] - fTi;
+				pfRe[ii + kk] += fTr;
+				pfIm[ii + kk] += fTi;
+			}
+		}
+	}
+}
+
+/**
+  * @brief Computes twiddles and bit reversal table
+  */
+static T_FFT_PLAN *BuildPlan (int iSize)
+{
+	T_FFT_PLAN *ptPlan;
+	uint32 u32Rev;
+	int iBits = 0;
+	int ii, jj;
+
+	ptPlan = (T_FFT_PLAN *)calloc(1, sizeof(T_FFT_PLAN));
+	if (ptPlan == NULL)
+		return NULL;
+	ptPlan->pfCos = (float *)malloc(iSize / 2 * sizeof(float));
+	ptPlan->pfSin = (float *)malloc(iSize / 2 * sizeof(float));
+	ptPlan->pu32Rev = (uint32 *)malloc(iSize * sizeof(uint32));
+	if (ptPlan->pfCos == NULL || ptPlan->pfSin == NULL || ptPlan->pu32Rev == NULL)
+	{
+		free(ptPlan->pfCos);
+		free(ptPlan->pfSin);
+		free(ptPlan->pu32Rev);
+		free(ptPlan);
+		return NULL;
+	}
+	ptPlan->iSize = iSize;
+	for (ii = 0; ii < iSize / 2; ii++)
+	{
+		ptPlan->pfCos[ii] = (float)cos(2 * M_PI * ii / iSize);
+		ptPlan->pfSin[ii] = (float)sin(2 * M_PI * ii / iSize);
+	}
+	while ((1 << iBits) < iSize)
+		iBits++;
+	for (ii = 0; ii < iSize; ii++)
+	{
+		u32Rev = 0;
+		for (jj = 0; jj < iBits; jj++)
+		{
+			if (ii & (1 << jj))
+				u32Rev |= 1 << (iBits - 1 - jj);
+		}
+		ptPlan->pu32Rev[ii] = u32Rev;
+	}
+
+	return ptPlan;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
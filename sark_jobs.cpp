@@ -0,0 +1,592 @@
+/**
+  ******************************************************************************
+  * @file    sark_jobs.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Measurement jobs shared by several devices
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <float.h>
+#include "sark_rem_client.h"
+#include "sark_jobs.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Worker of one device */
+typedef struct
+{
+	T_SARK_JOBS *pJobs;
+	int16 num;				/* device number */
+	volatile LONGLONG llRange;	/* pending jobs: first in the low half, end in the high half */
+	volatile float fLatency;	/* average time per job (ms), 0 if not yet known */
+	bool bRetired;			/* comm error in the current run */
+	uint32 u32Done;			/* jobs measured since created */
+	uint32 u32Stolen;		/* jobs taken from other devices since created */
+	LONGLONG llExchange;	/* counter ticks measuring jobs in the current run */
+	T_PROGRESS_RUN tProgress;	/* jobs of the current run not yet reported */
+} T_JOBS_DEV;
+
+struct sark_jobs
+{
+	int iDevs;
+	T_JOBS_DEV *ptDev;
+	HANDLE *phThread;
+	T_SARK_JOB *ptJob;		/* jobs of the current run */
+	double dTickMs;			/* performance counter ticks to ms */
+	T_SARK_TIMING *ptTiming;	/* filled by every run; NULL if not requested */
+	T_SARK_CANCEL *ptCancel;	/* token of every run; NULL if none */
+	T_SARK_PROGRESS tProgress;	/* progress reported by every run */
+	CRITICAL_SECTION csProgress;	/* one progress call at a time */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define JOBS_CHUNK_MS		20.0f	/* time per chunk taken from the own queue */
+#define JOBS_MAX_CHUNK		64
+#define JOBS_ALPHA			0.25f	/* latency averaging factor */
+
+/* Private macro -------------------------------------------------------------*/
+#define RANGE(lo, hi)		((LONGLONG)(((ULONGLONG)(uint32)(hi) << 32) | (uint32)(lo)))
+#define RANGE_LO(r)			((int)((ULONGLONG)(r) & 0xFFFFFFFF))
+#define RANGE_HI(r)			((int)((ULONGLONG)(r) >> 32))
+
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static DWORD WINAPI DevThread (LPVOID lpParam);
+static bool TakeChunk (T_JOBS_DEV *ptDev, int *piFirst, int *piEnd);
+static bool Steal (T_JOBS_DEV *ptDev);
+static void GiveBack (T_JOBS_DEV *ptDev, int iFirst);
+static int RunJob (int16 num, T_SARK_JOB *ptJob);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Creates a job pool shared by several devices
+  *
+  *	Every device has its own queue of pending jobs. A device that runs out of
+  *	work takes half of the queue of the device with most pending time, so a
+  *	slow or disconnected analyzer does not hold up the batch. Jobs are taken
+  *	in chunks sized from the measured time per job of every device.
+  *
+  * @param  pi16Dev		device numbers
+  * @param  iDevs		number of devices
+  * @retval
+  *			@li pool handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_JOBS *Sark_Jobs_Create (const int16 *pi16Dev, int iDevs)
+{
+	T_SARK_JOBS *pJobs;
+	LARGE_INTEGER liFreq;
+	int ii;
+
+	if (pi16Dev == NULL || iDevs <= 0 || iDevs > SARK_MAX_DEVICES)
+		return NULL;
+	pJobs = (T_SARK_JOBS *)calloc(1, sizeof(T_SARK_JOBS));
+	if (pJobs == NULL)
+		return NULL;
+	InitializeCriticalSection(&pJobs->csProgress);
+	pJobs->ptDev = (T_JOBS_DEV *)calloc(iDevs, sizeof(T_JOBS_DEV));
+	pJobs->phThread = (HANDLE *)calloc(iDevs, sizeof(HANDLE));
+	if (pJobs->ptDev == NULL || pJobs->phThread == NULL)
+	{
+		Sark_Jobs_Destroy(pJobs);
+		return NULL;
+	}
+	pJobs->iDevs = iDevs;
+	for (ii = 0; ii < iDevs; ii++)
+	{
+		pJobs->ptDev[ii].pJobs = pJobs;
+		pJobs->ptDev[ii].num = pi16Dev[ii];
+	}
+	QueryPerformanceFrequency(&liFreq);
+	pJobs->dTickMs = 1000.0 / (double)liFreq.QuadPart;
+
+	return pJobs;
+}
+
+/**
+  * @brief Releases a job pool
+  *
+  * @param  pJobs		pool handle
+  * @retval None
+  */
+void Sark_Jobs_Destroy (T_SARK_JOBS *pJobs)
+{
+	if (pJobs == NULL)
+		return;
+	free(pJobs->phThread);
+	free(pJobs->ptDev);
+	DeleteCriticalSection(&pJobs->csProgress);
+	free(pJobs);
+}
+
+/**
+  * @brief Measures a batch of jobs on all the devices of the pool
+  *
+  *	Jobs are first shared in proportion to the speed of every device seen in
+  *	previous runs. A device that fails with a comm error gives back its
+  *	pending jobs to the others. Results are written into the jobs.
+  *
+  * @param  pJobs		pool handle
+  * @param  ptJob		jobs
+  * @param  iCount		number of jobs
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error, some jobs could not be measured
+  *			@li -2: device answered error in some jobs
+  *			@li -3: invalid parameters
+  *			@li SARK_CANCELLED: cancelled or deadline passed; jobs not measured
+  *				have i8Rc SARK_CANCELLED
+  */
+int Sark_Jobs_Run (T_SARK_JOBS *pJobs, T_SARK_JOB *ptJob, int iCount)
+{
+	T_JOBS_DEV *ptDev;
+	LONGLONG llExchange;
+	float fSpeed = 0.0f;
+	float fAcc = 0.0f;
+	bool bKnown = true;
+	int iThreads = 0;
+	int iFirst = 0;
+	int iEnd;
+	int rc = 1;
+	int ii;
+
+	if (pJobs == NULL || ptJob == NULL || iCount <= 0)
+		return -3;
+	for (ii = 0; ii < iCount; ii++)
+	{
+		ptJob[ii].i8Rc = -1;
+		ptJob[ii].i16Dev = -1;
+	}
+	pJobs->ptJob = ptJob;
+	Sark_Timing_Begin(pJobs->ptTiming);
+
+	for (ii = 0; ii < pJobs->iDevs; ii++)
+	{
+		if (pJobs->ptDev[ii].fLatency <= 0.0f)
+			bKnown = false;
+		else
+			fSpeed += 1.0f / pJobs->ptDev[ii].fLatency;
+	}
+	for (ii = 0; ii < pJobs->iDevs; ii++)
+	{
+		ptDev = &pJobs->ptDev[ii];
+		if (bKnown)
+		{
+			fAcc += 1.0f / ptDev->fLatency;
+			iEnd = (int)(iCount * fAcc / fSpeed + 0.5f);
+		}
+		else
+		{
+			iEnd = iCount * (ii + 1) / pJobs->iDevs;
+		}
+		if (ii == pJobs->iDevs - 1 || iEnd > iCount)
+			iEnd = iCount;
+		ptDev->bRetired = false;
+		ptDev->llExchange = 0;
+		Sark_Progress_Begin(&ptDev->tProgress, &pJobs->tProgress, &pJobs->csProgress);
+		InterlockedExchange64(&ptDev->llRange, RANGE(iFirst, iEnd));
+		iFirst = iEnd;
+	}
+
+	for (ii = 0; ii < pJobs->iDevs; ii++)
+	{
+		ptDev = &pJobs->ptDev[ii];
+		/* The last device runs on the calling thread */
+		if (ii < pJobs->iDevs - 1)
+		{
+			pJobs->phThread[iThreads] = CreateThread(NULL, 0, DevThread, ptDev, 0, NULL);
+			if (pJobs->phThread[iThreads] != NULL)
+			{
+				iThreads++;
+				continue;
+			}
+		}
+		DevThread(ptDev);
+	}
+	if (iThreads > 0)
+		WaitForMultipleObjects(iThreads, pJobs->phThread, TRUE, INFINITE);
+	for (ii = 0; ii < iThreads; ii++)
+		CloseHandle(pJobs->phThread[ii]);
+	pJobs->ptJob = NULL;
+	llExchange = 0;
+	for (ii = 0; ii < pJobs->iDevs; ii++)
+		llExchange += pJobs->ptDev[ii].llExchange;
+	Sark_Timing_End(pJobs->ptTiming, llExchange, 0);
+
+	if (Sark_Cancel_Expired(pJobs->ptCancel))
+	{
+		for (ii = 0; ii < iCount; ii++)
+		{
+			if (ptJob[ii].i8Rc == -1)
+				ptJob[ii].i8Rc = SARK_CANCELLED;
+		}
+		return SARK_CANCELLED;
+	}
+	for (ii = 0; ii < iCount; ii++)
+	{
+		if (ptJob[ii].i8Rc == -1)
+			return -1;
+		if (ptJob[ii].i8Rc < 0)
+			rc = ptJob[ii].i8Rc;
+	}
+
+	return rc;
+}
+
+/**
+  * @brief Requests the timing of the runs of the pool
+  *
+  *	Every later run stamps the jobs, by job index, in the arrays of ptTiming
+  *	and fills its phases. dExchange is added over all the devices, so with
+  *	several devices it exceeds dTotal and dHost is not meaningful.
+  *
+  * @param  pJobs		pool handle
+  * @param  ptTiming	caller owned timing; NULL to stop timing
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Jobs_SetTiming (T_SARK_JOBS *pJobs, T_SARK_TIMING *ptTiming)
+{
+	if (pJobs == NULL)
+		return -3;
+	pJobs->ptTiming = ptTiming;
+	return 1;
+}
+
+/**
+  * @brief Attaches a cancellation token to the runs of the pool
+  *
+  *	Every device checks the token before each job, and the token ends the
+  *	waits for answers in progress.
+  *
+  * @param  pJobs		pool handle
+  * @param  ptCancel	token handle; NULL to detach
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Jobs_SetCancel (T_SARK_JOBS *pJobs, T_SARK_CANCEL *ptCancel)
+{
+	if (pJobs == NULL)
+		return -3;
+	pJobs->ptCancel = ptCancel;
+	return 1;
+}
+
+/**
+  * @brief Requests the progress of the runs of the pool
+  *
+  *	pfCallback is called with the job indexes newly measured. Each device
+  *	reports its own jobs, from its own thread and with its own limits, so
+  *	ranges arrive out of order; calls are serialized by the pool. A call
+  *	waits for both u32Ms since the previous call of the device and iPoints
+  *	new jobs; the jobs left are reported when the device ends the run.
+  *
+  * @param  pJobs		pool handle
+  * @param  pfCallback	callback; NULL to stop reporting
+  * @param  pvUser		given to pfCallback
+  * @param  u32Ms		minimum time between calls of a device (ms); 0: no limit
+  * @param  iPoints		minimum jobs per call; 0: no limit
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Jobs_SetProgress (T_SARK_JOBS *pJobs, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	if (pJobs == NULL)
+		return -3;
+	return Sark_Progress_Set(&pJobs->tProgress, pfCallback, pvUser, u32Ms, iPoints);
+}
+
+/**
+  * @brief Gets the counters of a device of the pool
+  *
+  * @param  pJobs		pool handle
+  * @param  num			device number
+  * @param  pu32Done	return jobs measured by the device
+  * @param  pu32Stolen	return jobs the device took from other devices
+  * @param  pfLatency	return average time per job (ms), 0 if not yet known
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters or device not in the pool
+  */
+int Sark_Jobs_Stats (T_SARK_JOBS *pJobs, int16 num, uint32 *pu32Done, uint32 *pu32Stolen, float *pfLatency)
+{
+	T_JOBS_DEV *ptDev;
+	int ii;
+
+	if (pJobs == NULL)
+		return -3;
+	for (ii = 0; ii < pJobs->iDevs; ii++)
+	{
+		ptDev = &pJobs->ptDev[ii];
+		if (ptDev->num != num)
+			continue;
+		if (pu32Done != NULL)
+			*pu32Done = ptDev->u32Done;
+		if (pu32Stolen != NULL)
+			*pu32Stolen = ptDev->u32Stolen;
+		if (pfLatency != NULL)
+			*pfLatency = ptDev->fLatency;
+		return 1;
+	}
+
+	return -3;
+}
+
+/**
+  * @brief Measures the jobs of one device, then helps the others
+  */
+static DWORD WINAPI DevThread (LPVOID lpParam)
+{
+	T_JOBS_DEV *ptDev = (T_JOBS_DEV *)lpParam;
+	T_SARK_JOBS *pJobs = ptDev->pJobs;
+	T_CANCEL_SCOPE tScope;
+	LARGE_INTEGER liStart, liEnd;
+	LONGLONG llSend, llRecv;
+	float fMs;
+	int iFirst, iEnd;
+	int ii;
+	int rc;
+
+	Sark_Cancel_Enter(&tScope, pJobs->ptCancel);
+	for (;;)
+	{
+		if (!TakeChunk(ptDev, &iFirst, &iEnd))
+		{
+			if (!Steal(ptDev))
+				break;
+			continue;
+		}
+		QueryPerformanceCounter(&liStart);
+		for (ii = iFirst; ii < iEnd; ii++)
+		{
+			if (Sark_Cancel_Pending())
+				break;
+			llSend = Sark_Timing_Now();
+			rc = RunJob(ptDev->num, &pJobs->ptJob[ii]);
+			llRecv = Sark_Timing_Now();
+			ptDev->llExchange += llRecv - llSend;
+			if (rc == -1)
+				break;
+			Sark_Timing_Stamp(pJobs->ptTiming, ii, 1, llSend, llRecv);
+			Sark_Progress_Done(&ptDev->tProgress, ii, 1);
+			ptDev->u32Done++;
+		}
+		if (ii < iEnd)
+		{
+			/* Leave the rest to the devices still working */
+			ptDev->bRetired = true;
+			GiveBack(ptDev, ii);
+			break;
+		}
+		QueryPerformanceCounter(&liEnd);
+		fMs = (float)((liEnd.QuadPart - liStart.QuadPart) * pJobs->dTickMs) / (iEnd - iFirst);
+		if (fMs <= 0.0f)
+			fMs = 0.001f;
+		if (ptDev->fLatency <= 0.0f)
+			ptDev->fLatency = fMs;
+		else
+			ptDev->fLatency += JOBS_ALPHA * (fMs - ptDev->fLatency);
+	}
+	Sark_Progress_Flush(&ptDev->tProgress);
+	Sark_Cancel_Leave(&tScope);
+
+	return 0;
+}
+
+/**
+  * @brief Takes a chunk from the front of the own queue
+  *
+  *	Slow devices take smaller chunks so more of their queue can be stolen.
+  */
+static bool TakeChunk (T_JOBS_DEV *ptDev, int *piFirst, int *piEnd)
+{
+	LONGLONG llOld;
+	int iChunk = 1;
+	int iLo, iHi;
+
+	if (ptDev->fLatency > 0.0f)
+	{
+		iChunk = (int)(JOBS_CHUNK_MS / ptDev->fLatency);
+		if (iChunk < 1)
+			iChunk = 1;
+		else if (iChunk > JOBS_MAX_CHUNK)
+			iChunk = JOBS_MAX_CHUNK;
+	}
+	for (;;)
+	{
+		llOld = ptDev->llRange;
+		iLo = RANGE_LO(llOld);
+		iHi = RANGE_HI(llOld);
+		if (iLo >= iHi)
+			return false;
+		if (iChunk > iHi - iLo)
+			iChunk = iHi - iLo;
+		if (InterlockedCompareExchange64(&ptDev->llRange, RANGE(iLo + iChunk, iHi), llOld) == llOld)
+		{
+			*piFirst = iLo;
+			*piEnd = iLo + iChunk;
+			return true;
+		}
+	}
+}
+
+/**
+  * @brief Takes pending jobs from the device with most pending time
+  *
+  *	The victim queue is split in proportion to the speed of both devices and
+  *	the back part becomes the own queue, which is empty at this point. Jobs
+  *	the victim would finish before this device are left alone.
+  */
+static bool Steal (T_JOBS_DEV *ptDev)
+{
+	T_SARK_JOBS *pJobs = ptDev->pJobs;
+	T_JOBS_DEV *ptVictim;
+	LONGLONG llOld;
+	float fOwn, fVictim;
+	float fCost, fBest;
+	int iLo, iHi, iTake;
+	int ii;
+
+	if (ptDev->bRetired)
+		return false;
+	fOwn = ptDev->fLatency;
+	for (;;)
+	{
+		ptVictim = NULL;
+		fBest = 0.0f;
+		for (ii = 0; ii < pJobs->iDevs; ii++)
+		{
+			if (&pJobs->ptDev[ii] == ptDev)
+				continue;
+			llOld = pJobs->ptDev[ii].llRange;
+			if (RANGE_LO(llOld) >= RANGE_HI(llOld))
+				continue;
+			if (pJobs->ptDev[ii].bRetired)
+				fVictim = FLT_MAX;
+			else if (pJobs->ptDev[ii].fLatency > 0.0f)
+				fVictim = pJobs->ptDev[ii].fLatency;
+			else
+				fVictim = fOwn;
+			fCost = (RANGE_HI(llOld) - RANGE_LO(llOld)) * fVictim;
+			if (ptVictim == NULL || fCost > fBest)
+			{
+				ptVictim = &pJobs->ptDev[ii];
+				fBest = fCost;
+			}
+		}
+		if (ptVictim == NULL)
+			return false;
+		if (!ptVictim->bRetired && fOwn > 0.0f && fBest <= fOwn)
+			return false;
+
+		llOld = ptVictim->llRange;
+		iLo = RANGE_LO(llOld);
+		iHi = RANGE_HI(llOld);
+		if (iLo >= iHi)
+			continue;
+		fVictim = ptVictim->fLatency;
+		if (ptVictim->bRetired)
+			iTake = iHi - iLo;
+		else if (fOwn > 0.0f && fVictim > 0.0f)
+			iTake = (int)((iHi - iLo) * fVictim / (fVictim + fOwn));
+		else
+			iTake = (iHi - iLo + 1) / 2;
+		if (iTake < 1)
+			iTake = 1;
+		if (InterlockedCompareExchange64(&ptVictim->llRange, RANGE(iLo, iHi - iTake), llOld) == llOld)
+		{
+			InterlockedExchange64(&ptDev->llRange, RANGE(iHi - iTake, iHi));
+			ptDev->u32Stolen += iTake;
+			return true;
+		}
+	}
+}
+
+/**
+  * @brief Returns the unfinished part of a chunk to the front of the own queue
+  */
+static void GiveBack (T_JOBS_DEV *ptDev, int iFirst)
+{
+	LONGLONG llOld;
+
+	do
+	{
+		llOld = ptDev->llRange;
+	} while (InterlockedCompareExchange64(&ptDev->llRange, RANGE(iFirst, RANGE_HI(llOld)), llOld) != llOld);
+}
+
+/**
+  * @brief Measures one job
+  */
+static int RunJob (int16 num, T_SARK_JOB *ptJob)
+{
+	float *pfVal = ptJob->tfVal;
+	int rc;
+
+	switch (ptJob->u8Type)
+	{
+	case JOB_MEAS_RX:
+		rc = Sark_Meas_Rx(num, ptJob->u32Freq, ptJob->u8Cal != 0, ptJob->u8Samples,
+			&pfVal[0], &pfVal[1], &pfVal[2], &pfVal[3]);
+		break;
+	case JOB_MEAS_VECT:
+		rc = Sark_Meas_Vect(num, ptJob->u32Freq, &pfVal[0], &pfVal[1], &pfVal[2], &pfVal[3]);
+		break;
+	case JOB_MEAS_THRU:
+		rc = Sark_Meas_Vect_Thru(num, ptJob->u32Freq, &pfVal[0], &pfVal[1], &pfVal[2], &pfVal[3]);
+		break;
+	case JOB_MEAS_RF:
+		rc = Sark_Meas_RF(num, ptJob->u32Freq, &pfVal[0], &pfVal[1], &pfVal[2], &pfVal[3]);
+		break;
+	default:
+		ptJob->i8Rc = -3;
+		return -3;
+	}
+	if (rc != -1)
+	{
+		ptJob->i8Rc = (int8)rc;
+		ptJob->i16Dev = num;
+	}
+
+	return rc;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file    sark_jobs.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Measurement jobs shared by several devices
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_JOBS_H__
+#define __SARK_JOBS_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+#include "sark_timing.h"
+#include "sark_cancel.h"
+#include "sark_progress.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_jobs T_SARK_JOBS;
+
+/* Measurement job */
+typedef struct
+{
+	uint32 u32Freq;			/* frequency */
+	uint8 u8Type;			/* JOB_MEAS_RX, JOB_MEAS_VECT, JOB_MEAS_THRU, JOB_MEAS_RF */
+	uint8 u8Cal;			/* JOB_MEAS_RX: {1: OSL calibrated; 0: not calibrated} */
+	uint8 u8Samples;		/* JOB_MEAS_RX: number of samples to average */
+	int8 i8Rc;				/* return: result of the measurement, as Sark_Meas_xx */
+	int16 i16Dev;			/* return: device that measured it */
+	float tfVal[4];			/* return: values in the order of Sark_Meas_xx */
+} T_SARK_JOB;
+
+/* Exported constants --------------------------------------------------------*/
+#define JOB_MEAS_RX			0	/* Sark_Meas_Rx: R, X, S21re, S21im */
+#define JOB_MEAS_VECT		1	/* Sark_Meas_Vect: MagV, PhV, MagI, PhI */
+#define JOB_MEAS_THRU		2	/* Sark_Meas_Vect_Thru: MagVout, PhVout, MagVin, PhVin */
+#define JOB_MEAS_RF			3	/* Sark_Meas_RF: MagV, PhV, MagI, PhI */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_JOBS *Sark_Jobs_Create (const int16 *pi16Dev, int iDevs);
+extern void Sark_Jobs_Destroy (T_SARK_JOBS *pJobs);
+extern int Sark_Jobs_Run (T_SARK_JOBS *pJobs, T_SARK_JOB *ptJob, int iCount);
+extern int Sark_Jobs_SetTiming (T_SARK_JOBS *pJobs, T_SARK_TIMING *ptTiming);
+extern int Sark_Jobs_SetCancel (T_SARK_JOBS *pJobs, T_SARK_CANCEL *ptCancel);
+extern int Sark_Jobs_SetProgress (T_SARK_JOBS *pJobs, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints);
+extern int Sark_Jobs_Stats (T_SARK_JOBS *pJobs, int16 num, uint32 *pu32Done, uint32 *pu32Stolen, float *pfLatency);
+
+#endif	 /* __SARK_JOBS_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
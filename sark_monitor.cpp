@@ -0,0 +1,417 @@
+/**
+  ******************************************************************************
+  * @file    sark_monitor.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Continuous sweep monitoring
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "sark_monitor.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Preallocated sweep result. lVer works as a sequence lock: it holds 2*seq
+ * once sweep seq is published and an odd value while the slot is rewritten. */
+typedef struct
+{
+	volatile LONG lVer;
+	float *pfR;
+	float *pfX;
+} T_MON_SLOT;
+
+struct sark_monitor
+{
+	int16 num;				/* device number */
+	T_SARK_SWEEP *pSweep;	/* sweep executed */
+	int iPoints;
+	int iSlots;
+	uint32 u32Interval;		/* pause between sweeps (ms) */
+	T_MON_SLOT *ptSlot;
+	float *pfData;			/* storage of all slots */
+	volatile LONG lHead;	/* sequence of newest published sweep; 0: none */
+	volatile LONG lErrors;	/* failed sweeps */
+	volatile LONG lLastRc;	/* return code of last sweep */
+	T_SARK_ALARM *pAlarm;	/* change detector fed with each sweep */
+	T_SARK_PUB *pPub;		/* publisher of each sweep */
+	CRITICAL_SECTION csAlarm;	/* guards pAlarm and pPub */
+	T_SARK_CANCEL *volatile ptCancel;	/* token of the sweeps; NULL if none */
+	T_SARK_CANCEL *ptStop;	/* aborts the sweep in progress when stopping */
+	HANDLE hStop;
+	HANDLE hThread;
+};
+
+/* Private define ------------------------------------------------------------*/
+#define MON_ERROR_DELAY		500		/* wait after a failed sweep (ms) */
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static DWORD WINAPI MonitorThread (LPVOID lpParam);
+static int ReadSlot (T_SARK_MONITOR *pMon, uint32 u32Seq, float *pfR, float *pfX);
+static void FreeMonitor (T_SARK_MONITOR *pMon);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Starts monitoring: runs a sweep repeatedly on a dedicated thread
+  *
+  *	Completed sweeps are published into a ring of iSlots preallocated
+  *	results. The slot being measured is not readable, so iSlots-1 sweeps of
+  *	history are available. The sweep must not be used by the caller until
+  *	the monitor is stopped.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pSweep		sweep to execute
+  * @param  iSlots		number of result slots (>= 2)
+  * @param  u32Interval	pause between sweeps in ms
+  * @retval
+  *			@li monitor handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_MONITOR *Sark_Monitor_Start (int16 num, T_SARK_SWEEP *pSweep, int iSlots, uint32 u32Interval)
+{
+	T_SARK_MONITOR *pMon;
+	int ii;
+
+	if (pSweep == NULL || iSlots < 2)
+		return NULL;
+	pMon = (T_SARK_MONITOR *)calloc(1, sizeof(T_SARK_MONITOR));
+	if (pMon == NULL)
+		return NULL;
+	pMon->num = num;
+	pMon->pSweep = pSweep;
+	pMon->iPoints = Sark_Sweep_Points(pSweep);
+	pMon->iSlots = iSlots;
+	pMon->u32Interval = u32Interval;
+	pMon->ptSlot = (T_MON_SLOT *)calloc(iSlots, sizeof(T_MON_SLOT));
+	pMon->pfData = (float *)malloc(iSlots * 2 * pMon->iPoints * sizeof(float));
+	pMon->hStop = CreateEvent(NULL, TRUE, FALSE, NULL);
+	pMon->ptStop = Sark_Cancel_Create();
+	InitializeCriticalSection(&pMon->csAlarm);
+	if (pMon->ptSlot == NULL || pMon->pfData == NULL || pMon->hStop == NULL || pMon->ptStop == NULL)
+	{
+		FreeMonitor(pMon);
+		return NULL;
+	}
+	for (ii = 0; ii < iSlots; ii++)
+	{
+		pMon->ptSlot[ii].pfR = &pMon->pfData[(2 * ii) * pMon->iPoints];
+		pMon->ptSlot[ii].pfX = &pMon->pfData[(2 * ii + 1) * pMon->iPoints];
+	}
+	pMon->hThread = CreateThread(NULL, 0, MonitorThread, pMon, 0, NULL);
+	if (pMon->hThread == NULL)
+	{
+		FreeMonitor(pMon);
+		return NULL;
+	}
+
+	return pMon;
+}
+
+/**
+  * @brief Stops monitoring and releases the monitor
+  *
+  *	The sweep in progress is cancelled.
+  *
+  * @param  pMon		monitor handle
+  * @retval None
+  */
+void Sark_Monitor_Stop (T_SARK_MONITOR *pMon)
+{
+	if (pMon == NULL)
+		return;
+	SetEvent(pMon->hStop);
+	Sark_Cancel_Set(pMon->ptStop);
+	WaitForSingleObject(pMon->hThread, INFINITE);
+	FreeMonitor(pMon);
+}
+
+/**
+  * @brief Reads the newest completed sweep
+  *
+  *	Never blocks the measurement thread.
+  *
+  * @param  pMon		monitor handle
+  * @param  pu32Seq		return sequence number of the sweep (first is 1)
+  * @param  pfR			return R (real Z), one per point
+  * @param  pfX			return X (imag Z), one per point
+  * @retval
+  *			@li 1: Ok
+  *			@li 0: no sweep completed yet
+  *			@li -3: invalid parameters
+  */
+int Sark_Monitor_Latest (T_SARK_MONITOR *pMon, uint32 *pu32Seq, float *pfR, float *pfX)
+{
+	uint32 u32Head;
+
+	if (pMon == NULL || pfR == NULL || pfX == NULL)
+		return -3;
+	for (;;)
+	{
+		u32Head = (uint32)pMon->lHead;
+		if (u32Head == 0)
+			return 0;
+		/* Only fails if the producer lapped the ring while copying */
+		if (ReadSlot(pMon, u32Head, pfR, pfX) == 1)
+			break;
+	}
+	if (pu32Seq != NULL)
+		*pu32Seq = u32Head;
+
+	return 1;
+}
+
+/**
+  * @brief Reads a sweep from the history
+  *
+  *	Sweeps from Latest-(iSlots-2) to Latest are normally available.
+  *
+  * @param  pMon		monitor handle
+  * @param  u32Seq		sequence number of the sweep
+  * @param  pfR			return R (real Z), one per point
+  * @param  pfX			return X (imag Z), one per point
+  * @retval
+  *			@li 1: Ok
+  *			@li 0: sweep not completed yet
+  *			@li -3: invalid parameters
+  *			@li -4: sweep overwritten
+  */
+int Sark_Monitor_Read (T_SARK_MONITOR *pMon, uint32 u32Seq, float *pfR, float *pfX)
+{
+	if (pMon == NULL || pfR == NULL || pfX == NULL)
+		return -3;
+	if (u32Seq == 0 || u32Seq > (uint32)pMon->lHead)
+		return 0;
+	return ReadSlot(pMon, u32Seq, pfR, pfX);
+}
+
+/**
+  * @brief Attaches a change detector fed with every completed sweep
+  *
+  *	The detector runs on the measurement thread right after the sweep is
+  *	published. Once this call returns with NULL the previous detector is no
+  *	longer used and can be destroyed.
+  *
+  * @param  pMon		monitor handle
+  * @param  pAlarm		change detector sized for the sweep; NULL to detach
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters or detector not sized for the sweep
+  */
+int Sark_Monitor_SetAlarm (T_SARK_MONITOR *pMon, T_SARK_ALARM *pAlarm)
+{
+	if (pMon == NULL)
+		return -3;
+	if (pAlarm != NULL && Sark_Alarm_Points(pAlarm) != pMon->iPoints)
+		return -3;
+	EnterCriticalSection(&pMon->csAlarm);
+	pMon->pAlarm = pAlarm;
+	LeaveCriticalSection(&pMon->csAlarm);
+	return 1;
+}
+
+/**
+  * @brief Attaches a publisher fed with every completed sweep
+  *
+  *	The sweep is posted on the measurement thread right after it is
+  *	published, without waiting for the subscribers. Once this call returns
+  *	with NULL the previous publisher is no longer used and can be stopped.
+  *
+  * @param  pMon		monitor handle
+  * @param  pPub		publisher started for the sweep; NULL to detach
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters or publisher not started for the sweep
+  */
+int Sark_Monitor_SetPub (T_SARK_MONITOR *pMon, T_SARK_PUB *pPub)
+{
+	if (pMon == NULL)
+		return -3;
+	if (pPub != NULL && Sark_Pub_Points(pPub) != pMon->iPoints)
+		return -3;
+	EnterCriticalSection(&pMon->csAlarm);
+	pMon->pPub = pPub;
+	LeaveCriticalSection(&pMon->csAlarm);
+	return 1;
+}
+
+/**
+  * @brief Attaches a cancellation token to the sweeps of the monitor
+  *
+  *	Once the token is cancelled or its deadline passes, the sweep in
+  *	progress is abandoned and no more sweeps are run; the last return code
+  *	becomes SARK_CANCELLED. The token must be kept until the monitor is
+  *	stopped.
+  *
+  * @param  pMon		monitor handle
+  * @param  ptCancel	token handle; NULL to detach
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Monitor_SetCancel (T_SARK_MONITOR *pMon, T_SARK_CANCEL *ptCancel)
+{
+	if (pMon == NULL)
+		return -3;
+	pMon->ptCancel = ptCancel;
+	return 1;
+}
+
+/**
+  * @brief Monitor statistics
+  *
+  * @param  pMon		monitor handle
+  * @param  pu32Sweeps	return completed sweeps
+  * @param  pu32Errors	return failed sweeps
+  * @param  piLastRc	return code of last sweep
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Monitor_Status (T_SARK_MONITOR *pMon, uint32 *pu32Sweeps, uint32 *pu32Errors, int *piLastRc)
+{
+	if (pMon == NULL)
+		return -3;
+	if (pu32Sweeps != NULL)
+		*pu32Sweeps = (uint32)pMon->lHead;
+	if (pu32Errors != NULL)
+		*pu32Errors = (uint32)pMon->lErrors;
+	if (piLastRc != NULL)
+		*piLastRc = (int)pMon->lLastRc;
+	return 1;
+}
+
+/**
+  * @brief Measurement thread
+  *
+  *	Single producer. The slot of the oldest sweep is marked as being written,
+  *	measured in place and then published by advancing lHead.
+  */
+static DWORD WINAPI MonitorThread (LPVOID lpParam)
+{
+	T_SARK_MONITOR *pMon = (T_SARK_MONITOR *)lpParam;
+	T_CANCEL_SCOPE tStopScope, tScope;
+	T_MON_SLOT *ptSlot;
+	uint32 u32Seq = 0;
+	DWORD dwWait;
+	int rc;
+
+	Sark_Cancel_Enter(&tStopScope, pMon->ptStop);
+	do
+	{
+		u32Seq++;
+		ptSlot = &pMon->ptSlot[u32Seq % pMon->iSlots];
+		InterlockedExchange(&ptSlot->lVer, (LONG)(2 * u32Seq - 1));
+		Sark_Cancel_Enter(&tScope, pMon->ptCancel);
+		rc = Sark_Sweep_Run(pMon->num, pMon->pSweep, ptSlot->pfR, ptSlot->pfX);
+		Sark_Cancel_Leave(&tScope);
+		if (rc == SARK_CANCELLED)
+		{
+			/* Stopping, or cancelled by the caller: idle until stopped */
+			if (!Sark_Cancel_Expired(pMon->ptStop))
+				InterlockedExchange(&pMon->lLastRc, rc);
+			u32Seq--;
+			dwWait = INFINITE;
+			continue;
+		}
+		InterlockedExchange(&pMon->lLastRc, rc);
+		if (rc < 0)
+		{
+			/* Slot stays invalid and is reused by the next attempt */
+			InterlockedIncrement(&pMon->lErrors);
+			u32Seq--;
+			dwWait = MON_ERROR_DELAY;
+		}
+		else
+		{
+			InterlockedExchange(&ptSlot->lVer, (LONG)(2 * u32Seq));
+			InterlockedExchange(&pMon->lHead, (LONG)u32Seq);
+			EnterCriticalSection(&pMon->csAlarm);
+			if (pMon->pAlarm != NULL)
+				Sark_Alarm_Update(pMon->pAlarm, u32Seq, ptSlot->pfR, ptSlot->pfX);
+			if (pMon->pPub != NULL)
+				Sark_Pub_Post(pMon->pPub, u32Seq, ptSlot->pfR, ptSlot->pfX);
+			LeaveCriticalSection(&pMon->csAlarm);
+			dwWait = pMon->u32Interval;
+		}
+	} while (WaitForSingleObject(pMon->hStop, dwWait) == WAIT_TIMEOUT);
+	Sark_Cancel_Leave(&tStopScope);
+
+	return 0;
+}
+
+/**
+  * @brief Copies a slot checking it was not rewritten meanwhile
+  *
+  * @retval
+  *			@li 1: Ok
+  *			@li -4: sweep overwritten
+  */
+static int ReadSlot (T_SARK_MONITOR *pMon, uint32 u32Seq, float *pfR, float *pfX)
+{
+	T_MON_SLOT *ptSlot = &pMon->ptSlot[u32Seq % pMon->iSlots];
+	LONG lVer = (LONG)(2 * u32Seq);
+
+	if (ptSlot->lVer != lVer)
+		return -4;
+	MemoryBarrier();
+	memcpy(pfR, ptSlot->pfR, pMon->iPoints * sizeof(float));
+	memcpy(pfX, ptSlot->pfX, pMon->iPoints * sizeof(float));
+	MemoryBarrier();
+	if (ptSlot->lVer != lVer)
+		return -4;
+
+	return 1;
+}
+
+/**
+  * @brief Releases monitor resources
+  */
+static void FreeMonitor (T_SARK_MONITOR *pMon)
+{
+	if (pMon->hThread != NULL)
+		CloseHandle(pMon->hThread);
+	if (pMon->hStop != NULL)
+		CloseHandle(pMon->hStop);
+	Sark_Cancel_Destroy(pMon->ptStop);
+	DeleteCriticalSection(&pMon->csAlarm);
+	free(pMon->pfData);
+	free(pMon->ptSlot);
+	free(pMon);
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file    sark_monitor.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Continuous sweep monitoring
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_MONITOR_H__
+#define __SARK_MONITOR_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+#include "sark_sweep.h"
+#include "sark_alarm.h"
+#include "sark_pub.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_monitor T_SARK_MONITOR;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_MONITOR *Sark_Monitor_Start (int16 num, T_SARK_SWEEP *pSweep, int iSlots, uint32 u32Interval);
+extern void Sark_Monitor_Stop (T_SARK_MONITOR *pMon);
+extern int Sark_Monitor_Latest (T_SARK_MONITOR *pMon, uint32 *pu32Seq, float *pfR, float *pfX);
+extern int Sark_Monitor_Read (T_SARK_MONITOR *pMon, uint32 u32Seq, float *pfR, float *pfX);
+extern int Sark_Monitor_SetAlarm (T_SARK_MONITOR *pMon, T_SARK_ALARM *pAlarm);
+extern int Sark_Monitor_SetPub (T_SARK_MONITOR *pMon, T_SARK_PUB *pPub);
+extern int Sark_Monitor_SetCancel (T_SARK_MONITOR *pMon, T_SARK_CANCEL *ptCancel);
+extern int Sark_Monitor_Status (T_SARK_MONITOR *pMon, uint32 *pu32Sweeps, uint32 *pu32Errors, int *piLastRc);
+
+#endif	 /* __SARK_MONITOR_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,509 @@
+/**
+  ******************************************************************************
+  * @file    sark_plan.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Precompiled sweep plans
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "sark_rem_client.h"
+#include "sark_plan.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct sark_plan
+{
+	int iPoints;			/* number of points */
+	int iFrames;			/* number of requests */
+	T_SARK_FRAME *ptFrame;	/* encoded requests; answers are decoded in place */
+	uint8 *pu8Count;		/* points answered by each request */
+	T_SARK_TIMING *ptTiming;	/* filled by every run; NULL if not requested */
+	T_SARK_CANCEL *ptCancel;	/* token of every run; NULL if none */
+	T_SARK_PROGRESS tProgress;	/* progress reported by every run */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define PLAN_EFF_POINTS		4		/* points answered by CMD_SARK_MEAS_RX_EFF */
+
+/* Plan file: magic, version(2), reserved(2), points(4), requests(4), then the
+   SARKCMD_TX_SIZE bytes of every request. Integers are little endian */
+#define PLAN_MAGIC			"SKPL"
+#define PLAN_FILE_VER		1
+#define PLAN_HEADER_SIZE	16
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static T_SARK_PLAN *AllocPlan (int iPoints, int iFrames);
+static T_SARK_PLAN *ReadPlan (FILE *pFile);
+static int GroupPoints (const uint32 *pu32Freq, int iPoint, int iPoints, bool bFloat);
+static void EncodeFrame (uint8 *pu8Tx, const uint32 *pu32Freq, int iCount, bool bCal, uint8 u8Samples);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Precompiles the requests measuring a list of frequencies
+  *
+  *	Runs of PLAN_EFF_POINTS evenly spaced ascending frequencies are grouped
+  *	in one CMD_SARK_MEAS_RX_EFF request when half float precision is enough;
+  *	the rest are measured with CMD_SARK_MEAS_RX. The grouping is decided
+  *	here, so running the plan only sends the requests and decodes the answers.
+  *
+  * @param  pu32Freq	frequency list
+  * @param  iPoints		number of frequencies
+  * @param  bCal		{TRUE: OSL calibrated measurement; FALSE: not calibrated}
+  * @param  u8Samples	Number of samples to average
+  * @param  bFloat		{TRUE: float precision; FALSE: half float precision}
+  * @retval
+  *			@li plan handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_PLAN *Sark_Plan_Create (const uint32 *pu32Freq, int iPoints, bool bCal, uint8 u8Samples, bool bFloat)
+{
+	T_SARK_PLAN *pPlan;
+	int iFrames, iCount;
+	int ii, jj;
+
+	if (pu32Freq == NULL || iPoints <= 0)
+		return NULL;
+
+	iFrames = 0;
+	for (ii = 0; ii < iPoints; ii += GroupPoints(pu32Freq, ii, iPoints, bFloat))
+		iFrames++;
+	pPlan = AllocPlan(iPoints, iFrames);
+	if (pPlan == NULL)
+		return NULL;
+
+	for (ii = 0, jj = 0; jj < iFrames; ii += iCount, jj++)
+	{
+		iCount = GroupPoints(pu32Freq, ii, iPoints, bFloat);
+		EncodeFrame(&pPlan->ptFrame[jj].tu8Tx[1], &pu32Freq[ii], iCount, bCal, u8Samples);
+		pPlan->pu8Count[jj] = (uint8)iCount;
+	}
+
+	return pPlan;
+}
+
+/**
+  * @brief Releases a plan
+  *
+  * @param  pPlan		plan handle
+  * @retval None
+  */
+void Sark_Plan_Destroy (T_SARK_PLAN *pPlan)
+{
+	if (pPlan == NULL)
+		return;
+	free(pPlan->pu8Count);
+	free(pPlan->ptFrame);
+	free(pPlan);
+}
+
+/**
+  * @brief Number of points of the plan
+  *
+  * @param  pPlan		plan handle
+  * @retval
+  *			@li >0: number of points
+  *			@li -3: invalid parameters
+  */
+int Sark_Plan_Points (T_SARK_PLAN *pPlan)
+{
+	if (pPlan == NULL)
+		return -3;
+	return pPlan->iPoints;
+}
+
+/**
+  * @brief Requests the timing of the runs of the plan
+  *
+  *	Every later run stamps the points in the arrays of ptTiming and fills
+  *	its phases. The points of a CMD_SARK_MEAS_RX_EFF request share its
+  *	timestamps, as do the points of a batch of requests on the network
+  *	interfaces.
+  *
+  * @param  pPlan		plan handle
+  * @param  ptTiming	caller owned timing; NULL to stop timing
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Plan_SetTiming (T_SARK_PLAN *pPlan, T_SARK_TIMING *ptTiming)
+{
+	if (pPlan == NULL)
+		return -3;
+	pPlan->ptTiming = ptTiming;
+	return 1;
+}
+
+/**
+  * @brief Attaches a cancellation token to the runs of the plan
+  *
+  *	The token is checked before every request and ends the wait for the
+  *	answer in progress. A cancelled run returns SARK_CANCELLED with the
+  *	points not measured set to NaN.
+  *
+  * @param  pPlan		plan handle
+  * @param  ptCancel	token handle; NULL to detach
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Plan_SetCancel (T_SARK_PLAN *pPlan, T_SARK_CANCEL *ptCancel)
+{
+	if (pPlan == NULL)
+		return -3;
+	pPlan->ptCancel = ptCancel;
+	return 1;
+}
+
+/**
+  * @brief Requests the progress of the runs of the plan
+  *
+  *	pfCallback is called by the thread running the plan with the points
+  *	newly measured; the points of a request are reported together. A call
+  *	waits for both u32Ms since the previous call and iPoints new points;
+  *	the points left are reported when the run ends.
+  *
+  * @param  pPlan		plan handle
+  * @param  pfCallback	callback; NULL to stop reporting
+  * @param  pvUser		given to pfCallback
+  * @param  u32Ms		minimum time between calls (ms); 0: no limit
+  * @param  iPoints		minimum points per call; 0: no limit
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Plan_SetProgress (T_SARK_PLAN *pPlan, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	if (pPlan == NULL)
+		return -3;
+	return Sark_Progress_Set(&pPlan->tProgress, pfCallback, pvUser, u32Ms, iPoints);
+}
+
+/**
+  * @brief Runs the plan measuring R and X
+  *
+  *	Nothing is allocated or encoded: the precompiled requests are sent as
+  *	they are and the answers are received into the plan. A plan is therefore
+  *	run by one thread at a time. On the network interfaces the requests are
+  *	sent SARK_EXCHANGE_MAX at a time (Sark_Exchange_N).
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pPlan		plan handle
+  * @param  pfR			return R (real Z), iPoints entries
+  * @param  pfX			return X (imag Z), iPoints entries
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  *			@li SARK_CANCELLED: cancelled or deadline passed
+  */
+int Sark_Plan_Run (int16 num, T_SARK_PLAN *pPlan, float *pfR, float *pfX)
+{
+	T_CANCEL_SCOPE tScope;
+	T_PROGRESS_RUN tProgress;
+	uint8 *pu8Rx;
+	LONGLONG llSend, llRecv;
+	LONGLONG llExchange = 0;
+	int iPoint = 0;
+	int iBatch;
+	int iCount;
+	int ii, jj, kk;
+	int rc = 1;
+
+	if (pPlan == NULL || pfR == NULL || pfX == NULL)
+		return -3;
+	Sark_Cancel_Enter(&tScope, pPlan->ptCancel);
+	Sark_Timing_Begin(pPlan->ptTiming);
+	Sark_Progress_Begin(&tProgress, &pPlan->tProgress, NULL);
+
+	iBatch = Sark_Exchange_Pipelined() ? SARK_EXCHANGE_MAX : 1;
+	for (ii = 0; rc > 0 && ii < pPlan->iFrames; ii += iCount)
+	{
+		if (Sark_Cancel_Pending())
+		{
+			rc = SARK_CANCELLED;
+			break;
+		}
+		iCount = pPlan->iFrames - ii;
+		if (iCount > iBatch)
+			iCount = iBatch;
+		llSend = Sark_Timing_Now();
+		rc = Sark_Exchange_N(num, &pPlan->ptFrame[ii], iCount);
+		llRecv = Sark_Timing_Now();
+		llExchange += llRecv - llSend;
+		if (rc < 0)
+		{
+			rc = -1;
+			break;
+		}
+		for (jj = ii; jj < ii + iCount; jj++)
+		{
+			pu8Rx = &pPlan->ptFrame[jj].tu8Rx[1];
+			if (pu8Rx[0] != ANS_SARK_OK)
+			{
+				rc = -2;
+				break;
+			}
+			Sark_Timing_Stamp(pPlan->ptTiming, iPoint, pPlan->pu8Count[jj], llSend, llRecv);
+			if (pPlan->pu8Count[jj] == 1)
+			{
+				Buf2Float(&pfR[iPoint], &pu8Rx[1]);
+				Buf2Float(&pfX[iPoint], &pu8Rx[5]);
+				Sark_Progress_Done(&tProgress, iPoint, 1);
+				iPoint++;
+				continue;
+			}
+			for (kk = 0; kk < PLAN_EFF_POINTS; kk++, iPoint++)
+			{
+				pfR[iPoint] = Half2Float((uint16)(pu8Rx[1 + 4 * kk] | (pu8Rx[2 + 4 * kk] << 8)));
+				pfX[iPoint] = Half2Float((uint16)(pu8Rx[3 + 4 * kk] | (pu8Rx[4 + 4 * kk] << 8)));
+			}
+			Sark_Progress_Done(&tProgress, iPoint - PLAN_EFF_POINTS, PLAN_EFF_POINTS);
+		}
+	}
+	Sark_Timing_End(pPlan->ptTiming, llExchange, 0);
+	if (rc < 0 && Sark_Cancel_Pending())
+	{
+		rc = SARK_CANCELLED;
+		Sark_Cancel_Unmeasured(pfR, pfX, iPoint, pPlan->iPoints);
+	}
+	Sark_Progress_Flush(&tProgress);
+	Sark_Cancel_Leave(&tScope);
+
+	return rc < 0 ? rc : 1;
+}
+
+/**
+  * @brief Saves the precompiled requests of a plan to a file
+  *
+  * @param  pPlan		plan handle
+  * @param  pszFile		file name
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: file error
+  *			@li -3: invalid parameters
+  */
+int Sark_Plan_Save (T_SARK_PLAN *pPlan, const char *pszFile)
+{
+	uint8 tu8Header[PLAN_HEADER_SIZE];
+	FILE *pFile;
+	int ii;
+	int rc = 1;
+
+	if (pPlan == NULL || pszFile == NULL)
+		return -3;
+	pFile = fopen(pszFile, "wb");
+	if (pFile == NULL)
+		return -1;
+
+	memset(tu8Header, 0, sizeof(tu8Header));
+	memcpy(tu8Header, PLAN_MAGIC, 4);
+	tu8Header[4] = (uint8)(PLAN_FILE_VER & 0xff);
+	tu8Header[5] = (uint8)(PLAN_FILE_VER >> 8);
+	Int2Buf(&tu8Header[8], (uint32)pPlan->iPoints);
+	Int2Buf(&tu8Header[12], (uint32)pPlan->iFrames);
+	if (fwrite(tu8Header, sizeof(tu8Header), 1, pFile) != 1)
+		rc = -1;
+	for (ii = 0; rc > 0 && ii < pPlan->iFrames; ii++)
+	{
+		if (fwrite(&pPlan->ptFrame[ii].tu8Tx[1], SARKCMD_TX_SIZE, 1, pFile) != 1)
+			rc = -1;
+	}
+	if (fclose(pFile) != 0)
+		rc = -1;
+
+	return rc;
+}
+
+/**
+  * @brief Loads a plan saved by Sark_Plan_Save
+  *
+  *	The requests are checked but not encoded again.
+  *
+  * @param  pszFile		file name
+  * @retval
+  *			@li plan handle
+  *			@li NULL: file error, invalid file or out of memory
+  */
+T_SARK_PLAN *Sark_Plan_Load (const char *pszFile)
+{
+	T_SARK_PLAN *pPlan;
+	FILE *pFile;
+
+	if (pszFile == NULL)
+		return NULL;
+	pFile = fopen(pszFile, "rb");
+	if (pFile == NULL)
+		return NULL;
+	pPlan = ReadPlan(pFile);
+	fclose(pFile);
+
+	return pPlan;
+}
+
+/**
+  * @brief Reads and checks a plan file
+  *
+  * @param  pFile		open file
+  * @retval
+  *			@li plan handle
+  *			@li NULL: invalid file or out of memory
+  */
+static T_SARK_PLAN *ReadPlan (FILE *pFile)
+{
+	uint8 tu8Header[PLAN_HEADER_SIZE];
+	T_SARK_PLAN *pPlan;
+	uint8 *pu8Tx;
+	uint32 u32Points, u32Frames;
+	int iPoints = 0;
+	int ii;
+
+	if (fread(tu8Header, sizeof(tu8Header), 1, pFile) != 1 ||
+		memcmp(tu8Header, PLAN_MAGIC, 4) != 0 ||
+		(tu8Header[4] | (tu8Header[5] << 8)) != PLAN_FILE_VER)
+		return NULL;
+	Buf2Int(&u32Points, &tu8Header[8]);
+	Buf2Int(&u32Frames, &tu8Header[12]);
+	if (u32Frames == 0 || u32Frames > u32Points || u32Points > 0x7fffffff)
+		return NULL;
+	pPlan = AllocPlan((int)u32Points, (int)u32Frames);
+	if (pPlan == NULL)
+		return NULL;
+
+	for (ii = 0; ii < pPlan->iFrames; ii++)
+	{
+		pu8Tx = &pPlan->ptFrame[ii].tu8Tx[1];
+		if (fread(pu8Tx, SARKCMD_TX_SIZE, 1, pFile) != 1)
+			break;
+		if (pu8Tx[0] == CMD_SARK_MEAS_RX)
+			pPlan->pu8Count[ii] = 1;
+		else if (pu8Tx[0] == CMD_SARK_MEAS_RX_EFF)
+			pPlan->pu8Count[ii] = PLAN_EFF_POINTS;
+		else
+			break;
+		iPoints += pPlan->pu8Count[ii];
+	}
+	if (ii < pPlan->iFrames || iPoints != pPlan->iPoints)
+	{
+		Sark_Plan_Destroy(pPlan);
+		return NULL;
+	}
+
+	return pPlan;
+}
+
+/**
+  * @brief Allocates a plan with zeroed requests
+  *
+  * @param  iPoints		number of points
+  * @param  iFrames		number of requests
+  * @retval
+  *			@li plan handle
+  *			@li NULL: out of memory
+  */
+static T_SARK_PLAN *AllocPlan (int iPoints, int iFrames)
+{
+	T_SARK_PLAN *pPlan;
+
+	pPlan = (T_SARK_PLAN *)calloc(1, sizeof(T_SARK_PLAN));
+	if (pPlan == NULL)
+		return NULL;
+	pPlan->ptFrame = (T_SARK_FRAME *)calloc(iFrames, sizeof(T_SARK_FRAME));
+	pPlan->pu8Count = (uint8 *)calloc(iFrames, sizeof(uint8));
+	if (pPlan->ptFrame == NULL || pPlan->pu8Count == NULL)
+	{
+		Sark_Plan_Destroy(pPlan);
+		return NULL;
+	}
+	pPlan->iPoints = iPoints;
+	pPlan->iFrames = iFrames;
+
+	return pPlan;
+}
+
+/**
+  * @brief Points measured by the request starting at a given point
+  *
+  * @param  pu32Freq	frequency list
+  * @param  iPoint		first point of the request
+  * @param  iPoints		number of frequencies
+  * @param  bFloat		{TRUE: float precision; FALSE: half float precision}
+  * @retval PLAN_EFF_POINTS or 1
+  */
+static int GroupPoints (const uint32 *pu32Freq, int iPoint, int iPoints, bool bFloat)
+{
+	uint32 u32Step;
+	int ii;
+
+	if (bFloat || iPoint + PLAN_EFF_POINTS > iPoints || pu32Freq[iPoint + 1] <= pu32Freq[iPoint])
+		return 1;
+	u32Step = pu32Freq[iPoint + 1] - pu32Freq[iPoint];
+	for (ii = 2; ii < PLAN_EFF_POINTS; ii++)
+	{
+		if (pu32Freq[iPoint + ii] - pu32Freq[iPoint + ii - 1] != u32Step)
+			return 1;
+	}
+	return PLAN_EFF_POINTS;
+}
+
+/**
+  * @brief Encodes the request measuring a group of points
+  *
+  * @param  pu8Tx		request, SARKCMD_TX_SIZE bytes already zeroed
+  * @param  pu32Freq	frequencies of the group
+  * @param  iCount		PLAN_EFF_POINTS or 1
+  * @param  bCal		{TRUE: OSL calibrated measurement; FALSE: not calibrated}
+  * @param  u8Samples	Number of samples to average
+  * @retval None
+  */
+static void EncodeFrame (uint8 *pu8Tx, const uint32 *pu32Freq, int iCount, bool bCal, uint8 u8Samples)
+{
+	pu8Tx[0] = (iCount == 1) ? CMD_SARK_MEAS_RX : CMD_SARK_MEAS_RX_EFF;
+	Int2Buf(&pu8Tx[1], pu32Freq[0]);
+	if (bCal)
+		pu8Tx[5] = PAR_SARK_CAL;
+	else
+		pu8Tx[5] = PAR_SARK_UNCAL;
+	pu8Tx[6] = u8Samples;
+	if (iCount != 1)
+		Int2Buf(&pu8Tx[7], pu32Freq[1] - pu32Freq[0]);
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    sark_plan.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Precompiled sweep plans
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_PLAN_H__
+#define __SARK_PLAN_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+#include "sark_timing.h"
+#include "sark_cancel.h"
+#include "sark_progress.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_plan T_SARK_PLAN;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_PLAN *Sark_Plan_Create (const uint32 *pu32Freq, int iPoints, bool bCal, uint8 u8Samples, bool bFloat);
+extern void Sark_Plan_Destroy (T_SARK_PLAN *pPlan);
+extern int Sark_Plan_Points (T_SARK_PLAN *pPlan);
+extern int Sark_Plan_SetTiming (T_SARK_PLAN *pPlan, T_SARK_TIMING *ptTiming);
+extern int Sark_Plan_SetCancel (T_SARK_PLAN *pPlan, T_SARK_CANCEL *ptCancel);
+extern int Sark_Plan_SetProgress (T_SARK_PLAN *pPlan, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints);
+extern int Sark_Plan_Run (int16 num, T_SARK_PLAN *pPlan, float *pfR, float *pfX);
+extern int Sark_Plan_Save (T_SARK_PLAN *pPlan, const char *pszFile);
+extern T_SARK_PLAN *Sark_Plan_Load (const char *pszFile);
+
+#endif	 /* __SARK_PLAN_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,168 @@
+/**
+  ******************************************************************************
+  * @file    sark_progress.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Throttled progress of long runs
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sark_timing.h"
+#include "sark_progress.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static void Report (T_PROGRESS_RUN *ptRun, LONGLONG llNow);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Configures the progress reported by the runs of an operation
+  *
+  *	A call is made once both limits are reached: u32Ms since the previous
+  *	call and iPoints newly completed points. The points left are reported
+  *	when the run ends, also when it fails or is cancelled.
+  *
+  * @param  ptProgress	progress of the operation
+  * @param  pfCallback	callback; NULL to stop reporting
+  * @param  pvUser		given to pfCallback
+  * @param  u32Ms		minimum time between calls (ms); 0: no limit
+  * @param  iPoints		minimum points per call; 0: no limit
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Progress_Set (T_SARK_PROGRESS *ptProgress, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	if (iPoints < 0)
+		return -3;
+	ptProgress->pfCallback = pfCallback;
+	ptProgress->pvUser = pvUser;
+	ptProgress->u32Ms = u32Ms;
+	ptProgress->iPoints = iPoints;
+	return 1;
+}
+
+/**
+  * @brief Starts reporting the progress of a run
+  *
+  * @param  ptRun		progress of the run
+  * @param  ptProgress	progress requested
+  * @param  pcsCall		serializes the calls of several threads; NULL if not needed
+  * @retval None
+  */
+void Sark_Progress_Begin (T_PROGRESS_RUN *ptRun, const T_SARK_PROGRESS *ptProgress, CRITICAL_SECTION *pcsCall)
+{
+	LARGE_INTEGER liFreq;
+
+	ptRun->ptProgress = ptProgress;
+	ptRun->pcsCall = pcsCall;
+	ptRun->iFirst = 0;
+	ptRun->iEnd = 0;
+	ptRun->llPeriod = 0;
+	if (ptProgress->pfCallback == NULL)
+		return;
+	QueryPerformanceFrequency(&liFreq);
+	ptRun->llPeriod = liFreq.QuadPart * ptProgress->u32Ms / 1000;
+	ptRun->llNext = Sark_Timing_Now() + ptRun->llPeriod;
+}
+
+/**
+  * @brief Accounts for completed points, reporting them if the limits allow
+  *
+  *	Points are expected in order. Points not following the previous ones
+  *	first report those, as a call covers a single range.
+  *
+  * @param  ptRun		progress of the run
+  * @param  iPoint		first point completed
+  * @param  iCount		number of points completed
+  * @retval None
+  */
+void Sark_Progress_Done (T_PROGRESS_RUN *ptRun, int iPoint, int iCount)
+{
+	LONGLONG llNow = 0;
+
+	if (ptRun->ptProgress->pfCallback == NULL)
+		return;
+	if (iPoint != ptRun->iEnd)
+	{
+		Sark_Progress_Flush(ptRun);
+		ptRun->iFirst = iPoint;
+	}
+	ptRun->iEnd = iPoint + iCount;
+	if (ptRun->iEnd - ptRun->iFirst < ptRun->ptProgress->iPoints)
+		return;
+	if (ptRun->llPeriod != 0)
+	{
+		llNow = Sark_Timing_Now();
+		if (llNow < ptRun->llNext)
+			return;
+	}
+	Report(ptRun, llNow);
+}
+
+/**
+  * @brief Reports the points completed and not yet reported
+  *
+  * @param  ptRun		progress of the run
+  * @retval None
+  */
+void Sark_Progress_Flush (T_PROGRESS_RUN *ptRun)
+{
+	if (ptRun->ptProgress->pfCallback == NULL || ptRun->iEnd == ptRun->iFirst)
+		return;
+	Report(ptRun, Sark_Timing_Now());
+}
+
+/**
+  * @brief Calls the callback with the pending points
+  */
+static void Report (T_PROGRESS_RUN *ptRun, LONGLONG llNow)
+{
+	const T_SARK_PROGRESS *ptProgress = ptRun->ptProgress;
+
+	if (ptRun->pcsCall != NULL)
+		EnterCriticalSection(ptRun->pcsCall);
+	ptProgress->pfCallback(ptProgress->pvUser, ptRun->iFirst, ptRun->iEnd);
+	if (ptRun->pcsCall != NULL)
+		LeaveCriticalSection(ptRun->pcsCall);
+	ptRun->iFirst = ptRun->iEnd;
+	ptRun->llNext = llNow + ptRun->llPeriod;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
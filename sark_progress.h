@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    sark_progress.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Throttled progress of long runs
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_PROGRESS_H__
+#define __SARK_PROGRESS_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Called with the points iFirst to iEnd-1, newly completed */
+typedef void (*SARK_PROGRESS) (void *pvUser, int iFirst, int iEnd);
+
+/* Progress requested for the runs of an operation */
+typedef struct
+{
+	SARK_PROGRESS pfCallback;	/* NULL: not requested */
+	void *pvUser;			/* given to pfCallback */
+	uint32 u32Ms;			/* minimum time between calls (ms); 0: no limit */
+	int iPoints;			/* minimum points per call; 0: no limit */
+} T_SARK_PROGRESS;
+
+/* Progress of one run, or of one device of a batch */
+typedef struct
+{
+	const T_SARK_PROGRESS *ptProgress;
+	CRITICAL_SECTION *pcsCall;	/* serializes the calls of several threads; may be NULL */
+	int iFirst;				/* first point not yet reported */
+	int iEnd;				/* end of the points completed */
+	LONGLONG llNext;		/* counter before which no call is made */
+	LONGLONG llPeriod;		/* u32Ms in counter ticks */
+} T_PROGRESS_RUN;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern int Sark_Progress_Set (T_SARK_PROGRESS *ptProgress, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints);
+extern void Sark_Progress_Begin (T_PROGRESS_RUN *ptRun, const T_SARK_PROGRESS *ptProgress, CRITICAL_SECTION *pcsCall);
+extern void Sark_Progress_Done (T_PROGRESS_RUN *ptRun, int iPoint, int iCount);
+extern void Sark_Progress_Flush (T_PROGRESS_RUN *ptRun);
+
+#endif	 /* __SARK_PROGRESS_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
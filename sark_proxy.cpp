@@ -0,0 +1,772 @@
+/**
+  ******************************************************************************
+  * @file    sark_proxy.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Proxy sharing the devices with local clients
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "sark_rem_client.h"
+#include "sock_cli.h"
+#include "shm_cli.h"
+#include "sark_proxy.h"
+
+#pragma comment (lib,"ws2_32.lib") 		// Winsock Library
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Request of a client */
+typedef struct proxy_req
+{
+	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	uint8 tu8Rx[BULK_MAX_FRAMES * SARKCMD_RX_SIZE];	/* answer frames */
+	int iAnswers;			/* answer frames expected */
+	HANDLE hDone;			/* signaled when the answer is in tu8Rx */
+	struct proxy_req *ptNext;
+	struct proxy_req *ptSame;	/* identical requests answered by the same exchange */
+} T_PROXY_REQ;
+
+/* Device served to the clients */
+typedef struct
+{
+	int16 num;				/* device number */
+	SOCKET hListen;
+	HANDLE hThread;
+	HANDLE hWork;			/* signaled when a request is queued */
+	CRITICAL_SECTION csLock;
+	T_PROXY_REQ *ptHead;	/* queued requests, oldest first */
+	T_PROXY_REQ *ptTail;
+	volatile LONG lServed;	/* requests answered since started */
+	volatile LONG lCoalesced;	/* requests answered by the exchange of another client */
+	volatile LONG lClients;	/* clients connected */
+	volatile LONG lStop;	/* the clients are gone; the thread ends */
+	T_SHM_SERVER *pShm;		/* shared memory served to one client, if any */
+	HANDLE hShmThread;
+	T_PROXY_REQ tShmReq;	/* request of the shared memory client */
+	volatile LONG lShmStop;	/* the shared memory thread ends */
+} T_PROXY_DEV;
+
+/* Connected client */
+typedef struct proxy_client
+{
+	T_PROXY_DEV *ptDev;
+	SOCKET hSock;
+	HANDLE hThread;
+	volatile LONG lDone;	/* the thread has finished */
+	T_PROXY_REQ tReq;
+	struct proxy_client *ptNext;
+} T_PROXY_CLIENT;
+
+struct sark_proxy
+{
+	int iDevs;				/* devices initialized */
+	T_PROXY_DEV tDev[SARK_MAX_DEVICES];
+	HANDLE hStop;
+	HANDLE hAccept;
+	T_PROXY_CLIENT *ptClients;	/* handled by the accept thread, then by Sark_Proxy_Stop */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define PROXY_TICK			100		/* in ms; the stop request is checked this often */
+#define PROXY_BACKLOG		16		/* pending connections per device */
+#define PROXY_SHM_NAME		200		/* shared memory name, device number included */
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static DWORD WINAPI AcceptThread (LPVOID lpParam);
+static void AddClient (T_SARK_PROXY *pProxy, T_PROXY_DEV *ptDev, SOCKET hSock);
+static void ReapClients (T_SARK_PROXY *pProxy, bool bAll);
+static DWORD WINAPI ClientThread (LPVOID lpParam);
+static DWORD WINAPI ShmThread (LPVOID lpParam);
+static void StopShm (T_SARK_PROXY *pProxy);
+static DWORD WINAPI DevThread (LPVOID lpParam);
+static int Answer (T_PROXY_DEV *ptDev, T_PROXY_REQ *ptReq);
+static void Queue (T_PROXY_DEV *ptDev, T_PROXY_REQ *ptReq);
+static void TakeSame (T_PROXY_DEV *ptDev, T_PROXY_REQ *ptReq);
+static void Serve (T_PROXY_DEV *ptDev, T_PROXY_REQ *ptReq);
+static int AnswerFrames (const uint8 *pu8Tx);
+static bool IsCoalescable (uint8 u8Cmd);
+static int RecvAll (SOCKET hSock, uint8 *pu8Buf, int iLen);
+static int SendAll (SOCKET hSock, const uint8 *pu8Buf, int iLen);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Starts serving the connected devices to local clients
+  *
+  *	Device n is served on TCP port u16Port + n of the loopback address, with
+  *	the frames of the socket interface, so the clients use Sark_Connect with
+  *	ITFZ_SOCK and "127.0.0.1:port". Tagged frames are not served.
+  *
+  *	Every device has a queue of requests served in arrival order. A client
+  *	waits for the answer before its next request is read, so clients are
+  *	served in turn whatever their request rate. Identical measurements of
+  *	several clients queued while the device is busy are answered by a
+  *	single exchange with the device.
+  *
+  *	The devices shall be connected with Sark_Connect before starting.
+  *
+  * @param  u16Port		port of device 0
+  * @param  iDevs		number of devices, from device 0
+  * @retval
+  *			@li proxy handle
+  *			@li NULL: invalid parameters, port in use or out of resources
+  */
+T_SARK_PROXY *Sark_Proxy_Start (uint16 u16Port, int iDevs)
+{
+	T_SARK_PROXY *pProxy;
+	T_PROXY_DEV *ptDev;
+	WSADATA wsa;
+	int ii;
+
+	if (u16Port == 0 || iDevs <= 0 || iDevs > SARK_MAX_DEVICES || u16Port + iDevs > 0x10000)
+		return NULL;
+	if (WSAStartup(MAKEWORD(2,2),&wsa) != 0)
+		return NULL;
+	pProxy = (T_SARK_PROXY *)calloc(1, sizeof(T_SARK_PROXY));
+	if (pProxy == NULL)
+	{
+		WSACleanup();
+		return NULL;
+	}
+	pProxy->hStop = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (pProxy->hStop == NULL)
+	{
+		Sark_Proxy_Stop(pProxy);
+		return NULL;
+	}
+	for (ii = 0; ii < iDevs; ii++)
+	{
+		ptDev = &pProxy->tDev[ii];
+		ptDev->num = (int16)ii;
+		InitializeCriticalSection(&ptDev->csLock);
+		pProxy->iDevs = ii + 1;
+		ptDev->hListen = Sock_Listen((uint16)(u16Port + ii), PROXY_BACKLOG);
+		ptDev->hWork = CreateEvent(NULL, FALSE, FALSE, NULL);
+		if (ptDev->hListen == INVALID_SOCKET || ptDev->hWork == NULL)
+		{
+			Sark_Proxy_Stop(pProxy);
+			return NULL;
+		}
+		ptDev->hThread = CreateThread(NULL, 0, DevThread, ptDev, 0, NULL);
+		if (ptDev->hThread == NULL)
+		{
+			Sark_Proxy_Stop(pProxy);
+			return NULL;
+		}
+	}
+	pProxy->hAccept = CreateThread(NULL, 0, AcceptThread, pProxy, 0, NULL);
+	if (pProxy->hAccept == NULL)
+	{
+		Sark_Proxy_Stop(pProxy);
+		return NULL;
+	}
+
+	return pProxy;
+}
+
+/**
+  * @brief Disconnects the clients and stops serving the devices
+  *
+  *	Waits for the exchanges in progress to complete.
+  *
+  * @param  pProxy		proxy handle
+  * @retval None
+  */
+void Sark_Proxy_Stop (T_SARK_PROXY *pProxy)
+{
+	T_PROXY_DEV *ptDev;
+	int ii;
+
+	if (pProxy == NULL)
+		return;
+	if (pProxy->hStop != NULL)
+		SetEvent(pProxy->hStop);
+	if (pProxy->hAccept != NULL)
+	{
+		WaitForSingleObject(pProxy->hAccept, INFINITE);
+		CloseHandle(pProxy->hAccept);
+	}
+	/* The clients waiting for an answer are served before the devices stop */
+	StopShm(pProxy);
+	ReapClients(pProxy, TRUE);
+	for (ii = 0; ii < pProxy->iDevs; ii++)
+	{
+		ptDev = &pProxy->tDev[ii];
+		if (ptDev->hThread != NULL)
+		{
+			InterlockedExchange(&ptDev->lStop, 1);
+			SetEvent(ptDev->hWork);
+			WaitForSingleObject(ptDev->hThread, INFINITE);
+			CloseHandle(ptDev->hThread);
+		}
+		if (ptDev->hWork != NULL)
+			CloseHandle(ptDev->hWork);
+		if (ptDev->hListen != INVALID_SOCKET)
+			closesocket(ptDev->hListen);
+		DeleteCriticalSection(&ptDev->csLock);
+	}
+	if (pProxy->hStop != NULL)
+		CloseHandle(pProxy->hStop);
+	free(pProxy);
+	WSACleanup();
+}
+
+/**
+  * @brief Gets the counters of a device served by the proxy
+  *
+  * @param  pProxy			proxy handle
+  * @param  num				device number
+  * @param  pu32Served		return requests answered since started
+  * @param  pu32Coalesced	return requests answered by the exchange of another client
+  * @param  pu32Clients		return clients connected
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters or device not served
+  */
+int Sark_Proxy_Stats (T_SARK_PROXY *pProxy, int16 num, uint32 *pu32Served, uint32 *pu32Coalesced,
+	uint32 *pu32Clients)
+{
+	T_PROXY_DEV *ptDev;
+
+	if (pProxy == NULL || num < 0 || num >= pProxy->iDevs)
+		return -3;
+	ptDev = &pProxy->tDev[num];
+	if (pu32Served != NULL)
+		*pu32Served = (uint32)ptDev->lServed;
+	if (pu32Coalesced != NULL)
+		*pu32Coalesced = (uint32)ptDev->lCoalesced;
+	if (pu32Clients != NULL)
+		*pu32Clients = (uint32)ptDev->lClients;
+
+	return 1;
+}
+
+/**
+  * @brief Also serves the devices on shared memory
+  *
+  *	Device n is served on the shared memory named pszName followed by n
+  *	("sark" serves device 0 on "sark0"), so a client on the same host uses
+  *	Sark_Connect with ITFZ_SHM and that name. Each area takes one client at
+  *	a time, whose requests are queued with those of the socket clients.
+  *	Shared memory clients are not counted by Sark_Proxy_Stats.
+  *
+  * @param  pProxy		proxy handle
+  * @param  pszName		shared memory name prefix
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: name in use or out of resources
+  *			@li -3: invalid parameters or already served on shared memory
+  */
+int Sark_Proxy_Shm (T_SARK_PROXY *pProxy, const char *pszName)
+{
+	char szName[PROXY_SHM_NAME];
+	T_PROXY_DEV *ptDev;
+	int ii;
+
+	if (pProxy == NULL || pszName == NULL || strlen(pszName) > PROXY_SHM_NAME - 4
+		|| pProxy->tDev[0].pShm != NULL)
+		return -3;
+	for (ii = 0; ii < pProxy->iDevs; ii++)
+	{
+		ptDev = &pProxy->tDev[ii];
+		InterlockedExchange(&ptDev->lShmStop, 0);
+		sprintf(szName, "%s%d", pszName, ii);
+		ptDev->pShm = Shm_Server_Create(szName);
+		ptDev->tShmReq.hDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+		if (ptDev->pShm != NULL && ptDev->tShmReq.hDone != NULL)
+			ptDev->hShmThread = CreateThread(NULL, 0, ShmThread, ptDev, 0, NULL);
+		if (ptDev->hShmThread == NULL)
+		{
+			StopShm(pProxy);
+			return -1;
+		}
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Accepts the clients of all the devices
+  */
+static DWORD WINAPI AcceptThread (LPVOID lpParam)
+{
+	T_SARK_PROXY *pProxy = (T_SARK_PROXY *)lpParam;
+	T_PROXY_DEV *ptDev;
+	struct timeval tTimeout;
+	fd_set tRead;
+	SOCKET hSock;
+	SOCKET hMax;
+	int ii;
+
+	while (WaitForSingleObject(pProxy->hStop, 0) == WAIT_TIMEOUT)
+	{
+		ReapClients(pProxy, FALSE);
+		FD_ZERO(&tRead);
+		hMax = 0;
+		for (ii = 0; ii < pProxy->iDevs; ii++)
+		{
+			FD_SET(pProxy->tDev[ii].hListen, &tRead);
+			if (pProxy->tDev[ii].hListen > hMax)
+				hMax = pProxy->tDev[ii].hListen;
+		}
+		tTimeout.tv_sec = 0;
+		tTimeout.tv_usec = PROXY_TICK * 1000;
+		if (select((int)hMax + 1, &tRead, NULL, NULL, &tTimeout) <= 0)
+			continue;
+		for (ii = 0; ii < pProxy->iDevs; ii++)
+		{
+			ptDev = &pProxy->tDev[ii];
+			if (!FD_ISSET(ptDev->hListen, &tRead))
+				continue;
+			hSock = accept(ptDev->hListen, NULL, NULL);
+			if (hSock != INVALID_SOCKET)
+				AddClient(pProxy, ptDev, hSock);
+		}
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Starts serving an accepted client
+  */
+static void AddClient (T_SARK_PROXY *pProxy, T_PROXY_DEV *ptDev, SOCKET hSock)
+{
+	T_PROXY_CLIENT *ptClient;
+	int iNoDelay = 1;
+
+	ptClient = (T_PROXY_CLIENT *)calloc(1, sizeof(T_PROXY_CLIENT));
+	if (ptClient == NULL)
+	{
+		closesocket(hSock);
+		return;
+	}
+	/* Answers are single frames, sent as soon as they are ready */
+	setsockopt(hSock, IPPROTO_TCP, TCP_NODELAY, (const char *)&iNoDelay, sizeof(iNoDelay));
+	ptClient->ptDev = ptDev;
+	ptClient->hSock = hSock;
+	ptClient->tReq.hDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (ptClient->tReq.hDone != NULL)
+	{
+		InterlockedIncrement(&ptDev->lClients);
+		ptClient->hThread = CreateThread(NULL, 0, ClientThread, ptClient, 0, NULL);
+	}
+	if (ptClient->hThread == NULL)
+	{
+		if (ptClient->tReq.hDone != NULL)
+		{
+			InterlockedDecrement(&ptDev->lClients);
+			CloseHandle(ptClient->tReq.hDone);
+		}
+		closesocket(hSock);
+		free(ptClient);
+		return;
+	}
+	ptClient->ptNext = pProxy->ptClients;
+	pProxy->ptClients = ptClient;
+}
+
+/**
+  * @brief Releases the clients that disconnected
+  *
+  * @param  pProxy		proxy handle
+  * @param  bAll		disconnect and release all the clients
+  */
+static void ReapClients (T_SARK_PROXY *pProxy, bool bAll)
+{
+	T_PROXY_CLIENT **pptClient = &pProxy->ptClients;
+	T_PROXY_CLIENT *ptClient;
+
+	while (*pptClient != NULL)
+	{
+		ptClient = *pptClient;
+		if (bAll)
+			shutdown(ptClient->hSock, SD_BOTH);
+		else if (!ptClient->lDone)
+		{
+			pptClient = &ptClient->ptNext;
+			continue;
+		}
+		WaitForSingleObject(ptClient->hThread, INFINITE);
+		*pptClient = ptClient->ptNext;
+		CloseHandle(ptClient->hThread);
+		CloseHandle(ptClient->tReq.hDone);
+		closesocket(ptClient->hSock);
+		free(ptClient);
+	}
+}
+
+/**
+  * @brief Reads the requests of a client and sends their answers
+  */
+static DWORD WINAPI ClientThread (LPVOID lpParam)
+{
+	T_PROXY_CLIENT *ptClient = (T_PROXY_CLIENT *)lpParam;
+	T_PROXY_REQ *ptReq = &ptClient->tReq;
+	int iFrames;
+
+	while (RecvAll(ptClient->hSock, ptReq->tu8Tx, SARKCMD_TX_SIZE) > 0)
+	{
+		if (ptReq->tu8Tx[0] == 0xff)
+		{
+			/* Disconnection; the client closes the socket after the answer,
+			   which leaves the TIME_WAIT state to the client side */
+			memset(ptReq->tu8Rx, 0, SARKCMD_RX_SIZE);
+			ptReq->tu8Rx[0] = ANS_SARK_OK;
+			iFrames = 1;
+		}
+		else
+			iFrames = Answer(ptClient->ptDev, ptReq);
+		if (SendAll(ptClient->hSock, ptReq->tu8Rx, iFrames * SARKCMD_RX_SIZE) < 0)
+			break;
+	}
+	shutdown(ptClient->hSock, SD_BOTH);
+	InterlockedDecrement(&ptClient->ptDev->lClients);
+	InterlockedExchange(&ptClient->lDone, 1);
+
+	return 0;
+}
+
+/**
+  * @brief Reads the requests of the shared memory client and queues their answers
+  */
+static DWORD WINAPI ShmThread (LPVOID lpParam)
+{
+	T_PROXY_DEV *ptDev = (T_PROXY_DEV *)lpParam;
+	T_PROXY_REQ *ptReq = &ptDev->tShmReq;
+	uint32 u32Seq;
+	int iFrames;
+	int ii;
+
+	while (ptDev->lShmStop == 0)
+	{
+		if (Shm_Server_Recv(ptDev->pShm, ptReq->tu8Tx, &u32Seq, PROXY_TICK) <= 0)
+			continue;
+		/* The client detached; no answer is awaited */
+		if (ptReq->tu8Tx[0] == 0xff)
+			continue;
+		iFrames = Answer(ptDev, ptReq);
+		for (ii = 0; ii < iFrames; ii++)
+		{
+			if (Shm_Server_Send(ptDev->pShm, u32Seq, &ptReq->tu8Rx[ii * SARKCMD_RX_SIZE]) < 0)
+				break;
+		}
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Stops serving the devices on shared memory
+  *
+  *	The requests being answered are served first.
+  */
+static void StopShm (T_SARK_PROXY *pProxy)
+{
+	T_PROXY_DEV *ptDev;
+	int ii;
+
+	for (ii = 0; ii < pProxy->iDevs; ii++)
+		InterlockedExchange(&pProxy->tDev[ii].lShmStop, 1);
+	for (ii = 0; ii < pProxy->iDevs; ii++)
+	{
+		ptDev = &pProxy->tDev[ii];
+		if (ptDev->hShmThread != NULL)
+		{
+			WaitForSingleObject(ptDev->hShmThread, INFINITE);
+			CloseHandle(ptDev->hShmThread);
+			ptDev->hShmThread = NULL;
+		}
+		if (ptDev->tShmReq.hDone != NULL)
+		{
+			CloseHandle(ptDev->tShmReq.hDone);
+			ptDev->tShmReq.hDone = NULL;
+		}
+		Shm_Server_Destroy(ptDev->pShm);
+		ptDev->pShm = NULL;
+	}
+}
+
+/**
+  * @brief Exchanges the queued requests with the device
+  */
+static DWORD WINAPI DevThread (LPVOID lpParam)
+{
+	T_PROXY_DEV *ptDev = (T_PROXY_DEV *)lpParam;
+	T_PROXY_REQ *ptReq;
+
+	for (;;)
+	{
+		EnterCriticalSection(&ptDev->csLock);
+		ptReq = ptDev->ptHead;
+		if (ptReq != NULL)
+		{
+			ptDev->ptHead = ptReq->ptNext;
+			if (ptDev->ptHead == NULL)
+				ptDev->ptTail = NULL;
+			if (IsCoalescable(ptReq->tu8Tx[0]))
+				TakeSame(ptDev, ptReq);
+		}
+		LeaveCriticalSection(&ptDev->csLock);
+		if (ptReq != NULL)
+		{
+			Serve(ptDev, ptReq);
+			continue;
+		}
+		if (ptDev->lStop)
+			break;
+		WaitForSingleObject(ptDev->hWork, INFINITE);
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Gets the answer to a request of a client
+  *
+  * @retval	answer frames in tu8Rx; a single frame if not ANS_SARK_OK
+  */
+static int Answer (T_PROXY_DEV *ptDev, T_PROXY_REQ *ptReq)
+{
+	ptReq->iAnswers = AnswerFrames(ptReq->tu8Tx);
+	if (ptReq->iAnswers == 0)
+	{
+		/* Not sent to the device, which would answer an error */
+		memset(ptReq->tu8Rx, 0, SARKCMD_RX_SIZE);
+		ptReq->tu8Rx[0] = ANS_SARK_ERR;
+	}
+	else
+	{
+		Queue(ptDev, ptReq);
+		WaitForSingleObject(ptReq->hDone, INFINITE);
+	}
+	if (ptReq->tu8Rx[0] != ANS_SARK_OK)
+		return 1;
+
+	return ptReq->iAnswers;
+}
+
+/**
+  * @brief Queues a request to the device
+  */
+static void Queue (T_PROXY_DEV *ptDev, T_PROXY_REQ *ptReq)
+{
+	ptReq->ptNext = NULL;
+	ptReq->ptSame = NULL;
+	EnterCriticalSection(&ptDev->csLock);
+	if (ptDev->ptTail != NULL)
+		ptDev->ptTail->ptNext = ptReq;
+	else
+		ptDev->ptHead = ptReq;
+	ptDev->ptTail = ptReq;
+	LeaveCriticalSection(&ptDev->csLock);
+	SetEvent(ptDev->hWork);
+}
+
+/**
+  * @brief Moves the queued copies of a request to its ptSame list
+  *
+  *	Called with the queue locked.
+  */
+static void TakeSame (T_PROXY_DEV *ptDev, T_PROXY_REQ *ptReq)
+{
+	T_PROXY_REQ **pptReq = &ptDev->ptHead;
+	T_PROXY_REQ *ptOther;
+	T_PROXY_REQ *ptLast = NULL;
+
+	while (*pptReq != NULL)
+	{
+		ptOther = *pptReq;
+		if (memcmp(ptOther->tu8Tx, ptReq->tu8Tx, SARKCMD_TX_SIZE) == 0)
+		{
+			*pptReq = ptOther->ptNext;
+			ptOther->ptSame = ptReq->ptSame;
+			ptReq->ptSame = ptOther;
+			continue;
+		}
+		ptLast = ptOther;
+		pptReq = &ptOther->ptNext;
+	}
+	ptDev->ptTail = ptLast;
+}
+
+/**
+  * @brief Exchanges a request with the device and answers its clients
+  */
+static void Serve (T_PROXY_DEV *ptDev, T_PROXY_REQ *ptReq)
+{
+	T_SARK_FRAME tFrame;
+	T_PROXY_REQ *ptSame;
+	T_PROXY_REQ *ptNext;
+	int iLen;
+	int rc;
+
+	memcpy(&tFrame.tu8Tx[1], ptReq->tu8Tx, SARKCMD_TX_SIZE);
+	if (ptReq->tu8Tx[0] == CMD_SARK_MEAS_RX_BULK)
+		rc = Sark_Exchange_Bulk(ptDev->num, &tFrame, ptReq->tu8Rx, ptReq->iAnswers);
+	else
+	{
+		rc = Sark_Exchange(ptDev->num, &tFrame);
+		memcpy(ptReq->tu8Rx, &tFrame.tu8Rx[1], SARKCMD_RX_SIZE);
+	}
+	if (rc < 0)
+	{
+		/* The clients see an unreachable device as a device error */
+		memset(ptReq->tu8Rx, 0, SARKCMD_RX_SIZE);
+		ptReq->tu8Rx[0] = ANS_SARK_ERR;
+	}
+	if (ptReq->tu8Rx[0] == ANS_SARK_OK)
+		iLen = ptReq->iAnswers * SARKCMD_RX_SIZE;
+	else
+		iLen = SARKCMD_RX_SIZE;
+
+	/* A client may queue its next request as soon as it is signaled */
+	for (ptSame = ptReq->ptSame; ptSame != NULL; ptSame = ptNext)
+	{
+		ptNext = ptSame->ptSame;
+		memcpy(ptSame->tu8Rx, ptReq->tu8Rx, iLen);
+		InterlockedIncrement(&ptDev->lCoalesced);
+		InterlockedIncrement(&ptDev->lServed);
+		SetEvent(ptSame->hDone);
+	}
+	InterlockedIncrement(&ptDev->lServed);
+	SetEvent(ptReq->hDone);
+}
+
+/**
+  * @brief Number of answer frames of a request
+  *
+  * @retval
+  *			@li answer frames
+  *			@li 0: invalid CMD_SARK_MEAS_RX_BULK request
+  */
+static int AnswerFrames (const uint8 *pu8Tx)
+{
+	int iPoints, iPer, iFrames;
+
+	if (pu8Tx[0] != CMD_SARK_MEAS_RX_BULK)
+		return 1;
+	if (pu8Tx[13] == BULK_FMT_FLOAT)
+		iPer = BULK_PER_FLOAT;
+	else if (pu8Tx[13] == BULK_FMT_HALF)
+		iPer = BULK_PER_HALF;
+	else
+		return 0;
+	iPoints = pu8Tx[11] | (pu8Tx[12] << 8);
+	iFrames = (iPoints + iPer - 1) / iPer;
+	if (iFrames < 1 || iFrames > BULK_MAX_FRAMES)
+		return 0;
+
+	return iFrames;
+}
+
+/**
+  * @brief Commands that only read, so one exchange can answer several clients
+  */
+static bool IsCoalescable (uint8 u8Cmd)
+{
+	switch (u8Cmd)
+	{
+	case CMD_SARK_VERSION:
+	case CMD_SARK_MEAS_RX:
+	case CMD_SARK_MEAS_VECTOR:
+	case CMD_SARK_MEAS_RF:
+	case CMD_SARK_MEAS_VEC_THRU:
+	case CMD_BATT_STAT:
+	case CMD_DISK_INFO:
+	case CMD_DISK_VOLUME:
+	case CMD_GET_SETTING:
+	case CMD_SARK_MEAS_RX_EFF:
+	case CMD_SARK_MEAS_RX_BULK:
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+/**
+  * @brief Receives a number of bytes
+  *
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error or connection closed
+  */
+static int RecvAll (SOCKET hSock, uint8 *pu8Buf, int iLen)
+{
+	int iResult;
+
+	while (iLen > 0)
+	{
+		iResult = recv(hSock, (char *)pu8Buf, iLen, 0);
+		if (iResult == SOCKET_ERROR || iResult == 0)
+			return -1;
+		pu8Buf += iResult;
+		iLen -= iResult;
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Sends a number of bytes
+  *
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  */
+static int SendAll (SOCKET hSock, const uint8 *pu8Buf, int iLen)
+{
+	int iResult;
+
+	while (iLen > 0)
+	{
+		iResult = send(hSock, (const char *)pu8Buf, iLen, 0);
+		if (iResult == SOCKET_ERROR)
+			return -1;
+		pu8Buf += iResult;
+		iLen -= iResult;
+	}
+
+	return 1;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
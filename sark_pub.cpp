@@ -0,0 +1,587 @@
+/**
+  ******************************************************************************
+  * @file    sark_pub.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Publication of completed sweeps to local subscribers
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <stdlib.h>
+#include "sark_rem_client.h"
+#include "sock_cli.h"
+#include "sark_pub.h"
+
+#pragma comment (lib,"ws2_32.lib") 		// Winsock Library
+
+/* Private define ------------------------------------------------------------*/
+#define PUB_MAX_SUBS		16		/* subscribers served at once */
+#define PUB_BACKLOG			4		/* pending connections */
+#define PUB_TICK			10		/* in ms; posted sweeps are taken this often */
+#define PUB_STALL			2000	/* in ms; subscribers not reading for this long are dropped */
+#define PUB_SNDBUF_SWEEPS	4		/* sweeps buffered by the socket of a subscriber */
+#define PUB_FRESH			0x10	/* lReady: buffer not yet taken by the publisher */
+#define PUB_INDEX			0x0f	/* lReady: buffer index */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Sweep posted by the measurement thread */
+typedef struct
+{
+	uint32 u32Seq;
+	float *pfR;
+	float *pfX;
+} T_PUB_BUF;
+
+/* Connected subscriber */
+typedef struct
+{
+	SOCKET hSock;
+	uint8 *pu8Msg;			/* message being sent */
+	int iLen;				/* bytes in pu8Msg */
+	int iSent;				/* bytes of pu8Msg already sent */
+	bool bPending;			/* a newer sweep waits for the message to be sent */
+	bool bClosed;			/* connection closed or failed */
+	DWORD dwProgress;		/* tick count of the last bytes sent */
+} T_PUB_SUB;
+
+struct sark_pub
+{
+	int iPoints;
+	uint8 u8Format;			/* PUB_FMT_FLOAT, PUB_FMT_HALF */
+	SOCKET hListen;
+	HANDLE hStop;
+	HANDLE hThread;
+	/* Triple buffer: Sark_Pub_Post fills tBuf[iBack] and swaps it with the
+	   newest one; the publisher thread swaps the newest with tBuf[iFront] */
+	T_PUB_BUF tBuf[3];
+	float *pfData;			/* storage of all buffers */
+	volatile LONG lReady;	/* newest buffer, with PUB_FRESH until taken */
+	int iBack;				/* only used by Sark_Pub_Post */
+	int iFront;				/* only used by the publisher thread */
+	/* Publisher thread */
+	uint8 *pu8Plan;			/* plan message */
+	int iPlanLen;
+	uint8 *pu8Sweep;		/* newest sweep message */
+	int iSweepLen;
+	bool bPublished;		/* pu8Sweep holds a sweep */
+	T_PUB_SUB tSub[PUB_MAX_SUBS];
+	int iSubs;
+	/* Statistics */
+	volatile LONG lSubs;	/* subscribers connected */
+	volatile LONG lSent;	/* sweeps sent entirely to a subscriber */
+	volatile LONG lSkipped;	/* sweeps a subscriber did not receive, summed over the subscribers */
+	volatile LONG lDropped;	/* subscribers disconnected for not reading */
+};
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static DWORD WINAPI PubThread (LPVOID lpParam);
+static void AddSub (T_SARK_PUB *pPub);
+static void RemoveSubs (T_SARK_PUB *pPub);
+static void Publish (T_SARK_PUB *pPub);
+static void SendSome (T_SARK_PUB *pPub, T_PUB_SUB *ptSub);
+static void LoadSweep (T_SARK_PUB *pPub, T_PUB_SUB *ptSub);
+static void EncodePlan (T_SARK_PUB *pPub, uint16 u16Ver, const uint8 *pu8FW, int16 num, const uint32 *pu32Freq);
+static void EncodeSweep (T_SARK_PUB *pPub, T_PUB_BUF *ptBuf);
+static void PutPrefix (uint8 *pu8Buf, uint8 u8Type, uint8 u8Format, int iLen);
+static void FreePub (T_SARK_PUB *pPub);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Starts publishing the results of a sweep to local subscribers
+  *
+  *	Subscribers connect to TCP port u16Port of the loopback address and
+  *	receive a PUB_MSG_PLAN message with the frequencies of the sweep and the
+  *	version of the device, then a PUB_MSG_SWEEP message per posted sweep.
+  *
+  *	Posting never waits for the subscribers. A subscriber still receiving a
+  *	sweep when newer ones are posted gets only the newest one next, and a
+  *	subscriber that reads nothing for PUB_STALL ms is disconnected.
+  *
+  * @param  u16Port		port of the subscribers
+  * @param  num			device number, whose version is published
+  * @param  pSweep		sweep whose results are posted
+  * @param  u8Format	PUB_FMT_FLOAT or PUB_FMT_HALF
+  * @retval
+  *			@li publisher handle
+  *			@li NULL: invalid parameters, device not answering, port in use or out of resources
+  */
+T_SARK_PUB *Sark_Pub_Start (uint16 u16Port, int16 num, T_SARK_SWEEP *pSweep, uint8 u8Format)
+{
+	T_SARK_PUB *pPub;
+	uint32 *pu32Freq;
+	uint16 u16Ver;
+	uint8 tu8FW[PUB_FW_SIZE];
+	WSADATA wsa;
+	int iPoints;
+	int ii;
+
+	iPoints = Sark_Sweep_Points(pSweep);
+	if (u16Port == 0 || iPoints <= 0 || u8Format > PUB_FMT_HALF)
+		return NULL;
+	memset(tu8FW, 0, sizeof(tu8FW));
+	if (Sark_Version(num, &u16Ver, tu8FW) != 1)
+		return NULL;
+	if (WSAStartup(MAKEWORD(2,2),&wsa) != 0)
+		return NULL;
+	pPub = (T_SARK_PUB *)calloc(1, sizeof(T_SARK_PUB));
+	if (pPub == NULL)
+	{
+		WSACleanup();
+		return NULL;
+	}
+	pPub->hListen = INVALID_SOCKET;
+	pPub->iPoints = iPoints;
+	pPub->u8Format = u8Format;
+	pPub->iPlanLen = PUB_PREFIX_SIZE + 2 + PUB_FW_SIZE + 2 + 4 + 4 * iPoints;
+	pPub->iSweepLen = PUB_PREFIX_SIZE + 4 + 4 + 2 * iPoints * (u8Format == PUB_FMT_HALF ? 2 : 4);
+	pPub->pfData = (float *)malloc(3 * 2 * iPoints * sizeof(float));
+	pPub->pu8Plan = (uint8 *)malloc(pPub->iPlanLen);
+	pPub->pu8Sweep = (uint8 *)malloc(pPub->iSweepLen);
+	pPub->hStop = CreateEvent(NULL, TRUE, FALSE, NULL);
+	pu32Freq = (uint32 *)malloc(iPoints * sizeof(uint32));
+	if (pPub->pfData == NULL || pPub->pu8Plan == NULL || pPub->pu8Sweep == NULL || pPub->hStop == NULL
+		|| pu32Freq == NULL)
+	{
+		free(pu32Freq);
+		FreePub(pPub);
+		return NULL;
+	}
+	for (ii = 0; ii < 3; ii++)
+	{
+		pPub->tBuf[ii].pfR = &pPub->pfData[(2 * ii) * iPoints];
+		pPub->tBuf[ii].pfX = &pPub->pfData[(2 * ii + 1) * iPoints];
+	}
+	pPub->iBack = 0;
+	pPub->lReady = 1;
+	pPub->iFront = 2;
+	Sark_Sweep_GetFreq(pSweep, pu32Freq);
+	EncodePlan(pPub, u16Ver, tu8FW, num, pu32Freq);
+	free(pu32Freq);
+
+	pPub->hListen = Sock_Listen(u16Port, PUB_BACKLOG);
+	if (pPub->hListen == INVALID_SOCKET)
+	{
+		FreePub(pPub);
+		return NULL;
+	}
+	pPub->hThread = CreateThread(NULL, 0, PubThread, pPub, 0, NULL);
+	if (pPub->hThread == NULL)
+	{
+		FreePub(pPub);
+		return NULL;
+	}
+
+	return pPub;
+}
+
+/**
+  * @brief Disconnects the subscribers and releases the publisher
+  *
+  * @param  pPub		publisher handle
+  * @retval None
+  */
+void Sark_Pub_Stop (T_SARK_PUB *pPub)
+{
+	if (pPub == NULL)
+		return;
+	SetEvent(pPub->hStop);
+	WaitForSingleObject(pPub->hThread, INFINITE);
+	FreePub(pPub);
+}
+
+/**
+  * @brief Gets the number of points of the sweeps posted to the publisher
+  *
+  * @param  pPub		publisher handle
+  * @retval
+  *			@li number of points
+  *			@li -3: invalid parameters
+  */
+int Sark_Pub_Points (T_SARK_PUB *pPub)
+{
+	if (pPub == NULL)
+		return -3;
+	return pPub->iPoints;
+}
+
+/**
+  * @brief Posts the results of a sweep to the subscribers
+  *
+  *	Copies the results and returns without waiting for the subscribers, so
+  *	it can be called from the measurement thread. Only one thread at a time
+  *	may post to a publisher.
+  *
+  * @param  pPub		publisher handle
+  * @param  u32Seq		sequence number of the sweep
+  * @param  pfR			R (real Z), one per point
+  * @param  pfX			X (imag Z), one per point
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Pub_Post (T_SARK_PUB *pPub, uint32 u32Seq, const float *pfR, const float *pfX)
+{
+	T_PUB_BUF *ptBuf;
+	LONG lOld;
+
+	if (pPub == NULL || pfR == NULL || pfX == NULL)
+		return -3;
+	ptBuf = &pPub->tBuf[pPub->iBack];
+	ptBuf->u32Seq = u32Seq;
+	memcpy(ptBuf->pfR, pfR, pPub->iPoints * sizeof(float));
+	memcpy(ptBuf->pfX, pfX, pPub->iPoints * sizeof(float));
+	lOld = InterlockedExchange(&pPub->lReady, pPub->iBack | PUB_FRESH);
+	if (lOld & PUB_FRESH)
+	{
+		/* Replaced before the publisher took it */
+		InterlockedExchangeAdd(&pPub->lSkipped, pPub->lSubs);
+	}
+	pPub->iBack = lOld & PUB_INDEX;
+
+	return 1;
+}
+
+/**
+  * @brief Publisher statistics
+  *
+  * @param  pPub			publisher handle
+  * @param  pu32Subs		return subscribers connected
+  * @param  pu32Sent		return sweeps sent entirely to a subscriber
+  * @param  pu32Skipped		return sweeps a subscriber did not receive, added for all subscribers
+  * @param  pu32Dropped		return subscribers disconnected for not reading
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Pub_Stats (T_SARK_PUB *pPub, uint32 *pu32Subs, uint32 *pu32Sent, uint32 *pu32Skipped,
+	uint32 *pu32Dropped)
+{
+	if (pPub == NULL)
+		return -3;
+	if (pu32Subs != NULL)
+		*pu32Subs = (uint32)pPub->lSubs;
+	if (pu32Sent != NULL)
+		*pu32Sent = (uint32)pPub->lSent;
+	if (pu32Skipped != NULL)
+		*pu32Skipped = (uint32)pPub->lSkipped;
+	if (pu32Dropped != NULL)
+		*pu32Dropped = (uint32)pPub->lDropped;
+	return 1;
+}
+
+/**
+  * @brief Publisher thread
+  *
+  *	Takes the newest posted sweep and sends it to the subscribers through
+  *	non-blocking sockets.
+  */
+static DWORD WINAPI PubThread (LPVOID lpParam)
+{
+	T_SARK_PUB *pPub = (T_SARK_PUB *)lpParam;
+	T_PUB_SUB *ptSub;
+	struct timeval tTimeout;
+	fd_set tRead, tWrite;
+	SOCKET hMax;
+	char tcDiscard[64];
+	int ii;
+
+	while (WaitForSingleObject(pPub->hStop, 0) == WAIT_TIMEOUT)
+	{
+		if (pPub->lReady & PUB_FRESH)
+			Publish(pPub);
+		FD_ZERO(&tRead);
+		FD_ZERO(&tWrite);
+		FD_SET(pPub->hListen, &tRead);
+		hMax = pPub->hListen;
+		for (ii = 0; ii < pPub->iSubs; ii++)
+		{
+			ptSub = &pPub->tSub[ii];
+			/* Readable when the subscriber closes the connection */
+			FD_SET(ptSub->hSock, &tRead);
+			if (ptSub->iSent < ptSub->iLen)
+				FD_SET(ptSub->hSock, &tWrite);
+			if (ptSub->hSock > hMax)
+				hMax = ptSub->hSock;
+		}
+		tTimeout.tv_sec = 0;
+		tTimeout.tv_usec = PUB_TICK * 1000;
+		if (select((int)hMax + 1, &tRead, &tWrite, NULL, &tTimeout) > 0)
+		{
+			for (ii = 0; ii < pPub->iSubs; ii++)
+			{
+				ptSub = &pPub->tSub[ii];
+				if (FD_ISSET(ptSub->hSock, &tRead)
+					&& recv(ptSub->hSock, tcDiscard, sizeof(tcDiscard), 0) <= 0)
+					ptSub->bClosed = TRUE;
+				if (!ptSub->bClosed && FD_ISSET(ptSub->hSock, &tWrite))
+					SendSome(pPub, ptSub);
+			}
+			if (FD_ISSET(pPub->hListen, &tRead))
+				AddSub(pPub);
+		}
+		RemoveSubs(pPub);
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Accepts a subscriber and queues the plan message to it
+  */
+static void AddSub (T_SARK_PUB *pPub)
+{
+	T_PUB_SUB *ptSub;
+	SOCKET hSock;
+	u_long ulNonBlock = 1;
+	int iSndBuf;
+
+	hSock = accept(pPub->hListen, NULL, NULL);
+	if (hSock == INVALID_SOCKET)
+		return;
+	if (pPub->iSubs == PUB_MAX_SUBS)
+	{
+		closesocket(hSock);
+		return;
+	}
+	ptSub = &pPub->tSub[pPub->iSubs];
+	ptSub->pu8Msg = (uint8 *)malloc(pPub->iPlanLen > pPub->iSweepLen ? pPub->iPlanLen : pPub->iSweepLen);
+	if (ptSub->pu8Msg == NULL || ioctlsocket(hSock, FIONBIO, &ulNonBlock) == SOCKET_ERROR)
+	{
+		free(ptSub->pu8Msg);
+		closesocket(hSock);
+		return;
+	}
+	/* Little buffering, so a slow subscriber gets recent sweeps rather than
+	   a backlog, and one not reading is detected */
+	iSndBuf = PUB_SNDBUF_SWEEPS * pPub->iSweepLen;
+	setsockopt(hSock, SOL_SOCKET, SO_SNDBUF, (const char *)&iSndBuf, sizeof(iSndBuf));
+	ptSub->hSock = hSock;
+	memcpy(ptSub->pu8Msg, pPub->pu8Plan, pPub->iPlanLen);
+	ptSub->iLen = pPub->iPlanLen;
+	ptSub->iSent = 0;
+	ptSub->bPending = pPub->bPublished;
+	ptSub->bClosed = FALSE;
+	ptSub->dwProgress = GetTickCount();
+	pPub->iSubs++;
+	InterlockedIncrement(&pPub->lSubs);
+}
+
+/**
+  * @brief Releases the subscribers closed or not reading
+  */
+static void RemoveSubs (T_SARK_PUB *pPub)
+{
+	T_PUB_SUB *ptSub;
+	bool bStalled;
+	int ii = 0;
+
+	while (ii < pPub->iSubs)
+	{
+		ptSub = &pPub->tSub[ii];
+		bStalled = ptSub->iSent < ptSub->iLen && GetTickCount() - ptSub->dwProgress > PUB_STALL;
+		if (!ptSub->bClosed && !bStalled)
+		{
+			ii++;
+			continue;
+		}
+		if (!ptSub->bClosed)
+			InterlockedIncrement(&pPub->lDropped);
+		closesocket(ptSub->hSock);
+		free(ptSub->pu8Msg);
+		*ptSub = pPub->tSub[--pPub->iSubs];
+		InterlockedDecrement(&pPub->lSubs);
+	}
+}
+
+/**
+  * @brief Takes the newest posted sweep and hands it to the subscribers
+  *
+  *	A subscriber still sending a message gets the sweep when done; a sweep
+  *	waiting there is replaced and counted as skipped.
+  */
+static void Publish (T_SARK_PUB *pPub)
+{
+	T_PUB_SUB *ptSub;
+	int ii;
+
+	pPub->iFront = InterlockedExchange(&pPub->lReady, pPub->iFront) & PUB_INDEX;
+	EncodeSweep(pPub, &pPub->tBuf[pPub->iFront]);
+	pPub->bPublished = TRUE;
+	for (ii = 0; ii < pPub->iSubs; ii++)
+	{
+		ptSub = &pPub->tSub[ii];
+		if (ptSub->iSent == ptSub->iLen)
+			LoadSweep(pPub, ptSub);
+		else
+		{
+			if (ptSub->bPending)
+				InterlockedIncrement(&pPub->lSkipped);
+			ptSub->bPending = TRUE;
+		}
+	}
+}
+
+/**
+  * @brief Sends what the socket of a subscriber takes without blocking
+  */
+static void SendSome (T_SARK_PUB *pPub, T_PUB_SUB *ptSub)
+{
+	int iResult;
+
+	iResult = send(ptSub->hSock, (const char *)&ptSub->pu8Msg[ptSub->iSent], ptSub->iLen - ptSub->iSent, 0);
+	if (iResult == SOCKET_ERROR)
+	{
+		if (WSAGetLastError() != WSAEWOULDBLOCK)
+			ptSub->bClosed = TRUE;
+		return;
+	}
+	ptSub->iSent += iResult;
+	ptSub->dwProgress = GetTickCount();
+	if (ptSub->iSent < ptSub->iLen)
+		return;
+	if (ptSub->pu8Msg[0] == PUB_MSG_SWEEP)
+		InterlockedIncrement(&pPub->lSent);
+	if (ptSub->bPending)
+		LoadSweep(pPub, ptSub);
+}
+
+/**
+  * @brief Queues the newest sweep message to a subscriber
+  */
+static void LoadSweep (T_SARK_PUB *pPub, T_PUB_SUB *ptSub)
+{
+	memcpy(ptSub->pu8Msg, pPub->pu8Sweep, pPub->iSweepLen);
+	ptSub->iLen = pPub->iSweepLen;
+	ptSub->iSent = 0;
+	ptSub->bPending = FALSE;
+	ptSub->dwProgress = GetTickCount();
+}
+
+/**
+  * @brief Encodes the plan message
+  */
+static void EncodePlan (T_SARK_PUB *pPub, uint16 u16Ver, const uint8 *pu8FW, int16 num, const uint32 *pu32Freq)
+{
+	uint8 *pu8Buf = pPub->pu8Plan;
+	int ii;
+
+	PutPrefix(pu8Buf, PUB_MSG_PLAN, pPub->u8Format, pPub->iPlanLen);
+	pu8Buf += PUB_PREFIX_SIZE;
+	Short2Buf(pu8Buf, u16Ver);
+	pu8Buf += 2;
+	memcpy(pu8Buf, pu8FW, PUB_FW_SIZE);
+	pu8Buf[PUB_FW_SIZE - 1] = 0;
+	pu8Buf += PUB_FW_SIZE;
+	Short2Buf(pu8Buf, (uint16)num);
+	pu8Buf += 2;
+	Int2Buf(pu8Buf, (uint32)pPub->iPoints);
+	pu8Buf += 4;
+	for (ii = 0; ii < pPub->iPoints; ii++, pu8Buf += 4)
+		Int2Buf(pu8Buf, pu32Freq[ii]);
+}
+
+/**
+  * @brief Encodes a sweep message with the R and X columns
+  */
+static void EncodeSweep (T_SARK_PUB *pPub, T_PUB_BUF *ptBuf)
+{
+	uint8 *pu8Buf = pPub->pu8Sweep;
+	int ii;
+
+	PutPrefix(pu8Buf, PUB_MSG_SWEEP, pPub->u8Format, pPub->iSweepLen);
+	pu8Buf += PUB_PREFIX_SIZE;
+	Int2Buf(pu8Buf, ptBuf->u32Seq);
+	pu8Buf += 4;
+	Int2Buf(pu8Buf, (uint32)pPub->iPoints);
+	pu8Buf += 4;
+	if (pPub->u8Format == PUB_FMT_HALF)
+	{
+		for (ii = 0; ii < pPub->iPoints; ii++, pu8Buf += 2)
+			Short2Buf(pu8Buf, Float2Half(ptBuf->pfR[ii]));
+		for (ii = 0; ii < pPub->iPoints; ii++, pu8Buf += 2)
+			Short2Buf(pu8Buf, Float2Half(ptBuf->pfX[ii]));
+	}
+	else
+	{
+		for (ii = 0; ii < pPub->iPoints; ii++, pu8Buf += 4)
+			Float2Buf(pu8Buf, ptBuf->pfR[ii]);
+		for (ii = 0; ii < pPub->iPoints; ii++, pu8Buf += 4)
+			Float2Buf(pu8Buf, ptBuf->pfX[ii]);
+	}
+}
+
+/**
+  * @brief Encodes the prefix of a message of iLen bytes
+  */
+static void PutPrefix (uint8 *pu8Buf, uint8 u8Type, uint8 u8Format, int iLen)
+{
+	pu8Buf[0] = u8Type;
+	pu8Buf[1] = u8Format;
+	Short2Buf(&pu8Buf[2], 0);
+	Int2Buf(&pu8Buf[4], (uint32)(iLen - PUB_PREFIX_SIZE));
+}
+
+/**
+  * @brief Releases publisher resources
+  */
+static void FreePub (T_SARK_PUB *pPub)
+{
+	int ii;
+
+	for (ii = 0; ii < pPub->iSubs; ii++)
+	{
+		closesocket(pPub->tSub[ii].hSock);
+		free(pPub->tSub[ii].pu8Msg);
+	}
+	if (pPub->hListen != INVALID_SOCKET)
+		closesocket(pPub->hListen);
+	if (pPub->hThread != NULL)
+		CloseHandle(pPub->hThread);
+	if (pPub->hStop != NULL)
+		CloseHandle(pPub->hStop);
+	free(pPub->pu8Sweep);
+	free(pPub->pu8Plan);
+	free(pPub->pfData);
+	free(pPub);
+	WSACleanup();
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
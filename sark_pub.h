@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    sark_pub.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Publication of completed sweeps to local subscribers
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_PUB_H__
+#define __SARK_PUB_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+#include "sark_sweep.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_pub T_SARK_PUB;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Wire format, little endian. Every message starts with PUB_PREFIX_SIZE bytes:
+   type (1), format (1), reserved (2) and length of the body (4).
+   PUB_MSG_PLAN, sent once on connection: protocol version (2), firmware
+   version (PUB_FW_SIZE, zero padded), device number (2), points (4) and the
+   frequencies (4 each).
+   PUB_MSG_SWEEP: sequence number (4), points (4), then all the R values and
+   all the X values, as floats or half floats given by the format */
+#define PUB_PREFIX_SIZE		8
+#define PUB_FW_SIZE			16
+#define PUB_MSG_PLAN		'P'
+#define PUB_MSG_SWEEP		'S'
+#define PUB_FMT_FLOAT		0
+#define PUB_FMT_HALF		1
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_PUB *Sark_Pub_Start (uint16 u16Port, int16 num, T_SARK_SWEEP *pSweep, uint8 u8Format);
+extern void Sark_Pub_Stop (T_SARK_PUB *pPub);
+extern int Sark_Pub_Points (T_SARK_PUB *pPub);
+extern int Sark_Pub_Post (T_SARK_PUB *pPub, uint32 u32Seq, const float *pfR, const float *pfX);
+extern int Sark_Pub_Stats (T_SARK_PUB *pPub, uint32 *pu32Subs, uint32 *pu32Sent, uint32 *pu32Skipped,
+	uint32 *pu32Dropped);
+
+#endif	 /* __SARK_PUB_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
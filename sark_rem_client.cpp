@@ -38,8 +38,11 @@
 #include <ws2tcpip.h>
 #include "hid.h"
 #include "sock_cli.h"
+#include "shm_cli.h"
+#include "sark_sim.h"
 #include "sark_cmd_defs.h"
 #include "sark_rem_client.h"
+#include "sark_cancel.h"
 #include "ble.h"
 
 /* Private typedef -----------------------------------------------------------*/
@@ -54,20 +57,16 @@
 /* External variables --------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
-static CRITICAL_SECTION txrx_mutex;
+static CRITICAL_SECTION txrx_mutex[SARK_MAX_DEVICES];	/* one per device */
 static bool bInitMutex = FALSE;
 static int16 gi16Itfz = ITFZ_HID;
+static int8 gi8Bulk[SARK_MAX_DEVICES];	/* bulk extension; 0: not known yet, 1: yes, -1: no */
 
 /* Private function prototypes -----------------------------------------------*/
-static void Float2Buf (uint8 tu8Buf[4], float fVal);
-static void Int2Buf (uint8 tu8Buf[4], uint32 u32Val);
-static void Buf2Int (uint32 *pu32Val, uint8 tu8Buf[4]);
-static void Buf2Float (float *pfVal, uint8 tu8Buf[4]);
-static void Buf2Short (uint16 *pu16Val, uint8 tu8Buf[4]);
-static void Short2Buf (uint8 tu8Buf[4], uint16 u16Val);
-static int SendReceive (int16 num, uint8 *tx, uint8 *rx);
-static uint16 Float2Half(float value);
-static float Half2Float(uint16 value);
+static int MeasBulk (int16 num, uint32 u32Freq, uint32 u32Step, int iPoints, bool bCal, uint8 u8Samples,
+	bool bFloat, float *pfR, float *pfX);
+static int MeasSingle (int16 num, uint32 u32Freq, uint32 u32Step, int iPoints, bool bCal, uint8 u8Samples,
+	bool bFloat, float *pfR, float *pfX);
 
 /* Private functions ---------------------------------------------------------*/
 
@@ -78,8 +77,15 @@ static float Half2Float(uint16 value);
   *						0: USB HID
   * 					1: Bluetooth LE
   *						2: Network
-  * @param  maxDev		maximum number of devices to detect (HID only)
-  * @param  serverAddr	server address (sockets only)
+  *						3: Local server, AF_UNIX socket
+  *						4: Local server, shared memory
+  *						5: Simulator
+  * @param  maxDev		maximum number of devices to detect (HID and simulator only)
+  * @param  serverAddr	server addresses (servers only); comma separated list of
+  *						host[:port] entries, socket paths or shared memory
+  *						names, each one addressed as a device; network and
+  *						local socket entries prefixed by "seq@" use tagged
+  *						frames. Simulator: NULL, "ordered" or "tagged" timing
   * @retval
   *			@li >=1: 	number of devices detected
   *			@li -1: 	device not detected
@@ -87,16 +93,25 @@ static float Half2Float(uint16 value);
 int Sark_Connect (int16 itfz, int16 maxDev, char *serverAddr)
 {
 	int iRc = -1;
+	int ii;
 
 	if (bInitMutex == FALSE)
 	{
-		InitializeCriticalSection(&txrx_mutex);
+		for (ii = 0; ii < SARK_MAX_DEVICES; ii++)
+			InitializeCriticalSection(&txrx_mutex[ii]);
 		bInitMutex = TRUE;
 	}
+	if (maxDev > SARK_MAX_DEVICES)
+		maxDev = SARK_MAX_DEVICES;
+	memset(gi8Bulk, 0, sizeof(gi8Bulk));
 
 	gi16Itfz = itfz;
-	if (gi16Itfz == ITFZ_SOCK)
-		return Sock_Connect(serverAddr);
+	if (gi16Itfz == ITFZ_SOCK || gi16Itfz == ITFZ_UNIX)
+		return Sock_Connect(serverAddr, gi16Itfz == ITFZ_UNIX);
+	else if (gi16Itfz == ITFZ_SHM)
+		return Shm_Connect(serverAddr);
+	else if (gi16Itfz == ITFZ_SIM)
+		return Sim_Open(maxDev, serverAddr);
 	else if (gi16Itfz == ITFZ_BT)
 	{
 #ifndef _NO_BLE_SUPPORT_
@@ -121,8 +136,14 @@ int Sark_Connect (int16 itfz, int16 maxDev, char *serverAddr)
   */
 int Sark_Close (int16 num)
 {
-	if (gi16Itfz == ITFZ_SOCK)
-		return Sock_Close();
+	if (num >= 0 && num < SARK_MAX_DEVICES)
+		gi8Bulk[num] = 0;
+	if (gi16Itfz == ITFZ_SOCK || gi16Itfz == ITFZ_UNIX)
+		return Sock_Close(num);
+	else if (gi16Itfz == ITFZ_SHM)
+		return Shm_Close(num);
+	else if (gi16Itfz == ITFZ_SIM)
+		return 1;
 	else if (gi16Itfz == ITFZ_BT)
 	{
 #ifndef _NO_BLE_SUPPORT_
@@ -136,9 +157,28 @@ int Sark_Close (int16 num)
 	return 1;
 }
 
+/**
+  * @brief Selects the event loop for network connections
+  *
+  *	One thread then drives the sockets of every server, keeping the requests
+  *	of all of them in flight at once, instead of a blocking exchange per
+  *	call. Switch it while no request is in progress.
+  *
+  * @param  bOn		{TRUE: event loop; FALSE: blocking sockets}
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  */
+int Sark_Net_Loop (bool bOn)
+{
+	return bOn ? Sock_Loop_Start() : Sock_Loop_Stop();
+}
+
 /**
   * @brief Get protocol version
   *
+  *	The version also tells whether the device takes CMD_SARK_MEAS_RX_BULK.
+  *
   * @param  num			device number (starting by zero)
   * @param  pu16Ver		protocol version
   * @param  pu8Fw		FW version
@@ -149,24 +189,27 @@ int Sark_Close (int16 num)
   */
 int Sark_Version (int16 num, uint16 *pu16Ver, uint8 *pu8FW)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_SARK_VERSION;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SARK_VERSION;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	Buf2Short(pu16Ver, &tu8Rx[1]);
-	memcpy(pu8FW, &tu8Rx[3], SARKCMD_RX_SIZE-3);
+	Buf2Short(pu16Ver, &pu8Rx[1]);
+	memcpy(pu8FW, &pu8Rx[3], SARKCMD_RX_SIZE-3);
+	if (num >= 0 && num < SARK_MAX_DEVICES)
+		gi8Bulk[num] = (*pu16Ver >= SARK_PROTO_BULK && gi16Itfz != ITFZ_BT) ? 1 : -1;
 
 	return 1;
 }
@@ -189,32 +232,84 @@ int Sark_Version (int16 num, uint16 *pu16Ver, uint8 *pu8FW)
   */
 int Sark_Meas_Rx (int16 num, uint32 u32Freq, bool bCal, uint8 u8Samples, float *pfR, float *pfX, float *pfS21re, float *pfS21im)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_SARK_MEAS_RX;
-	Int2Buf(&tu8Tx[1], u32Freq);
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SARK_MEAS_RX;
+	Int2Buf(&pu8Tx[1], u32Freq);
 	if (bCal)
-		tu8Tx[5] = PAR_SARK_CAL;
+		pu8Tx[5] = PAR_SARK_CAL;
 	else
-		tu8Tx[5] = PAR_SARK_UNCAL;
-	tu8Tx[6] = u8Samples;
+		pu8Tx[5] = PAR_SARK_UNCAL;
+	pu8Tx[6] = u8Samples;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	Buf2Float(pfR, &tu8Rx[1]);
-	Buf2Float(pfX, &tu8Rx[5]);
-	Buf2Float(pfS21re, &tu8Rx[9]);
-	Buf2Float(pfS21im, &tu8Rx[13]);
+	Buf2Float(pfR, &pu8Rx[1]);
+	Buf2Float(pfX, &pu8Rx[5]);
+	Buf2Float(pfS21re, &pu8Rx[9]);
+	Buf2Float(pfS21im, &pu8Rx[13]);
+
+	return 1;
+}
+
+/**
+  * @brief Measure R and X at several frequencies
+  *
+  *	The requests go through Sark_Exchange_N, so on the network interfaces
+  *	they are sent back to back and their answers read together.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pu32Freq	frequencies, iCount entries
+  * @param  iCount		number of points, up to SARK_EXCHANGE_MAX
+  * @param  bCal		{TRUE: OSL calibrated measurement; FALSE: not calibrated}
+  * @param  u8Samples	Number of samples to average
+  * @param  pfR			return R (real Z), iCount entries
+  * @param  pfX			return X (imag Z), iCount entries
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  */
+int Sark_Meas_Rx_N (int16 num, const uint32 *pu32Freq, int iCount, bool bCal, uint8 u8Samples, float *pfR, float *pfX)
+{
+	T_SARK_FRAME tFrame[SARK_EXCHANGE_MAX];
+	uint8 *pu8Rx;
+	uint8 *pu8Tx;
+	int ii;
+
+	if (iCount <= 0 || iCount > SARK_EXCHANGE_MAX)
+		return -3;
+	for (ii = 0; ii < iCount; ii++)
+	{
+		pu8Tx = &tFrame[ii].tu8Tx[1];
+		memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+		pu8Tx[0] = CMD_SARK_MEAS_RX;
+		Int2Buf(&pu8Tx[1], pu32Freq[ii]);
+		pu8Tx[5] = bCal ? PAR_SARK_CAL : PAR_SARK_UNCAL;
+		pu8Tx[6] = u8Samples;
+	}
+	if (Sark_Exchange_N(num, tFrame, iCount) < 0)
+		return -1;
+	for (ii = 0; ii < iCount; ii++)
+	{
+		pu8Rx = &tFrame[ii].tu8Rx[1];
+		if (pu8Rx[0] != ANS_SARK_OK)
+			return -2;
+		Buf2Float(&pfR[ii], &pu8Rx[1]);
+		Buf2Float(&pfX[ii], &pu8Rx[5]);
+	}
 
 	return 1;
 }
@@ -241,26 +336,27 @@ int Sark_Meas_Rx_Eff (int16 num, uint32 u32Freq, uint32 u32Step, bool bCal, uint
 	float *pfR4, float *pfX4
 	)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_SARK_MEAS_RX_EFF;
-	Int2Buf(&tu8Tx[1], u32Freq);
-	Int2Buf(&tu8Tx[7], u32Step);
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SARK_MEAS_RX_EFF;
+	Int2Buf(&pu8Tx[1], u32Freq);
+	Int2Buf(&pu8Tx[7], u32Step);
 	if (bCal)
-		tu8Tx[5] = PAR_SARK_CAL;
+		pu8Tx[5] = PAR_SARK_CAL;
 	else
-		tu8Tx[5] = PAR_SARK_UNCAL;
-	tu8Tx[6] = u8Samples;
+		pu8Tx[5] = PAR_SARK_UNCAL;
+	pu8Tx[6] = u8Samples;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
@@ -269,33 +365,33 @@ int Sark_Meas_Rx_Eff (int16 num, uint32 u32Freq, uint32 u32Step, bool bCal, uint
 	float fR, fX;
 	int offset = 1;
 
-	Buf2Short(&u16R, &tu8Rx[offset]);
+	Buf2Short(&u16R, &pu8Rx[offset]);
 	fR = Half2Float(u16R);
-	Buf2Short(&u16X, &tu8Rx[offset+2]);
+	Buf2Short(&u16X, &pu8Rx[offset+2]);
 	fX = Half2Float(u16X);
 	*pfR1 = fR;
 	*pfX1 = fX;
 	offset += 4;
 
-	Buf2Short(&u16R, &tu8Rx[offset]);
+	Buf2Short(&u16R, &pu8Rx[offset]);
 	fR = Half2Float(u16R);
-	Buf2Short(&u16X, &tu8Rx[offset+2]);
+	Buf2Short(&u16X, &pu8Rx[offset+2]);
 	fX = Half2Float(u16X);
 	*pfR2 = fR;
 	*pfX2 = fX;
 	offset += 4;
 
-	Buf2Short(&u16R, &tu8Rx[offset]);
+	Buf2Short(&u16R, &pu8Rx[offset]);
 	fR = Half2Float(u16R);
-	Buf2Short(&u16X, &tu8Rx[offset+2]);
+	Buf2Short(&u16X, &pu8Rx[offset+2]);
 	fX = Half2Float(u16X);
 	*pfR3 = fR;
 	*pfX3 = fX;
 	offset += 4;
 
-	Buf2Short(&u16R, &tu8Rx[offset]);
+	Buf2Short(&u16R, &pu8Rx[offset]);
 	fR = Half2Float(u16R);
-	Buf2Short(&u16X, &tu8Rx[offset+2]);
+	Buf2Short(&u16X, &pu8Rx[offset+2]);
 	fX = Half2Float(u16X);
 	*pfR4 = fR;
 	*pfX4 = fX;
@@ -304,6 +400,74 @@ int Sark_Meas_Rx_Eff (int16 num, uint32 u32Freq, uint32 u32Step, bool bCal, uint
 	return 1;
 }
 
+/**
+  * @brief Measure R and X at evenly spaced frequencies
+  *
+  *	Devices with protocol version SARK_PROTO_BULK or later answer up to
+  *	BULK_MAX_FRAMES frames to a single request, which is negotiated on the
+  *	first call through Sark_Version. Other devices, and devices that reject
+  *	the request, are measured with CMD_SARK_MEAS_RX_EFF (half floats) or
+  *	CMD_SARK_MEAS_RX (floats) instead.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  u32Freq		first frequency
+  * @param  u32Step		frequency step
+  * @param  u16Points	number of points
+  * @param  bCal		{TRUE: OSL calibrated measurement; FALSE: not calibrated}
+  * @param  u8Samples	Number of samples to average
+  * @param  bFloat		{TRUE: float precision; FALSE: half float precision}
+  * @param  pfR			return R (real Z), u16Points values
+  * @param  pfX			return X (imag Z), u16Points values
+  * @retval None
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid params
+  */
+int Sark_Meas_Rx_Bulk (int16 num, uint32 u32Freq, uint32 u32Step, uint16 u16Points, bool bCal, uint8 u8Samples,
+	bool bFloat, float *pfR, float *pfX)
+{
+	uint16 u16Ver;
+	uint8 tu8FW[SARKCMD_RX_SIZE];
+	int iPoint, iTake, iMax;
+	int rc;
+
+	if (num < 0 || num >= SARK_MAX_DEVICES || u16Points == 0 || pfR == NULL || pfX == NULL)
+		return -3;
+	if (gi8Bulk[num] == 0)
+	{
+		rc = Sark_Version(num, &u16Ver, tu8FW);
+		if (rc == -1)
+			return -1;
+		if (rc < 0)
+			gi8Bulk[num] = -1;
+	}
+
+	iMax = BULK_MAX_FRAMES * (bFloat ? BULK_PER_FLOAT : BULK_PER_HALF);
+	for (iPoint = 0; iPoint < u16Points; iPoint += iTake)
+	{
+		iTake = u16Points - iPoint;
+		if (iTake > iMax)
+			iTake = iMax;
+		rc = -2;
+		if (gi8Bulk[num] > 0)
+			rc = MeasBulk(num, u32Freq + iPoint * u32Step, u32Step, iTake, bCal, u8Samples,
+				bFloat, &pfR[iPoint], &pfX[iPoint]);
+		if (rc == -2)
+		{
+			rc = MeasSingle(num, u32Freq + iPoint * u32Step, u32Step, iTake, bCal, u8Samples,
+				bFloat, &pfR[iPoint], &pfX[iPoint]);
+			/* Rejected only by the bulk request: the device lacks it */
+			if (rc > 0)
+				gi8Bulk[num] = -1;
+		}
+		if (rc < 0)
+			return rc;
+	}
+
+	return 1;
+}
+
 /**
   * @brief Measure raw vector
   *
@@ -320,26 +484,27 @@ int Sark_Meas_Rx_Eff (int16 num, uint32 u32Freq, uint32 u32Step, bool bCal, uint
   */
 int Sark_Meas_Vect (int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV, float *pfMagI, float *pfPhI )
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_SARK_MEAS_VECTOR;
-	Int2Buf(&tu8Tx[1], u32Freq);
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SARK_MEAS_VECTOR;
+	Int2Buf(&pu8Tx[1], u32Freq);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	Buf2Float(pfMagV, &tu8Rx[1]);
-	Buf2Float(pfPhV, &tu8Rx[5]);
-	Buf2Float(pfMagI, &tu8Rx[9]);
-	Buf2Float(pfPhI, &tu8Rx[13]);
+	Buf2Float(pfMagV, &pu8Rx[1]);
+	Buf2Float(pfPhV, &pu8Rx[5]);
+	Buf2Float(pfMagI, &pu8Rx[9]);
+	Buf2Float(pfPhI, &pu8Rx[13]);
 
 	return 1;
 }
@@ -360,26 +525,27 @@ int Sark_Meas_Vect (int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV, floa
   */
 int Sark_Meas_RF (int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV, float *pfMagI, float *pfPhI )
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_SARK_MEAS_RF;
-	Int2Buf(&tu8Tx[1], u32Freq);
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SARK_MEAS_RF;
+	Int2Buf(&pu8Tx[1], u32Freq);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	Buf2Float(pfMagV, &tu8Rx[1]);
-	Buf2Float(pfPhV, &tu8Rx[5]);
-	Buf2Float(pfMagI, &tu8Rx[9]);
-	Buf2Float(pfPhI, &tu8Rx[13]);
+	Buf2Float(pfMagV, &pu8Rx[1]);
+	Buf2Float(pfPhV, &pu8Rx[5]);
+	Buf2Float(pfMagI, &pu8Rx[9]);
+	Buf2Float(pfPhI, &pu8Rx[13]);
 
 	return 1;
 }
@@ -400,26 +566,79 @@ int Sark_Meas_RF (int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV, float
   */
 int Sark_Meas_Vect_Thru (int16 num, uint32 u32Freq, float *pfMagVout, float *pfPhVout, float *pfMagVin, float *pfPhVin )
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_SARK_MEAS_VEC_THRU;
-	Int2Buf(&tu8Tx[1], u32Freq);
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SARK_MEAS_VEC_THRU;
+	Int2Buf(&pu8Tx[1], u32Freq);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	Buf2Float(pfMagVout, &tu8Rx[1]);
-	Buf2Float(pfPhVout, &tu8Rx[5]);
-	Buf2Float(pfMagVin, &tu8Rx[9]);
-	Buf2Float(pfPhVin, &tu8Rx[13]);
+	Buf2Float(pfMagVout, &pu8Rx[1]);
+	Buf2Float(pfPhVout, &pu8Rx[5]);
+	Buf2Float(pfMagVin, &pu8Rx[9]);
+	Buf2Float(pfPhVin, &pu8Rx[13]);
+
+	return 1;
+}
+
+/**
+  * @brief Measure raw vector Thru at several frequencies (SARK110 MK1)
+  *
+  *	The requests go through Sark_Exchange_N, so on the network interfaces
+  *	they are sent back to back and their answers read together.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pu32Freq	frequencies, iCount entries
+  * @param  iCount		number of points, up to SARK_EXCHANGE_MAX
+  * @param  pfMagVout	magnitude voltage out, iCount entries
+  * @param  pfPhVout	phase voltage out, iCount entries
+  * @param  pfMagVin	magnitude voltage in, iCount entries
+  * @param  pfPhVin		phase voltage in, iCount entries
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  */
+int Sark_Meas_Vect_Thru_N (int16 num, const uint32 *pu32Freq, int iCount,
+	float *pfMagVout, float *pfPhVout, float *pfMagVin, float *pfPhVin)
+{
+	T_SARK_FRAME tFrame[SARK_EXCHANGE_MAX];
+	uint8 *pu8Rx;
+	uint8 *pu8Tx;
+	int ii;
+
+	if (iCount <= 0 || iCount > SARK_EXCHANGE_MAX)
+		return -3;
+	for (ii = 0; ii < iCount; ii++)
+	{
+		pu8Tx = &tFrame[ii].tu8Tx[1];
+		memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+		pu8Tx[0] = CMD_SARK_MEAS_VEC_THRU;
+		Int2Buf(&pu8Tx[1], pu32Freq[ii]);
+	}
+	if (Sark_Exchange_N(num, tFrame, iCount) < 0)
+		return -1;
+	for (ii = 0; ii < iCount; ii++)
+	{
+		pu8Rx = &tFrame[ii].tu8Rx[1];
+		if (pu8Rx[0] != ANS_SARK_OK)
+			return -2;
+		Buf2Float(&pfMagVout[ii], &pu8Rx[1]);
+		Buf2Float(&pfPhVout[ii], &pu8Rx[5]);
+		Buf2Float(&pfMagVin[ii], &pu8Rx[9]);
+		Buf2Float(&pfPhVin[ii], &pu8Rx[13]);
+	}
 
 	return 1;
 }
@@ -438,22 +657,23 @@ int Sark_Meas_Vect_Thru (int16 num, uint32 u32Freq, float *pfMagVout, float *pfP
   */
 int Sark_Signal_Gen (int16 num, uint32 u32Freq, uint16 u16Level, uint8 u8Gain)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_SARK_SIGNAL_GEN;
-	Int2Buf(&tu8Tx[1], u32Freq);
-	Short2Buf(&tu8Tx[5], u16Level);
-	tu8Tx[7] = u8Gain;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SARK_SIGNAL_GEN;
+	Int2Buf(&pu8Tx[1], u32Freq);
+	Short2Buf(&pu8Tx[5], u16Level);
+	pu8Tx[7] = u8Gain;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
@@ -474,25 +694,26 @@ int Sark_Signal_Gen (int16 num, uint32 u32Freq, uint16 u16Level, uint8 u8Gain)
   */
 int Sark_BatteryStatus (int16 num, uint8 *pu8Vbus, uint16 *pu16Volt, uint8 *pu8Chr)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_BATT_STAT;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_BATT_STAT;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	*pu8Vbus = tu8Rx[1];
-	Buf2Short(pu16Volt, &tu8Rx[2]);
-	*pu8Chr = tu8Rx[4];
+	*pu8Vbus = pu8Rx[1];
+	Buf2Short(pu16Volt, &pu8Rx[2]);
+	*pu8Chr = pu8Rx[4];
 
 	return 1;
 }
@@ -509,23 +730,24 @@ int Sark_BatteryStatus (int16 num, uint8 *pu8Vbus, uint16 *pu16Volt, uint8 *pu8C
   */
 int Sark_GetKey (int16 num, uint8 *pu8Key)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_GET_KEY;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_GET_KEY;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	*pu8Key = tu8Rx[1];
+	*pu8Key = pu8Rx[1];
 
 	return 1;
 }
@@ -541,19 +763,20 @@ int Sark_GetKey (int16 num, uint8 *pu8Key)
   */
 int Sark_Device_Reset (int16 num)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_DEV_RST;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_DEV_RST;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
@@ -573,24 +796,25 @@ int Sark_Device_Reset (int16 num)
   */
 int Sark_DiskInfo (int16 num, uint32 *pu32Tot, uint32 *pu32Fre)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_DISK_INFO;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_DISK_INFO;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	Buf2Int(pu32Tot, &tu8Rx[1]);
-	Buf2Int(pu32Fre, &tu8Rx[5]);
+	Buf2Int(pu32Tot, &pu8Rx[1]);
+	Buf2Int(pu32Fre, &pu8Rx[5]);
 
 	return 1;
 }
@@ -607,23 +831,24 @@ int Sark_DiskInfo (int16 num, uint32 *pu32Tot, uint32 *pu32Fre)
   */
 int Sark_DiskVolume (int16 num, uint8 *pu8Volume)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_DISK_VOLUME;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_DISK_VOLUME;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	memcpy(pu8Volume, &tu8Rx[1], SARKCMD_RX_SIZE-1);
+	memcpy(pu8Volume, &pu8Rx[1], SARKCMD_RX_SIZE-1);
 
 	return 1;
 }
@@ -641,21 +866,22 @@ int Sark_DiskVolume (int16 num, uint8 *pu8Volume)
   */
 int Sark_Buzzer (int16 num, uint16 u16Freq, uint16 u16Duration)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_BUZZER;
-	Short2Buf(&tu8Tx[1], u16Freq);
-	Short2Buf(&tu8Tx[3], u16Duration);
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_BUZZER;
+	Short2Buf(&pu8Tx[1], u16Freq);
+	Short2Buf(&pu8Tx[3], u16Duration);
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
@@ -684,26 +910,27 @@ int Sark_Buzzer (int16 num, uint16 u16Freq, uint16 u16Duration)
   */
 int Sark_GPIO (int16 num, uint8 u8Cmd, uint8 u8Port, uint8 u8In, uint8 *pu8Out)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_GPIO;
-	tu8Tx[1] = u8Cmd;
-	tu8Tx[2] = u8Port;
-	tu8Tx[3] = u8In;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_GPIO;
+	pu8Tx[1] = u8Cmd;
+	pu8Tx[2] = u8Port;
+	pu8Tx[3] = u8In;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	*pu8Out = tu8Rx[1];
+	*pu8Out = pu8Rx[1];
 	return 1;
 }
 
@@ -720,21 +947,22 @@ int Sark_GPIO (int16 num, uint8 u8Cmd, uint8 u8Port, uint8 u8In, uint8 *pu8Out)
   */
 int Sark_SetSetting (int16 num, uint8 u8Reg, uint8 u8Val)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_SET_SETTING;
-	tu8Tx[1] = u8Reg;
-	tu8Tx[2] = u8Val;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SET_SETTING;
+	pu8Tx[1] = u8Reg;
+	pu8Tx[2] = u8Val;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
@@ -754,44 +982,41 @@ int Sark_SetSetting (int16 num, uint8 u8Reg, uint8 u8Val)
   */
 int Sark_GetSetting (int16 num, uint8 u8Reg, uint8 *pu8Val)
 {
-	uint8 tu8Rx[SARKCMD_RX_SIZE];
-	uint8 tu8Tx[SARKCMD_TX_SIZE];
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Rx = &tFrame.tu8Rx[1];
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
 	int rc;
 
-	memset(tu8Tx, 0, SARKCMD_TX_SIZE);
-	tu8Tx[0] = CMD_GET_SETTING;
-	tu8Tx[1] = u8Reg;
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_GET_SETTING;
+	pu8Tx[1] = u8Reg;
 
-	rc = SendReceive (num, tu8Tx, tu8Rx);
+	rc = Sark_Exchange (num, &tFrame);
 	if (rc < 0)
 	{
 		return -1;
 	}
-	if (tu8Rx[0]!=ANS_SARK_OK)
+	if (pu8Rx[0]!=ANS_SARK_OK)
 	{
 		return -2;
 	}
-	*pu8Val = tu8Rx[1];
+	*pu8Val = pu8Rx[1];
 	return 1;
 }
 
 /**
-  * @brief
-  * @param  None
-  * @retval None
+  * @brief Stores a float in little endian order
   */
-static void Float2Buf (uint8 tu8Buf[4], float fVal)
+void Float2Buf (uint8 tu8Buf[4], float fVal)
 {
 	uint32 u32Val = *((uint32*)(&fVal));
 	Int2Buf(tu8Buf, u32Val);
 }
 
 /**
-  * @brief
-  * @param  None
-  * @retval None
+  * @brief Stores a 32 bit value in little endian order
   */
-static void Int2Buf (uint8 tu8Buf[4], uint32 u32Val)
+void Int2Buf (uint8 tu8Buf[4], uint32 u32Val)
 {
 	tu8Buf[3] = (uint8)((u32Val&0xff000000)>>24);
 	tu8Buf[2] = (uint8)((u32Val&0x00ff0000)>>16);
@@ -800,11 +1025,9 @@ static void Int2Buf (uint8 tu8Buf[4], uint32 u32Val)
 }
 
 /**
-  * @brief
-  * @param  None
-  * @retval None
+  * @brief Reads a float stored in little endian order
   */
-static void Buf2Float (float *pfVal, uint8 tu8Buf[4])
+void Buf2Float (float *pfVal, const uint8 tu8Buf[4])
 {
 	uint32 u32Val;
 	Buf2Int(&u32Val, tu8Buf);
@@ -812,11 +1035,9 @@ static void Buf2Float (float *pfVal, uint8 tu8Buf[4])
 }
 
 /**
-  * @brief
-  * @param  None
-  * @retval None
+  * @brief Reads a 32 bit value stored in little endian order
   */
-static void Buf2Int (uint32 *pu32Val, uint8 tu8Buf[4])
+void Buf2Int (uint32 *pu32Val, const uint8 tu8Buf[4])
 {
 	uint32 u32Val;
 
@@ -829,11 +1050,9 @@ static void Buf2Int (uint32 *pu32Val, uint8 tu8Buf[4])
 }
 
 /**
-  * @brief
-  * @param  None
-  * @retval None
+  * @brief Reads a 16 bit value stored in little endian order
   */
-static void Buf2Short (uint16 *pu16Val, uint8 tu8Buf[4])
+void Buf2Short (uint16 *pu16Val, const uint8 tu8Buf[2])
 {
 	uint16 u16Val;
 
@@ -844,11 +1063,9 @@ static void Buf2Short (uint16 *pu16Val, uint8 tu8Buf[4])
 }
 
 /**
-  * @brief
-  * @param  None
-  * @retval None
+  * @brief Stores a 16 bit value in little endian order
   */
-static void Short2Buf (uint8 tu8Buf[4], uint16 u16Val)
+void Short2Buf (uint8 tu8Buf[2], uint16 u16Val)
 {
 	tu8Buf[1] = (uint8)((u16Val&0xff00)>>8);
 	tu8Buf[0] = (uint8)((u16Val&0x00ff)>>0);
@@ -856,20 +1073,206 @@ static void Short2Buf (uint8 tu8Buf[4], uint16 u16Val)
 
 
 /**
-  * @brief Send receive
+  * @brief Measures points with one CMD_SARK_MEAS_RX_BULK request
   *
-  * @param  None
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  */
+static int MeasBulk (int16 num, uint32 u32Freq, uint32 u32Step, int iPoints, bool bCal, uint8 u8Samples,
+	bool bFloat, float *pfR, float *pfX)
+{
+	T_SARK_FRAME tFrame;
+	uint8 *pu8Tx = &tFrame.tu8Tx[1];
+	uint8 tu8Ans[BULK_MAX_FRAMES * SARKCMD_RX_SIZE];
+	uint8 *pu8Frame;
+	uint16 u16Val;
+	int iPer, iFrames;
+	int ii, iPoint;
+	int rc;
+
+	iPer = bFloat ? BULK_PER_FLOAT : BULK_PER_HALF;
+	iFrames = (iPoints + iPer - 1) / iPer;
+
+	memset(pu8Tx, 0, SARKCMD_TX_SIZE);
+	pu8Tx[0] = CMD_SARK_MEAS_RX_BULK;
+	Int2Buf(&pu8Tx[1], u32Freq);
+	if (bCal)
+		pu8Tx[5] = PAR_SARK_CAL;
+	else
+		pu8Tx[5] = PAR_SARK_UNCAL;
+	pu8Tx[6] = u8Samples;
+	Int2Buf(&pu8Tx[7], u32Step);
+	Short2Buf(&pu8Tx[11], (uint16)iPoints);
+	pu8Tx[13] = bFloat ? BULK_FMT_FLOAT : BULK_FMT_HALF;
+
+	rc = Sark_Exchange_Bulk(num, &tFrame, tu8Ans, iFrames);
+	if (rc < 0)
+	{
+		return -1;
+	}
+	if (tu8Ans[0]!=ANS_SARK_OK)
+	{
+		return -2;
+	}
+
+	for (iPoint = 0; iPoint < iPoints; iPoint++)
+	{
+		pu8Frame = &tu8Ans[(iPoint / iPer) * SARKCMD_RX_SIZE];
+		ii = iPoint % iPer;
+		if (pu8Frame[0] != ANS_SARK_OK || pu8Frame[1] != (uint8)(iPoint / iPer))
+			return -1;
+		if (bFloat)
+		{
+			Buf2Float(&pfR[iPoint], &pu8Frame[2 + 8 * ii]);
+			Buf2Float(&pfX[iPoint], &pu8Frame[6 + 8 * ii]);
+		}
+		else
+		{
+			Buf2Short(&u16Val, &pu8Frame[2 + 4 * ii]);
+			pfR[iPoint] = Half2Float(u16Val);
+			Buf2Short(&u16Val, &pu8Frame[4 + 4 * ii]);
+			pfX[iPoint] = Half2Float(u16Val);
+		}
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Measures points with the requests of devices without bulk
+  *
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  */
+static int MeasSingle (int16 num, uint32 u32Freq, uint32 u32Step, int iPoints, bool bCal, uint8 u8Samples,
+	bool bFloat, float *pfR, float *pfX)
+{
+	float tfR[4], tfX[4];
+	float fS21re, fS21im;
+	int iPoint, ii;
+	int rc;
+
+	for (iPoint = 0; iPoint < iPoints; iPoint += 4)
+	{
+		if (bFloat)
+		{
+			for (ii = 0; ii < 4 && iPoint + ii < iPoints; ii++)
+			{
+				rc = Sark_Meas_Rx(num, u32Freq + (iPoint + ii) * u32Step, bCal, u8Samples,
+					&pfR[iPoint + ii], &pfX[iPoint + ii], &fS21re, &fS21im);
+				if (rc < 0)
+					return rc;
+			}
+			continue;
+		}
+		rc = Sark_Meas_Rx_Eff(num, u32Freq + iPoint * u32Step, u32Step, bCal, u8Samples,
+			&tfR[0], &tfX[0], &tfR[1], &tfX[1], &tfR[2], &tfX[2], &tfR[3], &tfX[3]);
+		if (rc < 0)
+			return rc;
+		for (ii = 0; ii < 4 && iPoint + ii < iPoints; ii++)
+		{
+			pfR[iPoint + ii] = tfR[ii];
+			pfX[iPoint + ii] = tfX[ii];
+		}
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Sends a request answered by several frames
+  *
+  *	Receiving stops after the first answer if it is not ANS_SARK_OK, as an
+  *	error is answered by a single frame. The request is encoded by the caller
+  *	at tu8Tx[1], as for Sark_Exchange.
+  *
+  * @param  num			device number
+  * @param  ptFrame		request, and answer buffer for HID
+  * @param  pu8Rx		answers, SARKCMD_RX_SIZE bytes each
+  * @param  iAnswers	number of answer frames
   * @retval
   *			@li 1: Ok
   *			@li -1: error
   */
-static int SendReceive (int16 num, uint8 *tx, uint8 *rx)
+int Sark_Exchange_Bulk (int16 num, T_SARK_FRAME *ptFrame, uint8 *pu8Rx, int iAnswers)
 {
+	uint8 *tx = &ptFrame->tu8Tx[1];
+	T_CANCEL_SCOPE tScope;
+	int ii;
+	int rc;
+
+	if (gi16Itfz == ITFZ_SOCK || gi16Itfz == ITFZ_UNIX)
+		return Sock_SendReceiveBulk(num, tx, pu8Rx, iAnswers);
+	else if (gi16Itfz == ITFZ_SHM)
+		return Shm_SendReceiveBulk(num, tx, pu8Rx, iAnswers);
+	else if (gi16Itfz == ITFZ_SIM)
+		return Sim_SendReceiveBulk(num, tx, pu8Rx, iAnswers);
+	else if (gi16Itfz == ITFZ_BT)
+		return -1;
+
+	/* HID */
+	if (num < 0 || num >= SARK_MAX_DEVICES)
+		return -1;
+	EnterCriticalSection(&txrx_mutex[num]);
+	rc = rawhid_send_report(num, ptFrame->tu8Tx, sizeof(ptFrame->tu8Tx), HID_TX_TIMEOUT, 0);
+	for (ii = 0; rc > 0 && ii < iAnswers; ii++)
+	{
+		if (Sark_Cancel_Pending())
+		{
+			rc = 0;
+			break;
+		}
+		rc = rawhid_recv_report(num, ptFrame->tu8Rx, sizeof(ptFrame->tu8Rx), HID_RX_TIMEOUT);
+		if (rc <= 0)
+			break;
+		memcpy(&pu8Rx[ii * SARKCMD_RX_SIZE], &ptFrame->tu8Rx[1], SARKCMD_RX_SIZE);
+		if (pu8Rx[0] != ANS_SARK_OK)
+			break;
+	}
+	if (rc == 0)
+	{
+		/* Frames coming late would be taken as answers to later requests */
+		Sark_Cancel_Shield(&tScope);
+		while (rawhid_recv_report(num, ptFrame->tu8Rx, sizeof(ptFrame->tu8Rx), HID_RX_TIMEOUT) > 0)
+			;
+		Sark_Cancel_Leave(&tScope);
+	}
+	rc = (rc > 0) ? 1 : -1;
+	LeaveCriticalSection(&txrx_mutex[num]);
+
+	return rc;
+}
+
+/**
+  * @brief Send a request frame and receive its answer
+  *
+  *	The request is encoded by the caller at tu8Tx[1], and the answer is
+  *	decoded from tu8Rx[1]. Byte 0 of both is the HID report ID slot, so the
+  *	HID transport sends and receives the reports in place without copies.
+  *
+  * @param  num: device number
+  * @param  ptFrame: caller owned request and answer buffers
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  */
+int Sark_Exchange (int16 num, T_SARK_FRAME *ptFrame)
+{
+	uint8 *tx = &ptFrame->tu8Tx[1];
+	uint8 *rx = &ptFrame->tu8Rx[1];
 	int i;
 	int rc;
 
-	if (gi16Itfz == ITFZ_SOCK)
-		return Sock_SendReceive(tx, rx);
+	if (gi16Itfz == ITFZ_SOCK || gi16Itfz == ITFZ_UNIX)
+		return Sock_SendReceive(num, tx, rx);
+	else if (gi16Itfz == ITFZ_SHM)
+		return Shm_SendReceive(num, tx, rx);
+	else if (gi16Itfz == ITFZ_SIM)
+		return Sim_SendReceive(num, tx, rx);
 	else if (gi16Itfz == ITFZ_BT)
 	{
 #ifndef _NO_BLE_SUPPORT_
@@ -881,7 +1284,7 @@ static int SendReceive (int16 num, uint8 *tx, uint8 *rx)
 		else
 			numRetry = 5;
 
-		EnterCriticalSection(&txrx_mutex);
+		EnterCriticalSection(&txrx_mutex[0]);
 		for (retryGbl = 0; retryGbl < numRetry; retryGbl++)
 		{
 			if (retryGbl != 0)
@@ -902,31 +1305,105 @@ static int SendReceive (int16 num, uint8 *tx, uint8 *rx)
 				}
 			}
 		}
-		LeaveCriticalSection(&txrx_mutex);
+		LeaveCriticalSection(&txrx_mutex[0]);
 #endif
 	}
 	else  /* HID */
 	{
-		EnterCriticalSection(&txrx_mutex);
+		if (num < 0 || num >= SARK_MAX_DEVICES)
+			return -1;
+		/* Devices are locked independently so they can be used from parallel threads */
+		EnterCriticalSection(&txrx_mutex[num]);
 		for (i=0; i < 5; i++)
 		{
-			rc = rawhid_send(num, tx, SARKCMD_TX_SIZE, HID_TX_TIMEOUT);
+			/* A cancelled operation is not retried; the answers still due are skipped later */
+			if (i != 0 && Sark_Cancel_Pending())
+				break;
+			/*
+			 * A retry still accepts the late answer to an earlier attempt,
+			 * so after a timeout it waits once more before sending again
+			 */
+			if (i == 0 || rc != 0 || (i % 2) == 0)
+				rc = rawhid_send_report(num, ptFrame->tu8Tx, sizeof(ptFrame->tu8Tx), HID_TX_TIMEOUT, i != 0);
 			if (rc < 0)
 				break;
-			rc = rawhid_recv(num, rx, SARKCMD_RX_SIZE, HID_RX_TIMEOUT);
+			rc = rawhid_recv_report(num, ptFrame->tu8Rx, sizeof(ptFrame->tu8Rx), HID_RX_TIMEOUT);
 			if (rc < 0)
 				break;
+			if (rc == 0)
+				continue;	/* no answer yet */
 			if (rx[0]==ANS_SARK_OK || rx[0]==ANS_SARK_ERR)
 				break;
 			else
 				rc = -1;
 		}
-		LeaveCriticalSection(&txrx_mutex);
+		if (rc == 0)
+			rc = -1;
+		LeaveCriticalSection(&txrx_mutex[num]);
 	}
 
 	return rc;
 }
 
+/**
+  * @brief Send several request frames and receive their answers
+  *
+  *	On the network interfaces the requests are sent back to back and the
+  *	answers read as they come (Sock_SendReceiveN). The other interfaces
+  *	exchange the frames one by one, stopping at the first error or when
+  *	the operation is cancelled.
+  *
+  * @param  num			device number
+  * @param  ptFrame		caller owned request and answer buffers, iCount entries
+  * @param  iCount		number of frames, up to SARK_EXCHANGE_MAX
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  *			@li -2: no answer
+  */
+int Sark_Exchange_N (int16 num, T_SARK_FRAME *ptFrame, int iCount)
+{
+	uint8 tu8Tx[SARK_EXCHANGE_MAX * SARKCMD_TX_SIZE];
+	uint8 tu8Rx[SARK_EXCHANGE_MAX * SARKCMD_RX_SIZE];
+	int ii;
+	int rc = -1;
+
+	if (iCount <= 0 || iCount > SARK_EXCHANGE_MAX)
+		return -1;
+	if (iCount > 1 && Sark_Exchange_Pipelined())
+	{
+		for (ii = 0; ii < iCount; ii++)
+			memcpy(&tu8Tx[ii * SARKCMD_TX_SIZE], &ptFrame[ii].tu8Tx[1], SARKCMD_TX_SIZE);
+		rc = Sock_SendReceiveN(num, tu8Tx, tu8Rx, iCount);
+		for (ii = 0; rc > 0 && ii < iCount; ii++)
+			memcpy(&ptFrame[ii].tu8Rx[1], &tu8Rx[ii * SARKCMD_RX_SIZE], SARKCMD_RX_SIZE);
+		return rc;
+	}
+	for (ii = 0; ii < iCount; ii++)
+	{
+		if (ii != 0 && Sark_Cancel_Pending())
+			return -1;
+		rc = Sark_Exchange(num, &ptFrame[ii]);
+		if (rc < 0)
+			break;
+	}
+
+	return rc;
+}
+
+/**
+  * @brief Tells whether Sark_Exchange_N sends its frames together
+  *
+  *	Callers size their batches with it: on the other interfaces a batch
+  *	only delays the results of its first frames.
+  *
+  * @retval TRUE for the network interfaces
+  */
+bool Sark_Exchange_Pipelined (void)
+{
+	return gi16Itfz == ITFZ_SOCK || gi16Itfz == ITFZ_UNIX;
+}
+
 /**
   * @brief
   *
@@ -963,7 +1440,7 @@ union Bits
 static int32 const C_MAXD = C_INFC - C_MAXC - 1;
 static int32 const C_MIND = C_MINC - C_SUBC - 1;
 
-static uint16 Float2Half(float value)
+uint16 Float2Half(float value)
 {
     union Bits v, s;
 	v.f = value;
@@ -981,7 +1458,7 @@ static uint16 Float2Half(float value)
 	return v.ui | sign;
 }
 
-static float Half2Float(uint16 value)
+float Half2Float(uint16 value)
 {
 	union Bits v;
 	v.ui = value;
@@ -39,32 +39,56 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "device.h"
+#include "sark_cmd_defs.h"
 
 /* Exported types ------------------------------------------------------------*/
 typedef enum
 {
 	ITFZ_HID,
 	ITFZ_BT,
-	ITFZ_SOCK
+	ITFZ_SOCK,
+	ITFZ_UNIX,
+	ITFZ_SHM,
+	ITFZ_SIM
 } T_ITFZ;
 
+/* Request and answer frames, with the HID report ID slot reserved in byte 0 */
+typedef struct
+{
+	uint8 tu8Tx[SARKCMD_TX_SIZE+1];
+	uint8 tu8Rx[SARKCMD_RX_SIZE+1];
+} T_SARK_FRAME;
+
 /* Exported constants --------------------------------------------------------*/
+#define SARK_MAX_DEVICES	64	/* maximum number of devices handled */
+#define SARK_EXCHANGE_MAX	32	/* frames of one Sark_Exchange_N */
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 extern int Sark_Connect (int16 itfz, int16 maxDev, char *serverAddr);
 extern int Sark_Close (int16 num);
+extern int Sark_Net_Loop (bool bOn);
+extern int Sark_Exchange (int16 num, T_SARK_FRAME *ptFrame);
+extern int Sark_Exchange_Bulk (int16 num, T_SARK_FRAME *ptFrame, uint8 *pu8Rx, int iAnswers);
+extern int Sark_Exchange_N (int16 num, T_SARK_FRAME *ptFrame, int iCount);
+extern bool Sark_Exchange_Pipelined (void);
 extern int Sark_Version (int16 num, uint16 *pu16Ver, uint8 *pu8FW);
 extern int Sark_Meas_Rx (int16 num, uint32 u32Freq, bool bCal, uint8 u8Samples, float *pfR, float *pfX, float *pfS21re, float *pfS21im);
+extern int Sark_Meas_Rx_N (int16 num, const uint32 *pu32Freq, int iCount, bool bCal, uint8 u8Samples, float *pfR, float *pfX);
 extern int Sark_Meas_Rx_Eff (int16 num, uint32 u32Freq, uint32 u32Step, bool bCal, uint8 u8Samples,
 	float *pfR1, float *pfX1,
 	float *pfR2, float *pfX2,
 	float *pfR3, float *pfX3,
 	float *pfR4, float *pfX4
 	);
+extern int Sark_Meas_Rx_Bulk (int16 num, uint32 u32Freq, uint32 u32Step, uint16 u16Points, bool bCal, uint8 u8Samples,
+	bool bFloat, float *pfR, float *pfX);
 extern int Sark_Meas_Vect (int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV,
 										   float *pfMagI, float *pfPhI );
 extern int Sark_Meas_RF (int16 num, uint32 u32Freq, float *pfMagV, float *pfPhV,
 										   float *pfMagI, float *pfPhI );
+extern int Sark_Meas_Vect_Thru_N (int16 num, const uint32 *pu32Freq, int iCount,
+	float *pfMagVout, float *pfPhVout, float *pfMagVin, float *pfPhVin);
 extern int Sark_Meas_Vect_Thru (int16 num, uint32 u32Freq, float *pfMagVout, float *pfPhVout,
 										   float *pfMagVin, float *pfPhVin );
 extern int Sark_Signal_Gen (int16 num, uint32 u32Freq, uint16 u16Level, uint8 u8Gain);
@@ -78,6 +102,18 @@ extern int Sark_GPIO (int16 num, uint8 u8Cmd, uint8 u8Port, uint8 u8In, uint8 *p
 extern int Sark_SetSetting (int16 num, uint8 u8Reg, uint8 u8Val);
 extern int Sark_GetSetting (int16 num, uint8 u8Reg, uint8 *pu8Val);
 
+/* Half float conversion used by the protocol */
+extern uint16 Float2Half (float value);
+extern float Half2Float (uint16 value);
+
+/* Little endian fields of the protocol frames */
+extern void Int2Buf (uint8 tu8Buf[4], uint32 u32Val);
+extern void Buf2Int (uint32 *pu32Val, const uint8 tu8Buf[4]);
+extern void Short2Buf (uint8 tu8Buf[2], uint16 u16Val);
+extern void Buf2Short (uint16 *pu16Val, const uint8 tu8Buf[2]);
+extern void Float2Buf (uint8 tu8Buf[4], float fVal);
+extern void Buf2Float (float *pfVal, const uint8 tu8Buf[4]);
+
 #endif	 /* __SARK_REM_CLIENT_H__ */
 
 /**
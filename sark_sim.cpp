@@ -0,0 +1,419 @@
+/**
+  ******************************************************************************
+  * @file    sark_sim.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Loopback device simulator
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include "sark_cmd_defs.h"
+#include "sark_rem_client.h"
+#include "sark_sim.h"
+#include "sark_cancel.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Timing of the answers */
+typedef enum
+{
+	SIM_INSTANT,			/* at once */
+	SIM_ORDERED,			/* after the measurement time; one request at a time */
+	SIM_TAGGED				/* after the measurement time; requests overlap */
+} T_SIM_MODE;
+
+/* Simulated device */
+typedef struct
+{
+	uint32 u32Noise;		/* noise generator state */
+	uint8 tu8Setting[8];	/* SETTING_xx registers */
+} T_SIM_DEV;
+
+/* Private define ------------------------------------------------------------*/
+#define SIM_PROTOCOL		SARK_PROTO_BULK	/* protocol version reported */
+#define SIM_FW				"SIM 1.0"
+#define SIM_VOLUME			"SIMULATOR"
+#define SIM_Z0				50.0f		/* source impedance */
+#define SIM_RES_FREQ		14.1e6		/* load resonance, shifted per device */
+#define SIM_RES_R			50.0f		/* load resistance at resonance */
+#define SIM_RES_Q			8.0			/* load quality factor */
+#define SIM_NOISE			0.2f		/* R and X noise with one sample (ohm) */
+#define SIM_THRU_DELAY		10e-9		/* thru path delay */
+#define SIM_THRU_GAIN		0.5f		/* thru path gain */
+#define SIM_RF_FREQ			7.1e6		/* carrier seen by the RF receiver */
+#define SIM_RF_FLOOR		1e-5f		/* RF receiver noise floor */
+#define SIM_SAMPLE_US		250			/* measurement time per sample and point */
+
+#define PI					3.14159265358979
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static T_SIM_DEV gtDev[SARK_MAX_DEVICES];
+static int16 gi16Devs = 0;
+static T_SIM_MODE geMode = SIM_INSTANT;
+static CRITICAL_SECTION gcsDev[SARK_MAX_DEVICES];	/* one per device */
+static bool bInitLock = FALSE;
+
+/* Private function prototypes -----------------------------------------------*/
+static int Serve (int16 num, uint8 *tx, uint8 *rx, int iAnswers);
+static int Answer (int16 num, uint8 *tx, uint8 *rx);
+static int AnswerBulk (int16 num, uint8 *tx, uint8 *rx, int iAnswers);
+static void LoadZ (int16 num, double dFreq, float *pfR, float *pfX);
+static float Noise (T_SIM_DEV *ptDev, uint8 u8Samples);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Opens simulated devices
+  *
+  *	Every device measures a series RLC load that resonates at SIM_RES_FREQ
+  *	plus 100 kHz per device number, with noise that falls with the number
+  *	of samples averaged.
+  *
+  *	Answers are given at once, unless a mode is selected: "ordered" waits
+  *	the measurement time of each request, SIM_SAMPLE_US per sample and
+  *	point, serving the requests of a device one at a time in order, as a
+  *	server with in-order frames; "tagged" waits the same time but lets the
+  *	requests of a device overlap, as a server with tagged frames.
+  *
+  * @param  iDevs		number of devices
+  * @param  pszMode		NULL or empty, "ordered" or "tagged"
+  * @retval
+  *			@li number of devices opened
+  *			@li -1: unknown mode
+  */
+int Sim_Open (int16 iDevs, const char *pszMode)
+{
+	int ii;
+
+	if (pszMode == NULL || *pszMode == 0)
+		geMode = SIM_INSTANT;
+	else if (strcmp(pszMode, "ordered") == 0)
+		geMode = SIM_ORDERED;
+	else if (strcmp(pszMode, "tagged") == 0)
+		geMode = SIM_TAGGED;
+	else
+		return -1;
+	if (bInitLock == FALSE)
+	{
+		for (ii = 0; ii < SARK_MAX_DEVICES; ii++)
+			InitializeCriticalSection(&gcsDev[ii]);
+		bInitLock = TRUE;
+	}
+	if (iDevs < 1)
+		iDevs = 1;
+	if (iDevs > SARK_MAX_DEVICES)
+		iDevs = SARK_MAX_DEVICES;
+	for (ii = 0; ii < iDevs; ii++)
+	{
+		memset(&gtDev[ii], 0, sizeof(T_SIM_DEV));
+		gtDev[ii].u32Noise = 0x12345678 + ii;
+	}
+	gi16Devs = iDevs;
+
+	return iDevs;
+}
+
+/**
+  * @brief Answers a request as a device would
+  *
+  * @param  num			device number (starting by zero)
+  * @param  tx			request
+  * @param  rx			answer
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: no such device
+  */
+int Sim_SendReceive (int16 num, uint8 *tx, uint8 *rx)
+{
+	return Serve(num, tx, rx, 1);
+}
+
+/**
+  * @brief Answers a request that takes several answer frames
+  *
+  *	Implements CMD_SARK_MEAS_RX_BULK. Requests that need more than iAnswers
+  *	frames, and any other request, are answered by a single frame.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  tx			request
+  * @param  rx			answers, SARKCMD_RX_SIZE bytes each
+  * @param  iAnswers	answer frames that fit in rx
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: no such device
+  */
+int Sim_SendReceiveBulk (int16 num, uint8 *tx, uint8 *rx, int iAnswers)
+{
+	return Serve(num, tx, rx, iAnswers);
+}
+
+/**
+  * @brief Answers a request with the timing of the mode
+  */
+static int Serve (int16 num, uint8 *tx, uint8 *rx, int iAnswers)
+{
+	DWORD dwTime;
+	int iSamples;
+
+	if (num < 0 || num >= gi16Devs)
+		return -1;
+	EnterCriticalSection(&gcsDev[num]);
+	if (tx[0] == CMD_SARK_MEAS_RX_BULK)
+		iSamples = AnswerBulk(num, tx, rx, iAnswers);
+	else
+		iSamples = Answer(num, tx, rx);
+	dwTime = (iSamples * SIM_SAMPLE_US + 999) / 1000;
+	if (geMode == SIM_ORDERED)
+		Sark_Cancel_Wait(NULL, dwTime);
+	LeaveCriticalSection(&gcsDev[num]);
+	if (geMode == SIM_TAGGED)
+		Sark_Cancel_Wait(NULL, dwTime);
+
+	return 1;
+}
+
+/**
+  * @brief Answers a single frame request
+  *
+  * @retval	samples measured, over all the points
+  */
+static int Answer (int16 num, uint8 *tx, uint8 *rx)
+{
+	T_SIM_DEV *ptDev = &gtDev[num];
+	double dFreq, dW;
+	float fR, fX, fMag, fPh, fDen;
+	uint32 u32Val;
+	uint8 u8Samples;
+	int iSamples = 0;
+	int ii;
+
+	memset(rx, 0, SARKCMD_RX_SIZE);
+	rx[0] = ANS_SARK_OK;
+	Buf2Int(&u32Val, &tx[1]);
+	dFreq = (double)u32Val;
+	u8Samples = tx[6] != 0 ? tx[6] : 1;
+
+	switch (tx[0])
+	{
+	case CMD_SARK_VERSION:
+		Short2Buf(&rx[1], SIM_PROTOCOL);
+		strcpy((char *)&rx[3], SIM_FW);
+		break;
+	case CMD_SARK_MEAS_RX:
+		iSamples = u8Samples;
+		LoadZ(num, dFreq, &fR, &fX);
+		Float2Buf(&rx[1], fR + Noise(ptDev, u8Samples));
+		Float2Buf(&rx[5], fX + Noise(ptDev, u8Samples));
+		break;
+	case CMD_SARK_MEAS_RX_EFF:
+		/* Four points, u32Step apart, as half floats */
+		iSamples = 4 * u8Samples;
+		Buf2Int(&u32Val, &tx[7]);
+		for (ii = 0; ii < 4; ii++)
+		{
+			LoadZ(num, dFreq + (double)ii * u32Val, &fR, &fX);
+			Short2Buf(&rx[1 + 4 * ii], Float2Half(fR + Noise(ptDev, u8Samples)));
+			Short2Buf(&rx[3 + 4 * ii], Float2Half(fX + Noise(ptDev, u8Samples)));
+		}
+		break;
+	case CMD_SARK_MEAS_VECTOR:
+		/* V and I across the load driven from SIM_Z0 */
+		iSamples = 1;
+		LoadZ(num, dFreq, &fR, &fX);
+		fDen = (fR + SIM_Z0) * (fR + SIM_Z0) + fX * fX;
+		fMag = 1.0f / sqrtf(fDen);
+		fPh = -atan2f(fX, fR + SIM_Z0);
+		Float2Buf(&rx[1], sqrtf(fR * fR + fX * fX) * fMag);
+		Float2Buf(&rx[5], atan2f(fX, fR) + fPh);
+		Float2Buf(&rx[9], fMag);
+		Float2Buf(&rx[13], fPh);
+		break;
+	case CMD_SARK_MEAS_VEC_THRU:
+		/* Delay line between the ports */
+		iSamples = 1;
+		dW = 2.0 * PI * dFreq;
+		Float2Buf(&rx[1], SIM_THRU_GAIN);
+		Float2Buf(&rx[5], (float)fmod(-dW * SIM_THRU_DELAY, 2.0 * PI));
+		Float2Buf(&rx[9], 1.0f);
+		Float2Buf(&rx[13], 0.0f);
+		break;
+	case CMD_SARK_MEAS_RF:
+		/* Noise floor plus one carrier, 10 kHz wide */
+		iSamples = 1;
+		fMag = SIM_RF_FLOOR * (1.0f + 0.5f * Noise(ptDev, 1));
+		if (fabs(dFreq - SIM_RF_FREQ) < 5e3)
+			fMag += 0.01f;
+		Float2Buf(&rx[1], fMag);
+		break;
+	case CMD_BATT_STAT:
+		rx[1] = 1;
+		Short2Buf(&rx[2], 4100);
+		break;
+	case CMD_DISK_INFO:
+		Int2Buf(&rx[1], 4096);
+		Int2Buf(&rx[5], 4000);
+		break;
+	case CMD_DISK_VOLUME:
+		strcpy((char *)&rx[1], SIM_VOLUME);
+		break;
+	case CMD_SET_SETTING:
+		if (tx[1] >= sizeof(ptDev->tu8Setting))
+			rx[0] = ANS_SARK_ERR;
+		else
+			ptDev->tu8Setting[tx[1]] = tx[2];
+		break;
+	case CMD_GET_SETTING:
+		if (tx[1] >= sizeof(ptDev->tu8Setting))
+			rx[0] = ANS_SARK_ERR;
+		else
+			rx[1] = ptDev->tu8Setting[tx[1]];
+		break;
+	case CMD_SARK_SIGNAL_GEN:
+	case CMD_BUZZER:
+	case CMD_GET_KEY:
+	case CMD_DEV_RST:
+	case CMD_GPIO:
+	case 0xff:				/* disconnection */
+		break;
+	default:
+		rx[0] = ANS_SARK_ERR;
+		break;
+	}
+
+	return iSamples;
+}
+
+/**
+  * @brief Answers CMD_SARK_MEAS_RX_BULK
+  *
+  *	Requests that need more than iAnswers frames are answered by an error.
+  *
+  * @retval	samples measured, over all the points
+  */
+static int AnswerBulk (int16 num, uint8 *tx, uint8 *rx, int iAnswers)
+{
+	T_SIM_DEV *ptDev;
+	uint8 *pu8Frame;
+	double dFreq, dStep;
+	float fR, fX;
+	uint32 u32Val;
+	uint16 u16Points;
+	uint8 u8Samples;
+	int iPer, iFrames;
+	int ii, jj, iPoint;
+
+	ptDev = &gtDev[num];
+	Buf2Int(&u32Val, &tx[1]);
+	dFreq = (double)u32Val;
+	u8Samples = tx[6] != 0 ? tx[6] : 1;
+	Buf2Int(&u32Val, &tx[7]);
+	dStep = (double)u32Val;
+	Buf2Short(&u16Points, &tx[11]);
+	iPer = tx[13] == BULK_FMT_FLOAT ? BULK_PER_FLOAT : BULK_PER_HALF;
+	iFrames = (u16Points + iPer - 1) / iPer;
+	if (tx[13] > BULK_FMT_FLOAT || iFrames == 0 || iFrames > iAnswers || iFrames > BULK_MAX_FRAMES)
+	{
+		memset(rx, 0, SARKCMD_RX_SIZE);
+		rx[0] = ANS_SARK_ERR;
+		return 0;
+	}
+
+	for (ii = 0; ii < iFrames; ii++)
+	{
+		pu8Frame = &rx[ii * SARKCMD_RX_SIZE];
+		memset(pu8Frame, 0, SARKCMD_RX_SIZE);
+		pu8Frame[0] = ANS_SARK_OK;
+		pu8Frame[1] = (uint8)ii;
+		for (jj = 0; jj < iPer; jj++)
+		{
+			iPoint = ii * iPer + jj;
+			if (iPoint >= u16Points)
+				break;
+			LoadZ(num, dFreq + iPoint * dStep, &fR, &fX);
+			fR += Noise(ptDev, u8Samples);
+			fX += Noise(ptDev, u8Samples);
+			if (iPer == BULK_PER_FLOAT)
+			{
+				Float2Buf(&pu8Frame[2 + 8 * jj], fR);
+				Float2Buf(&pu8Frame[6 + 8 * jj], fX);
+			}
+			else
+			{
+				Short2Buf(&pu8Frame[2 + 4 * jj], Float2Half(fR));
+				Short2Buf(&pu8Frame[4 + 4 * jj], Float2Half(fX));
+			}
+		}
+	}
+
+	return u16Points * u8Samples;
+}
+
+/**
+  * @brief Impedance of the simulated load
+  */
+static void LoadZ (int16 num, double dFreq, float *pfR, float *pfX)
+{
+	double dRes = SIM_RES_FREQ + 100e3 * num;
+	double dRatio;
+
+	if (dFreq <= 0.0)
+		dFreq = 1.0;
+	dRatio = dFreq / dRes - dRes / dFreq;
+	*pfR = SIM_RES_R;
+	*pfX = (float)(SIM_RES_R * SIM_RES_Q * dRatio);
+}
+
+/**
+  * @brief Zero mean noise reduced by averaging
+  */
+static float Noise (T_SIM_DEV *ptDev, uint8 u8Samples)
+{
+	float fSum = 0.0f;
+	int ii;
+
+	/* Sum of uniform values, close enough to gaussian */
+	for (ii = 0; ii < 4; ii++)
+	{
+		ptDev->u32Noise = ptDev->u32Noise * 1664525 + 1013904223;
+		fSum += (float)(ptDev->u32Noise >> 8) / (float)(1 << 24) - 0.5f;
+	}
+
+	return fSum * SIM_NOISE * 1.732f / sqrtf((float)u8Samples);
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,325 @@
+/**
+  ******************************************************************************
+  * @file    sark_spectrum.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Passive RF spectrum scanner
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <math.h>
+#include "sark_rem_client.h"
+#include "sark_spectrum.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Waterfall row; lVer is a sequence lock as in the monitor ring */
+typedef struct
+{
+	volatile LONG lVer;		/* 2*scan when published, odd while written */
+	float *pfLevel;
+} T_SPEC_ROW;
+
+struct sark_spectrum
+{
+	uint32 u32Start;		/* first frequency */
+	uint32 u32Step;			/* frequency step */
+	int iPoints;
+
+	/* Traces (dB), guarded by csTraces */
+	CRITICAL_SECTION csTraces;
+	float *pfLast;
+	float *pfPeak;
+	float *pfMin;
+	double *pdPowSum;		/* sum of linear power for the average */
+	uint32 u32AvgScans;		/* scans in the average and holds */
+	volatile LONG lReset;	/* reset requested */
+
+	/* Waterfall */
+	T_SPEC_ROW *ptRow;
+	int iRows;
+	volatile LONG lHead;	/* newest published scan; 0: none */
+
+	float *pfData;			/* storage of traces and rows */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define SPEC_MIN_LEVEL		1e-10f	/* floor before converting to dB */
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static void UpdateTraces (T_SARK_SPECTRUM *pSpec, const float *pfLevel);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Creates a spectrum scanner for a uniform band
+  *
+  * @param  u32Start	first frequency
+  * @param  u32Step		frequency step
+  * @param  iPoints		number of points
+  * @param  iRows		waterfall rows kept (>= 2)
+  * @retval
+  *			@li spectrum handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_SPECTRUM *Sark_Spectrum_Create (uint32 u32Start, uint32 u32Step, int iPoints, int iRows)
+{
+	T_SARK_SPECTRUM *pSpec;
+	int ii;
+
+	if (iPoints <= 0 || iRows < 2)
+		return NULL;
+	pSpec = (T_SARK_SPECTRUM *)calloc(1, sizeof(T_SARK_SPECTRUM));
+	if (pSpec == NULL)
+		return NULL;
+	InitializeCriticalSection(&pSpec->csTraces);
+	pSpec->u32Start = u32Start;
+	pSpec->u32Step = u32Step;
+	pSpec->iPoints = iPoints;
+	pSpec->iRows = iRows;
+	pSpec->ptRow = (T_SPEC_ROW *)calloc(iRows, sizeof(T_SPEC_ROW));
+	pSpec->pdPowSum = (double *)calloc(iPoints, sizeof(double));
+	pSpec->pfData = (float *)malloc((3 + iRows) * iPoints * sizeof(float));
+	if (pSpec->ptRow == NULL || pSpec->pdPowSum == NULL || pSpec->pfData == NULL)
+	{
+		Sark_Spectrum_Destroy(pSpec);
+		return NULL;
+	}
+	pSpec->pfLast = &pSpec->pfData[0];
+	pSpec->pfPeak = &pSpec->pfData[iPoints];
+	pSpec->pfMin = &pSpec->pfData[2 * iPoints];
+	for (ii = 0; ii < iRows; ii++)
+		pSpec->ptRow[ii].pfLevel = &pSpec->pfData[(3 + ii) * iPoints];
+
+	return pSpec;
+}
+
+/**
+  * @brief Releases a spectrum scanner
+  *
+  * @param  pSpec		spectrum handle
+  * @retval None
+  */
+void Sark_Spectrum_Destroy (T_SARK_SPECTRUM *pSpec)
+{
+	if (pSpec == NULL)
+		return;
+	DeleteCriticalSection(&pSpec->csTraces);
+	free(pSpec->pfData);
+	free(pSpec->pdPowSum);
+	free(pSpec->ptRow);
+	free(pSpec);
+}
+
+/**
+  * @brief Clears peak-hold, min-hold and average
+  *
+  *	May be called from any thread, takes effect at the end of the current scan.
+  *
+  * @param  pSpec		spectrum handle
+  * @retval None
+  */
+void Sark_Spectrum_Reset (T_SARK_SPECTRUM *pSpec)
+{
+	if (pSpec == NULL)
+		return;
+	InterlockedExchange(&pSpec->lReset, 1);
+}
+
+/**
+  * @brief Scans the band with the generator disabled
+  *
+  *	Each scan measures every point with Sark_Meas_RF, publishes the levels
+  *	as a new waterfall row and updates the traces. Levels are the voltage
+  *	magnitude in dB.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pSpec		spectrum handle
+  * @param  iScans		number of scans
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  */
+int Sark_Spectrum_Scan (int16 num, T_SARK_SPECTRUM *pSpec, int iScans)
+{
+	T_SPEC_ROW *ptRow;
+	uint32 u32Scan;
+	float fMagV, fPhV, fMagI, fPhI;
+	int ii, jj;
+	int rc;
+
+	if (pSpec == NULL || iScans <= 0)
+		return -3;
+
+	u32Scan = (uint32)pSpec->lHead;
+	for (jj = 0; jj < iScans; jj++)
+	{
+		u32Scan++;
+		ptRow = &pSpec->ptRow[u32Scan % pSpec->iRows];
+		InterlockedExchange(&ptRow->lVer, (LONG)(2 * u32Scan - 1));
+		for (ii = 0; ii < pSpec->iPoints; ii++)
+		{
+			rc = Sark_Meas_RF(num, pSpec->u32Start + ii * pSpec->u32Step, &fMagV, &fPhV, &fMagI, &fPhI);
+			if (rc < 0)
+				return rc;
+			if (fMagV < SPEC_MIN_LEVEL)
+				fMagV = SPEC_MIN_LEVEL;
+			ptRow->pfLevel[ii] = 20.0f * log10f(fMagV);
+		}
+		UpdateTraces(pSpec, ptRow->pfLevel);
+		InterlockedExchange(&ptRow->lVer, (LONG)(2 * u32Scan));
+		InterlockedExchange(&pSpec->lHead, (LONG)u32Scan);
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Reads the traces
+  *
+  * @param  pSpec		spectrum handle
+  * @param  pfLast		return last scan (dB), may be NULL
+  * @param  pfPeak		return peak-hold (dB), may be NULL
+  * @param  pfMin		return min-hold (dB), may be NULL
+  * @param  pfAvg		return power average (dB), may be NULL
+  * @param  pu32Scans	return number of the newest scan, may be NULL
+  * @retval
+  *			@li 1: Ok
+  *			@li 0: no scan completed since the last reset
+  *			@li -3: invalid parameters
+  */
+int Sark_Spectrum_Traces (T_SARK_SPECTRUM *pSpec, float *pfLast, float *pfPeak, float *pfMin, float *pfAvg, uint32 *pu32Scans)
+{
+	int ii;
+
+	if (pSpec == NULL)
+		return -3;
+	EnterCriticalSection(&pSpec->csTraces);
+	if (pSpec->u32AvgScans == 0)
+	{
+		LeaveCriticalSection(&pSpec->csTraces);
+		return 0;
+	}
+	if (pfLast != NULL)
+		memcpy(pfLast, pSpec->pfLast, pSpec->iPoints * sizeof(float));
+	if (pfPeak != NULL)
+		memcpy(pfPeak, pSpec->pfPeak, pSpec->iPoints * sizeof(float));
+	if (pfMin != NULL)
+		memcpy(pfMin, pSpec->pfMin, pSpec->iPoints * sizeof(float));
+	if (pfAvg != NULL)
+	{
+		for (ii = 0; ii < pSpec->iPoints; ii++)
+			pfAvg[ii] = (float)(10.0 * log10(pSpec->pdPowSum[ii] / pSpec->u32AvgScans));
+	}
+	if (pu32Scans != NULL)
+		*pu32Scans = (uint32)pSpec->lHead;
+	LeaveCriticalSection(&pSpec->csTraces);
+
+	return 1;
+}
+
+/**
+  * @brief Reads a waterfall row
+  *
+  *	Rows from newest-(iRows-2) to newest are normally available.
+  *
+  * @param  pSpec		spectrum handle
+  * @param  u32Scan		scan number; 0 for the newest
+  * @param  pfLevel		return levels (dB), one per point
+  * @retval
+  *			@li 1: Ok
+  *			@li 0: scan not completed yet
+  *			@li -3: invalid parameters
+  *			@li -4: row overwritten
+  */
+int Sark_Spectrum_Waterfall (T_SARK_SPECTRUM *pSpec, uint32 u32Scan, float *pfLevel)
+{
+	T_SPEC_ROW *ptRow;
+	LONG lVer;
+
+	if (pSpec == NULL || pfLevel == NULL)
+		return -3;
+	if (u32Scan == 0)
+		u32Scan = (uint32)pSpec->lHead;
+	if (u32Scan == 0 || u32Scan > (uint32)pSpec->lHead)
+		return 0;
+	ptRow = &pSpec->ptRow[u32Scan % pSpec->iRows];
+	lVer = (LONG)(2 * u32Scan);
+	if (ptRow->lVer != lVer)
+		return -4;
+	MemoryBarrier();
+	memcpy(pfLevel, ptRow->pfLevel, pSpec->iPoints * sizeof(float));
+	MemoryBarrier();
+	if (ptRow->lVer != lVer)
+		return -4;
+
+	return 1;
+}
+
+/**
+  * @brief Adds a completed scan to the traces
+  */
+static void UpdateTraces (T_SARK_SPECTRUM *pSpec, const float *pfLevel)
+{
+	int ii;
+
+	EnterCriticalSection(&pSpec->csTraces);
+	if (InterlockedExchange(&pSpec->lReset, 0))
+		pSpec->u32AvgScans = 0;
+	if (pSpec->u32AvgScans == 0)
+	{
+		memcpy(pSpec->pfPeak, pfLevel, pSpec->iPoints * sizeof(float));
+		memcpy(pSpec->pfMin, pfLevel, pSpec->iPoints * sizeof(float));
+		memset(pSpec->pdPowSum, 0, pSpec->iPoints * sizeof(double));
+	}
+	for (ii = 0; ii < pSpec->iPoints; ii++)
+	{
+		if (pfLevel[ii] > pSpec->pfPeak[ii])
+			pSpec->pfPeak[ii] = pfLevel[ii];
+		if (pfLevel[ii] < pSpec->pfMin[ii])
+			pSpec->pfMin[ii] = pfLevel[ii];
+		pSpec->pdPowSum[ii] += pow(10.0, pfLevel[ii] / 10.0);
+	}
+	memcpy(pSpec->pfLast, pfLevel, pSpec->iPoints * sizeof(float));
+	pSpec->u32AvgScans++;
+	LeaveCriticalSection(&pSpec->csTraces);
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file    sark_spectrum.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Passive RF spectrum scanner
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_SPECTRUM_H__
+#define __SARK_SPECTRUM_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_spectrum T_SARK_SPECTRUM;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_SPECTRUM *Sark_Spectrum_Create (uint32 u32Start, uint32 u32Step, int iPoints, int iRows);
+extern void Sark_Spectrum_Destroy (T_SARK_SPECTRUM *pSpec);
+extern void Sark_Spectrum_Reset (T_SARK_SPECTRUM *pSpec);
+extern int Sark_Spectrum_Scan (int16 num, T_SARK_SPECTRUM *pSpec, int iScans);
+extern int Sark_Spectrum_Traces (T_SARK_SPECTRUM *pSpec, float *pfLast, float *pfPeak, float *pfMin, float *pfAvg, uint32 *pu32Scans);
+extern int Sark_Spectrum_Waterfall (T_SARK_SPECTRUM *pSpec, uint32 u32Scan, float *pfLevel);
+
+#endif	 /* __SARK_SPECTRUM_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,312 @@
+/**
+  ******************************************************************************
+  * @file    sark_split.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Sweeps split across several devices
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include "sark_rem_client.h"
+#include "sark_split.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Sub-band measured by one device */
+typedef struct
+{
+	int16 num;				/* device number */
+	T_SARK_SWEEP *pSweep;	/* sub-band sweep */
+	int iFirst;				/* first point in the logical sweep */
+	int iPoints;
+	float *pfOffR;			/* calibration offsets, NULL if none */
+	float *pfOffX;
+	float *pfR;				/* output of the current run */
+	float *pfX;
+	int iRc;				/* result of the current run */
+	LONGLONG llExchange;	/* ticks waiting for answers in the current run */
+	LONGLONG llProbe;		/* part of llExchange probing adaptive averaging */
+	CRITICAL_SECTION *pcsProgress;	/* one progress call at a time */
+} T_SPLIT_PART;
+
+struct sark_split
+{
+	int iPoints;			/* points of the logical sweep */
+	int iParts;
+	T_SPLIT_PART *ptPart;
+	HANDLE *phThread;
+	T_SARK_TIMING *ptTiming;	/* timing of the logical sweep; NULL if not requested */
+	CRITICAL_SECTION csProgress;	/* one progress call at a time */
+};
+
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static DWORD WINAPI PartThread (LPVOID lpParam);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Splits a sweep in contiguous sub-bands, one per device
+  *
+  *	Each sub-band is a slice of the sweep (Sark_Sweep_Slice), so runs of
+  *	the split follow the cancellation token, progress and timing the sweep
+  *	had when the split was created, with points numbered in the sweep.
+  *
+  * @param  pSweep		logical sweep (settings and frequencies are copied)
+  * @param  pi16Dev		device numbers, all different
+  * @param  iDevs		number of devices
+  * @retval
+  *			@li split handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_SPLIT *Sark_Split_Create (T_SARK_SWEEP *pSweep, const int16 *pi16Dev, int iDevs)
+{
+	T_SARK_SPLIT *pSplit;
+	T_SPLIT_PART *ptPart;
+	int iPoints;
+	int iFirst = 0;
+	int ii, jj;
+
+	iPoints = Sark_Sweep_Points(pSweep);
+	if (iPoints <= 0 || pi16Dev == NULL || iDevs <= 0 || iDevs > SARK_MAX_DEVICES || iDevs > iPoints)
+		return NULL;
+	/* A device measures one sub-band at a time */
+	for (ii = 0; ii < iDevs; ii++)
+	{
+		for (jj = 0; jj < ii; jj++)
+		{
+			if (pi16Dev[jj] == pi16Dev[ii])
+				return NULL;
+		}
+	}
+	pSplit = (T_SARK_SPLIT *)calloc(1, sizeof(T_SARK_SPLIT));
+	if (pSplit == NULL)
+		return NULL;
+	InitializeCriticalSection(&pSplit->csProgress);
+	pSplit->ptPart = (T_SPLIT_PART *)calloc(iDevs, sizeof(T_SPLIT_PART));
+	pSplit->phThread = (HANDLE *)calloc(iDevs, sizeof(HANDLE));
+	if (pSplit->ptPart == NULL || pSplit->phThread == NULL)
+	{
+		Sark_Split_Destroy(pSplit);
+		return NULL;
+	}
+	pSplit->iPoints = iPoints;
+	pSplit->iParts = iDevs;
+	pSplit->ptTiming = Sark_Sweep_GetTiming(pSweep);
+	for (ii = 0; ii < iDevs; ii++)
+	{
+		ptPart = &pSplit->ptPart[ii];
+		ptPart->num = pi16Dev[ii];
+		ptPart->pcsProgress = &pSplit->csProgress;
+		ptPart->iFirst = iFirst;
+		ptPart->iPoints = iPoints * (ii + 1) / iDevs - iFirst;
+		ptPart->pSweep = Sark_Sweep_Slice(pSweep, iFirst, ptPart->iPoints);
+		if (ptPart->pSweep == NULL)
+		{
+			Sark_Split_Destroy(pSplit);
+			return NULL;
+		}
+		iFirst += ptPart->iPoints;
+	}
+
+	return pSplit;
+}
+
+/**
+  * @brief Releases a split sweep
+  *
+  * @param  pSplit		split handle
+  * @retval None
+  */
+void Sark_Split_Destroy (T_SARK_SPLIT *pSplit)
+{
+	int ii;
+
+	if (pSplit == NULL)
+		return;
+	if (pSplit->ptPart != NULL)
+	{
+		for (ii = 0; ii < pSplit->iParts; ii++)
+		{
+			Sark_Sweep_Destroy(pSplit->ptPart[ii].pSweep);
+			free(pSplit->ptPart[ii].pfOffR);
+		}
+	}
+	free(pSplit->phThread);
+	free(pSplit->ptPart);
+	DeleteCriticalSection(&pSplit->csProgress);
+	free(pSplit);
+}
+
+/**
+  * @brief Sets the calibration offsets of a device
+  *
+  *	Offsets are added to the R and X measured by the device. They are given
+  *	for every point of the logical sweep; only the points of the sub-band
+  *	assigned to the device are used.
+  *
+  * @param  pSplit		split handle
+  * @param  num			device number
+  * @param  pfR			R offsets, one per point; NULL clears the offsets
+  * @param  pfX			X offsets, one per point
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters, device not in the split or out of memory
+  */
+int Sark_Split_SetOffset (T_SARK_SPLIT *pSplit, int16 num, const float *pfR, const float *pfX)
+{
+	T_SPLIT_PART *ptPart = NULL;
+	int ii;
+
+	if (pSplit == NULL)
+		return -3;
+	for (ii = 0; ii < pSplit->iParts; ii++)
+	{
+		if (pSplit->ptPart[ii].num == num)
+			ptPart = &pSplit->ptPart[ii];
+	}
+	if (ptPart == NULL)
+		return -3;
+	free(ptPart->pfOffR);
+	ptPart->pfOffR = ptPart->pfOffX = NULL;
+	if (pfR == NULL)
+		return 1;
+	if (pfX == NULL)
+		return -3;
+	ptPart->pfOffR = (float *)malloc(2 * ptPart->iPoints * sizeof(float));
+	if (ptPart->pfOffR == NULL)
+		return -3;
+	ptPart->pfOffX = &ptPart->pfOffR[ptPart->iPoints];
+	memcpy(ptPart->pfOffR, &pfR[ptPart->iFirst], ptPart->iPoints * sizeof(float));
+	memcpy(ptPart->pfOffX, &pfX[ptPart->iFirst], ptPart->iPoints * sizeof(float));
+
+	return 1;
+}
+
+/**
+  * @brief Runs the sub-bands in parallel and stitches the results
+  *
+  *	Every device writes straight into its range of the output arrays.
+  *	Progress calls come from the threads of the devices, one at a time,
+  *	before the calibration offsets are added. The timing phases add up
+  *	the waits of all the devices.
+  *
+  * @param  pSplit		split handle
+  * @param  pfR			return R (real Z), one per point of the logical sweep
+  * @param  pfX			return X (imag Z), one per point of the logical sweep
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  *			@li SARK_CANCELLED: cancelled or deadline passed; points not
+  *				measured are NaN
+  */
+int Sark_Split_Run (T_SARK_SPLIT *pSplit, float *pfR, float *pfX)
+{
+	T_SPLIT_PART *ptPart;
+	LONGLONG llExchange = 0, llProbe = 0;
+	int iThreads = 0;
+	int rc = 1;
+	int ii;
+
+	if (pSplit == NULL || pfR == NULL || pfX == NULL)
+		return -3;
+	Sark_Timing_Begin(pSplit->ptTiming);
+	for (ii = 0; ii < pSplit->iParts; ii++)
+	{
+		ptPart = &pSplit->ptPart[ii];
+		ptPart->pfR = &pfR[ptPart->iFirst];
+		ptPart->pfX = &pfX[ptPart->iFirst];
+		/* The last sub-band runs on the calling thread */
+		if (ii < pSplit->iParts - 1)
+		{
+			pSplit->phThread[iThreads] = CreateThread(NULL, 0, PartThread, ptPart, 0, NULL);
+			if (pSplit->phThread[iThreads] != NULL)
+			{
+				iThreads++;
+				continue;
+			}
+		}
+		PartThread(ptPart);
+	}
+	if (iThreads > 0)
+		WaitForMultipleObjects(iThreads, pSplit->phThread, TRUE, INFINITE);
+	for (ii = 0; ii < iThreads; ii++)
+		CloseHandle(pSplit->phThread[ii]);
+	for (ii = 0; ii < pSplit->iParts; ii++)
+	{
+		llExchange += pSplit->ptPart[ii].llExchange;
+		llProbe += pSplit->ptPart[ii].llProbe;
+	}
+	Sark_Timing_End(pSplit->ptTiming, llExchange, llProbe);
+
+	for (ii = 0; ii < pSplit->iParts; ii++)
+	{
+		if (pSplit->ptPart[ii].iRc == SARK_CANCELLED)
+			return SARK_CANCELLED;
+		if (pSplit->ptPart[ii].iRc < 0 && rc > 0)
+			rc = pSplit->ptPart[ii].iRc;
+	}
+
+	return rc;
+}
+
+/**
+  * @brief Measures one sub-band
+  */
+static DWORD WINAPI PartThread (LPVOID lpParam)
+{
+	T_SPLIT_PART *ptPart = (T_SPLIT_PART *)lpParam;
+	int ii;
+
+	ptPart->iRc = Sark_Sweep_RunPart(ptPart->num, ptPart->pSweep, ptPart->pfR, ptPart->pfX, ptPart->pcsProgress,
+		&ptPart->llExchange, &ptPart->llProbe);
+	if (ptPart->iRc >= 0 && ptPart->pfOffR != NULL)
+	{
+		for (ii = 0; ii < ptPart->iPoints; ii++)
+		{
+			ptPart->pfR[ii] += ptPart->pfOffR[ii];
+			ptPart->pfX[ii] += ptPart->pfOffX[ii];
+		}
+	}
+
+	return 0;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    sark_split.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Sweeps split across several devices
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_SPLIT_H__
+#define __SARK_SPLIT_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+#include "sark_sweep.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_split T_SARK_SPLIT;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_SPLIT *Sark_Split_Create (T_SARK_SWEEP *pSweep, const int16 *pi16Dev, int iDevs);
+extern void Sark_Split_Destroy (T_SARK_SPLIT *pSplit);
+extern int Sark_Split_SetOffset (T_SARK_SPLIT *pSplit, int16 num, const float *pfR, const float *pfX);
+extern int Sark_Split_Run (T_SARK_SPLIT *pSplit, float *pfR, float *pfX);
+
+#endif	 /* __SARK_SPLIT_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,611 @@
+/**
+  ******************************************************************************
+  * @file    sark_sweep.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Frequency sweeps
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <math.h>
+#include "sark_rem_client.h"
+#include "sark_sweep.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Averaging state learned for a group of consecutive points */
+typedef struct
+{
+	uint8 u8Samples;		/* samples used for the points of the region */
+	bool bLearned;			/* TRUE once the region noise has been probed */
+	float fNoise;			/* last measured noise (ohms) at u8Samples */
+} T_ADAPT_REGION;
+
+struct sark_sweep
+{
+	uint32 *pu32Freq;		/* frequency list */
+	int iPoints;			/* number of points */
+	bool bCal;				/* OSL calibrated measurement */
+	uint8 u8Samples;		/* samples when not adaptive */
+
+	/* Adaptive averaging */
+	bool bAdaptive;
+	float fNoise;			/* target noise floor (ohms) */
+	uint8 u8MinSamples;
+	uint8 u8MaxSamples;
+	int iRegionPoints;		/* points per region */
+	int iRegions;
+	int iNextProbe;			/* learned region to re-probe in next run */
+	T_ADAPT_REGION *ptRegion;
+
+	T_SARK_TIMING *ptTiming;	/* filled by every run; NULL if not requested */
+	T_SARK_CANCEL *ptCancel;	/* token of every run; NULL if none */
+	T_SARK_PROGRESS tProgress;	/* progress reported by every run */
+	int iBase;				/* first point of a slice in its source sweep, 0 if none */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define ADAPT_PROBE_READS	4		/* repeated readings used to estimate noise */
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static int RunPoints (int16 num, T_SARK_SWEEP *pSweep, float *pfR, float *pfX, T_PROGRESS_RUN *ptProgress,
+	LONGLONG *pllExchange, LONGLONG *pllProbe);
+static int ProbeRegion (int16 num, T_SARK_SWEEP *pSweep, T_ADAPT_REGION *ptRegion, int iPoint, float *pfR, float *pfX);
+static uint8 RegionSamples (T_SARK_SWEEP *pSweep, int iPoint);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Creates a sweep over a list of frequencies
+  *
+  * @param  pu32Freq	frequency list (copied)
+  * @param  iPoints		number of frequencies
+  * @param  bCal		{TRUE: OSL calibrated measurement; FALSE: not calibrated}
+  * @param  u8Samples	Number of samples to average
+  * @retval
+  *			@li sweep handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_SWEEP *Sark_Sweep_Create (const uint32 *pu32Freq, int iPoints, bool bCal, uint8 u8Samples)
+{
+	T_SARK_SWEEP *pSweep;
+
+	if (pu32Freq == NULL || iPoints <= 0)
+		return NULL;
+	pSweep = (T_SARK_SWEEP *)calloc(1, sizeof(T_SARK_SWEEP));
+	if (pSweep == NULL)
+		return NULL;
+	pSweep->pu32Freq = (uint32 *)malloc(iPoints * sizeof(uint32));
+	if (pSweep->pu32Freq == NULL)
+	{
+		free(pSweep);
+		return NULL;
+	}
+	memcpy(pSweep->pu32Freq, pu32Freq, iPoints * sizeof(uint32));
+	pSweep->iPoints = iPoints;
+	pSweep->bCal = bCal;
+	pSweep->u8Samples = u8Samples;
+
+	return pSweep;
+}
+
+/**
+  * @brief Creates a sweep over a range of points of another sweep
+  *
+  *	Settings, including adaptive averaging, the cancellation token, the
+  *	progress and the timing, are copied; learned samples are not. The
+  *	slice stamps and reports its points by their index in pSweep, so the
+  *	slices of a sweep can share its timing arrays and progress callback.
+  *
+  * @param  pSweep		source sweep
+  * @param  iFirst		first point
+  * @param  iPoints		number of points
+  * @retval
+  *			@li sweep handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_SWEEP *Sark_Sweep_Slice (T_SARK_SWEEP *pSweep, int iFirst, int iPoints)
+{
+	T_SARK_SWEEP *pSlice;
+
+	if (pSweep == NULL || iFirst < 0 || iPoints <= 0 || iFirst + iPoints > pSweep->iPoints)
+		return NULL;
+	pSlice = Sark_Sweep_Create(&pSweep->pu32Freq[iFirst], iPoints, pSweep->bCal, pSweep->u8Samples);
+	if (pSlice == NULL)
+		return NULL;
+	if (pSweep->bAdaptive &&
+		Sark_Sweep_Adaptive(pSlice, pSweep->fNoise, pSweep->u8MinSamples, pSweep->u8MaxSamples, pSweep->iRegionPoints) < 0)
+	{
+		Sark_Sweep_Destroy(pSlice);
+		return NULL;
+	}
+	pSlice->ptTiming = pSweep->ptTiming;
+	pSlice->ptCancel = pSweep->ptCancel;
+	pSlice->tProgress = pSweep->tProgress;
+	pSlice->iBase = pSweep->iBase + iFirst;
+
+	return pSlice;
+}
+
+/**
+  * @brief Releases a sweep
+  *
+  * @param  pSweep		sweep handle
+  * @retval None
+  */
+void Sark_Sweep_Destroy (T_SARK_SWEEP *pSweep)
+{
+	if (pSweep == NULL)
+		return;
+	free(pSweep->ptRegion);
+	free(pSweep->pu32Freq);
+	free(pSweep);
+}
+
+/**
+  * @brief Configures adaptive sample averaging
+  *
+  *	The sweep is split in regions of iRegionPoints consecutive points. The
+  *	first run probes each region with repeated readings, estimates the noise
+  *	and picks the number of samples that brings it down to fNoise. Learned
+  *	values are kept in the sweep and reused by later runs; one region is
+  *	re-probed per run to follow drift.
+  *
+  * @param  pSweep			sweep handle
+  * @param  fNoise			target noise floor in ohms; <= 0 disables adaptive mode
+  * @param  u8MinSamples	minimum number of samples
+  * @param  u8MaxSamples	maximum number of samples
+  * @param  iRegionPoints	points per region
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters or out of memory
+  */
+int Sark_Sweep_Adaptive (T_SARK_SWEEP *pSweep, float fNoise, uint8 u8MinSamples, uint8 u8MaxSamples, int iRegionPoints)
+{
+	int ii;
+
+	if (pSweep == NULL)
+		return -3;
+	free(pSweep->ptRegion);
+	pSweep->ptRegion = NULL;
+	pSweep->bAdaptive = FALSE;
+	if (!(fNoise > 0))
+		return 1;
+	if (u8MinSamples == 0 || u8MaxSamples < u8MinSamples || iRegionPoints <= 0)
+		return -3;
+
+	pSweep->iRegions = (pSweep->iPoints + iRegionPoints - 1) / iRegionPoints;
+	pSweep->ptRegion = (T_ADAPT_REGION *)calloc(pSweep->iRegions, sizeof(T_ADAPT_REGION));
+	if (pSweep->ptRegion == NULL)
+		return -3;
+	for (ii = 0; ii < pSweep->iRegions; ii++)
+		pSweep->ptRegion[ii].u8Samples = u8MinSamples;
+	pSweep->fNoise = fNoise;
+	pSweep->u8MinSamples = u8MinSamples;
+	pSweep->u8MaxSamples = u8MaxSamples;
+	pSweep->iRegionPoints = iRegionPoints;
+	pSweep->iNextProbe = 0;
+	pSweep->bAdaptive = TRUE;
+
+	return 1;
+}
+
+/**
+  * @brief Get the number of samples used for each point
+  *
+  * @param  pSweep		sweep handle
+  * @param  pu8Samples	return samples per point (iPoints entries)
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Sweep_GetSamples (T_SARK_SWEEP *pSweep, uint8 *pu8Samples)
+{
+	int ii;
+
+	if (pSweep == NULL || pu8Samples == NULL)
+		return -3;
+	for (ii = 0; ii < pSweep->iPoints; ii++)
+		pu8Samples[ii] = RegionSamples(pSweep, ii);
+	return 1;
+}
+
+/**
+  * @brief Get the frequency of each point
+  *
+  * @param  pSweep		sweep handle
+  * @param  pu32Freq	return frequencies (iPoints entries)
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Sweep_GetFreq (T_SARK_SWEEP *pSweep, uint32 *pu32Freq)
+{
+	if (pSweep == NULL || pu32Freq == NULL)
+		return -3;
+	memcpy(pu32Freq, pSweep->pu32Freq, pSweep->iPoints * sizeof(uint32));
+	return 1;
+}
+
+/**
+  * @brief Number of points of the sweep
+  *
+  * @param  pSweep		sweep handle
+  * @retval
+  *			@li >0: number of points
+  *			@li -3: invalid parameters
+  */
+int Sark_Sweep_Points (T_SARK_SWEEP *pSweep)
+{
+	if (pSweep == NULL)
+		return -3;
+	return pSweep->iPoints;
+}
+
+/**
+  * @brief Requests the timing of the runs of the sweep
+  *
+  *	Every later run stamps the points in the arrays of ptTiming and fills
+  *	its phases. Probed points take the send time of the first reading and
+  *	the answer time of the last one; the points of a batch of requests on
+  *	the network interfaces share its timestamps. The timing is written by
+  *	the thread running the sweep, which includes a monitor of the sweep.
+  *
+  * @param  pSweep		sweep handle
+  * @param  ptTiming	caller owned timing; NULL to stop timing
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Sweep_SetTiming (T_SARK_SWEEP *pSweep, T_SARK_TIMING *ptTiming)
+{
+	if (pSweep == NULL)
+		return -3;
+	pSweep->ptTiming = ptTiming;
+	return 1;
+}
+
+/**
+  * @brief Timing requested for the runs of the sweep
+  *
+  * @param  pSweep		sweep handle
+  * @retval caller owned timing; NULL if not requested
+  */
+T_SARK_TIMING *Sark_Sweep_GetTiming (T_SARK_SWEEP *pSweep)
+{
+	if (pSweep == NULL)
+		return NULL;
+	return pSweep->ptTiming;
+}
+
+/**
+  * @brief Attaches a cancellation token to the runs of the sweep
+  *
+  *	The token is checked before every point and ends the wait for the
+  *	answer in progress. A cancelled run returns SARK_CANCELLED with the
+  *	points not measured set to NaN.
+  *
+  * @param  pSweep		sweep handle
+  * @param  ptCancel	token handle; NULL to detach
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Sweep_SetCancel (T_SARK_SWEEP *pSweep, T_SARK_CANCEL *ptCancel)
+{
+	if (pSweep == NULL)
+		return -3;
+	pSweep->ptCancel = ptCancel;
+	return 1;
+}
+
+/**
+  * @brief Requests the progress of the runs of the sweep
+  *
+  *	pfCallback is called by the thread running the sweep, a monitor of the
+  *	sweep included, with the points newly measured, so partial traces can
+  *	be drawn. A call waits for both u32Ms since the previous call and
+  *	iPoints new points; the points left are reported when the run ends.
+  *
+  * @param  pSweep		sweep handle
+  * @param  pfCallback	callback; NULL to stop reporting
+  * @param  pvUser		given to pfCallback
+  * @param  u32Ms		minimum time between calls (ms); 0: no limit
+  * @param  iPoints		minimum points per call; 0: no limit
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Sweep_SetProgress (T_SARK_SWEEP *pSweep, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	if (pSweep == NULL)
+		return -3;
+	return Sark_Progress_Set(&pSweep->tProgress, pfCallback, pvUser, u32Ms, iPoints);
+}
+
+/**
+  * @brief Runs the sweep measuring R and X
+  *
+  *	On the network interfaces the points are requested SARK_EXCHANGE_MAX
+  *	at a time (Sark_Meas_Rx_N); a batch never spans two adaptive regions,
+  *	so its points share the samples of their region.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pSweep		sweep handle
+  * @param  pfR			return R (real Z), iPoints entries
+  * @param  pfX			return X (imag Z), iPoints entries
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  *			@li SARK_CANCELLED: cancelled or deadline passed
+  */
+int Sark_Sweep_Run (int16 num, T_SARK_SWEEP *pSweep, float *pfR, float *pfX)
+{
+	T_CANCEL_SCOPE tScope;
+	T_PROGRESS_RUN tProgress;
+	LONGLONG llExchange = 0, llProbe = 0;
+	int rc;
+
+	if (pSweep == NULL || pfR == NULL || pfX == NULL)
+		return -3;
+	Sark_Cancel_Enter(&tScope, pSweep->ptCancel);
+	Sark_Timing_Begin(pSweep->ptTiming);
+	Sark_Progress_Begin(&tProgress, &pSweep->tProgress, NULL);
+	rc = RunPoints(num, pSweep, pfR, pfX, &tProgress, &llExchange, &llProbe);
+	Sark_Timing_End(pSweep->ptTiming, llExchange + llProbe, llProbe);
+	Sark_Progress_Flush(&tProgress);
+	Sark_Cancel_Leave(&tScope);
+
+	return rc;
+}
+
+/**
+  * @brief Runs a slice alongside the other slices of its sweep
+  *
+  *	As Sark_Sweep_Run, but the phases of the shared timing are left to the
+  *	caller, which times the whole run and adds up the ticks of every slice.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pSlice		slice handle
+  * @param  pfR			return R (real Z), iPoints entries of the slice
+  * @param  pfX			return X (imag Z), iPoints entries of the slice
+  * @param  pcsProgress	serializes the progress calls of the slices
+  * @param  pllExchange	return ticks waiting for device answers, probes included
+  * @param  pllProbe	return ticks probing adaptive averaging
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  *			@li SARK_CANCELLED: cancelled or deadline passed
+  */
+int Sark_Sweep_RunPart (int16 num, T_SARK_SWEEP *pSlice, float *pfR, float *pfX, CRITICAL_SECTION *pcsProgress,
+	LONGLONG *pllExchange, LONGLONG *pllProbe)
+{
+	T_CANCEL_SCOPE tScope;
+	T_PROGRESS_RUN tProgress;
+	LONGLONG llExchange = 0, llProbe = 0;
+	int rc;
+
+	if (pSlice == NULL || pfR == NULL || pfX == NULL || pllExchange == NULL || pllProbe == NULL)
+		return -3;
+	Sark_Cancel_Enter(&tScope, pSlice->ptCancel);
+	Sark_Progress_Begin(&tProgress, &pSlice->tProgress, pcsProgress);
+	rc = RunPoints(num, pSlice, pfR, pfX, &tProgress, &llExchange, &llProbe);
+	Sark_Progress_Flush(&tProgress);
+	Sark_Cancel_Leave(&tScope);
+	*pllExchange = llExchange + llProbe;
+	*pllProbe = llProbe;
+
+	return rc;
+}
+
+/**
+  * @brief Measures the points of a sweep
+  *
+  *	Timestamps and progress are given by point index in the source sweep.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pSweep		sweep handle
+  * @param  pfR			return R (real Z), iPoints entries
+  * @param  pfX			return X (imag Z), iPoints entries
+  * @param  ptProgress	progress of the run
+  * @param  pllExchange	return ticks measuring, probes excluded
+  * @param  pllProbe	return ticks probing adaptive averaging
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li SARK_CANCELLED: cancelled or deadline passed
+  */
+static int RunPoints (int16 num, T_SARK_SWEEP *pSweep, float *pfR, float *pfX, T_PROGRESS_RUN *ptProgress,
+	LONGLONG *pllExchange, LONGLONG *pllProbe)
+{
+	T_ADAPT_REGION *ptRegion;
+	LONGLONG llSend, llRecv;
+	LONGLONG llExchange = 0, llProbe = 0;
+	int iProbe = -1;
+	int iBatch;
+	int iCount;
+	int iEnd;
+	int ii;
+	int rc = 1;
+
+	if (pSweep->bAdaptive)
+	{
+		/* Re-probe one already learned region per run, round robin */
+		iProbe = pSweep->iNextProbe;
+		pSweep->iNextProbe = (pSweep->iNextProbe + 1) % pSweep->iRegions;
+	}
+
+	iBatch = Sark_Exchange_Pipelined() ? SARK_EXCHANGE_MAX : 1;
+	for (ii = 0; ii < pSweep->iPoints; ii += iCount)
+	{
+		iCount = 1;
+		if (Sark_Cancel_Pending())
+		{
+			rc = SARK_CANCELLED;
+			break;
+		}
+		if (pSweep->bAdaptive && (ii % pSweep->iRegionPoints) == 0)
+		{
+			int iRegion = ii / pSweep->iRegionPoints;
+
+			ptRegion = &pSweep->ptRegion[iRegion];
+			if (!ptRegion->bLearned || iRegion == iProbe)
+			{
+				llSend = Sark_Timing_Now();
+				rc = ProbeRegion(num, pSweep, ptRegion, ii, &pfR[ii], &pfX[ii]);
+				llRecv = Sark_Timing_Now();
+				llProbe += llRecv - llSend;
+				if (rc < 0)
+					break;
+				Sark_Timing_Stamp(pSweep->ptTiming, pSweep->iBase + ii, 1, llSend, llRecv);
+				Sark_Progress_Done(ptProgress, pSweep->iBase + ii, 1);
+				continue;
+			}
+		}
+		iEnd = pSweep->iPoints;
+		if (pSweep->bAdaptive && iEnd > (ii / pSweep->iRegionPoints + 1) * pSweep->iRegionPoints)
+			iEnd = (ii / pSweep->iRegionPoints + 1) * pSweep->iRegionPoints;
+		iCount = iEnd - ii;
+		if (iCount > iBatch)
+			iCount = iBatch;
+		llSend = Sark_Timing_Now();
+		rc = Sark_Meas_Rx_N(num, &pSweep->pu32Freq[ii], iCount, pSweep->bCal, RegionSamples(pSweep, ii),
+			&pfR[ii], &pfX[ii]);
+		llRecv = Sark_Timing_Now();
+		llExchange += llRecv - llSend;
+		if (rc < 0)
+			break;
+		Sark_Timing_Stamp(pSweep->ptTiming, pSweep->iBase + ii, iCount, llSend, llRecv);
+		Sark_Progress_Done(ptProgress, pSweep->iBase + ii, iCount);
+	}
+	*pllExchange = llExchange;
+	*pllProbe = llProbe;
+	if (rc < 0 && Sark_Cancel_Pending())
+	{
+		rc = SARK_CANCELLED;
+		Sark_Cancel_Unmeasured(pfR, pfX, ii, pSweep->iPoints);
+	}
+
+	return rc < 0 ? rc : 1;
+}
+
+/**
+  * @brief Estimates the noise of a region and adjusts its samples
+  *
+  *	Takes ADAPT_PROBE_READS readings of the first point of the region.
+  *	Averaging n samples reduces the noise variance by n, so the samples
+  *	needed for the target are scaled by (noise/target)^2.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pSweep		sweep handle
+  * @param  ptRegion	region state
+  * @param  iPoint		point index of the probe
+  * @param  pfR			return mean R of the readings
+  * @param  pfX			return mean X of the readings
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  */
+static int ProbeRegion (int16 num, T_SARK_SWEEP *pSweep, T_ADAPT_REGION *ptRegion, int iPoint, float *pfR, float *pfX)
+{
+	float tfR[ADAPT_PROBE_READS];
+	float tfX[ADAPT_PROBE_READS];
+	float fS21re, fS21im;
+	double dMeanR = 0, dMeanX = 0;
+	double dVar = 0;
+	double dSamples;
+	uint8 u8Cur;
+	int ii;
+	int rc;
+
+	u8Cur = ptRegion->u8Samples;
+	for (ii = 0; ii < ADAPT_PROBE_READS; ii++)
+	{
+		rc = Sark_Meas_Rx(num, pSweep->pu32Freq[iPoint], pSweep->bCal, u8Cur,
+			&tfR[ii], &tfX[ii], &fS21re, &fS21im);
+		if (rc < 0)
+			return rc;
+		dMeanR += tfR[ii];
+		dMeanX += tfX[ii];
+	}
+	dMeanR /= ADAPT_PROBE_READS;
+	dMeanX /= ADAPT_PROBE_READS;
+	for (ii = 0; ii < ADAPT_PROBE_READS; ii++)
+	{
+		dVar += (tfR[ii] - dMeanR) * (tfR[ii] - dMeanR);
+		dVar += (tfX[ii] - dMeanX) * (tfX[ii] - dMeanX);
+	}
+	dVar /= (ADAPT_PROBE_READS - 1);
+	*pfR = (float)dMeanR;
+	*pfX = (float)dMeanX;
+
+	ptRegion->fNoise = (float)sqrt(dVar);
+	dSamples = ceil(u8Cur * dVar / ((double)pSweep->fNoise * pSweep->fNoise));
+	if (ptRegion->bLearned)
+		dSamples = ceil((dSamples + ptRegion->u8Samples) / 2);	/* smooth re-probes */
+	if (dSamples < pSweep->u8MinSamples)
+		dSamples = pSweep->u8MinSamples;
+	if (dSamples > pSweep->u8MaxSamples)
+		dSamples = pSweep->u8MaxSamples;
+	ptRegion->u8Samples = (uint8)dSamples;
+	ptRegion->bLearned = TRUE;
+
+	return 1;
+}
+
+/**
+  * @brief Samples to use for a given point
+  *
+  * @param  pSweep		sweep handle
+  * @param  iPoint		point index
+  * @retval number of samples
+  */
+static uint8 RegionSamples (T_SARK_SWEEP *pSweep, int iPoint)
+{
+	if (!pSweep->bAdaptive)
+		return pSweep->u8Samples;
+	return pSweep->ptRegion[iPoint / pSweep->iRegionPoints].u8Samples;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
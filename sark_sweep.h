@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file    sark_sweep.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Frequency sweeps
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_SWEEP_H__
+#define __SARK_SWEEP_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+#include "sark_timing.h"
+#include "sark_cancel.h"
+#include "sark_progress.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_sweep T_SARK_SWEEP;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_SWEEP *Sark_Sweep_Create (const uint32 *pu32Freq, int iPoints, bool bCal, uint8 u8Samples);
+extern T_SARK_SWEEP *Sark_Sweep_Slice (T_SARK_SWEEP *pSweep, int iFirst, int iPoints);
+extern void Sark_Sweep_Destroy (T_SARK_SWEEP *pSweep);
+extern int Sark_Sweep_Adaptive (T_SARK_SWEEP *pSweep, float fNoise, uint8 u8MinSamples, uint8 u8MaxSamples, int iRegionPoints);
+extern int Sark_Sweep_GetSamples (T_SARK_SWEEP *pSweep, uint8 *pu8Samples);
+extern int Sark_Sweep_GetFreq (T_SARK_SWEEP *pSweep, uint32 *pu32Freq);
+extern int Sark_Sweep_Points (T_SARK_SWEEP *pSweep);
+extern int Sark_Sweep_SetTiming (T_SARK_SWEEP *pSweep, T_SARK_TIMING *ptTiming);
+extern T_SARK_TIMING *Sark_Sweep_GetTiming (T_SARK_SWEEP *pSweep);
+extern int Sark_Sweep_SetCancel (T_SARK_SWEEP *pSweep, T_SARK_CANCEL *ptCancel);
+extern int Sark_Sweep_SetProgress (T_SARK_SWEEP *pSweep, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints);
+extern int Sark_Sweep_Run (int16 num, T_SARK_SWEEP *pSweep, float *pfR, float *pfX);
+extern int Sark_Sweep_RunPart (int16 num, T_SARK_SWEEP *pSlice, float *pfR, float *pfX, CRITICAL_SECTION *pcsProgress,
+	LONGLONG *pllExchange, LONGLONG *pllProbe);
+
+#endif	 /* __SARK_SWEEP_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
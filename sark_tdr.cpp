@@ -0,0 +1,289 @@
+/**
+  ******************************************************************************
+  * @file    sark_tdr.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Time domain reflectometry (distance to fault)
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <math.h>
+#include "sark_fft.h"
+#include "sark_tdr.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct sark_tdr
+{
+	int iPoints;			/* sweep points */
+	int iSize;				/* FFT size (output points) */
+	float fZ0;				/* reference impedance */
+	float fDistStep;		/* distance per output point (m) */
+	float fImpNorm;			/* impulse normalization (1/sum of window) */
+	const T_FFT_PLAN *ptPlan;
+	float *pfWinBp;			/* band-pass window, iPoints entries */
+	float *pfWinLp;			/* low-pass (half) window, iPoints entries */
+	float *pfRe;			/* FFT work buffers, iSize entries */
+	float *pfIm;
+	float *pfData;
+};
+
+/* Private define ------------------------------------------------------------*/
+#define TDR_C0				299792458.0		/* speed of light (m/s) */
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static float Window (uint8 u8Window, double dPos);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Creates a TDR processor for uniform sweeps
+  *
+  *	The FFT plan of iFftSize points is taken from a process wide cache, so
+  *	processors for the same size share twiddles and bit reversal tables.
+  *
+  * @param  iPoints		sweep points; more than 2 for TDR_WIN_HANN and TDR_WIN_BLACKMAN
+  * @param  u32Step		sweep frequency step (Hz)
+  * @param  iFftSize	FFT size, power of two > 2 * iPoints so that the step
+  *						response holds every point; 0 selects 4x zero padding
+  * @param  u8Window	TDR_WIN_RECT, TDR_WIN_HANN, TDR_WIN_HAMMING, TDR_WIN_BLACKMAN
+  * @param  fVf			velocity factor of the line
+  * @param  fZ0			reference impedance (ohms)
+  * @retval
+  *			@li tdr handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_TDR *Sark_Tdr_Create (int iPoints, uint32 u32Step, int iFftSize, uint8 u8Window, float fVf, float fZ0)
+{
+	T_SARK_TDR *pTdr;
+	double dSum = 0;
+	int ii;
+
+	if (iPoints < 2 || u32Step == 0 || fVf <= 0 || fZ0 <= 0 || u8Window > TDR_WIN_BLACKMAN)
+		return NULL;
+	if (iFftSize == 0)
+	{
+		for (iFftSize = 2; iFftSize < 4 * iPoints; iFftSize *= 2)
+			;
+	}
+	if (iFftSize <= 2 * iPoints)
+		return NULL;
+	pTdr = (T_SARK_TDR *)calloc(1, sizeof(T_SARK_TDR));
+	if (pTdr == NULL)
+		return NULL;
+	pTdr->ptPlan = Fft_Plan(iFftSize);
+	pTdr->pfData = (float *)malloc((2 * iPoints + 2 * iFftSize) * sizeof(float));
+	if (pTdr->ptPlan == NULL || pTdr->pfData == NULL)
+	{
+		Sark_Tdr_Destroy(pTdr);
+		return NULL;
+	}
+	pTdr->iPoints = iPoints;
+	pTdr->iSize = iFftSize;
+	pTdr->fZ0 = fZ0;
+	pTdr->pfWinBp = &pTdr->pfData[0];
+	pTdr->pfWinLp = &pTdr->pfData[iPoints];
+	pTdr->pfRe = &pTdr->pfData[2 * iPoints];
+	pTdr->pfIm = &pTdr->pfData[2 * iPoints + iFftSize];
+	for (ii = 0; ii < iPoints; ii++)
+	{
+		pTdr->pfWinBp[ii] = Window(u8Window, (double)ii / (iPoints - 1));
+		pTdr->pfWinLp[ii] = Window(u8Window, 0.5 + 0.5 * (ii + 1) / iPoints);
+		dSum += pTdr->pfWinBp[ii];
+	}
+	if (dSum <= 0)
+	{
+		/* Hann and Blackman are zero at both ends of two points */
+		Sark_Tdr_Destroy(pTdr);
+		return NULL;
+	}
+	pTdr->fImpNorm = (float)(1.0 / dSum);
+	/* Round trip: t = n / (N * df), d = c * vf * t / 2 */
+	pTdr->fDistStep = (float)(TDR_C0 * fVf / (2.0 * iFftSize * u32Step));
+
+	return pTdr;
+}
+
+/**
+  * @brief Releases a TDR processor
+  *
+  * @param  pTdr		tdr handle
+  * @retval None
+  */
+void Sark_Tdr_Destroy (T_SARK_TDR *pTdr)
+{
+	if (pTdr == NULL)
+		return;
+	free(pTdr->pfData);
+	free(pTdr);
+}
+
+/**
+  * @brief Number of output points (FFT size)
+  *
+  * @param  pTdr		tdr handle
+  * @retval
+  *			@li >0: output points
+  *			@li -3: invalid parameters
+  */
+int Sark_Tdr_Size (T_SARK_TDR *pTdr)
+{
+	if (pTdr == NULL)
+		return -3;
+	return pTdr->iSize;
+}
+
+/**
+  * @brief Converts a sweep to time domain
+  *
+  *	The reflection coefficient is computed from R and X and windowed.
+  *	The impulse response is the magnitude of the band-pass transform, valid
+  *	for any start frequency, and is 1.0 for a full reflection. The step
+  *	response uses the low-pass transform: the sweep must be harmonic (start
+  *	frequency equal to the step) and the DC term is extrapolated from the
+  *	first point.
+  *
+  * @param  pTdr		tdr handle
+  * @param  pfR			R (real Z), iPoints entries
+  * @param  pfX			X (imag Z), iPoints entries
+  * @param  pfDist		return distance (m), Sark_Tdr_Size entries, may be NULL
+  * @param  pfImpulse	return impulse response magnitude, may be NULL
+  * @param  pfStep		return step response, may be NULL
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Tdr_Process (T_SARK_TDR *pTdr, const float *pfR, const float *pfX, float *pfDist, float *pfImpulse, float *pfStep)
+{
+	float *pfRe, *pfIm;
+	float fDr, fDi, fD2;
+	float fNr, fNi;
+	double dAcc;
+	int iSize;
+	int ii;
+
+	if (pTdr == NULL || pfR == NULL || pfX == NULL)
+		return -3;
+	iSize = pTdr->iSize;
+	pfRe = pTdr->pfRe;
+	pfIm = pTdr->pfIm;
+
+	if (pfDist != NULL)
+	{
+		for (ii = 0; ii < iSize; ii++)
+			pfDist[ii] = ii * pTdr->fDistStep;
+	}
+
+	if (pfImpulse != NULL)
+	{
+		/* Gamma = (Z - Z0) / (Z + Z0), windowed, zero padded */
+		for (ii = 0; ii < pTdr->iPoints; ii++)
+		{
+			fNr = pfR[ii] - pTdr->fZ0;
+			fNi = pfX[ii];
+			fDr = pfR[ii] + pTdr->fZ0;
+			fDi = pfX[ii];
+			fD2 = fDr * fDr + fDi * fDi;
+			if (fD2 == 0)
+				fD2 = 1e-12f;
+			pfRe[ii] = pTdr->pfWinBp[ii] * (fNr * fDr + fNi * fDi) / fD2;
+			pfIm[ii] = pTdr->pfWinBp[ii] * (fNi * fDr - fNr * fDi) / fD2;
+		}
+		memset(&pfRe[pTdr->iPoints], 0, (iSize - pTdr->iPoints) * sizeof(float));
+		memset(&pfIm[pTdr->iPoints], 0, (iSize - pTdr->iPoints) * sizeof(float));
+		Fft_Transform(pTdr->ptPlan, pfRe, pfIm, TRUE);
+		for (ii = 0; ii < iSize; ii++)
+			pfImpulse[ii] = sqrtf(pfRe[ii] * pfRe[ii] + pfIm[ii] * pfIm[ii]) * pTdr->fImpNorm;
+	}
+
+	if (pfStep != NULL)
+	{
+		/* Hermitian spectrum on the harmonic grid: bins 1..P hold the sweep */
+		memset(pfRe, 0, iSize * sizeof(float));
+		memset(pfIm, 0, iSize * sizeof(float));
+		for (ii = 0; ii < pTdr->iPoints; ii++)
+		{
+			fNr = pfR[ii] - pTdr->fZ0;
+			fNi = pfX[ii];
+			fDr = pfR[ii] + pTdr->fZ0;
+			fDi = pfX[ii];
+			fD2 = fDr * fDr + fDi * fDi;
+			if (fD2 == 0)
+				fD2 = 1e-12f;
+			pfRe[ii + 1] = pTdr->pfWinLp[ii] * (fNr * fDr + fNi * fDi) / fD2;
+			pfIm[ii + 1] = pTdr->pfWinLp[ii] * (fNi * fDr - fNr * fDi) / fD2;
+			pfRe[iSize - ii - 1] = pfRe[ii + 1];
+			pfIm[iSize - ii - 1] = -pfIm[ii + 1];
+		}
+		pfRe[0] = pfRe[1];		/* DC extrapolated from the first point, real */
+		Fft_Transform(pTdr->ptPlan, pfRe, pfIm, TRUE);
+		dAcc = 0;
+		for (ii = 0; ii < iSize; ii++)
+		{
+			dAcc += pfRe[ii];
+			pfStep[ii] = (float)(dAcc / iSize);
+		}
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Window coefficient
+  *
+  * @param  u8Window	window type
+  * @param  dPos		position 0..1 across the window; 0.5 is the center
+  * @retval coefficient
+  */
+static float Window (uint8 u8Window, double dPos)
+{
+	double dX = M_PI * dPos;
+
+	switch (u8Window)
+	{
+	case TDR_WIN_HANN:
+		return (float)(0.5 - 0.5 * cos(2 * dX));
+	case TDR_WIN_HAMMING:
+		return (float)(0.54 - 0.46 * cos(2 * dX));
+	case TDR_WIN_BLACKMAN:
+		return (float)(0.42 - 0.5 * cos(2 * dX) + 0.08 * cos(4 * dX));
+	default:
+		return 1.0f;
+	}
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    sark_tdr.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Time domain reflectometry (distance to fault)
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_TDR_H__
+#define __SARK_TDR_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_tdr T_SARK_TDR;
+
+/* Exported constants --------------------------------------------------------*/
+/* Windows applied to the reflection coefficient */
+#define TDR_WIN_RECT		0
+#define TDR_WIN_HANN		1
+#define TDR_WIN_HAMMING		2
+#define TDR_WIN_BLACKMAN	3
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_TDR *Sark_Tdr_Create (int iPoints, uint32 u32Step, int iFftSize, uint8 u8Window, float fVf, float fZ0);
+extern void Sark_Tdr_Destroy (T_SARK_TDR *pTdr);
+extern int Sark_Tdr_Size (T_SARK_TDR *pTdr);
+extern int Sark_Tdr_Process (T_SARK_TDR *pTdr, const float *pfR, const float *pfX, float *pfDist, float *pfImpulse, float *pfStep);
+
+#endif	 /* __SARK_TDR_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
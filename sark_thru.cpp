@@ -0,0 +1,409 @@
+/**
+  ******************************************************************************
+  * @file    sark_thru.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Two-port transmission (S21) sweeps
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <math.h>
+#include "sark_rem_client.h"
+#include "sark_thru.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct sark_thru
+{
+	uint32 *pu32Freq;		/* frequency list */
+	int iPoints;
+	bool bRef;				/* reference available */
+
+	/* Arrays of iPoints, single allocation */
+	float *pfMagOut;		/* raw Vout */
+	float *pfPhOut;
+	float *pfMagIn;			/* raw Vin */
+	float *pfPhIn;
+	float *pfMag;			/* S21 linear magnitude */
+	float *pfPh;			/* S21 phase (rad) */
+	float *pfRefMag;		/* thru reference */
+	float *pfRefPh;
+	float *pfDelayK;		/* -1/(2*pi*df) for the group delay differences */
+	float *pfData;
+
+	T_SARK_CANCEL *ptCancel;	/* token of every measurement; NULL if none */
+	T_SARK_PROGRESS tProgress;	/* progress reported by every measurement */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define THRU_ARRAYS			9
+#define THRU_MIN_MAG		1e-12f
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static int MeasureS21 (int16 num, T_SARK_THRU *pThru);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Creates a thru sweep over a list of frequencies
+  *
+  * @param  pu32Freq	frequency list (copied), ascending
+  * @param  iPoints		number of frequencies
+  * @retval
+  *			@li thru handle
+  *			@li NULL: invalid parameters or out of memory
+  */
+T_SARK_THRU *Sark_Thru_Create (const uint32 *pu32Freq, int iPoints)
+{
+	T_SARK_THRU *pThru;
+	double dDf;
+	int iLo, iHi;
+	int ii;
+
+	if (pu32Freq == NULL || iPoints <= 0)
+		return NULL;
+	pThru = (T_SARK_THRU *)calloc(1, sizeof(T_SARK_THRU));
+	if (pThru == NULL)
+		return NULL;
+	pThru->pu32Freq = (uint32 *)malloc(iPoints * sizeof(uint32));
+	pThru->pfData = (float *)malloc(THRU_ARRAYS * iPoints * sizeof(float));
+	if (pThru->pu32Freq == NULL || pThru->pfData == NULL)
+	{
+		Sark_Thru_Destroy(pThru);
+		return NULL;
+	}
+	memcpy(pThru->pu32Freq, pu32Freq, iPoints * sizeof(uint32));
+	pThru->iPoints = iPoints;
+	pThru->pfMagOut = &pThru->pfData[0 * iPoints];
+	pThru->pfPhOut = &pThru->pfData[1 * iPoints];
+	pThru->pfMagIn = &pThru->pfData[2 * iPoints];
+	pThru->pfPhIn = &pThru->pfData[3 * iPoints];
+	pThru->pfMag = &pThru->pfData[4 * iPoints];
+	pThru->pfPh = &pThru->pfData[5 * iPoints];
+	pThru->pfRefMag = &pThru->pfData[6 * iPoints];
+	pThru->pfRefPh = &pThru->pfData[7 * iPoints];
+	pThru->pfDelayK = &pThru->pfData[8 * iPoints];
+
+	/* Central differences inside, one-sided at both ends */
+	for (ii = 0; ii < iPoints; ii++)
+	{
+		iLo = (ii > 0) ? ii - 1 : 0;
+		iHi = (ii < iPoints - 1) ? ii + 1 : iPoints - 1;
+		dDf = (double)pu32Freq[iHi] - (double)pu32Freq[iLo];
+		pThru->pfDelayK[ii] = (dDf != 0) ? (float)(-1.0 / (2 * M_PI * dDf)) : 0;
+	}
+
+	return pThru;
+}
+
+/**
+  * @brief Releases a thru sweep
+  *
+  * @param  pThru		thru handle
+  * @retval None
+  */
+void Sark_Thru_Destroy (T_SARK_THRU *pThru)
+{
+	if (pThru == NULL)
+		return;
+	free(pThru->pfData);
+	free(pThru->pu32Freq);
+	free(pThru);
+}
+
+/**
+  * @brief Measures and stores the thru reference
+  *
+  *	Connect the reference thru (cable without DUT) before calling. Later
+  *	runs are normalized against it. A failed or cancelled measurement
+  *	leaves no reference stored.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pThru		thru handle
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  *			@li SARK_CANCELLED: cancelled or deadline passed
+  */
+int Sark_Thru_Reference (int16 num, T_SARK_THRU *pThru)
+{
+	int rc;
+
+	if (pThru == NULL)
+		return -3;
+	pThru->bRef = FALSE;
+	rc = MeasureS21(num, pThru);
+	if (rc < 0)
+		return rc;
+	memcpy(pThru->pfRefMag, pThru->pfMag, pThru->iPoints * sizeof(float));
+	memcpy(pThru->pfRefPh, pThru->pfPh, pThru->iPoints * sizeof(float));
+	pThru->bRef = TRUE;
+
+	return 1;
+}
+
+/**
+  * @brief Reads the stored thru reference, e.g. to save it
+  *
+  * @param  pThru		thru handle
+  * @param  pfMag		return reference linear magnitude, one per point
+  * @param  pfPh		return reference phase (rad), one per point
+  * @retval
+  *			@li 1: Ok
+  *			@li 0: no reference stored
+  *			@li -3: invalid parameters
+  */
+int Sark_Thru_GetReference (T_SARK_THRU *pThru, float *pfMag, float *pfPh)
+{
+	if (pThru == NULL || pfMag == NULL || pfPh == NULL)
+		return -3;
+	if (!pThru->bRef)
+		return 0;
+	memcpy(pfMag, pThru->pfRefMag, pThru->iPoints * sizeof(float));
+	memcpy(pfPh, pThru->pfRefPh, pThru->iPoints * sizeof(float));
+	return 1;
+}
+
+/**
+  * @brief Loads a thru reference previously read with Sark_Thru_GetReference
+  *
+  * @param  pThru		thru handle
+  * @param  pfMag		reference linear magnitude, one per point; NULL clears it
+  * @param  pfPh		reference phase (rad), one per point
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Thru_SetReference (T_SARK_THRU *pThru, const float *pfMag, const float *pfPh)
+{
+	if (pThru == NULL)
+		return -3;
+	pThru->bRef = FALSE;
+	if (pfMag == NULL)
+		return 1;
+	if (pfPh == NULL)
+		return -3;
+	memcpy(pThru->pfRefMag, pfMag, pThru->iPoints * sizeof(float));
+	memcpy(pThru->pfRefPh, pfPh, pThru->iPoints * sizeof(float));
+	pThru->bRef = TRUE;
+	return 1;
+}
+
+/**
+  * @brief Attaches a cancellation token to the measurements of the thru
+  *
+  *	The token is checked before every request, or every batch of requests
+  *	on the network interfaces, and ends the wait for the answer in
+  *	progress. Outputs are not written by a cancelled run.
+  *
+  * @param  pThru		thru handle
+  * @param  ptCancel	token handle; NULL to detach
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Thru_SetCancel (T_SARK_THRU *pThru, T_SARK_CANCEL *ptCancel)
+{
+	if (pThru == NULL)
+		return -3;
+	pThru->ptCancel = ptCancel;
+	return 1;
+}
+
+/**
+  * @brief Requests the progress of the measurements of the thru
+  *
+  *	pfCallback is called by the thread measuring with the points newly
+  *	read, by runs and reference measurements alike. S21 and the group
+  *	delay are computed once all the points are read.
+  *
+  * @param  pThru		thru handle
+  * @param  pfCallback	callback; NULL to stop reporting
+  * @param  pvUser		given to pfCallback
+  * @param  u32Ms		minimum time between calls (ms); 0: no limit
+  * @param  iPoints		minimum points per call; 0: no limit
+  * @retval
+  *			@li 1: Ok
+  *			@li -3: invalid parameters
+  */
+int Sark_Thru_SetProgress (T_SARK_THRU *pThru, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints)
+{
+	if (pThru == NULL)
+		return -3;
+	return Sark_Progress_Set(&pThru->tProgress, pfCallback, pvUser, u32Ms, iPoints);
+}
+
+/**
+  * @brief Runs the thru sweep
+  *
+  *	S21 is Vout/Vin normalized by the reference if stored. The phase is
+  *	unwrapped along the sweep before differentiating, so the group delay is
+  *	-d(phase)/d(omega) without 2*pi jumps.
+  *
+  * @param  num			device number (starting by zero)
+  * @param  pThru		thru handle
+  * @param  pfMagDb		return S21 magnitude (dB), may be NULL
+  * @param  pfPhase		return S21 phase (degrees, -180..180), may be NULL
+  * @param  pfDelay		return group delay (s), may be NULL
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: comm error
+  *			@li -2: device answered error
+  *			@li -3: invalid parameters
+  *			@li SARK_CANCELLED: cancelled or deadline passed
+  */
+int Sark_Thru_Run (int16 num, T_SARK_THRU *pThru, float *pfMagDb, float *pfPhase, float *pfDelay)
+{
+	float *pfMag, *pfPh;
+	float *pfUnwrap;
+	float fStep;
+	int iPoints;
+	int ii;
+	int rc;
+
+	if (pThru == NULL)
+		return -3;
+	rc = MeasureS21(num, pThru);
+	if (rc < 0)
+		return rc;
+
+	iPoints = pThru->iPoints;
+	pfMag = pThru->pfMag;
+	pfPh = pThru->pfPh;
+	if (pThru->bRef)
+	{
+		for (ii = 0; ii < iPoints; ii++)
+		{
+			pfMag[ii] = pfMag[ii] / (pThru->pfRefMag[ii] + THRU_MIN_MAG);
+			pfPh[ii] = pfPh[ii] - pThru->pfRefPh[ii];
+		}
+	}
+
+	/* Wrap to -pi..pi */
+	for (ii = 0; ii < iPoints; ii++)
+		pfPh[ii] -= (float)(2 * M_PI) * floorf((pfPh[ii] + (float)M_PI) / (float)(2 * M_PI));
+
+	if (pfMagDb != NULL)
+	{
+		for (ii = 0; ii < iPoints; ii++)
+			pfMagDb[ii] = 20.0f * log10f(pfMag[ii] + THRU_MIN_MAG);
+	}
+	if (pfPhase != NULL)
+	{
+		for (ii = 0; ii < iPoints; ii++)
+			pfPhase[ii] = pfPh[ii] * (float)(180.0 / M_PI);
+	}
+	if (pfDelay != NULL)
+	{
+		/* Unwrap in place over the raw Vout phase buffer, no longer needed */
+		pfUnwrap = pThru->pfPhOut;
+		pfUnwrap[0] = pfPh[0];
+		for (ii = 1; ii < iPoints; ii++)
+		{
+			fStep = pfPh[ii] - pfPh[ii - 1];
+			fStep -= (float)(2 * M_PI) * floorf((fStep + (float)M_PI) / (float)(2 * M_PI));
+			pfUnwrap[ii] = pfUnwrap[ii - 1] + fStep;
+		}
+		if (iPoints == 1)
+			pfDelay[0] = 0;
+		else
+		{
+			for (ii = 0; ii < iPoints; ii++)
+			{
+				int iLo = (ii > 0) ? ii - 1 : 0;
+				int iHi = (ii < iPoints - 1) ? ii + 1 : iPoints - 1;
+				pfDelay[ii] = (pfUnwrap[iHi] - pfUnwrap[iLo]) * pThru->pfDelayK[ii];
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Measures all points and computes raw S21 = Vout/Vin
+  *
+  *	Readings are collected first into SoA buffers, then converted in a
+  *	single pass. On the network interfaces the points are requested
+  *	SARK_EXCHANGE_MAX at a time (Sark_Meas_Vect_Thru_N).
+  */
+static int MeasureS21 (int16 num, T_SARK_THRU *pThru)
+{
+	T_CANCEL_SCOPE tScope;
+	T_PROGRESS_RUN tProgress;
+	int iBatch;
+	int iCount;
+	int ii;
+	int rc = 1;
+
+	Sark_Cancel_Enter(&tScope, pThru->ptCancel);
+	Sark_Progress_Begin(&tProgress, &pThru->tProgress, NULL);
+	iBatch = Sark_Exchange_Pipelined() ? SARK_EXCHANGE_MAX : 1;
+	for (ii = 0; ii < pThru->iPoints; ii += iCount)
+	{
+		if (Sark_Cancel_Pending())
+		{
+			rc = SARK_CANCELLED;
+			break;
+		}
+		iCount = pThru->iPoints - ii;
+		if (iCount > iBatch)
+			iCount = iBatch;
+		rc = Sark_Meas_Vect_Thru_N(num, &pThru->pu32Freq[ii], iCount,
+			&pThru->pfMagOut[ii], &pThru->pfPhOut[ii], &pThru->pfMagIn[ii], &pThru->pfPhIn[ii]);
+		if (rc < 0)
+			break;
+		Sark_Progress_Done(&tProgress, ii, iCount);
+	}
+	if (rc < 0 && Sark_Cancel_Pending())
+		rc = SARK_CANCELLED;
+	Sark_Progress_Flush(&tProgress);
+	Sark_Cancel_Leave(&tScope);
+	if (rc < 0)
+		return rc;
+	for (ii = 0; ii < pThru->iPoints; ii++)
+	{
+		pThru->pfMag[ii] = pThru->pfMagOut[ii] / (pThru->pfMagIn[ii] + THRU_MIN_MAG);
+		pThru->pfPh[ii] = pThru->pfPhOut[ii] - pThru->pfPhIn[ii];
+	}
+
+	return 1;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
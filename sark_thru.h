@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    sark_thru.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Two-port transmission (S21) sweeps
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_THRU_H__
+#define __SARK_THRU_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+#include "sark_cancel.h"
+#include "sark_progress.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct sark_thru T_SARK_THRU;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern T_SARK_THRU *Sark_Thru_Create (const uint32 *pu32Freq, int iPoints);
+extern void Sark_Thru_Destroy (T_SARK_THRU *pThru);
+extern int Sark_Thru_Reference (int16 num, T_SARK_THRU *pThru);
+extern int Sark_Thru_GetReference (T_SARK_THRU *pThru, float *pfMag, float *pfPh);
+extern int Sark_Thru_SetReference (T_SARK_THRU *pThru, const float *pfMag, const float *pfPh);
+extern int Sark_Thru_SetCancel (T_SARK_THRU *pThru, T_SARK_CANCEL *ptCancel);
+extern int Sark_Thru_SetProgress (T_SARK_THRU *pThru, SARK_PROGRESS pfCallback, void *pvUser, uint32 u32Ms, int iPoints);
+extern int Sark_Thru_Run (int16 num, T_SARK_THRU *pThru, float *pfMagDb, float *pfPhase, float *pfDelay);
+
+#endif	 /* __SARK_THRU_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file    sark_timing.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Measurement timestamps and run timing
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sark_timing.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Reads the monotonic performance counter
+  *
+  * @param  None
+  * @retval counter ticks
+  */
+LONGLONG Sark_Timing_Now (void)
+{
+	LARGE_INTEGER liNow;
+
+	QueryPerformanceCounter(&liNow);
+	return liNow.QuadPart;
+}
+
+/**
+  * @brief Starts timing a run
+  *
+  * @param  ptTiming	timing of the run; NULL if not requested
+  * @retval None
+  */
+void Sark_Timing_Begin (T_SARK_TIMING *ptTiming)
+{
+	LARGE_INTEGER liFreq;
+
+	if (ptTiming == NULL)
+		return;
+	QueryPerformanceFrequency(&liFreq);
+	ptTiming->llFreq = liFreq.QuadPart;
+	ptTiming->dTotal = 0;
+	ptTiming->dExchange = 0;
+	ptTiming->dProbe = 0;
+	ptTiming->dHost = 0;
+	ptTiming->llStart = Sark_Timing_Now();
+}
+
+/**
+  * @brief Records the timestamps of points measured by one exchange
+  *
+  * @param  ptTiming	timing of the run; NULL if not requested
+  * @param  iFirst		first point
+  * @param  iCount		number of points
+  * @param  llSend		counter when the request was sent
+  * @param  llRecv		counter when the answer was received
+  * @retval None
+  */
+void Sark_Timing_Stamp (T_SARK_TIMING *ptTiming, int iFirst, int iCount, LONGLONG llSend, LONGLONG llRecv)
+{
+	int ii;
+
+	if (ptTiming == NULL)
+		return;
+	for (ii = iFirst; ii < iFirst + iCount && ii < ptTiming->iPoints; ii++)
+	{
+		if (ptTiming->pllSend != NULL)
+			ptTiming->pllSend[ii] = llSend;
+		if (ptTiming->pllRecv != NULL)
+			ptTiming->pllRecv[ii] = llRecv;
+	}
+}
+
+/**
+  * @brief Ends timing a run and fills its phases
+  *
+  * @param  ptTiming	timing of the run; NULL if not requested
+  * @param  llExchange	ticks waiting for device answers, probes included
+  * @param  llProbe		ticks probing adaptive averaging
+  * @retval None
+  */
+void Sark_Timing_End (T_SARK_TIMING *ptTiming, LONGLONG llExchange, LONGLONG llProbe)
+{
+	double dTickMs;
+
+	if (ptTiming == NULL)
+		return;
+	dTickMs = 1000.0 / (double)ptTiming->llFreq;
+	ptTiming->dTotal = (Sark_Timing_Now() - ptTiming->llStart) * dTickMs;
+	ptTiming->dExchange = llExchange * dTickMs;
+	ptTiming->dProbe = llProbe * dTickMs;
+	ptTiming->dHost = ptTiming->dTotal - ptTiming->dExchange;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file    sark_timing.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Measurement timestamps and run timing
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SARK_TIMING_H__
+#define __SARK_TIMING_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Timing of a run, in ticks of the monotonic performance counter
+   (QueryPerformanceCounter). The timestamp arrays are owned by the caller and
+   indexed by point or job; entries beyond iPoints are not written */
+typedef struct
+{
+	LONGLONG *pllSend;		/* counter when the request of every point was sent; may be NULL */
+	LONGLONG *pllRecv;		/* counter when the answer of every point was received; may be NULL */
+	int iPoints;			/* entries of pllSend and pllRecv */
+	LONGLONG llFreq;		/* return: counter ticks per second */
+	LONGLONG llStart;		/* return: counter at the start of the run */
+	double dTotal;			/* return: duration of the run (ms) */
+	double dExchange;		/* return: time waiting for device answers (ms) */
+	double dProbe;			/* return: part of dExchange spent probing adaptive averaging (ms) */
+	double dHost;			/* return: dTotal - dExchange; encoding, decoding and scheduling (ms) */
+} T_SARK_TIMING;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern LONGLONG Sark_Timing_Now (void);
+extern void Sark_Timing_Begin (T_SARK_TIMING *ptTiming);
+extern void Sark_Timing_Stamp (T_SARK_TIMING *ptTiming, int iFirst, int iCount, LONGLONG llSend, LONGLONG llRecv);
+extern void Sark_Timing_End (T_SARK_TIMING *ptTiming, LONGLONG llExchange, LONGLONG llProbe);
+
+#endif	 /* __SARK_TIMING_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,542 @@
+/**
+  ******************************************************************************
+  * @file    shm_cli.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Shared memory transport for a co-located server
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "shm_cli.h"
+#include "sark_cmd_defs.h"
+#include "sark_cancel.h"
+
+/* Private define ------------------------------------------------------------*/
+#define SHM_SLOTS			64			/* frames per ring, power of two */
+#define SHM_SPIN			4000		/* polls before sleeping on the event (multiprocessor) */
+#define SHM_TIMEOUT			2000		/* in ms */
+#define SHM_MAGIC			0x314D4853	/* "SHM1" */
+#define SHM_NAME_MAX		240
+#define CACHE_LINE			64
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* One frame; the server copies the sequence number of a request to its answer */
+typedef struct
+{
+	uint32 u32Seq;
+	uint8 tu8Frame[SARKCMD_TX_SIZE];	/* TX and RX frames have the same size */
+} T_SHM_SLOT;
+
+/* Single producer, single consumer ring */
+typedef struct
+{
+	volatile LONG lTail;	/* written by the producer */
+	uint8 tu8Pad1[CACHE_LINE - sizeof(LONG)];
+	volatile LONG lHead;	/* written by the consumer */
+	volatile LONG lWaiting;	/* consumer sleeping on the event */
+	uint8 tu8Pad2[CACHE_LINE - 2 * sizeof(LONG)];
+	T_SHM_SLOT tSlot[SHM_SLOTS];
+} T_SHM_RING;
+
+/* Shared memory area */
+typedef struct
+{
+	volatile LONG lMagic;	/* SHM_MAGIC once the server has set up the area */
+	volatile LONG lClient;	/* 1 while a client is attached */
+	uint8 tu8Pad[CACHE_LINE - 2 * sizeof(LONG)];
+	T_SHM_RING tReq;		/* client to server */
+	T_SHM_RING tAns;		/* server to client */
+} T_SHM_AREA;
+
+/* Client connection */
+typedef struct
+{
+	HANDLE hMap;
+	T_SHM_AREA *ptArea;
+	HANDLE hReq;			/* signaled when a request is queued */
+	HANDLE hAns;			/* signaled when an answer is queued */
+	uint32 u32Seq;			/* last request sent */
+	CRITICAL_SECTION csLock;
+} T_SHM_CONN;
+
+struct shm_server
+{
+	HANDLE hMap;
+	T_SHM_AREA *ptArea;
+	HANDLE hReq;
+	HANDLE hAns;
+};
+
+/* Private macro -------------------------------------------------------------*/
+/* External variables --------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static T_SHM_CONN gtConn[SHM_MAX_SERVERS];
+static int giServers = 0;
+static bool bInitLock = FALSE;
+static int giSpin = -1;			/* polls before sleeping; none on a single processor */
+
+/* Private function prototypes -----------------------------------------------*/
+static int Attach (T_SHM_CONN *ptConn, const char *pszName);
+static void Detach (T_SHM_CONN *ptConn);
+static bool RingPut (T_SHM_RING *ptRing, HANDLE hEvent, uint32 u32Seq, const uint8 *pu8Frame);
+static bool RingGet (T_SHM_RING *ptRing, HANDLE hEvent, uint32 *pu32Seq, uint8 *pu8Frame, DWORD dwTimeout);
+static HANDLE EventByName (const char *pszName, const char *pszSuffix, bool bCreate);
+static int SpinCount (void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Attaches to servers on the same host
+  *
+  *	Requests and answers go through two rings in a shared memory area
+  *	created by the server. A side only sleeps on an event when its ring is
+  *	empty and only signals the other side when it is sleeping, so frames
+  *	normally cross without any system call.
+  *
+  * @param	serverAddr	comma separated list of shared memory names
+  * @retval
+  *			@li >=1: 	number of servers
+  *			@li -1: 	invalid list
+  *			@li -2: 	server not found or busy with another client
+  */
+int Shm_Connect (char *serverAddr)
+{
+	char szName[SHM_NAME_MAX];
+	const char *pszItem;
+	int iLen;
+	int iResult = 1;
+	int ii;
+
+	if (serverAddr == NULL)
+		return -1;
+	if (bInitLock == FALSE)
+	{
+		for (ii = 0; ii < SHM_MAX_SERVERS; ii++)
+			InitializeCriticalSection(&gtConn[ii].csLock);
+		bInitLock = TRUE;
+	}
+	for (ii = 0; ii < giServers; ii++)
+		Shm_Close(ii);
+	giServers = 0;
+
+	for (pszItem = serverAddr; *pszItem != 0; pszItem += iLen)
+	{
+		if (*pszItem == ',')
+			pszItem++;
+		iLen = (int)strcspn(pszItem, ",");
+		if (iLen <= 0 || iLen >= SHM_NAME_MAX || giServers == SHM_MAX_SERVERS)
+		{
+			iResult = -1;
+			break;
+		}
+		memcpy(szName, pszItem, iLen);
+		szName[iLen] = 0;
+		iResult = Attach(&gtConn[giServers], szName);
+		if (iResult < 0)
+			break;
+		giServers++;
+	}
+	if (iResult < 0)
+	{
+		for (ii = 0; ii < giServers; ii++)
+			Shm_Close(ii);
+		giServers = 0;
+		return iResult;
+	}
+
+	return giServers;
+}
+
+/**
+  * @brief Detaches from a server
+  *
+  * @param  num		server number (starting by zero)
+  * @retval
+  *			@li 1: Ok
+  */
+int Shm_Close (int16 num)
+{
+	T_SHM_CONN *ptConn;
+	uint8 tx[SARKCMD_TX_SIZE];
+
+	if (bInitLock == FALSE || num < 0 || num >= giServers)
+		return 1;
+	ptConn = &gtConn[num];
+	EnterCriticalSection(&ptConn->csLock);
+	if (ptConn->ptArea != NULL)
+	{
+		/* Inform server about disconnection; no answer is awaited */
+		memset(tx, 0xff, SARKCMD_TX_SIZE);
+		RingPut(&ptConn->ptArea->tReq, ptConn->hReq, ++ptConn->u32Seq, tx);
+		Detach(ptConn);
+	}
+	LeaveCriticalSection(&ptConn->csLock);
+
+	return 1;
+}
+
+/**
+  * @brief Send receive
+  *
+  * @param  num			server number (starting by zero)
+  * @param  tx			request
+  * @param  rx			answer
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  *			@li -2: no answer
+  */
+int Shm_SendReceive (int16 num, uint8 *tx, uint8 *rx)
+{
+	return Shm_SendReceiveBulk(num, tx, rx, 1);
+}
+
+/**
+  * @brief Sends a request answered by several frames
+  *
+  *	The server sends every answer frame with the sequence number of the
+  *	request. Receiving stops after the first answer if it is not
+  *	ANS_SARK_OK, as an error is answered by a single frame.
+  *
+  * @param  num			server number (starting by zero)
+  * @param  tx			request
+  * @param  rx			answers, SARKCMD_RX_SIZE bytes each
+  * @param  iAnswers	number of answer frames
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  *			@li -2: no answer
+  */
+int Shm_SendReceiveBulk (int16 num, uint8 *tx, uint8 *rx, int iAnswers)
+{
+	T_SHM_CONN *ptConn;
+	uint32 u32Seq;
+	int iDone = 0;
+	int iResult = -2;
+
+	if (bInitLock == FALSE || num < 0 || num >= giServers || iAnswers <= 0)
+		return -1;
+	ptConn = &gtConn[num];
+	EnterCriticalSection(&ptConn->csLock);
+	if (ptConn->ptArea == NULL
+		|| !RingPut(&ptConn->ptArea->tReq, ptConn->hReq, ++ptConn->u32Seq, tx))
+	{
+		LeaveCriticalSection(&ptConn->csLock);
+		return -1;
+	}
+	/* Answers left by requests that timed out are skipped */
+	while (RingGet(&ptConn->ptArea->tAns, ptConn->hAns, &u32Seq, &rx[iDone * SARKCMD_RX_SIZE], SHM_TIMEOUT))
+	{
+		if (u32Seq != ptConn->u32Seq)
+			continue;
+		iDone++;
+		if (iDone == iAnswers || rx[0] != ANS_SARK_OK)
+		{
+			iResult = 1;
+			break;
+		}
+	}
+	LeaveCriticalSection(&ptConn->csLock);
+
+	return iResult;
+}
+
+/**
+  * @brief Creates the shared memory area of a server
+  *
+  * @param	pszName		shared memory name
+  * @retval
+  *			@li server handle
+  *			@li NULL: invalid name, name in use or out of resources
+  */
+T_SHM_SERVER *Shm_Server_Create (const char *pszName)
+{
+	T_SHM_SERVER *pSrv;
+
+	if (pszName == NULL || strlen(pszName) >= SHM_NAME_MAX - 8)
+		return NULL;
+	pSrv = (T_SHM_SERVER *)calloc(1, sizeof(T_SHM_SERVER));
+	if (pSrv == NULL)
+		return NULL;
+	pSrv->hMap = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(T_SHM_AREA), pszName);
+	if (pSrv->hMap == NULL || GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		Shm_Server_Destroy(pSrv);
+		return NULL;
+	}
+	pSrv->ptArea = (T_SHM_AREA *)MapViewOfFile(pSrv->hMap, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(T_SHM_AREA));
+	pSrv->hReq = EventByName(pszName, "_req", TRUE);
+	pSrv->hAns = EventByName(pszName, "_ans", TRUE);
+	if (pSrv->ptArea == NULL || pSrv->hReq == NULL || pSrv->hAns == NULL)
+	{
+		Shm_Server_Destroy(pSrv);
+		return NULL;
+	}
+	memset(pSrv->ptArea, 0, sizeof(T_SHM_AREA));
+	InterlockedExchange(&pSrv->ptArea->lMagic, SHM_MAGIC);
+
+	return pSrv;
+}
+
+/**
+  * @brief Releases the shared memory area of a server
+  *
+  * @param  pSrv		server handle
+  * @retval None
+  */
+void Shm_Server_Destroy (T_SHM_SERVER *pSrv)
+{
+	if (pSrv == NULL)
+		return;
+	if (pSrv->ptArea != NULL)
+	{
+		InterlockedExchange(&pSrv->ptArea->lMagic, 0);
+		UnmapViewOfFile(pSrv->ptArea);
+	}
+	if (pSrv->hReq != NULL)
+		CloseHandle(pSrv->hReq);
+	if (pSrv->hAns != NULL)
+		CloseHandle(pSrv->hAns);
+	if (pSrv->hMap != NULL)
+		CloseHandle(pSrv->hMap);
+	free(pSrv);
+}
+
+/**
+  * @brief Waits for the next request of the client
+  *
+  * @param  pSrv		server handle
+  * @param  tx			return request
+  * @param  pu32Seq		return sequence number, to be given back with the answer
+  * @param  dwTimeout	timeout (ms)
+  * @retval
+  *			@li 1: Ok
+  *			@li 0: timeout
+  *			@li -3: invalid parameters
+  */
+int Shm_Server_Recv (T_SHM_SERVER *pSrv, uint8 *tx, uint32 *pu32Seq, DWORD dwTimeout)
+{
+	if (pSrv == NULL || tx == NULL || pu32Seq == NULL)
+		return -3;
+	if (!RingGet(&pSrv->ptArea->tReq, pSrv->hReq, pu32Seq, tx, dwTimeout))
+		return 0;
+	return 1;
+}
+
+/**
+  * @brief Queues the answer to a request
+  *
+  * @param  pSrv		server handle
+  * @param  u32Seq		sequence number of the request
+  * @param  rx			answer
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: answer ring full, client not reading
+  *			@li -3: invalid parameters
+  */
+int Shm_Server_Send (T_SHM_SERVER *pSrv, uint32 u32Seq, const uint8 *rx)
+{
+	if (pSrv == NULL || rx == NULL)
+		return -3;
+	if (!RingPut(&pSrv->ptArea->tAns, pSrv->hAns, u32Seq, rx))
+		return -1;
+	return 1;
+}
+
+/**
+  * @brief Maps the area of a server and claims it
+  *
+  * @retval
+  *			@li 1: Ok
+  *			@li -2: server not found or busy
+  */
+static int Attach (T_SHM_CONN *ptConn, const char *pszName)
+{
+	ptConn->hMap = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, pszName);
+	if (ptConn->hMap == NULL)
+		return -2;
+	ptConn->ptArea = (T_SHM_AREA *)MapViewOfFile(ptConn->hMap, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(T_SHM_AREA));
+	ptConn->hReq = EventByName(pszName, "_req", FALSE);
+	ptConn->hAns = EventByName(pszName, "_ans", FALSE);
+	if (ptConn->ptArea == NULL || ptConn->hReq == NULL || ptConn->hAns == NULL
+		|| ptConn->ptArea->lMagic != SHM_MAGIC)
+	{
+		Detach(ptConn);
+		return -2;
+	}
+	/* Rings are single producer, single consumer: one client at a time */
+	if (InterlockedCompareExchange(&ptConn->ptArea->lClient, 1, 0) != 0)
+	{
+		UnmapViewOfFile(ptConn->ptArea);
+		ptConn->ptArea = NULL;
+		Detach(ptConn);
+		return -2;
+	}
+	/* Drops answers left for a previous client */
+	InterlockedExchange(&ptConn->ptArea->tAns.lHead, ptConn->ptArea->tAns.lTail);
+
+	return 1;
+}
+
+/**
+  * @brief Releases the area of a server
+  */
+static void Detach (T_SHM_CONN *ptConn)
+{
+	if (ptConn->ptArea != NULL)
+	{
+		InterlockedExchange(&ptConn->ptArea->lClient, 0);
+		UnmapViewOfFile(ptConn->ptArea);
+		ptConn->ptArea = NULL;
+	}
+	if (ptConn->hReq != NULL)
+		CloseHandle(ptConn->hReq);
+	if (ptConn->hAns != NULL)
+		CloseHandle(ptConn->hAns);
+	if (ptConn->hMap != NULL)
+		CloseHandle(ptConn->hMap);
+	ptConn->hReq = ptConn->hAns = ptConn->hMap = NULL;
+}
+
+/**
+  * @brief Queues a frame
+  *
+  *	The consumer is signaled only when it announced it is going to sleep.
+  *	Both sides publish their own index before reading the other's flag, so
+  *	a wakeup cannot be lost.
+  *
+  * @retval	FALSE if the ring is full
+  */
+static bool RingPut (T_SHM_RING *ptRing, HANDLE hEvent, uint32 u32Seq, const uint8 *pu8Frame)
+{
+	LONG lTail = ptRing->lTail;
+	T_SHM_SLOT *ptSlot;
+
+	if (lTail - ptRing->lHead >= SHM_SLOTS)
+		return FALSE;
+	ptSlot = &ptRing->tSlot[lTail & (SHM_SLOTS - 1)];
+	ptSlot->u32Seq = u32Seq;
+	memcpy(ptSlot->tu8Frame, pu8Frame, SARKCMD_TX_SIZE);
+	InterlockedExchange(&ptRing->lTail, lTail + 1);
+	if (ptRing->lWaiting)
+		SetEvent(hEvent);
+
+	return TRUE;
+}
+
+/**
+  * @brief Takes the next frame, waiting for it if needed
+  *
+  *	Polls for a while before sleeping, as the other side usually answers
+  *	within microseconds when it runs on another processor.
+  *
+  * @retval	FALSE on timeout, or when the operation of the calling thread is cancelled
+  */
+static bool RingGet (T_SHM_RING *ptRing, HANDLE hEvent, uint32 *pu32Seq, uint8 *pu8Frame, DWORD dwTimeout)
+{
+	LONG lHead = ptRing->lHead;
+	T_SHM_SLOT *ptSlot;
+	DWORD dwStart = GetTickCount();
+	DWORD dwElapsed;
+	int iSpin = SpinCount();
+	int ii;
+
+	for (ii = 0; ptRing->lTail == lHead; ii++)
+	{
+		if (ii < iSpin)
+		{
+			YieldProcessor();
+			continue;
+		}
+		InterlockedExchange(&ptRing->lWaiting, 1);
+		if (ptRing->lTail == lHead)
+		{
+			dwElapsed = GetTickCount() - dwStart;
+			if (dwElapsed >= dwTimeout)
+			{
+				InterlockedExchange(&ptRing->lWaiting, 0);
+				return FALSE;
+			}
+			if (Sark_Cancel_Wait(hEvent, dwTimeout - dwElapsed) == WAIT_TIMEOUT && Sark_Cancel_Pending())
+			{
+				InterlockedExchange(&ptRing->lWaiting, 0);
+				return FALSE;
+			}
+		}
+		InterlockedExchange(&ptRing->lWaiting, 0);
+	}
+	MemoryBarrier();
+	ptSlot = &ptRing->tSlot[lHead & (SHM_SLOTS - 1)];
+	*pu32Seq = ptSlot->u32Seq;
+	memcpy(pu8Frame, ptSlot->tu8Frame, SARKCMD_RX_SIZE);
+	InterlockedExchange(&ptRing->lHead, lHead + 1);
+
+	return TRUE;
+}
+
+/**
+  * @brief Creates or opens the named event of one side of a ring
+  */
+static HANDLE EventByName (const char *pszName, const char *pszSuffix, bool bCreate)
+{
+	char szEvent[SHM_NAME_MAX + 8];
+
+	sprintf(szEvent, "%s%s", pszName, pszSuffix);
+	if (bCreate)
+		return CreateEventA(NULL, FALSE, FALSE, szEvent);
+	return OpenEventA(EVENT_MODIFY_STATE | SYNCHRONIZE, FALSE, szEvent);
+}
+
+/**
+  * @brief Number of polls before sleeping
+  *
+  *	Polling only helps when the other side runs at the same time on another
+  *	processor.
+  */
+static int SpinCount (void)
+{
+	SYSTEM_INFO tInfo;
+
+	if (giSpin < 0)
+	{
+		GetSystemInfo(&tInfo);
+		giSpin = (tInfo.dwNumberOfProcessors > 1) ? SHM_SPIN : 0;
+	}
+	return giSpin;
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,67 @@
+/**
+  ******************************************************************************
+  * @file    shm_cli.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL - Shared memory transport for a co-located server
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SHM_CLI_H__
+#define __SHM_CLI_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include "device.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct shm_server T_SHM_SERVER;
+
+/* Exported constants --------------------------------------------------------*/
+#define SHM_MAX_SERVERS		16	/* maximum number of servers in the list */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+int Shm_Connect (char *serverAddr);
+int Shm_Close (int16 num);
+int Shm_SendReceive (int16 num, uint8 *tx, uint8 *rx);
+int Shm_SendReceiveBulk (int16 num, uint8 *tx, uint8 *rx, int iAnswers);
+
+T_SHM_SERVER *Shm_Server_Create (const char *pszName);
+void Shm_Server_Destroy (T_SHM_SERVER *pSrv);
+int Shm_Server_Recv (T_SHM_SERVER *pSrv, uint8 *tx, uint32 *pu32Seq, DWORD dwTimeout);
+int Shm_Server_Send (T_SHM_SERVER *pSrv, uint32 u32Seq, const uint8 *rx);
+
+#endif	 /* __SHM_CLI_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
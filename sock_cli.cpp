@@ -37,162 +37,1858 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "sock_cli.h"
 #include "sark_cmd_defs.h"
+#include "sark_cancel.h"
 
 #pragma comment (lib,"ws2_32.lib") 		// Winsock Library
 #pragma comment (lib, "Mswsock.lib")
 #pragma comment (lib, "AdvApi32.lib")
 
 
-/* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
-#define NUM_RETRIES			5
+#define NUM_RETRIES			5		/* reconnection attempts per request */
 //#define SERVER 				"192.168.1.66"
 #define PORT 				8888
 #define TIMEOUT_CONNECT		3000	/* in ms */
+#define TIMEOUT_RX			2000	/* in ms; no answer means the link is down */
+#define BACKOFF_MIN			250		/* in ms */
+#define BACKOFF_MAX			8000	/* in ms */
+#define RXBUF_SIZE			4096	/* receive ring buffer */
+#define MAX_BATCH			128		/* requests sent before reading their answers */
+#define UNIX_PATH_MAX		108		/* as in afunix.h */
+#define LOOP_TICK			100		/* in ms; answer deadlines are checked this often */
+#define TAG_PREFIX			"seq@"	/* server list entries that use tagged frames */
+#define TAG_SIZE			2		/* sequence tag in front of tagged frames */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Request handled by the event loop */
+typedef struct sock_req
+{
+	uint8 *pu8Tx;			/* requests, SARKCMD_TX_SIZE bytes each */
+	uint8 *pu8Rx;			/* return answers, SARKCMD_RX_SIZE bytes each */
+	int iCount;				/* number of requests */
+	int iAnswers;			/* answer frames to each request; 1 unless iCount is 1 */
+	int iSent;				/* requests given to the socket */
+	int iDone;				/* answer frames received */
+	int iResult;			/* 0: pending; 1: Ok; -1: error; -2: no answer */
+	HANDLE hEvent;			/* signaled when completed */
+	struct sock_req *ptNext;
+} T_SOCK_REQ;
+
+/* AF_UNIX address, as in afunix.h (Windows 10 1803 and later) */
+typedef struct
+{
+	u_short sun_family;
+	char sun_path[UNIX_PATH_MAX];
+} T_UNIX_ADDR;
+
+/* Connect in progress to the addresses of a server */
+typedef struct
+{
+	struct addrinfo *ptList;	/* resolved addresses, NULL for AF_UNIX */
+	struct addrinfo *ptAddr;	/* address being tried; NULL once all failed */
+	struct addrinfo tLocal;	/* address of an AF_UNIX server */
+	SOCKET hSock;			/* socket of the attempt */
+	bool bConnected;
+	DWORD dwDeadline;		/* tick count by which the attempt must connect */
+} T_SOCK_OPEN;
+
+/* Connection to a server */
+typedef struct
+{
+	SOCKET hSock;
+	bool bLocal;			/* AF_UNIX socket; szHost is the socket path */
+	char szHost[256];		/* server address, kept for reconnection; empty if not in use */
+	char szPort[8];
+	bool bTagged;			/* frames carry a sequence tag; answers may come out of order */
+	uint16 u16Tag;			/* next tag of the blocking exchanges */
+	DWORD dwBackoff;		/* current delay between reconnection attempts (ms) */
+	DWORD dwRetryAt;		/* tick count of the next reconnection attempt */
+	struct sockaddr_storage tAddr;	/* server address, resolved once for the event loop */
+	int iAddrLen;			/* zero if not resolved */
+	uint8 tu8RxBuf[RXBUF_SIZE];	/* received bytes not yet taken as frames */
+	int iRxHead;			/* first byte in tu8RxBuf */
+	int iRxCount;			/* bytes in tu8RxBuf */
+	HANDLE hWait;			/* manual reset; ends the connect and receive waits */
+	CRITICAL_SECTION csLock;
+	/* Event loop */
+	SOCKET hBound;			/* socket associated with the completion port */
+	OVERLAPPED tRxOv;
+	OVERLAPPED tTxOv;
+	bool bRxBusy;			/* receive in progress */
+	bool bTxBusy;			/* send in progress */
+	uint8 tu8TxBuf[MAX_BATCH * (TAG_SIZE + SARKCMD_TX_SIZE)];	/* requests being sent */
+	int iTxLen;				/* bytes in tu8TxBuf */
+	int iTxSent;			/* bytes of tu8TxBuf already sent */
+	int iInFlight;			/* answer frames due for the requests sent */
+	DWORD dwDeadline;		/* tick count by which the next answer is due */
+	int iFailRc;			/* result of the requests left when the socket was lost */
+	T_SOCK_REQ *ptHead;		/* submitted requests, oldest first */
+	T_SOCK_REQ *ptTail;
+	T_SOCK_REQ *ptSend;		/* first request not entirely sent */
+	bool bConnecting;		/* the loop is reopening the connection */
+	SOCKET hConnect;		/* socket of the connection attempt in progress */
+	int iAttempts;			/* connection attempts made */
+	DWORD dwConnectAt;		/* tick count of the next attempt, or by which it must connect */
+	/* Event loop, tagged frames; the tag is the index in these tables */
+	T_SOCK_REQ *ptTagReq[MAX_BATCH];	/* request of each tag in flight */
+	int tiTagIdx[MAX_BATCH];	/* request number within ptTagReq */
+	int tiTagLeft[MAX_BATCH];	/* answer frames still due */
+	int iTagNext;			/* where the search for a free tag starts */
+} T_SOCK_CONN;
 
 /* Private macro -------------------------------------------------------------*/
+#define RX_FRAME(c)			((c)->bTagged ? TAG_SIZE + SARKCMD_RX_SIZE : SARKCMD_RX_SIZE)
 /* External variables --------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-static SOCKET ConnectSocket = INVALID_SOCKET;
+static T_SOCK_CONN gtConn[SOCK_MAX_SERVERS];
+static int giServers = 0;
+static bool bInitLock = FALSE;
+static HANDLE ghPort = NULL;			/* completion port of the event loop */
+static HANDLE ghLoop = NULL;			/* event loop thread */
+static volatile LONG glLoopStop = 0;
+static __declspec(thread) HANDLE ghReqEvent = NULL;	/* completion event of the calling thread */
 
 /* Private function prototypes -----------------------------------------------*/
-static void CALLBACK TimerProc(PVOID lpParameter, BOOLEAN TimerOrWaitFired);
+static T_SOCK_CONN *GetConn (int16 num);
+static bool ParseServer (T_SOCK_CONN *ptConn, const char *pszItem, int iLen);
+static int OpenSockets (T_SOCK_CONN *ptConns, int iCount, HANDLE hEvent);
+static void ConnectStart (T_SOCK_OPEN *ptOpen, HANDLE hEvent);
+static void ConnectNext (T_SOCK_OPEN *ptOpen, HANDLE hEvent);
+static void CloseSocket (T_SOCK_CONN *ptConn);
+static void InitConns (void);
+static int Exchange (T_SOCK_CONN *ptConn, uint8 *tx, uint8 *rx, int iCount, int *piDone);
+static int ExchangeBulk (T_SOCK_CONN *ptConn, uint8 *tx, uint8 *rx, int iAnswers);
+static int ExchangeTagged (T_SOCK_CONN *ptConn, uint8 *tx, uint8 *rx, int iCount, int iAnswers, int *piDone);
+static int SendAll (SOCKET hSock, const uint8 *pu8Buf, int iLen);
+static int ReadFrame (T_SOCK_CONN *ptConn, uint8 *rx, uint16 *pu16Tag);
+static void TakeFrame (T_SOCK_CONN *ptConn, uint8 *rx, uint16 *pu16Tag);
+static void TakeBytes (T_SOCK_CONN *ptConn, uint8 *pu8Buf, int iLen);
+static void PutTag (uint8 *pu8Buf, uint16 u16Tag);
+static bool Reconnect (T_SOCK_CONN *ptConn);
+static bool IsIdempotent (uint8 u8Cmd);
+static int Post (T_SOCK_CONN *ptConn, T_SOCK_REQ *ptReq, bool bReopen);
+static bool Withdraw (T_SOCK_CONN *ptConn, T_SOCK_REQ *ptReq);
+static bool BindSocket (T_SOCK_CONN *ptConn);
+static int LoopSendReceive (T_SOCK_CONN *ptConn, uint8 *tx, uint8 *rx, int iCount, int iAnswers, bool bReopen);
+static DWORD WINAPI LoopThread (LPVOID lpParam);
+static void Completed (T_SOCK_CONN *ptConn, OVERLAPPED *ptOv, BOOL bOk, DWORD dwBytes);
+static void Pump (T_SOCK_CONN *ptConn);
+static void LoopConnect (T_SOCK_CONN *ptConn);
+static void ConnectFailed (T_SOCK_CONN *ptConn, DWORD dwNow);
+static int PutTagged (T_SOCK_CONN *ptConn, T_SOCK_REQ *ptReq, int iTake, uint8 *pu8Buf);
+static bool TakeTagged (T_SOCK_CONN *ptConn);
+static void Fail (T_SOCK_CONN *ptConn, int iResult);
+static void Complete (T_SOCK_REQ *ptReq, int iResult);
 
 /* Private functions ---------------------------------------------------------*/
 
 /**
-  * @brief Open connection
+  * @brief Open connections
+  *
+  *	Connects to every server of a comma separated list of host[:port]
+  *	entries; IPv6 addresses with a port are given as [addr]:port. Servers
+  *	are addressed by their position in the list, starting by zero. A server
+  *	that cannot be reached keeps its number and is connected again when
+  *	used. Local servers are given by the paths of their AF_UNIX sockets.
+  *	Entries prefixed by TAG_PREFIX ("seq@host:port") are servers that take
+  *	tagged frames: every request is preceded by a 16-bit little endian tag
+  *	that the server puts in front of each of its answer frames, so answers
+  *	can come in any order and a slow request does not hold up the others.
+  *	The list is parsed before connecting, and the servers are connected
+  *	together, so those that do not answer delay the call once, by
+  *	TIMEOUT_CONNECT, however many they are.
   *
-  * @param
+  * @param	serverAddr	server addresses
+  * @param	bLocal		{TRUE: AF_UNIX socket paths; FALSE: TCP servers}
   * @retval
-  *			@li 1: 	   	Ok
-  *			@li <0: 	Error
+  *			@li >=1: 	number of servers
+  *			@li -1: 	invalid list
+  *			@li -2: 	no server reached
   */
-int Sock_Connect (char* serverAddr)
+int Sock_Connect (char* serverAddr, bool bLocal)
 {
-    WSADATA wsa;
-    struct addrinfo *result = NULL,
-                    *ptr = NULL,
-                    hints;
-    int iResult;
+	WSADATA wsa;
+	T_SOCK_CONN *ptConn;
+	const char *pszItem;
+	HANDLE hEvent;
+	int iLen;
+	int iOpen = 0;
+	int ii;
+
+	if (serverAddr == NULL)
+		return -1;
+	InitConns();
+	for (ii = 0; ii < giServers; ii++)
+		Sock_Close(ii);
+	giServers = 0;
 
-    if (WSAStartup(MAKEWORD(2,2),&wsa) != 0)
-    {
+	for (pszItem = serverAddr; *pszItem != 0 && giServers < SOCK_MAX_SERVERS; pszItem += iLen)
+	{
+		if (*pszItem == ',')
+			pszItem++;
+		iLen = (int)strcspn(pszItem, ",");
+		ptConn = &gtConn[giServers];
+		EnterCriticalSection(&ptConn->csLock);
+		ptConn->bLocal = bLocal;
+		if (!ParseServer(ptConn, pszItem, iLen) || WSAStartup(MAKEWORD(2,2),&wsa) != 0)
+		{
+			LeaveCriticalSection(&ptConn->csLock);
+			break;
+		}
+		ptConn->dwBackoff = BACKOFF_MIN;
+		ptConn->dwRetryAt = GetTickCount();
+		ptConn->iAddrLen = 0;
+		LeaveCriticalSection(&ptConn->csLock);
+		giServers++;
+	}
+	if (*pszItem != 0 || giServers == 0)
+	{
+		for (ii = 0; ii < giServers; ii++)
+			Sock_Close(ii);
+		giServers = 0;
 		return -1;
-    }
+	}
 
-    ZeroMemory( &hints, sizeof(hints) );
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_protocol = IPPROTO_TCP;
+	hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (hEvent != NULL)
+	{
+		for (ii = 0; ii < giServers; ii++)
+			EnterCriticalSection(&gtConn[ii].csLock);
+		iOpen = OpenSockets(gtConn, giServers, hEvent);
+		for (ii = 0; ii < giServers; ii++)
+			LeaveCriticalSection(&gtConn[ii].csLock);
+		CloseHandle(hEvent);
+	}
+	if (iOpen == 0)
+	{
+		for (ii = 0; ii < giServers; ii++)
+			Sock_Close(ii);
+		giServers = 0;
+		return -2;
+	}
 
-    // Resolve the server address and port
-	char portStr[6];
-    sprintf(portStr, "%u",PORT);
-    iResult = getaddrinfo(serverAddr, portStr, &hints, &result);
-    if ( iResult != 0 ) {
-        WSACleanup();
-        return -1;
-    }
-    // Attempt to connect to an address until one succeeds
-    for(ptr=result; ptr != NULL ;ptr=ptr->ai_next) {
+	return giServers;
+}
 
-        // Create a SOCKET for connecting to server
-        ConnectSocket = socket(ptr->ai_family, ptr->ai_socktype,
-            ptr->ai_protocol);
-        if (ConnectSocket == INVALID_SOCKET)
+/**
+  * @brief Close connection
+  *
+  * @param  num		server number (starting by zero)
+  * @retval
+  *			@li 1: Ok
+  */
+int Sock_Close (int16 num)
+{
+	T_SOCK_CONN *ptConn = GetConn(num);
+	int iDone;
+	int ii;
+	uint8 tx[SARKCMD_TX_SIZE];
+	uint8 rx[SARKCMD_RX_SIZE];
+
+	if (ptConn == NULL)
+		return 1;
+	if (ghPort != NULL && ptConn->hSock != INVALID_SOCKET)
+	{
+		/* Inform server about disconnection */
+		memset(tx, 0xff, SARKCMD_TX_SIZE);
+		LoopSendReceive(ptConn, tx, rx, 1, 1, FALSE);
+	}
+	EnterCriticalSection(&ptConn->csLock);
+	if (ptConn->szHost[0] != 0)
+	{
+		if (ptConn->hSock != INVALID_SOCKET)
 		{
-            WSACleanup();
-            return -1;
-        }
+			if (ghPort == NULL)
+			{
+				/* Inform server about disconnection */
+				memset(tx, 0xff, SARKCMD_TX_SIZE);
+				Exchange(ptConn, tx, rx, 1, &iDone);
+			}
+			shutdown(ptConn->hSock, SD_SEND);
+		}
+		// cleanup
+		if (ghPort != NULL)
+			Fail(ptConn, -1);	/* also ends a reconnection by the loop */
+		else
+			CloseSocket(ptConn);
+		/* The event loop may still hold operations of the socket */
+		for (ii = 0; ii < TIMEOUT_RX && (ptConn->bRxBusy || ptConn->bTxBusy); ii++)
+		{
+			LeaveCriticalSection(&ptConn->csLock);
+			Sleep(1);
+			EnterCriticalSection(&ptConn->csLock);
+		}
+		WSACleanup();
+		/* An empty address prevents reconnection */
+		ptConn->szHost[0] = 0;
+	}
+	LeaveCriticalSection(&ptConn->csLock);
 
-        /*
-		* Connect to server.
-		*/
-		// connect is blocking, so create a timeout timer with shorter wait time
-		HANDLE timer_handle;
-		CreateTimerQueueTimer(&timer_handle, NULL, TimerProc, NULL, TIMEOUT_CONNECT, 0, WT_EXECUTEDEFAULT);
+	return 1;
+}
 
-		iResult = connect( ConnectSocket, ptr->ai_addr, (int)ptr->ai_addrlen);
+/**
+  * @brief Send receive
+  *
+  *	A lost connection is reopened with exponential backoff between attempts.
+  *	The request is sent again on the new connection if repeating it has no
+  *	side effects; otherwise the error is returned and the connection is kept
+  *	for the next request. The waits for the connection and the answers end
+  *	when the operation of the calling thread is cancelled (sark_cancel.h);
+  *	the connection is then closed, as its answers would come out of step.
+  *
+  * @param  num		server number (starting by zero)
+  * @param  tx			request
+  * @param  rx			answer
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  *			@li -2: no answer
+  */
+int Sock_SendReceive (int16 num, uint8 *tx, uint8 *rx)
+{
+	return Sock_SendReceiveN(num, tx, rx, 1);
+}
 
-		DeleteTimerQueueTimer(NULL, timer_handle, NULL);
+/**
+  * @brief Sends several requests and receives their answers
+  *
+  *	Requests are sent back to back, up to MAX_BATCH in a single send, and
+  *	the answers are read as they come, several per recv when the network
+  *	coalesces them. If the connection is lost, the requests not yet answered
+  *	are sent again after reconnecting when all of them can be repeated.
+  *	While the event loop runs, the requests are handed to it and this call
+  *	waits for their completion.
+  *
+  * @param  num		server number (starting by zero)
+  * @param  tx			requests, SARKCMD_TX_SIZE bytes each
+  * @param  rx			answers, SARKCMD_RX_SIZE bytes each
+  * @param  iCount		number of requests
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  *			@li -2: no answer
+  */
+int Sock_SendReceiveN (int16 num, uint8 *tx, uint8 *rx, int iCount)
+{
+	T_SOCK_CONN *ptConn = GetConn(num);
+	int iResult = -1;
+	int iDone = 0;
+	int iRedo;
+	int ii;
 
-        if (iResult == SOCKET_ERROR)
+	if (ptConn == NULL || iCount <= 0)
+		return -1;
+	if (ghPort != NULL)
+		return LoopSendReceive(ptConn, tx, rx, iCount, 1, TRUE);
+	EnterCriticalSection(&ptConn->csLock);
+	if (ptConn->hSock != INVALID_SOCKET)
+		iResult = Exchange(ptConn, tx, rx, iCount, &iDone);
+	if (iResult < 0)
+	{
+		CloseSocket(ptConn);
+		if (Reconnect(ptConn))
 		{
-            closesocket(ConnectSocket);
-            ConnectSocket = INVALID_SOCKET;
-            continue;
-        }
-        break;
-    }
+			for (ii = iDone; ii < iCount; ii++)
+			{
+				if (!IsIdempotent(tx[ii * SARKCMD_TX_SIZE]))
+					break;
+			}
+			if (ii == iCount)
+				iResult = Exchange(ptConn, &tx[iDone * SARKCMD_TX_SIZE], &rx[iDone * SARKCMD_RX_SIZE],
+					iCount - iDone, &iRedo);
+		}
+		if (iResult < 0)
+			CloseSocket(ptConn);
+	}
+	LeaveCriticalSection(&ptConn->csLock);
 
-    freeaddrinfo(result);
+	return iResult;
+}
 
-    if (ConnectSocket == INVALID_SOCKET)
+/**
+  * @brief Sends a request answered by several frames
+  *
+  *	Used by CMD_SARK_MEAS_RX_BULK. Receiving stops after the first answer
+  *	if it is not ANS_SARK_OK, as an error is answered by a single frame.
+  *	If the connection is lost, the request is sent again after reconnecting.
+  *
+  * @param  num		server number (starting by zero)
+  * @param  tx			request
+  * @param  rx			answers, SARKCMD_RX_SIZE bytes each
+  * @param  iAnswers	number of answer frames
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  *			@li -2: no answer
+  */
+int Sock_SendReceiveBulk (int16 num, uint8 *tx, uint8 *rx, int iAnswers)
+{
+	T_SOCK_CONN *ptConn = GetConn(num);
+	int iResult = -1;
+
+	if (ptConn == NULL || iAnswers <= 0)
+		return -1;
+	if (ghPort != NULL)
+		return LoopSendReceive(ptConn, tx, rx, 1, iAnswers, TRUE);
+	EnterCriticalSection(&ptConn->csLock);
+	if (ptConn->hSock != INVALID_SOCKET)
+		iResult = ExchangeBulk(ptConn, tx, rx, iAnswers);
+	if (iResult < 0)
+	{
+		/* Answers may be left in the stream, so it is never reused */
+		CloseSocket(ptConn);
+		if (IsIdempotent(tx[0]) && Reconnect(ptConn))
+			iResult = ExchangeBulk(ptConn, tx, rx, iAnswers);
+		if (iResult < 0)
+			CloseSocket(ptConn);
+	}
+	LeaveCriticalSection(&ptConn->csLock);
+
+	return iResult;
+}
+
+/**
+  * @brief Starts the event loop
+  *
+  *	A single thread then drives the sockets of every server through an I/O
+  *	completion port: requests of all the servers are kept in flight at once
+  *	and each one is completed as its answers arrive, so many servers are
+  *	served without a thread per connection. The blocking calls hand their
+  *	requests to the loop and wait for them. Lost connections are reopened
+  *	by the loop without blocking it, so a server that cannot be reached
+  *	does not hold up the others. Start it while no request is in progress.
+  *
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  */
+int Sock_Loop_Start (void)
+{
+	if (ghPort != NULL)
+		return 1;
+	InitConns();
+	glLoopStop = 0;
+	ghPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+	if (ghPort == NULL)
+		return -1;
+	ghLoop = CreateThread(NULL, 0, LoopThread, NULL, 0, NULL);
+	if (ghLoop == NULL)
 	{
-        WSACleanup();
-        return -2;
-    }
+		CloseHandle(ghPort);
+		ghPort = NULL;
+		return -1;
+	}
 
 	return 1;
 }
 
 /**
-  * @brief Close connection
+  * @brief Stops the event loop
+  *
+  *	Requests still pending fail with -1. The sockets used by the loop are
+  *	closed and connected again by the next request.
   *
   * @retval
   *			@li 1: Ok
   */
-int Sock_Close (void)
+int Sock_Loop_Stop (void)
+{
+	if (ghPort == NULL)
+		return 1;
+	InterlockedExchange(&glLoopStop, 1);
+	PostQueuedCompletionStatus(ghPort, 0, 0, NULL);
+	WaitForSingleObject(ghLoop, INFINITE);
+	CloseHandle(ghLoop);
+	CloseHandle(ghPort);
+	ghLoop = NULL;
+	ghPort = NULL;
+
+	return 1;
+}
+
+/**
+  * @brief Opens a listening socket on the loopback address
+  *
+  *	For the local servers of the DLL: the proxy and the publisher.
+  *
+  * @param  u16Port		TCP port
+  * @param  iBacklog	pending connections
+  * @retval	socket, INVALID_SOCKET if failed
+  */
+SOCKET Sock_Listen (uint16 u16Port, int iBacklog)
+{
+	struct sockaddr_in tAddr;
+	SOCKET hSock;
+
+	hSock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (hSock == INVALID_SOCKET)
+		return INVALID_SOCKET;
+	memset(&tAddr, 0, sizeof(tAddr));
+	tAddr.sin_family = AF_INET;
+	tAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	tAddr.sin_port = htons(u16Port);
+	if (bind(hSock, (struct sockaddr *)&tAddr, sizeof(tAddr)) == SOCKET_ERROR
+		|| listen(hSock, iBacklog) == SOCKET_ERROR)
+	{
+		closesocket(hSock);
+		return INVALID_SOCKET;
+	}
+
+	return hSock;
+}
+
+/**
+  * @brief Gets the connection of a server
+  *
+  * @retval	connection, NULL if the number is out of the list
+  */
+static T_SOCK_CONN *GetConn (int16 num)
 {
+	if (bInitLock == FALSE || num < 0 || num >= giServers)
+		return NULL;
+	return &gtConn[num];
+}
+
+/**
+  * @brief Parses one host[:port] or socket path entry of the server list
+  *
+  * @param	ptConn		return host, port and framing
+  * @param	pszItem		entry, not terminated
+  * @param	iLen		entry length
+  * @retval	FALSE if malformed
+  */
+static bool ParseServer (T_SOCK_CONN *ptConn, const char *pszItem, int iLen)
+{
+	const char *pszPort = NULL;
+	const char *pszEnd;
+	int iHost;
+	int iPort;
+
+	while (iLen > 0 && *pszItem == ' ')
+	{
+		pszItem++;
+		iLen--;
+	}
+	while (iLen > 0 && pszItem[iLen - 1] == ' ')
+		iLen--;
+	ptConn->bTagged = (iLen > (int)strlen(TAG_PREFIX) && memcmp(pszItem, TAG_PREFIX, strlen(TAG_PREFIX)) == 0);
+	if (ptConn->bTagged)
+	{
+		pszItem += strlen(TAG_PREFIX);
+		iLen -= (int)strlen(TAG_PREFIX);
+	}
+	if (iLen <= 0)
+		return FALSE;
+	if (ptConn->bLocal)
+	{
+		if (iLen >= UNIX_PATH_MAX)
+			return FALSE;
+		memcpy(ptConn->szHost, pszItem, iLen);
+		ptConn->szHost[iLen] = 0;
+		ptConn->szPort[0] = 0;
+		return TRUE;
+	}
+	pszEnd = pszItem + iLen;
+	if (pszItem[0] == '[')
+	{
+		/* [IPv6]:port */
+		pszPort = (const char *)memchr(pszItem, ']', iLen);
+		if (pszPort == NULL)
+			return FALSE;
+		pszItem++;
+		iHost = (int)(pszPort - pszItem);
+		pszPort++;
+		if (pszPort == pszEnd)
+			pszPort = NULL;
+		else if (*pszPort == ':')
+			pszPort++;
+		else
+			return FALSE;
+	}
+	else
+	{
+		pszPort = (const char *)memchr(pszItem, ':', iLen);
+		/* A bare IPv6 address has several colons and no port */
+		if (pszPort != NULL && memchr(pszPort + 1, ':', iLen - (pszPort + 1 - pszItem)) != NULL)
+			pszPort = NULL;
+		iHost = (pszPort != NULL) ? (int)(pszPort - pszItem) : iLen;
+		if (pszPort != NULL)
+			pszPort++;
+	}
+	if (iHost <= 0 || iHost >= (int)sizeof(ptConn->szHost))
+		return FALSE;
+	iPort = PORT;
+	if (pszPort != NULL)
+	{
+		iPort = atoi(pszPort);
+		if (iPort <= 0 || iPort > 65535)
+			return FALSE;
+	}
+	memcpy(ptConn->szHost, pszItem, iHost);
+	ptConn->szHost[iHost] = 0;
+	sprintf(ptConn->szPort, "%u", iPort);
+
+	return TRUE;
+}
+
+/**
+  * @brief Opens the sockets of several servers together
+  *
+  *	A non-blocking connect is started to every server and the connects are
+  *	waited for together, so a server that does not answer delays the others
+  *	by TIMEOUT_CONNECT at most. The addresses of a server are tried in
+  *	turn, TIMEOUT_CONNECT each. The wait ends early if the operation of the
+  *	calling thread is cancelled.
+  *
+  * @param	ptConns		connections, with their server addresses
+  * @param	iCount		number of connections, up to SOCK_MAX_SERVERS
+  * @param	hEvent		manual reset event for the wait
+  * @retval	number of connections opened
+  */
+static int OpenSockets (T_SOCK_CONN *ptConns, int iCount, HANDLE hEvent)
+{
+	T_SOCK_OPEN tOpen[SOCK_MAX_SERVERS];
+	T_SOCK_OPEN *ptOpen;
+	T_SOCK_CONN *ptConn;
+	struct addrinfo hints;
+	struct addrinfo *ptAddr;
+	T_UNIX_ADDR tUnix;
+	fd_set tWrite, tExcept;
+	struct timeval tPoll = { 0, 0 };
+	DWORD dwTimeout = TIMEOUT_RX;
+	DWORD dwNow, dwWait;
+	u_long ulMode = 0;
+	int iErr, iLen;
+	int iMax, iReady;
+	int iOpen = 0;
+	int ii;
+
+	for (ii = 0; ii < iCount; ii++)
+	{
+		ptConn = &ptConns[ii];
+		ptOpen = &tOpen[ii];
+		ZeroMemory(ptOpen, sizeof(T_SOCK_OPEN));
+		ptOpen->hSock = INVALID_SOCKET;
+		ZeroMemory(&hints, sizeof(hints));
+		hints.ai_socktype = SOCK_STREAM;
+		if (ptConn->bLocal)
+		{
+			ZeroMemory(&tUnix, sizeof(tUnix));
+			tUnix.sun_family = AF_UNIX;
+			strcpy(tUnix.sun_path, ptConn->szHost);
+			memcpy(&ptConn->tAddr, &tUnix, sizeof(tUnix));
+			ptConn->iAddrLen = sizeof(tUnix);
+			ptOpen->tLocal.ai_family = AF_UNIX;
+			ptOpen->tLocal.ai_socktype = SOCK_STREAM;
+			ptOpen->tLocal.ai_addr = (struct sockaddr *)&ptConn->tAddr;
+			ptOpen->tLocal.ai_addrlen = sizeof(tUnix);
+			ptOpen->ptAddr = &ptOpen->tLocal;
+		}
+		else
+		{
+			hints.ai_family = AF_UNSPEC;
+			hints.ai_protocol = IPPROTO_TCP;
+			// Resolve the server address and port
+			if (getaddrinfo(ptConn->szHost, ptConn->szPort, &hints, &ptOpen->ptList) != 0)
+				ptOpen->ptList = NULL;
+			ptOpen->ptAddr = ptOpen->ptList;
+		}
+		ConnectStart(ptOpen, hEvent);
+	}
+
+	for (;;)
+	{
+		/* Connects in progress; those past their deadline go to the next address */
+		FD_ZERO(&tWrite);
+		FD_ZERO(&tExcept);
+		dwNow = GetTickCount();
+		dwWait = TIMEOUT_CONNECT;
+		iMax = -1;
+		for (ii = 0; ii < iCount; ii++)
+		{
+			ptOpen = &tOpen[ii];
+			if (ptOpen->hSock != INVALID_SOCKET && !ptOpen->bConnected
+				&& (LONG)(dwNow - ptOpen->dwDeadline) >= 0)
+				ConnectNext(ptOpen, hEvent);
+			if (ptOpen->hSock == INVALID_SOCKET || ptOpen->bConnected)
+				continue;
+			FD_SET(ptOpen->hSock, &tWrite);
+			FD_SET(ptOpen->hSock, &tExcept);
+			if ((int)ptOpen->hSock > iMax)
+				iMax = (int)ptOpen->hSock;
+			if (ptOpen->dwDeadline - dwNow < dwWait)
+				dwWait = ptOpen->dwDeadline - dwNow;
+		}
+		if (iMax < 0 || Sark_Cancel_Pending())
+			break;
+		/* Reset before polling: a connect ending after the poll sets it again */
+		ResetEvent(hEvent);
+		/* Writable when connected; failure is signaled in the except set */
+		iReady = select(iMax + 1, NULL, &tWrite, &tExcept, &tPoll);
+		if (iReady == 0)
+		{
+			Sark_Cancel_Wait(hEvent, dwWait);
+			continue;
+		}
+		for (ii = 0; ii < iCount; ii++)
+		{
+			ptOpen = &tOpen[ii];
+			if (ptOpen->hSock == INVALID_SOCKET || ptOpen->bConnected)
+				continue;
+			if (iReady > 0 && !FD_ISSET(ptOpen->hSock, &tWrite) && !FD_ISSET(ptOpen->hSock, &tExcept))
+				continue;
+			iErr = 0;
+			iLen = sizeof(iErr);
+			if (iReady > 0 && FD_ISSET(ptOpen->hSock, &tWrite)
+				&& getsockopt(ptOpen->hSock, SOL_SOCKET, SO_ERROR, (char *)&iErr, &iLen) != SOCKET_ERROR
+				&& iErr == 0)
+				ptOpen->bConnected = TRUE;
+			else
+				ConnectNext(ptOpen, hEvent);
+		}
+	}
+
+	for (ii = 0; ii < iCount; ii++)
+	{
+		ptConn = &ptConns[ii];
+		ptOpen = &tOpen[ii];
+		ptConn->hSock = INVALID_SOCKET;
+		if (ptOpen->hSock != INVALID_SOCKET)
+		{
+			WSAEventSelect(ptOpen->hSock, NULL, 0);
+			if (ptOpen->bConnected && ioctlsocket(ptOpen->hSock, FIONBIO, &ulMode) != SOCKET_ERROR)
+				ptConn->hSock = ptOpen->hSock;
+			else
+				closesocket(ptOpen->hSock);
+		}
+		/* Kept for the event loop: the address that answered, else the first one */
+		ptAddr = (ptConn->hSock != INVALID_SOCKET) ? ptOpen->ptAddr : ptOpen->ptList;
+		if (ptOpen->ptList != NULL && ptAddr != NULL && ptAddr->ai_addrlen <= sizeof(ptConn->tAddr))
+		{
+			memcpy(&ptConn->tAddr, ptAddr->ai_addr, ptAddr->ai_addrlen);
+			ptConn->iAddrLen = (int)ptAddr->ai_addrlen;
+		}
+		if (ptOpen->ptList != NULL)
+			freeaddrinfo(ptOpen->ptList);
+		if (ptConn->hSock == INVALID_SOCKET)
+			continue;
+		/* A server that stops reading does not block sends forever; answers are waited for by ReadFrame */
+		setsockopt(ptConn->hSock, SOL_SOCKET, SO_SNDTIMEO, (const char *)&dwTimeout, sizeof(dwTimeout));
+		iOpen++;
+	}
+
+	return iOpen;
+}
+
+/**
+  * @brief Starts a non-blocking connect to the address of an attempt
+  *
+  *	Addresses that fail at once are skipped. No socket is left when every
+  *	address failed.
+  *
+  * @param	ptOpen		attempt
+  * @param	hEvent		manual reset event, signaled when the connect ends
+  * @retval None
+  */
+static void ConnectStart (T_SOCK_OPEN *ptOpen, HANDLE hEvent)
+{
+	struct addrinfo *ptAddr;
+
+	for (; ptOpen->ptAddr != NULL; ptOpen->ptAddr = ptOpen->ptAddr->ai_next)
+	{
+		ptAddr = ptOpen->ptAddr;
+		// Create a SOCKET for connecting to server
+		ptOpen->hSock = socket(ptAddr->ai_family, ptAddr->ai_socktype, ptAddr->ai_protocol);
+		if (ptOpen->hSock == INVALID_SOCKET)
+			continue;
+		/* Also makes the socket non-blocking */
+		if (WSAEventSelect(ptOpen->hSock, hEvent, FD_CONNECT) != SOCKET_ERROR)
+		{
+			if (connect(ptOpen->hSock, ptAddr->ai_addr, (int)ptAddr->ai_addrlen) != SOCKET_ERROR)
+			{
+				ptOpen->bConnected = TRUE;
+				return;
+			}
+			if (WSAGetLastError() == WSAEWOULDBLOCK)
+			{
+				ptOpen->dwDeadline = GetTickCount() + TIMEOUT_CONNECT;
+				return;
+			}
+		}
+		closesocket(ptOpen->hSock);
+		ptOpen->hSock = INVALID_SOCKET;
+	}
+}
+
+/**
+  * @brief Gives up the address of an attempt and starts the next one
+  *
+  * @param	ptOpen		attempt
+  * @param	hEvent		manual reset event, signaled when the connect ends
+  * @retval None
+  */
+static void ConnectNext (T_SOCK_OPEN *ptOpen, HANDLE hEvent)
+{
+	closesocket(ptOpen->hSock);
+	ptOpen->hSock = INVALID_SOCKET;
+	ptOpen->ptAddr = ptOpen->ptAddr->ai_next;
+	ConnectStart(ptOpen, hEvent);
+}
+
+/**
+  * @brief Initializes the connection table, once
+  */
+static void InitConns (void)
+{
+	int ii;
+
+	if (bInitLock)
+		return;
+	for (ii = 0; ii < SOCK_MAX_SERVERS; ii++)
+	{
+		gtConn[ii].hSock = INVALID_SOCKET;
+		gtConn[ii].hBound = INVALID_SOCKET;
+		gtConn[ii].hConnect = INVALID_SOCKET;
+		gtConn[ii].hWait = CreateEvent(NULL, TRUE, FALSE, NULL);
+		InitializeCriticalSection(&gtConn[ii].csLock);
+	}
+	bInitLock = TRUE;
+}
+
+/**
+  * @brief Closes the socket of a connection, if open
+  *
+  *	A reconnection in progress in the event loop is given up.
+  */
+static void CloseSocket (T_SOCK_CONN *ptConn)
+{
+	if (ptConn->hConnect != INVALID_SOCKET)
+	{
+		closesocket(ptConn->hConnect);
+		ptConn->hConnect = INVALID_SOCKET;
+	}
+	ptConn->bConnecting = FALSE;
+	if (ptConn->hSock == INVALID_SOCKET)
+		return;
+	closesocket(ptConn->hSock);
+	ptConn->hSock = INVALID_SOCKET;
+	ptConn->hBound = INVALID_SOCKET;
+	/* Anything left belongs to the lost connection */
+	ptConn->iRxHead = 0;
+	ptConn->iRxCount = 0;
+}
+
+/**
+  * @brief Sends requests and waits for their answers
+  *
+  * @param	ptConn		connection
+  * @param  tx			requests
+  * @param  rx			answers
+  * @param  iCount		number of requests
+  * @param  piDone		return number of requests answered, counted from the first
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: send error
+  *			@li -2: no answer
+  */
+static int Exchange (T_SOCK_CONN *ptConn, uint8 *tx, uint8 *rx, int iCount, int *piDone)
+{
+	uint16 u16Tag;
+	int iChunk, iAnswered;
 	int iResult;
-	uint8 tx[SARKCMD_TX_SIZE];
-	uint8 rx[SARKCMD_RX_SIZE];
+	int ii;
 
-	/* Inform server about disconnection */
-	memset(tx, 0xff, SARKCMD_TX_SIZE);
-	Sock_SendReceive( tx, rx);
+	*piDone = 0;
+	while (*piDone < iCount)
+	{
+		iChunk = iCount - *piDone;
+		if (iChunk > MAX_BATCH)
+			iChunk = MAX_BATCH;
+		if (ptConn->bTagged)
+		{
+			iResult = ExchangeTagged(ptConn, &tx[*piDone * SARKCMD_TX_SIZE], &rx[*piDone * SARKCMD_RX_SIZE],
+				iChunk, 1, &iAnswered);
+			*piDone += iAnswered;
+			if (iResult < 0)
+				return iResult;
+			continue;
+		}
+		if (SendAll(ptConn->hSock, &tx[*piDone * SARKCMD_TX_SIZE], iChunk * SARKCMD_TX_SIZE) < 0)
+			return -1;
+		for (ii = 0; ii < iChunk; ii++)
+		{
+			if (ReadFrame(ptConn, &rx[*piDone * SARKCMD_RX_SIZE], &u16Tag) < 0)
+				return -2;
+			(*piDone)++;
+		}
+	}
 
-	iResult = shutdown(ConnectSocket, SD_SEND);
-    // cleanup
-    closesocket(ConnectSocket);
-    WSACleanup();
+	return 1;
+}
+
+/**
+  * @brief Sends a request and waits for its answer frames
+  *
+  * @param	ptConn		connection
+  * @param  tx			request
+  * @param  rx			answers
+  * @param  iAnswers	number of answer frames
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: send error
+  *			@li -2: no answer
+  */
+static int ExchangeBulk (T_SOCK_CONN *ptConn, uint8 *tx, uint8 *rx, int iAnswers)
+{
+	uint16 u16Tag;
+	int ii;
+
+	if (ptConn->bTagged)
+		return ExchangeTagged(ptConn, tx, rx, 1, iAnswers, &ii);
+	if (SendAll(ptConn->hSock, tx, SARKCMD_TX_SIZE) < 0)
+		return -1;
+	for (ii = 0; ii < iAnswers; ii++)
+	{
+		if (ReadFrame(ptConn, &rx[ii * SARKCMD_RX_SIZE], &u16Tag) < 0)
+			return -2;
+		if (rx[0] != ANS_SARK_OK)
+			break;
+	}
 
 	return 1;
 }
 
 /**
-  * @brief Send receive
+  * @brief Sends tagged requests and waits for their answers, in any order
   *
-  * @param  None
+  *	Each answer frame is put in place by its tag.
+  *
+  * @param	ptConn		connection
+  * @param  tx			requests, up to MAX_BATCH
+  * @param  rx			answers
+  * @param  iCount		number of requests
+  * @param  iAnswers	answer frames to each request
+  * @param  piDone		return number of requests answered, counted from the first
   * @retval
   *			@li 1: Ok
-  *			@li -1: error
+  *			@li -1: send error
+  *			@li -2: no answer, or an answer not asked for
   */
-int Sock_SendReceive (uint8 *tx, uint8 *rx)
+static int ExchangeTagged (T_SOCK_CONN *ptConn, uint8 *tx, uint8 *rx, int iCount, int iAnswers, int *piDone)
+{
+	int tiGot[MAX_BATCH];		/* answer frames received by each request */
+	uint8 *pu8Buf = ptConn->tu8TxBuf;
+	uint8 *pu8Frame;
+	uint16 u16Base = ptConn->u16Tag;
+	uint16 u16Tag;
+	int iLeft = iCount;
+	int ii;
+
+	*piDone = 0;
+	for (ii = 0; ii < iCount; ii++)
+	{
+		PutTag(pu8Buf, (uint16)(u16Base + ii));
+		memcpy(&pu8Buf[TAG_SIZE], &tx[ii * SARKCMD_TX_SIZE], SARKCMD_TX_SIZE);
+		pu8Buf += TAG_SIZE + SARKCMD_TX_SIZE;
+		tiGot[ii] = 0;
+	}
+	ptConn->u16Tag += (uint16)iCount;
+	if (SendAll(ptConn->hSock, ptConn->tu8TxBuf, iCount * (TAG_SIZE + SARKCMD_TX_SIZE)) < 0)
+		return -1;
+
+	while (iLeft > 0)
+	{
+		if (ReadFrame(ptConn, NULL, &u16Tag) < 0)
+			return -2;
+		ii = (uint16)(u16Tag - u16Base);
+		if (ii >= iCount || tiGot[ii] >= iAnswers)
+			return -2;
+		pu8Frame = &rx[(ii * iAnswers + tiGot[ii]) * SARKCMD_RX_SIZE];
+		TakeBytes(ptConn, pu8Frame, SARKCMD_RX_SIZE);
+		tiGot[ii]++;
+		/* An error is answered by a single frame */
+		if (tiGot[ii] == 1 && pu8Frame[0] != ANS_SARK_OK)
+			tiGot[ii] = iAnswers;
+		if (tiGot[ii] == iAnswers)
+			iLeft--;
+		while (*piDone < iCount && tiGot[*piDone] == iAnswers)
+			(*piDone)++;
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Sends a buffer, retrying partial sends
+  */
+static int SendAll (SOCKET hSock, const uint8 *pu8Buf, int iLen)
 {
 	int iResult;
 
-	iResult = send( ConnectSocket, (const char*)tx, SARKCMD_TX_SIZE, 0 );
-    if (iResult == SOCKET_ERROR) {
-        return -1;
-    }
-	memset(rx, 0, SARKCMD_RX_SIZE);
-	iResult = recv(ConnectSocket, (char*)rx, SARKCMD_RX_SIZE, 0);
-	if (iResult <= 0)
-		return -2;
+	while (iLen > 0)
+	{
+		iResult = send(hSock, (const char *)pu8Buf, iLen, 0);
+		if (iResult == SOCKET_ERROR)
+			return -1;
+		pu8Buf += iResult;
+		iLen -= iResult;
+	}
+
+	return 1;
+}
+
+/**
+  * @brief Takes the next answer from the receive buffer
+  *
+  *	Reads as much as fits in the ring buffer when less than a frame is
+  *	buffered, so answers split or coalesced by the network are put back
+  *	together and several of them are taken from one receive. The receive
+  *	is overlapped so its wait also ends when the operation of the calling
+  *	thread is cancelled; the socket is then closed to abort it.
+  *
+  * @param	ptConn		connection
+  * @param  rx			return answer, SARKCMD_RX_SIZE bytes; NULL to only take
+  *						the tag, leaving the answer to TakeBytes
+  * @param  pu16Tag		return tag of tagged frames
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: connection closed, timeout or cancelled
+  */
+static int ReadFrame (T_SOCK_CONN *ptConn, uint8 *rx, uint16 *pu16Tag)
+{
+	OVERLAPPED tOv;
+	WSABUF tBuf;
+	DWORD dwRead = 0;
+	DWORD dwFlags = 0;
+	int iWrite, iFree;
+
+	if (ptConn->iRxCount == 0)
+		ptConn->iRxHead = 0;
+	while (ptConn->iRxCount < RX_FRAME(ptConn))
+	{
+		iWrite = (ptConn->iRxHead + ptConn->iRxCount) % RXBUF_SIZE;
+		if (iWrite >= ptConn->iRxHead)
+			iFree = RXBUF_SIZE - iWrite;
+		else
+			iFree = ptConn->iRxHead - iWrite;
+		tBuf.buf = (char *)&ptConn->tu8RxBuf[iWrite];
+		tBuf.len = iFree;
+		ZeroMemory(&tOv, sizeof(tOv));
+		tOv.hEvent = ptConn->hWait;
+		ResetEvent(tOv.hEvent);
+		if (WSARecv(ptConn->hSock, &tBuf, 1, &dwRead, &dwFlags, &tOv, NULL) == SOCKET_ERROR)
+		{
+			if (WSAGetLastError() != WSA_IO_PENDING)
+				return -1;
+			if (Sark_Cancel_Wait(tOv.hEvent, TIMEOUT_RX) != WAIT_OBJECT_0)
+			{
+				/* The buffer is in use until the aborted receive is over */
+				CloseSocket(ptConn);
+				WaitForSingleObject(tOv.hEvent, INFINITE);
+				return -1;
+			}
+			if (!WSAGetOverlappedResult(ptConn->hSock, &tOv, &dwRead, FALSE, &dwFlags))
+				return -1;
+		}
+		if (dwRead == 0)
+			return -1;
+		ptConn->iRxCount += dwRead;
+	}
+	TakeFrame(ptConn, rx, pu16Tag);
+
+	return 1;
+}
+
+/**
+  * @brief Moves one buffered answer out of the receive buffer
+  *
+  * @param	ptConn		connection
+  * @param  rx			return answer; NULL to take the tag only
+  * @param  pu16Tag		return tag, zero if frames are not tagged
+  */
+static void TakeFrame (T_SOCK_CONN *ptConn, uint8 *rx, uint16 *pu16Tag)
+{
+	uint8 tu8Tag[TAG_SIZE];
+
+	*pu16Tag = 0;
+	if (ptConn->bTagged)
+	{
+		TakeBytes(ptConn, tu8Tag, TAG_SIZE);
+		*pu16Tag = (uint16)(tu8Tag[0] | (tu8Tag[1] << 8));
+	}
+	if (rx != NULL)
+		TakeBytes(ptConn, rx, SARKCMD_RX_SIZE);
+}
+
+/**
+  * @brief Moves buffered bytes out of the receive buffer
+  */
+static void TakeBytes (T_SOCK_CONN *ptConn, uint8 *pu8Buf, int iLen)
+{
+	int iFirst;
+
+	iFirst = RXBUF_SIZE - ptConn->iRxHead;
+	if (iFirst > iLen)
+		iFirst = iLen;
+	memcpy(pu8Buf, &ptConn->tu8RxBuf[ptConn->iRxHead], iFirst);
+	memcpy(&pu8Buf[iFirst], ptConn->tu8RxBuf, iLen - iFirst);
+	ptConn->iRxHead = (ptConn->iRxHead + iLen) % RXBUF_SIZE;
+	ptConn->iRxCount -= iLen;
+}
+
+/**
+  * @brief Writes a tag in front of a request
+  */
+static void PutTag (uint8 *pu8Buf, uint16 u16Tag)
+{
+	pu8Buf[0] = (uint8)u16Tag;
+	pu8Buf[1] = (uint8)(u16Tag >> 8);
+}
+
+/**
+  * @brief Reopens a lost connection
+  *
+  *	The delay between attempts doubles up to BACKOFF_MAX and is kept across
+  *	requests: while a server stays down, requests fail at once until the
+  *	next attempt is due. It goes back to BACKOFF_MIN once connected.
+  *	A cancelled operation gives up at once, leaving the backoff as it was.
+  *
+  * @retval	TRUE if connected
+  */
+static bool Reconnect (T_SOCK_CONN *ptConn)
+{
+	int ii;
+
+	if (ptConn->szHost[0] == 0)
+		return FALSE;
+	if ((LONG)(GetTickCount() - ptConn->dwRetryAt) < 0)
+		return FALSE;
+	for (ii = 0; ii < NUM_RETRIES; ii++)
+	{
+		if (Sark_Cancel_Pending())
+			return FALSE;
+		if (ii != 0)
+		{
+			Sark_Cancel_Wait(NULL, ptConn->dwBackoff);
+			if (Sark_Cancel_Pending())
+				return FALSE;
+			ptConn->dwBackoff *= 2;
+			if (ptConn->dwBackoff > BACKOFF_MAX)
+				ptConn->dwBackoff = BACKOFF_MAX;
+		}
+		if (OpenSockets(ptConn, 1, ptConn->hWait) == 1)
+		{
+			ptConn->dwBackoff = BACKOFF_MIN;
+			return TRUE;
+		}
+		if (Sark_Cancel_Pending())
+			return FALSE;
+		if (ptConn->dwBackoff >= BACKOFF_MAX)
+			break;
+	}
+	ptConn->dwRetryAt = GetTickCount() + ptConn->dwBackoff;
+
+	return FALSE;
+}
+
+/**
+  * @brief Tells if a request can be sent again without side effects
+  *
+  *	Requests that press keys, sound the buzzer, reset the device or drive
+  *	GPIOs may have been executed before the connection was lost.
+  */
+static bool IsIdempotent (uint8 u8Cmd)
+{
+	switch (u8Cmd)
+	{
+	case CMD_SARK_VERSION:
+	case CMD_SARK_MEAS_RX:
+	case CMD_SARK_MEAS_VECTOR:
+	case CMD_SARK_SIGNAL_GEN:
+	case CMD_SARK_MEAS_RF:
+	case CMD_SARK_MEAS_VEC_THRU:
+	case CMD_BATT_STAT:
+	case CMD_DISK_INFO:
+	case CMD_DISK_VOLUME:
+	case CMD_SET_SETTING:
+	case CMD_GET_SETTING:
+	case CMD_SARK_MEAS_RX_EFF:
+	case CMD_SARK_MEAS_RX_BULK:
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+/**
+  * @brief Hands a request to the event loop
+  *
+  * @param	ptConn		connection
+  * @param	ptReq		request
+  * @param	bReopen		reopen the connection if lost
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error; the request is not submitted
+  */
+static int Post (T_SOCK_CONN *ptConn, T_SOCK_REQ *ptReq, bool bReopen)
+{
+	ptReq->iSent = 0;
+	ptReq->iDone = 0;
+	ptReq->iResult = 0;
+	ptReq->ptNext = NULL;
+	EnterCriticalSection(&ptConn->csLock);
+	if (glLoopStop != 0)
+	{
+		LeaveCriticalSection(&ptConn->csLock);
+		return -1;
+	}
+	/*
+	 * A socket being closed by the loop is reopened once its requests have
+	 * failed. The loop connects, so the lock is never held while waiting;
+	 * while a server stays down, requests fail at once until the next
+	 * attempt is due.
+	 */
+	if (ptConn->hSock == INVALID_SOCKET && !ptConn->bConnecting && ptConn->ptHead == NULL
+		&& !ptConn->bRxBusy && !ptConn->bTxBusy)
+	{
+		if (!bReopen || ptConn->szHost[0] == 0 || (LONG)(GetTickCount() - ptConn->dwRetryAt) < 0)
+		{
+			LeaveCriticalSection(&ptConn->csLock);
+			return -1;
+		}
+		ptConn->bConnecting = TRUE;
+		ptConn->iAttempts = 0;
+		ptConn->dwConnectAt = GetTickCount();
+	}
+	if (!BindSocket(ptConn))
+	{
+		CloseSocket(ptConn);
+		LeaveCriticalSection(&ptConn->csLock);
+		return -1;
+	}
+	if (ptConn->ptTail != NULL)
+		ptConn->ptTail->ptNext = ptReq;
+	else
+		ptConn->ptHead = ptReq;
+	ptConn->ptTail = ptReq;
+	if (ptConn->ptSend == NULL)
+		ptConn->ptSend = ptReq;
+	LeaveCriticalSection(&ptConn->csLock);
+	/* Wakes up the loop to send it */
+	PostQueuedCompletionStatus(ghPort, 0, (ULONG_PTR)ptConn, NULL);
+
 	return 1;
 }
 
 /**
-  * @brief Connect timer timeout callback
+  * @brief Takes back a request of a cancelled operation
+  *
+  *	A request not sent yet is removed from the queue. Once sent, answers
+  *	are due that would be taken as those of the next requests, so the
+  *	connection is failed instead and the request completes with the others.
+  *
+  * @retval	TRUE if removed; FALSE if it is or will be completed by the loop
+  */
+static bool Withdraw (T_SOCK_CONN *ptConn, T_SOCK_REQ *ptReq)
+{
+	T_SOCK_REQ *ptPrev = NULL;
+	T_SOCK_REQ *ptIt;
+
+	EnterCriticalSection(&ptConn->csLock);
+	if (ptReq->iResult != 0)
+	{
+		/* Completed meanwhile */
+		LeaveCriticalSection(&ptConn->csLock);
+		return FALSE;
+	}
+	if (ptReq->iSent != 0)
+	{
+		Fail(ptConn, -1);
+		LeaveCriticalSection(&ptConn->csLock);
+		return FALSE;
+	}
+	for (ptIt = ptConn->ptHead; ptIt != ptReq; ptIt = ptIt->ptNext)
+		ptPrev = ptIt;
+	if (ptPrev == NULL)
+		ptConn->ptHead = ptReq->ptNext;
+	else
+		ptPrev->ptNext = ptReq->ptNext;
+	if (ptConn->ptTail == ptReq)
+		ptConn->ptTail = ptPrev;
+	if (ptConn->ptSend == ptReq)
+		ptConn->ptSend = ptReq->ptNext;
+	ptReq->iResult = -1;
+	LeaveCriticalSection(&ptConn->csLock);
+
+	return TRUE;
+}
+
+/**
+  * @brief Associates the socket of a connection with the completion port
+  *
+  * @retval	FALSE if failed
+  */
+static bool BindSocket (T_SOCK_CONN *ptConn)
+{
+	if (ptConn->hSock == INVALID_SOCKET || ptConn->hBound == ptConn->hSock)
+		return TRUE;
+	if (CreateIoCompletionPort((HANDLE)ptConn->hSock, ghPort, (ULONG_PTR)ptConn, 0) == NULL)
+		return FALSE;
+	ptConn->hBound = ptConn->hSock;
+
+	return TRUE;
+}
+
+/**
+  * @brief Sends requests through the event loop and waits for their answers
+  *
+  *	As the blocking exchange, the requests not yet answered are sent again
+  *	once on a new connection if all of them can be repeated. If the
+  *	operation of the calling thread is cancelled, the requests are taken
+  *	back when none was sent yet, or else their connection is failed.
+  *
+  * @retval
+  *			@li 1: Ok
+  *			@li -1: error
+  *			@li -2: no answer
+  */
+static int LoopSendReceive (T_SOCK_CONN *ptConn, uint8 *tx, uint8 *rx, int iCount, int iAnswers, bool bReopen)
+{
+	T_SOCK_REQ tReq;
+	int iTry;
+	int iReq;
+	int ii;
+
+	/* One event per thread, kept for its life: a thread waits for one request at a time */
+	if (ghReqEvent == NULL)
+		ghReqEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (ghReqEvent == NULL)
+		return -1;
+	tReq.hEvent = ghReqEvent;
+	tReq.pu8Tx = tx;
+	tReq.pu8Rx = rx;
+	tReq.iCount = iCount;
+	tReq.iAnswers = iAnswers;
+	tReq.iResult = -1;
+	for (iTry = 0; iTry < 2; iTry++)
+	{
+		if (Post(ptConn, &tReq, bReopen) < 0)
+		{
+			tReq.iResult = -1;
+			break;
+		}
+		/* The loop completes every request, at the latest by its deadline */
+		if (Sark_Cancel_Wait(tReq.hEvent, INFINITE) != WAIT_OBJECT_0 && !Withdraw(ptConn, &tReq))
+			WaitForSingleObject(tReq.hEvent, INFINITE);
+		if (tReq.iResult > 0 || !bReopen || Sark_Cancel_Pending())
+			break;
+		/* Requests partly answered are sent again whole; tagged answers
+		   may have come in any order, so all of them are sent again */
+		iReq = ptConn->bTagged ? 0 : tReq.iDone / tReq.iAnswers;
+		for (ii = iReq; ii < tReq.iCount; ii++)
+		{
+			if (!IsIdempotent(tReq.pu8Tx[ii * SARKCMD_TX_SIZE]))
+				break;
+		}
+		if (ii < tReq.iCount)
+			break;
+		tReq.pu8Tx += iReq * SARKCMD_TX_SIZE;
+		tReq.pu8Rx += iReq * tReq.iAnswers * SARKCMD_RX_SIZE;
+		tReq.iCount -= iReq;
+	}
+
+	return tReq.iResult;
+}
+
+/**
+  * @brief Event loop
+  *
+  *	Waits on the completion port for finished sends and receives, and for
+  *	the wake-ups posted by Post; every LOOP_TICK it fails the connections
+  *	whose answers are overdue and polls the ones being reopened. A
+  *	connection locked by another thread is skipped until the next tick.
+  *	When stopped, it closes its sockets and waits for their aborted
+  *	operations before failing what is left.
+  */
+static DWORD WINAPI LoopThread (LPVOID lpParam)
+{
+	T_SOCK_CONN *ptConn;
+	OVERLAPPED *ptOv;
+	ULONG_PTR ulKey;
+	DWORD dwBytes;
+	DWORD dwNow;
+	DWORD dwScan = GetTickCount() + LOOP_TICK;
+	DWORD dwStart;
+	BOOL bOk;
+	bool bBusy;
+	int ii;
+
+	while (glLoopStop == 0)
+	{
+		bOk = GetQueuedCompletionStatus(ghPort, &dwBytes, &ulKey, &ptOv, LOOP_TICK);
+		/* Nothing dequeued on timeout; a NULL key is the stop wake-up */
+		ptConn = (bOk || ptOv != NULL) ? (T_SOCK_CONN *)ulKey : NULL;
+		if (ptConn != NULL)
+		{
+			EnterCriticalSection(&ptConn->csLock);
+			if (ptOv != NULL)
+				Completed(ptConn, ptOv, bOk, dwBytes);
+			else
+				Pump(ptConn);
+			LeaveCriticalSection(&ptConn->csLock);
+		}
+		dwNow = GetTickCount();
+		if ((LONG)(dwNow - dwScan) >= 0)
+		{
+			for (ii = 0; ii < giServers; ii++)
+			{
+				ptConn = &gtConn[ii];
+				if (!TryEnterCriticalSection(&ptConn->csLock))
+					continue;
+				if (ptConn->iInFlight > 0 && ptConn->hSock != INVALID_SOCKET
+					&& (LONG)(dwNow - ptConn->dwDeadline) >= 0)
+					Fail(ptConn, -2);
+				else if (ptConn->bConnecting)
+					Pump(ptConn);
+				LeaveCriticalSection(&ptConn->csLock);
+			}
+			dwScan = dwNow + LOOP_TICK;
+		}
+	}
+
+	/* Stop: sockets bound to this port cannot be used without it */
+	for (ii = 0; ii < SOCK_MAX_SERVERS; ii++)
+	{
+		ptConn = &gtConn[ii];
+		EnterCriticalSection(&ptConn->csLock);
+		if (ptConn->hBound != INVALID_SOCKET)
+			CloseSocket(ptConn);
+		Fail(ptConn, -1);
+		LeaveCriticalSection(&ptConn->csLock);
+	}
+	dwStart = GetTickCount();
+	do
+	{
+		bBusy = FALSE;
+		for (ii = 0; ii < SOCK_MAX_SERVERS; ii++)
+			bBusy |= gtConn[ii].bRxBusy || gtConn[ii].bTxBusy;
+		if (!bBusy)
+			break;
+		bOk = GetQueuedCompletionStatus(ghPort, &dwBytes, &ulKey, &ptOv, LOOP_TICK);
+		ptConn = (T_SOCK_CONN *)ulKey;
+		if (ptOv != NULL)
+		{
+			EnterCriticalSection(&ptConn->csLock);
+			Completed(ptConn, ptOv, bOk, dwBytes);
+			LeaveCriticalSection(&ptConn->csLock);
+		}
+	} while (GetTickCount() - dwStart < TIMEOUT_RX);
+
+	return 0;
+}
+
+/**
+  * @brief Handles a finished send or receive
+  */
+static void Completed (T_SOCK_CONN *ptConn, OVERLAPPED *ptOv, BOOL bOk, DWORD dwBytes)
+{
+	T_SOCK_REQ *ptReq;
+	uint8 *pu8Frame;
+	uint16 u16Tag;
+
+	if (ptOv == &ptConn->tTxOv)
+	{
+		ptConn->bTxBusy = FALSE;
+		if (ptConn->hSock == INVALID_SOCKET)
+			;	/* aborted by Fail */
+		else if (!bOk || dwBytes == 0)
+			Fail(ptConn, -1);
+		else
+			ptConn->iTxSent += dwBytes;
+	}
+	else if (ptOv == &ptConn->tRxOv)
+	{
+		ptConn->bRxBusy = FALSE;
+		if (ptConn->hSock == INVALID_SOCKET)
+			;	/* aborted by Fail */
+		else if (!bOk || dwBytes == 0)
+			Fail(ptConn, -1);
+		else
+		{
+			ptConn->iRxCount += dwBytes;
+			while (ptConn->iRxCount >= RX_FRAME(ptConn))
+			{
+				if (ptConn->bTagged)
+				{
+					if (!TakeTagged(ptConn))
+					{
+						Fail(ptConn, -1);
+						break;
+					}
+					continue;
+				}
+				ptReq = ptConn->ptHead;
+				if (ptReq == NULL || ptReq->iDone >= ptReq->iSent * ptReq->iAnswers)
+				{
+					/* Not asked for: the stream is out of step */
+					Fail(ptConn, -1);
+					break;
+				}
+				pu8Frame = &ptReq->pu8Rx[ptReq->iDone * SARKCMD_RX_SIZE];
+				TakeFrame(ptConn, pu8Frame, &u16Tag);
+				ptReq->iDone++;
+				ptConn->iInFlight--;
+				ptConn->dwDeadline = GetTickCount() + TIMEOUT_RX;
+				if (ptReq->iAnswers > 1 && ptReq->iDone == 1 && pu8Frame[0] != ANS_SARK_OK)
+				{
+					/* An error is answered by a single frame */
+					ptConn->iInFlight -= ptReq->iAnswers - 1;
+					ptReq->iDone = ptReq->iAnswers;
+				}
+				if (ptReq->iDone == ptReq->iCount * ptReq->iAnswers)
+				{
+					ptConn->ptHead = ptReq->ptNext;
+					if (ptConn->ptHead == NULL)
+						ptConn->ptTail = NULL;
+					Complete(ptReq, 1);
+				}
+			}
+			if (ptConn->iRxCount == 0)
+				ptConn->iRxHead = 0;
+		}
+	}
+	Pump(ptConn);
+}
+
+/**
+  * @brief Starts the sends and receives a connection can take
+  *
+  *	Requests are taken in order from the submitted ones, while fewer than
+  *	MAX_BATCH answers are due, and sent in a single send. A receive is kept posted
+  *	while answers are due. Once the socket is lost and its operations are
+  *	over, the requests left are failed, unless the connection is being
+  *	reopened: they are sent once connected.
+  */
+static void Pump (T_SOCK_CONN *ptConn)
+{
+	T_SOCK_REQ *ptReq;
+	WSABUF tBuf;
+	DWORD dwFlags = 0;
+	int iWrite, iFree;
+	int iFrames, iDue, iTake;
+	int iLen;
+
+	if (ptConn->hSock == INVALID_SOCKET && ptConn->bConnecting)
+		LoopConnect(ptConn);
+	if (ptConn->hSock == INVALID_SOCKET)
+	{
+		if (!ptConn->bConnecting && !ptConn->bRxBusy && !ptConn->bTxBusy)
+		{
+			while (ptConn->ptHead != NULL)
+			{
+				ptReq = ptConn->ptHead;
+				ptConn->ptHead = ptReq->ptNext;
+				Complete(ptReq, ptConn->iFailRc);
+			}
+			ptConn->ptTail = NULL;
+			ptConn->ptSend = NULL;
+			ptConn->iInFlight = 0;
+			memset(ptConn->ptTagReq, 0, sizeof(ptConn->ptTagReq));
+			ptConn->iTxLen = 0;
+			ptConn->iTxSent = 0;
+		}
+		return;
+	}
+
+	if (!ptConn->bTxBusy)
+	{
+		if (ptConn->iTxSent >= ptConn->iTxLen)
+		{
+			/* Next batch */
+			iFrames = 0;
+			iDue = 0;
+			iLen = 0;
+			while (ptConn->ptSend != NULL && ptConn->iInFlight + iDue < MAX_BATCH)
+			{
+				ptReq = ptConn->ptSend;
+				iTake = ptReq->iCount - ptReq->iSent;
+				if (iTake * ptReq->iAnswers > MAX_BATCH - ptConn->iInFlight - iDue)
+					iTake = (MAX_BATCH - ptConn->iInFlight - iDue) / ptReq->iAnswers;
+				if (iTake == 0)
+				{
+					/* Too many answers: sent alone once the others are in */
+					if (ptConn->iInFlight + iDue > 0)
+						break;
+					iTake = 1;
+				}
+				if (ptConn->bTagged)
+					iLen += PutTagged(ptConn, ptReq, iTake, &ptConn->tu8TxBuf[iLen]);
+				else
+				{
+					memcpy(&ptConn->tu8TxBuf[iLen],
+						&ptReq->pu8Tx[ptReq->iSent * SARKCMD_TX_SIZE], iTake * SARKCMD_TX_SIZE);
+					iLen += iTake * SARKCMD_TX_SIZE;
+				}
+				ptReq->iSent += iTake;
+				iFrames += iTake;
+				iDue += iTake * ptReq->iAnswers;
+				if (ptReq->iSent == ptReq->iCount)
+					ptConn->ptSend = ptReq->ptNext;
+			}
+			if (iFrames > 0 && ptConn->iInFlight == 0)
+				ptConn->dwDeadline = GetTickCount() + TIMEOUT_RX;
+			ptConn->iInFlight += iDue;
+			ptConn->iTxLen = iLen;
+			ptConn->iTxSent = 0;
+		}
+		if (ptConn->iTxSent < ptConn->iTxLen)
+		{
+			tBuf.buf = (char *)&ptConn->tu8TxBuf[ptConn->iTxSent];
+			tBuf.len = ptConn->iTxLen - ptConn->iTxSent;
+			ZeroMemory(&ptConn->tTxOv, sizeof(OVERLAPPED));
+			ptConn->bTxBusy = TRUE;
+			if (WSASend(ptConn->hSock, &tBuf, 1, NULL, 0, &ptConn->tTxOv, NULL) == SOCKET_ERROR
+				&& WSAGetLastError() != WSA_IO_PENDING)
+			{
+				ptConn->bTxBusy = FALSE;
+				Fail(ptConn, -1);
+				return;
+			}
+		}
+	}
+
+	if (!ptConn->bRxBusy && ptConn->iInFlight > 0)
+	{
+		/* The buffer holds more than MAX_BATCH answers, so it is never full here */
+		iWrite = (ptConn->iRxHead + ptConn->iRxCount) % RXBUF_SIZE;
+		if (iWrite >= ptConn->iRxHead)
+			iFree = RXBUF_SIZE - iWrite;
+		else
+			iFree = ptConn->iRxHead - iWrite;
+		tBuf.buf = (char *)&ptConn->tu8RxBuf[iWrite];
+		tBuf.len = iFree;
+		ZeroMemory(&ptConn->tRxOv, sizeof(OVERLAPPED));
+		ptConn->bRxBusy = TRUE;
+		if (WSARecv(ptConn->hSock, &tBuf, 1, NULL, &dwFlags, &ptConn->tRxOv, NULL) == SOCKET_ERROR
+			&& WSAGetLastError() != WSA_IO_PENDING)
+		{
+			ptConn->bRxBusy = FALSE;
+			Fail(ptConn, -1);
+		}
+	}
+}
+
+/**
+  * @brief Reopens a connection of the event loop, without waiting
   *
+  *	Starts a non-blocking connect to the stored address, and checks it on
+  *	the next calls, at least every LOOP_TICK, until it is connected or
+  *	TIMEOUT_CONNECT is over. Failed attempts are repeated with the backoff
+  *	of Reconnect; when they run out, the requests waiting fail with -1.
   */
-static void CALLBACK TimerProc(PVOID lpParameter, BOOLEAN TimerOrWaitFired)
+static void LoopConnect (T_SOCK_CONN *ptConn)
 {
-	closesocket(ConnectSocket);
+	DWORD dwNow = GetTickCount();
+	u_long ulMode = 1;
+	fd_set tWrite, tExcept;
+	struct timeval tPoll = { 0, 0 };
+	int iErr = 0;
+	int iLen = sizeof(iErr);
+	int iReady;
+
+	if (ptConn->hConnect == INVALID_SOCKET)
+	{
+		if ((LONG)(dwNow - ptConn->dwConnectAt) < 0)
+			return;		/* backoff */
+		if (ptConn->iAddrLen > 0)
+			ptConn->hConnect = socket(ptConn->tAddr.ss_family, SOCK_STREAM, 0);
+		if (ptConn->hConnect == INVALID_SOCKET
+			|| ioctlsocket(ptConn->hConnect, FIONBIO, &ulMode) == SOCKET_ERROR
+			|| (connect(ptConn->hConnect, (struct sockaddr *)&ptConn->tAddr, ptConn->iAddrLen) == SOCKET_ERROR
+				&& WSAGetLastError() != WSAEWOULDBLOCK))
+		{
+			ConnectFailed(ptConn, dwNow);
+			return;
+		}
+		ptConn->dwConnectAt = dwNow + TIMEOUT_CONNECT;
+	}
+	FD_ZERO(&tWrite);
+	FD_ZERO(&tExcept);
+	FD_SET(ptConn->hConnect, &tWrite);
+	FD_SET(ptConn->hConnect, &tExcept);
+	/* Writable when connected; failure is signaled in the except set */
+	iReady = select((int)ptConn->hConnect + 1, NULL, &tWrite, &tExcept, &tPoll);
+	if (iReady == 0)
+	{
+		if ((LONG)(dwNow - ptConn->dwConnectAt) >= 0)
+			ConnectFailed(ptConn, dwNow);
+		return;
+	}
+	if (iReady < 0 || !FD_ISSET(ptConn->hConnect, &tWrite)
+		|| getsockopt(ptConn->hConnect, SOL_SOCKET, SO_ERROR, (char *)&iErr, &iLen) == SOCKET_ERROR
+		|| iErr != 0)
+	{
+		ConnectFailed(ptConn, dwNow);
+		return;
+	}
+	ulMode = 0;
+	ioctlsocket(ptConn->hConnect, FIONBIO, &ulMode);
+	ptConn->hSock = ptConn->hConnect;
+	ptConn->hConnect = INVALID_SOCKET;
+	ptConn->bConnecting = FALSE;
+	ptConn->dwBackoff = BACKOFF_MIN;
+	if (!BindSocket(ptConn))
+	{
+		CloseSocket(ptConn);
+		ptConn->iFailRc = -1;
+	}
+}
+
+/**
+  * @brief Ends a failed connection attempt of the event loop
+  *
+  *	The next one is due after the backoff delay, which doubles up to
+  *	BACKOFF_MAX. After NUM_RETRIES attempts, or at BACKOFF_MAX, the loop
+  *	gives up until dwRetryAt.
+  */
+static void ConnectFailed (T_SOCK_CONN *ptConn, DWORD dwNow)
+{
+	if (ptConn->hConnect != INVALID_SOCKET)
+	{
+		closesocket(ptConn->hConnect);
+		ptConn->hConnect = INVALID_SOCKET;
+	}
+	ptConn->iAttempts++;
+	if (ptConn->iAttempts >= NUM_RETRIES || ptConn->dwBackoff >= BACKOFF_MAX)
+	{
+		ptConn->bConnecting = FALSE;
+		ptConn->dwRetryAt = dwNow + ptConn->dwBackoff;
+		ptConn->iFailRc = -1;
+		return;
+	}
+	ptConn->dwConnectAt = dwNow + ptConn->dwBackoff;
+	ptConn->dwBackoff *= 2;
+	if (ptConn->dwBackoff > BACKOFF_MAX)
+		ptConn->dwBackoff = BACKOFF_MAX;
+}
+
+/**
+  * @brief Copies requests to the send buffer, each one with a free tag
+  *
+  *	No more than MAX_BATCH requests are in flight, so a tag is always free.
+  *
+  * @retval	bytes written
+  */
+static int PutTagged (T_SOCK_CONN *ptConn, T_SOCK_REQ *ptReq, int iTake, uint8 *pu8Buf)
+{
+	int iTag;
+	int ii;
+
+	for (ii = 0; ii < iTake; ii++)
+	{
+		iTag = ptConn->iTagNext;
+		while (ptConn->ptTagReq[iTag] != NULL)
+			iTag = (iTag + 1) % MAX_BATCH;
+		ptConn->iTagNext = (iTag + 1) % MAX_BATCH;
+		ptConn->ptTagReq[iTag] = ptReq;
+		ptConn->tiTagIdx[iTag] = ptReq->iSent + ii;
+		ptConn->tiTagLeft[iTag] = ptReq->iAnswers;
+		PutTag(&pu8Buf[ii * (TAG_SIZE + SARKCMD_TX_SIZE)], (uint16)iTag);
+		memcpy(&pu8Buf[ii * (TAG_SIZE + SARKCMD_TX_SIZE) + TAG_SIZE],
+			&ptReq->pu8Tx[(ptReq->iSent + ii) * SARKCMD_TX_SIZE], SARKCMD_TX_SIZE);
+	}
+
+	return iTake * (TAG_SIZE + SARKCMD_TX_SIZE);
+}
+
+/**
+  * @brief Routes one buffered tagged answer to its request
+  *
+  *	The request is completed with its last answer, wherever it is in the
+  *	list of submitted requests.
+  *
+  * @retval	FALSE if the tag was not asked for
+  */
+static bool TakeTagged (T_SOCK_CONN *ptConn)
+{
+	T_SOCK_REQ *ptReq, *ptPrev, *ptIt;
+	uint8 *pu8Frame;
+	uint16 u16Tag;
+	int iFrame;
+
+	TakeFrame(ptConn, NULL, &u16Tag);
+	if (u16Tag >= MAX_BATCH || ptConn->ptTagReq[u16Tag] == NULL)
+		return FALSE;
+	ptReq = ptConn->ptTagReq[u16Tag];
+	iFrame = ptConn->tiTagIdx[u16Tag] * ptReq->iAnswers + ptReq->iAnswers - ptConn->tiTagLeft[u16Tag];
+	pu8Frame = &ptReq->pu8Rx[iFrame * SARKCMD_RX_SIZE];
+	TakeBytes(ptConn, pu8Frame, SARKCMD_RX_SIZE);
+	ptReq->iDone++;
+	ptConn->iInFlight--;
+	ptConn->dwDeadline = GetTickCount() + TIMEOUT_RX;
+	ptConn->tiTagLeft[u16Tag]--;
+	if (ptConn->tiTagLeft[u16Tag] == ptReq->iAnswers - 1 && pu8Frame[0] != ANS_SARK_OK)
+	{
+		/* An error is answered by a single frame */
+		ptConn->iInFlight -= ptConn->tiTagLeft[u16Tag];
+		ptReq->iDone += ptConn->tiTagLeft[u16Tag];
+		ptConn->tiTagLeft[u16Tag] = 0;
+	}
+	if (ptConn->tiTagLeft[u16Tag] == 0)
+		ptConn->ptTagReq[u16Tag] = NULL;
+
+	if (ptReq->iDone == ptReq->iCount * ptReq->iAnswers)
+	{
+		ptPrev = NULL;
+		for (ptIt = ptConn->ptHead; ptIt != ptReq; ptIt = ptIt->ptNext)
+			ptPrev = ptIt;
+		if (ptPrev == NULL)
+			ptConn->ptHead = ptReq->ptNext;
+		else
+			ptPrev->ptNext = ptReq->ptNext;
+		if (ptConn->ptTail == ptReq)
+			ptConn->ptTail = ptPrev;
+		Complete(ptReq, 1);
+	}
+
+	return TRUE;
+}
+
+/**
+  * @brief Closes a lost connection of the event loop
+  *
+  *	Its requests fail with the given result once the operations aborted by
+  *	closing the socket have come back.
+  */
+static void Fail (T_SOCK_CONN *ptConn, int iResult)
+{
+	if (ptConn->hSock != INVALID_SOCKET || ptConn->bConnecting)
+	{
+		CloseSocket(ptConn);
+		ptConn->iFailRc = iResult;
+	}
+	else if (ptConn->ptHead != NULL)
+		ptConn->iFailRc = iResult;
+	Pump(ptConn);
+}
+
+/**
+  * @brief Completes a request of the event loop
+  *
+  *	The request belongs to the caller again once signaled.
+  */
+static void Complete (T_SOCK_REQ *ptReq, int iResult)
+{
+	HANDLE hEvent = ptReq->hEvent;
+
+	ptReq->ptNext = NULL;
+	ptReq->iResult = iResult;
+	SetEvent(hEvent);
 }
 
 /**
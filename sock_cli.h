@@ -38,15 +38,22 @@
 #define __SOCK_CLI_H__
 
 /* Includes ------------------------------------------------------------------*/
+#include <winsock2.h>
 #include "device.h"
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
+#define SOCK_MAX_SERVERS	64	/* maximum number of servers in the list */
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
-int Sock_Connect (char* serverAddr);
-int Sock_Close (void);
-int Sock_SendReceive (uint8 *tx, uint8 *rx);
+int Sock_Connect (char* serverAddr, bool bLocal);
+int Sock_Close (int16 num);
+int Sock_SendReceive (int16 num, uint8 *tx, uint8 *rx);
+int Sock_SendReceiveN (int16 num, uint8 *tx, uint8 *rx, int iCount);
+int Sock_SendReceiveBulk (int16 num, uint8 *tx, uint8 *rx, int iAnswers);
+int Sock_Loop_Start (void);
+int Sock_Loop_Stop (void);
+SOCKET Sock_Listen (uint16 u16Port, int iBacklog);
 
 #endif	 /* __SOCK_CLI_H__ */
 
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file    hid_none.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - HID interface without devices
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/*
+ * Stands in for hid_WINDOWS.cpp in the tests that only use the other
+ * interfaces, as the Windows driver stack is not available.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "hid.h"
+
+/* Private functions ---------------------------------------------------------*/
+
+int rawhid_open (int max, int vid, int pid, int usage_page, int usage) { return 0; }
+int rawhid_recv_report (int num, void *report, int len, int timeout) { return -1; }
+int rawhid_send_report (int num, void *report, int len, int timeout, int retry) { return -1; }
+void rawhid_close (int num) { }
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    test.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - checks
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TEST_H__
+#define __TEST_H__
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+
+/* Exported variables --------------------------------------------------------*/
+static int giTestFailed;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Reports a failed check and goes on with the test */
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) \
+		{ \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			giTestFailed++; \
+		} \
+	} while (0)
+
+/* Prints the outcome; the exit status of the test */
+#define TEST_RESULT(name) \
+	(printf("%s: %s\n", (name), giTestFailed ? "FAILED" : "passed"), giTestFailed != 0)
+
+#endif	 /* __TEST_H__ */
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
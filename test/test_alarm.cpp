@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file    test_alarm.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - sweep change detection
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sark_alarm.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define ALARM_POINTS	4
+#define ALARM_R			50.0f
+#define ALARM_STEP		10.0f	/* change of R that raises every point */
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Builds the baseline and moves every point away from it
+  *
+  * @retval	events generated by the change
+  */
+static int Change (T_SARK_ALARM *pAlarm)
+{
+	float tfR[ALARM_POINTS], tfX[ALARM_POINTS];
+	int ii;
+
+	for (ii = 0; ii < ALARM_POINTS; ii++)
+	{
+		tfR[ii] = ALARM_R;
+		tfX[ii] = 0;
+	}
+	Sark_Alarm_Update(pAlarm, 1, tfR, tfX);
+	Sark_Alarm_Update(pAlarm, 2, tfR, tfX);
+	for (ii = 0; ii < ALARM_POINTS; ii++)
+		tfR[ii] += ALARM_STEP;
+	return Sark_Alarm_Update(pAlarm, 3, tfR, tfX);
+}
+
+/**
+  * @brief The queue holds as many events as asked for, and counts the rest
+  */
+static void TestQueue (int iQueue)
+{
+	T_SARK_ALARM *pAlarm;
+	T_SARK_ALARM_EVENT tEvents[ALARM_POINTS];
+	uint32 u32Lost = 0;
+	int iKept = iQueue < ALARM_POINTS ? iQueue : ALARM_POINTS;
+	int ii;
+
+	pAlarm = Sark_Alarm_Create(ALARM_POINTS, 2, 0.1f, 3.0f, 1.0f, iQueue);
+	CHECK(pAlarm != NULL);
+	if (pAlarm == NULL)
+		return;
+	CHECK(Change(pAlarm) == iKept);
+	CHECK(Sark_Alarm_GetEvents(pAlarm, tEvents, ALARM_POINTS, &u32Lost) == iKept);
+	CHECK(u32Lost == (uint32)(ALARM_POINTS - iKept));
+	for (ii = 0; ii < iKept; ii++)
+	{
+		CHECK(tEvents[ii].u32Seq == 3 && tEvents[ii].i32Point == ii);
+		CHECK(tEvents[ii].u8Type == ALARM_RAISE && tEvents[ii].fR == ALARM_R + ALARM_STEP);
+	}
+	CHECK(Sark_Alarm_GetEvents(pAlarm, tEvents, ALARM_POINTS, &u32Lost) == 0);
+	CHECK(u32Lost == 0);
+	Sark_Alarm_Destroy(pAlarm);
+}
+
+int main (void)
+{
+	CHECK(Sark_Alarm_Create(ALARM_POINTS, 2, 0.1f, 3.0f, 1.0f, 0) == NULL);
+	TestQueue(1);
+	TestQueue(3);
+	TestQueue(ALARM_POINTS);
+	return TEST_RESULT("test_alarm");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,236 @@
+/**
+  ******************************************************************************
+  * @file    test_batch.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - batched requests of plans and sweeps
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include "sock_cli.h"
+#include "sark_cmd_defs.h"
+#include "sark_rem_client.h"
+#include "sark_plan.h"
+#include "sark_sweep.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PORT_MOCK		18140
+#define MAX_FRAMES		64		/* requests read at once by the mock server */
+#define NUM_POINTS		100
+#define REGION_POINTS	10
+#define MIN_SAMPLES		2
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Mock device: R is the frequency in MHz and X the samples requested */
+typedef struct
+{
+	SOCKET hListen;
+	volatile LONG lMaxRead;		/* most requests taken by one recv */
+	volatile LONG lRequests;
+	volatile LONG lStop;
+} T_MOCK_SERVER;
+
+/* Private variables ---------------------------------------------------------*/
+static T_MOCK_SERVER gtSrv;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Answers the requests of one connection until it closes
+  */
+static void ServeClient (T_MOCK_SERVER *ptSrv, SOCKET hSock)
+{
+	uint8 tu8Buf[MAX_FRAMES * SARKCMD_TX_SIZE];
+	uint8 tu8Answer[MAX_FRAMES * SARKCMD_RX_SIZE];
+	uint8 *pu8Req;
+	uint8 *pu8Ans;
+	uint32 u32Freq;
+	int iLen = 0;
+	int iRead;
+	int iFrames;
+	int ii;
+
+	while (ptSrv->lStop == 0)
+	{
+		iRead = recv(hSock, (char *)&tu8Buf[iLen], sizeof(tu8Buf) - iLen, 0);
+		if (iRead <= 0)
+			break;
+		iLen += iRead;
+		iFrames = iLen / SARKCMD_TX_SIZE;
+		if (iFrames > ptSrv->lMaxRead)
+			InterlockedExchange(&ptSrv->lMaxRead, iFrames);
+		InterlockedExchangeAdd(&ptSrv->lRequests, iFrames);
+		memset(tu8Answer, 0, sizeof(tu8Answer));
+		for (ii = 0; ii < iFrames; ii++)
+		{
+			pu8Req = &tu8Buf[ii * SARKCMD_TX_SIZE];
+			pu8Ans = &tu8Answer[ii * SARKCMD_RX_SIZE];
+			if (pu8Req[0] != CMD_SARK_MEAS_RX)
+			{
+				pu8Ans[0] = ANS_SARK_ERR;
+				continue;
+			}
+			Buf2Int(&u32Freq, &pu8Req[1]);
+			pu8Ans[0] = ANS_SARK_OK;
+			Float2Buf(&pu8Ans[1], u32Freq / 1e6f);
+			Float2Buf(&pu8Ans[5], (float)pu8Req[6]);
+		}
+		send(hSock, (const char *)tu8Answer, iFrames * SARKCMD_RX_SIZE, 0);
+		iLen -= iFrames * SARKCMD_TX_SIZE;
+		memmove(tu8Buf, &tu8Buf[iFrames * SARKCMD_TX_SIZE], iLen);
+	}
+	closesocket(hSock);
+}
+
+/**
+  * @brief Accepts the connections of the mock server until stopped
+  */
+static DWORD WINAPI MockServer (LPVOID lpParam)
+{
+	T_MOCK_SERVER *ptSrv = (T_MOCK_SERVER *)lpParam;
+	struct timeval tWait;
+	fd_set tRead;
+
+	while (ptSrv->lStop == 0)
+	{
+		FD_ZERO(&tRead);
+		FD_SET(ptSrv->hListen, &tRead);
+		tWait.tv_sec = 0;
+		tWait.tv_usec = 20000;
+		if (select((int)ptSrv->hListen + 1, &tRead, NULL, NULL, &tWait) > 0)
+			ServeClient(ptSrv, accept(ptSrv->hListen, NULL, NULL));
+	}
+	closesocket(ptSrv->hListen);
+
+	return 0;
+}
+
+/**
+  * @brief Checks a run against the mock device
+  */
+static void CheckPoints (const uint32 *pu32Freq, const float *pfR, const float *pfX, const uint8 *pu8Samples)
+{
+	int iBad = 0;
+	int ii;
+
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (fabs(pfR[ii] - pu32Freq[ii] / 1e6) > 1e-5 || pfX[ii] != pu8Samples[ii])
+			iBad++;
+	}
+	CHECK(iBad == 0);
+}
+
+/**
+  * @brief Runs a plan and a sweep; their requests must reach the server together
+  */
+static void TestRuns (void)
+{
+	uint32 tu32Freq[NUM_POINTS];
+	uint8 tu8Samples[NUM_POINTS];
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	T_SARK_PLAN *pPlan;
+	T_SARK_SWEEP *pSweep;
+	int ii;
+
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		tu32Freq[ii] = 1000000 + 37000 * ii;
+		tu8Samples[ii] = 3;
+	}
+
+	pPlan = Sark_Plan_Create(tu32Freq, NUM_POINTS, TRUE, 3, TRUE);
+	CHECK(pPlan != NULL);
+	InterlockedExchange(&gtSrv.lMaxRead, 0);
+	InterlockedExchange(&gtSrv.lRequests, 0);
+	CHECK(Sark_Plan_Run(0, pPlan, tfR, tfX) == 1);
+	CheckPoints(tu32Freq, tfR, tfX, tu8Samples);
+	CHECK(gtSrv.lRequests == NUM_POINTS);
+	CHECK(gtSrv.lMaxRead > 1);
+	CHECK(gtSrv.lMaxRead <= SARK_EXCHANGE_MAX);
+	Sark_Plan_Destroy(pPlan);
+
+	pSweep = Sark_Sweep_Create(tu32Freq, NUM_POINTS, TRUE, 3);
+	CHECK(pSweep != NULL);
+	InterlockedExchange(&gtSrv.lMaxRead, 0);
+	CHECK(Sark_Sweep_Run(0, pSweep, tfR, tfX) == 1);
+	CheckPoints(tu32Freq, tfR, tfX, tu8Samples);
+	CHECK(gtSrv.lMaxRead > 1);
+
+	/* The mock has no noise: every region settles at the fewest samples */
+	CHECK(Sark_Sweep_Adaptive(pSweep, 0.1f, MIN_SAMPLES, 50, REGION_POINTS) == 1);
+	CHECK(Sark_Sweep_Run(0, pSweep, tfR, tfX) == 1);
+	InterlockedExchange(&gtSrv.lMaxRead, 0);
+	CHECK(Sark_Sweep_Run(0, pSweep, tfR, tfX) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+		tu8Samples[ii] = MIN_SAMPLES;
+	CheckPoints(tu32Freq, tfR, tfX, tu8Samples);
+	CHECK(gtSrv.lMaxRead > 1);
+	CHECK(gtSrv.lMaxRead <= REGION_POINTS);	/* a batch stays within its region */
+	Sark_Sweep_Destroy(pSweep);
+}
+
+int main (void)
+{
+	HANDLE hServer;
+	char szServer[32];
+
+	memset(&gtSrv, 0, sizeof(gtSrv));
+	gtSrv.hListen = Sock_Listen(PORT_MOCK, 1);
+	if (gtSrv.hListen == INVALID_SOCKET)
+	{
+		printf("test_batch: port %u in use\n", PORT_MOCK);
+		return 1;
+	}
+	hServer = CreateThread(NULL, 0, MockServer, &gtSrv, 0, NULL);
+
+	sprintf(szServer, "127.0.0.1:%u", PORT_MOCK);
+	CHECK(Sark_Connect(ITFZ_SOCK, 1, szServer) == 1);
+	TestRuns();
+	CHECK(Sock_Loop_Start() == 1);
+	TestRuns();
+	CHECK(Sock_Loop_Stop() == 1);
+	Sark_Close(0);
+
+	InterlockedExchange(&gtSrv.lStop, 1);
+	WaitForSingleObject(hServer, INFINITE);
+	CloseHandle(hServer);
+	return TEST_RESULT("test_batch");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,387 @@
+/**
+  ******************************************************************************
+  * @file    test_hid_open.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - HID device table against mock devices
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <windows.h>
+#include <setupapi.h>
+#include <cfgmgr32.h>
+extern "C"
+{
+#include <hidsdi.h>
+}
+#include "device.h"
+#include "hid.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define MOCK_DEVS		3
+#define MOCK_REPORT		19		/* report length, report ID included */
+#define MOCK_VID		0x0483
+#define MOCK_PID		0x5750
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Mock HID device; echoes every output report as an input report */
+typedef struct
+{
+	const WCHAR *pwszPath;
+	bool bPresent;
+	int iOpens;				/* handles opened for I/O */
+	HANDLE hHandle;			/* last handle opened for I/O */
+	CRITICAL_SECTION csLock;
+	OVERLAPPED *ptRead;		/* read pending */
+	uint8 *pu8Read;
+	uint8 tu8Echo[8][MOCK_REPORT];
+	int iEchoes;
+} T_MOCK_HID;
+
+/* Private variables ---------------------------------------------------------*/
+static T_MOCK_HID gtHid[MOCK_DEVS] =
+{
+	{ L"\\\\?\\hid#vid_0483&pid_5750#0" },
+	{ L"\\\\?\\hid#vid_0483&pid_5750#1" },
+	{ L"\\\\?\\hid#vid_0483&pid_5750#2" },
+};
+static PCM_NOTIFY_CALLBACK gpfNotify;
+static uint8 gu8Big[600];			/* longer than any report */
+
+/* Private functions ---------------------------------------------------------*/
+
+static T_MOCK_HID *MockFind (HANDLE h)
+{
+	int ii;
+
+	for (ii = 0; ii < MOCK_DEVS; ii++)
+	{
+		if (gtHid[ii].hHandle == h)
+			return &gtHid[ii];
+	}
+	return NULL;
+}
+
+/* Completes an overlapped transfer; the device lock is held */
+static void MockComplete (OVERLAPPED *ptOv, DWORD dwStatus, DWORD dwBytes)
+{
+	ptOv->Internal = dwStatus;
+	ptOv->InternalHigh = dwBytes;
+	SetEvent(ptOv->hEvent);
+}
+
+/* Device enumeration --------------------------------------------------------*/
+void HidD_GetHidGuid (GUID *ptGuid) { memset(ptGuid, 0, sizeof(GUID)); }
+
+HDEVINFO SetupDiGetClassDevsW (const GUID *ptGuid, const WCHAR *pwszEnum, void *pvParent, DWORD dwFlags)
+{
+	return gtHid;
+}
+
+BOOL SetupDiEnumDeviceInterfaces (HDEVINFO hInfo, void *pvDev, const GUID *ptGuid, DWORD dwIndex,
+	SP_DEVICE_INTERFACE_DATA *ptIface)
+{
+	int ii;
+
+	for (ii = 0; ii < MOCK_DEVS; ii++)
+	{
+		if (gtHid[ii].bPresent && dwIndex-- == 0)
+		{
+			ptIface->Reserved = ii;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+BOOL SetupDiGetDeviceInterfaceDetailW (HDEVINFO hInfo, SP_DEVICE_INTERFACE_DATA *ptIface,
+	SP_DEVICE_INTERFACE_DETAIL_DATA_W *ptDetail, DWORD dwSize, DWORD *pdwRequired, void *pvDev)
+{
+	DWORD dwNeed = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_W) + MAX_PATH * sizeof(WCHAR);
+
+	if (pdwRequired != NULL)
+		*pdwRequired = dwNeed;
+	if (ptDetail == NULL || dwSize < dwNeed)
+		return FALSE;
+	wcscpy(ptDetail->DevicePath, gtHid[ptIface->Reserved].pwszPath);
+	return TRUE;
+}
+
+BOOL SetupDiDestroyDeviceInfoList (HDEVINFO hInfo) { return TRUE; }
+
+static CONFIGRET WINAPI MockRegister (PCM_NOTIFY_FILTER ptFilter, PVOID pvContext,
+	PCM_NOTIFY_CALLBACK pfCallback, PHCMNOTIFICATION phNotify)
+{
+	gpfNotify = pfCallback;
+	*phNotify = &gpfNotify;
+	return CR_SUCCESS;
+}
+
+HMODULE LoadLibraryA (const char *pszName) { return &gpfNotify; }
+void *GetProcAddress (HMODULE hLib, const char *pszName) { return (void *)MockRegister; }
+
+/* HID class driver ----------------------------------------------------------*/
+BOOL HidD_GetAttributes (HANDLE hDev, HIDD_ATTRIBUTES *ptAttr)
+{
+	ptAttr->VendorID = MOCK_VID;
+	ptAttr->ProductID = MOCK_PID;
+	return TRUE;
+}
+
+BOOL HidD_GetPreparsedData (HANDLE hDev, PHIDP_PREPARSED_DATA *ppvData) { *ppvData = hDev; return TRUE; }
+BOOL HidD_FreePreparsedData (PHIDP_PREPARSED_DATA pvData) { return TRUE; }
+
+BOOL HidP_GetCaps (PHIDP_PREPARSED_DATA pvData, HIDP_CAPS *ptCaps)
+{
+	memset(ptCaps, 0, sizeof(HIDP_CAPS));
+	ptCaps->InputReportByteLength = MOCK_REPORT;
+	ptCaps->OutputReportByteLength = MOCK_REPORT;
+	return TRUE;
+}
+
+/* Device I/O ----------------------------------------------------------------*/
+
+/* Device handles are events, so CloseHandle releases them */
+HANDLE CreateFileW (const WCHAR *pwszPath, DWORD dwAccess, DWORD dwShare, void *pvAttr,
+	DWORD dwCreate, DWORD dwFlags, HANDLE hTemplate)
+{
+	HANDLE h;
+	int ii;
+
+	for (ii = 0; ii < MOCK_DEVS; ii++)
+	{
+		if (gtHid[ii].bPresent && wcscmp(gtHid[ii].pwszPath, pwszPath) == 0)
+			break;
+	}
+	if (ii == MOCK_DEVS)
+		return INVALID_HANDLE_VALUE;
+	h = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (dwAccess != 0)
+	{
+		EnterCriticalSection(&gtHid[ii].csLock);
+		gtHid[ii].hHandle = h;
+		gtHid[ii].iOpens++;
+		gtHid[ii].iEchoes = 0;
+		LeaveCriticalSection(&gtHid[ii].csLock);
+	}
+	return h;
+}
+
+BOOL WriteFile (HANDLE h, const void *pvBuf, DWORD dwLen, DWORD *pdwWritten, OVERLAPPED *ptOv)
+{
+	T_MOCK_HID *ptHid = MockFind(h);
+
+	if (ptHid == NULL || dwLen != MOCK_REPORT)
+		return FALSE;
+	EnterCriticalSection(&ptHid->csLock);
+	if (ptHid->ptRead != NULL)
+	{
+		memcpy(ptHid->pu8Read, pvBuf, dwLen);
+		MockComplete(ptHid->ptRead, ERROR_SUCCESS, dwLen);
+		ptHid->ptRead = NULL;
+	}
+	else if (ptHid->iEchoes < 8)
+		memcpy(ptHid->tu8Echo[ptHid->iEchoes++], pvBuf, dwLen);
+	MockComplete(ptOv, ERROR_SUCCESS, dwLen);
+	LeaveCriticalSection(&ptHid->csLock);
+	return TRUE;
+}
+
+BOOL ReadFile (HANDLE h, void *pvBuf, DWORD dwLen, DWORD *pdwRead, OVERLAPPED *ptOv)
+{
+	T_MOCK_HID *ptHid = MockFind(h);
+
+	if (ptHid == NULL)
+		return FALSE;
+	EnterCriticalSection(&ptHid->csLock);
+	if (ptHid->iEchoes > 0)
+	{
+		memcpy(pvBuf, ptHid->tu8Echo[0], MOCK_REPORT);
+		memmove(ptHid->tu8Echo[0], ptHid->tu8Echo[1], --ptHid->iEchoes * MOCK_REPORT);
+		MockComplete(ptOv, ERROR_SUCCESS, MOCK_REPORT);
+	}
+	else
+	{
+		ptHid->ptRead = ptOv;
+		ptHid->pu8Read = (uint8 *)pvBuf;
+	}
+	LeaveCriticalSection(&ptHid->csLock);
+	SetLastError(ERROR_IO_PENDING);
+	return FALSE;
+}
+
+BOOL CancelIoEx (HANDLE h, OVERLAPPED *ptOv)
+{
+	T_MOCK_HID *ptHid = MockFind(h);
+
+	if (ptHid == NULL)
+		return FALSE;
+	EnterCriticalSection(&ptHid->csLock);
+	if (ptHid->ptRead == ptOv)
+	{
+		MockComplete(ptOv, ERROR_OPERATION_ABORTED, 0);
+		ptHid->ptRead = NULL;
+	}
+	LeaveCriticalSection(&ptHid->csLock);
+	return TRUE;
+}
+
+BOOL GetOverlappedResult (HANDLE h, OVERLAPPED *ptOv, DWORD *pdwBytes, BOOL bWait)
+{
+	if (WaitForSingleObject(ptOv->hEvent, bWait ? INFINITE : 0) != WAIT_OBJECT_0)
+		return FALSE;
+	*pdwBytes = (DWORD)ptOv->InternalHigh;
+	SetLastError((DWORD)ptOv->Internal);
+	return ptOv->Internal == ERROR_SUCCESS;
+}
+
+/* Tests ---------------------------------------------------------------------*/
+
+/**
+  * @brief Sends a packet to a device and checks it is echoed
+  */
+static bool Echo (int num, uint8 u8Tag)
+{
+	uint8 tu8Tx[MOCK_REPORT - 1];
+	uint8 tu8Rx[MOCK_REPORT - 1];
+
+	memset(tu8Tx, u8Tag, sizeof(tu8Tx));
+	if (rawhid_send(num, tu8Tx, sizeof(tu8Tx), 100) != sizeof(tu8Tx))
+		return false;
+	if (rawhid_recv(num, tu8Rx, sizeof(tu8Rx), 100) != sizeof(tu8Rx))
+		return false;
+	return memcmp(tu8Tx, tu8Rx, sizeof(tu8Tx)) == 0;
+}
+
+static int Opens (void)
+{
+	int iOpens = 0;
+	int ii;
+
+	for (ii = 0; ii < MOCK_DEVS; ii++)
+		iOpens += gtHid[ii].iOpens;
+	return iOpens;
+}
+
+static void Notify (int iDev, CM_NOTIFY_ACTION eAction)
+{
+	CM_NOTIFY_EVENT_DATA tData;
+
+	memset(&tData, 0, sizeof(tData));
+	wcscpy(tData.u.DeviceInterface.SymbolicLink, gtHid[iDev].pwszPath);
+	gtHid[iDev].bPresent = (eAction == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL);
+	gpfNotify(NULL, NULL, eAction, &tData, sizeof(tData));
+}
+
+/**
+  * @brief Opening again keeps the devices already open
+  */
+static void TestOpenAgain (void)
+{
+	CHECK(rawhid_open(2, MOCK_VID, MOCK_PID, -1, -1) == 2);
+	CHECK(Opens() == 2);
+	CHECK(Echo(0, 1) && Echo(1, 2));
+	CHECK(rawhid_open(2, MOCK_VID, MOCK_PID, -1, -1) == 2);
+	CHECK(Opens() == 2);
+	CHECK(Echo(0, 3) && Echo(1, 4));
+
+	/* Lengths that do not fit a report are rejected */
+	CHECK(rawhid_send(0, gu8Big, -1, 100) == -1);
+	CHECK(rawhid_send(0, gu8Big, sizeof(gu8Big), 100) == -1);
+	CHECK(Echo(0, 17));
+}
+
+/**
+  * @brief Devices closed one by one are opened again and work
+  */
+static void TestCloseReopen (void)
+{
+	rawhid_close(0);
+	rawhid_close(1);
+	CHECK(rawhid_send(0, (void *)"x", 1, 100) == -1);
+	CHECK(rawhid_open(2, MOCK_VID, MOCK_PID, -1, -1) == 2);
+	CHECK(Opens() == 4);
+	CHECK(Echo(0, 5) && Echo(1, 6));
+
+	/* Only one closed: the other one stays open */
+	rawhid_close(1);
+	CHECK(rawhid_open(2, MOCK_VID, MOCK_PID, -1, -1) == 2);
+	CHECK(Opens() == 5);
+	CHECK(Echo(0, 7) && Echo(1, 8));
+}
+
+/**
+  * @brief Devices plugged and unplugged are tracked without walking the class again
+  */
+static void TestHotplug (void)
+{
+	Notify(2, CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL);
+	CHECK(rawhid_open(3, MOCK_VID, MOCK_PID, -1, -1) == 3);
+	CHECK(Opens() == 6);
+	CHECK(Echo(0, 9) && Echo(1, 10) && Echo(2, 11));
+
+	Notify(0, CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL);
+	CHECK(rawhid_open(3, MOCK_VID, MOCK_PID, -1, -1) == 2);
+	CHECK(Opens() == 6);
+	CHECK(Echo(0, 12) && Echo(1, 13));
+
+	/* A device back on the same path is opened again */
+	Notify(0, CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL);
+	CHECK(rawhid_open(3, MOCK_VID, MOCK_PID, -1, -1) == 3);
+	CHECK(Opens() == 7);
+	CHECK(Echo(0, 14) && Echo(1, 15) && Echo(2, 16));
+
+	CHECK(rawhid_open(0, MOCK_VID, MOCK_PID, -1, -1) == 0);
+	CHECK(rawhid_send(0, (void *)"x", 1, 100) == -1);
+}
+
+int main (void)
+{
+	int ii;
+
+	for (ii = 0; ii < MOCK_DEVS; ii++)
+	{
+		InitializeCriticalSection(&gtHid[ii].csLock);
+		gtHid[ii].bPresent = (ii < 2);
+	}
+	TestOpenAgain();
+	TestCloseReopen();
+	TestHotplug();
+	return TEST_RESULT("test_hid_open");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,275 @@
+/**
+  ******************************************************************************
+  * @file    test_hid_rx.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - HID receive queue against a mock device
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "hid_rx.h"
+#include "sark_cancel.h"
+#include "test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Answer the device will give */
+typedef struct
+{
+	DWORD dwDue;			/* tick it is read at */
+	uint8 u8Id;				/* request answered */
+} T_MOCK_ANSWER;
+
+/* Mock device: answers requests one after another, each after a delay */
+typedef struct
+{
+	CRITICAL_SECTION csLock;
+	HANDLE hWake;			/* signaled when a request is queued or the read cancelled */
+	T_MOCK_ANSWER tAnswer[64];
+	int iHead;
+	int iTail;
+	DWORD dwBusyUntil;		/* end of the request being served */
+	bool bCancel;
+	bool bGone;
+} T_MOCK_DEV;
+
+/* Private define ------------------------------------------------------------*/
+#define REPORT_LEN		19
+#define RX_TIMEOUT		220		/* in ms, as HID_RX_TIMEOUT */
+#define NUM_RETRIES		5
+
+/* Private variables ---------------------------------------------------------*/
+static T_MOCK_DEV gtDev;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Queues a request; its answer is read dwDelay ms after the previous one
+  */
+static void MockRequest (T_MOCK_DEV *ptDev, uint8 u8Id, DWORD dwDelay)
+{
+	DWORD dwNow = GetTickCount();
+
+	EnterCriticalSection(&ptDev->csLock);
+	if ((LONG)(ptDev->dwBusyUntil - dwNow) < 0)
+		ptDev->dwBusyUntil = dwNow;
+	ptDev->dwBusyUntil += dwDelay;
+	ptDev->tAnswer[ptDev->iTail % 64].dwDue = ptDev->dwBusyUntil;
+	ptDev->tAnswer[ptDev->iTail % 64].u8Id = u8Id;
+	ptDev->iTail++;
+	LeaveCriticalSection(&ptDev->csLock);
+	SetEvent(ptDev->hWake);
+}
+
+/**
+  * @brief HIDRX_READ of the mock device; byte 0 is the report ID
+  */
+static int MockRead (void *pvDev, uint8 *pu8Buf, int iLen)
+{
+	T_MOCK_DEV *ptDev = (T_MOCK_DEV *)pvDev;
+	DWORD dwWait;
+
+	for (;;)
+	{
+		EnterCriticalSection(&ptDev->csLock);
+		if (ptDev->bCancel || ptDev->bGone)
+		{
+			ptDev->bCancel = false;
+			LeaveCriticalSection(&ptDev->csLock);
+			return ptDev->bGone ? -1 : 0;
+		}
+		dwWait = INFINITE;
+		if (ptDev->iHead != ptDev->iTail)
+		{
+			dwWait = ptDev->tAnswer[ptDev->iHead % 64].dwDue - GetTickCount();
+			if ((LONG)dwWait <= 0)
+			{
+				memset(pu8Buf, 0, iLen);
+				pu8Buf[1] = ptDev->tAnswer[ptDev->iHead % 64].u8Id;
+				ptDev->iHead++;
+				LeaveCriticalSection(&ptDev->csLock);
+				return iLen;
+			}
+		}
+		LeaveCriticalSection(&ptDev->csLock);
+		WaitForSingleObject(ptDev->hWake, dwWait);
+	}
+}
+
+/**
+  * @brief HIDRX_CANCEL of the mock device
+  */
+static void MockCancel (void *pvDev)
+{
+	T_MOCK_DEV *ptDev = (T_MOCK_DEV *)pvDev;
+
+	EnterCriticalSection(&ptDev->csLock);
+	ptDev->bCancel = true;
+	LeaveCriticalSection(&ptDev->csLock);
+	SetEvent(ptDev->hWake);
+}
+
+static void MockReset (T_MOCK_DEV *ptDev)
+{
+	InitializeCriticalSection(&ptDev->csLock);
+	ptDev->hWake = CreateEvent(NULL, FALSE, FALSE, NULL);
+	ptDev->iHead = ptDev->iTail = 0;
+	ptDev->dwBusyUntil = 0;
+	ptDev->bCancel = ptDev->bGone = false;
+}
+
+/**
+  * @brief Sends a request and waits for its answer, retrying as the client does
+  *
+  * @retval id of the request answered, 0 if none; *piTries attempts made
+  */
+static int Transfer (T_HID_RX *pRx, uint8 u8Id, DWORD dwDelay, int *piTries)
+{
+	uint8 tu8Report[HIDRX_REPORT_MAX];
+	int ii;
+
+	for (ii = 0; ii < NUM_RETRIES; ii++)
+	{
+		HidRx_Begin(pRx, ii != 0);
+		MockRequest(&gtDev, u8Id, dwDelay);
+		if (HidRx_Recv(pRx, tu8Report, sizeof(tu8Report), RX_TIMEOUT) > 0)
+		{
+			*piTries = ii + 1;
+			return tu8Report[1];
+		}
+	}
+	*piTries = NUM_RETRIES;
+	return 0;
+}
+
+/**
+  * @brief An answer is taken by the request it belongs to
+  */
+static void TestAnswer (void)
+{
+	T_HID_RX *pRx;
+	int iTries;
+	int ii;
+
+	MockReset(&gtDev);
+	pRx = HidRx_Start(MockRead, MockCancel, &gtDev, REPORT_LEN);
+	CHECK(pRx != NULL);
+	CHECK(Transfer(pRx, 1, 5, &iTries) == 1 && iTries == 1);
+	for (ii = 2; ii < 200; ii++)
+		CHECK(Transfer(pRx, (uint8)ii, 0, &iTries) == ii && iTries == 1);
+	HidRx_Stop(pRx);
+}
+
+/**
+  * @brief A late answer completes the retried request; the answers to the
+  *		other attempts are not taken by the next requests
+  */
+static void TestLateAnswer (void)
+{
+	T_HID_RX *pRx;
+	int iTries;
+
+	MockReset(&gtDev);
+	pRx = HidRx_Start(MockRead, MockCancel, &gtDev, REPORT_LEN);
+	CHECK(Transfer(pRx, 10, 300, &iTries) == 10 && iTries == 2);
+	CHECK(Transfer(pRx, 11, 5, &iTries) == 11);
+	CHECK(Transfer(pRx, 12, 5, &iTries) == 12);
+	/* Retried three times; the next request waits for the device to catch up */
+	CHECK(Transfer(pRx, 13, 500, &iTries) == 13 && iTries == 3);
+	CHECK(Transfer(pRx, 14, 5, &iTries) == 14);
+	CHECK(Transfer(pRx, 15, 5, &iTries) == 15);
+	HidRx_Stop(pRx);
+}
+
+/**
+  * @brief An answer left unread when the caller gave up is skipped
+  */
+static void TestStaleAnswer (void)
+{
+	uint8 tu8Report[HIDRX_REPORT_MAX];
+	T_HID_RX *pRx;
+	int iTries;
+
+	MockReset(&gtDev);
+	pRx = HidRx_Start(MockRead, MockCancel, &gtDev, REPORT_LEN);
+	HidRx_Begin(pRx, FALSE);
+	MockRequest(&gtDev, 20, 100);
+	CHECK(HidRx_Recv(pRx, tu8Report, sizeof(tu8Report), 20) == 0);
+	Sleep(150);
+	CHECK(Transfer(pRx, 21, 5, &iTries) == 21 && iTries == 1);
+	HidRx_Stop(pRx);
+}
+
+/**
+  * @brief A cancelled operation stops waiting; a device gone ends the wait
+  */
+static void TestCancelAndGone (void)
+{
+	uint8 tu8Report[HIDRX_REPORT_MAX];
+	T_CANCEL_SCOPE tScope;
+	T_SARK_CANCEL *ptCancel;
+	T_HID_RX *pRx;
+	DWORD dwStart;
+
+	MockReset(&gtDev);
+	pRx = HidRx_Start(MockRead, MockCancel, &gtDev, REPORT_LEN);
+	ptCancel = Sark_Cancel_Create();
+	Sark_Cancel_Set(ptCancel);
+	Sark_Cancel_Enter(&tScope, ptCancel);
+	HidRx_Begin(pRx, FALSE);
+	dwStart = GetTickCount();
+	CHECK(HidRx_Recv(pRx, tu8Report, sizeof(tu8Report), 2000) == 0);
+	CHECK(GetTickCount() - dwStart < 100);
+	Sark_Cancel_Leave(&tScope);
+	Sark_Cancel_Destroy(ptCancel);
+
+	EnterCriticalSection(&gtDev.csLock);
+	gtDev.bGone = true;
+	LeaveCriticalSection(&gtDev.csLock);
+	SetEvent(gtDev.hWake);
+	CHECK(HidRx_Recv(pRx, tu8Report, sizeof(tu8Report), 2000) == -1);
+	HidRx_Stop(pRx);
+}
+
+int main (void)
+{
+	TestAnswer();
+	TestLateAnswer();
+	TestStaleAnswer();
+	TestCancelAndGone();
+	return TEST_RESULT("test_hid_rx");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
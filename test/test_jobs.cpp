@@ -0,0 +1,286 @@
+/**
+  ******************************************************************************
+  * @file    test_jobs.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - work stealing of job pools against mock devices
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include "sock_cli.h"
+#include "sark_cmd_defs.h"
+#include "sark_rem_client.h"
+#include "sark_jobs.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PORT_MOCK		18160	/* one port per device */
+#define NUM_DEVS		3
+#define SLOW_DEV		1		/* the device behind a slow link */
+#define SLOW_MS			5		/* time per answer of the slow device */
+#define NUM_JOBS		200
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Mock device: R is the frequency in MHz and X the device number */
+typedef struct
+{
+	SOCKET hListen;
+	int16 num;
+	DWORD dwDelay;				/* ms per answer */
+	volatile LONG lRequests;
+	volatile LONG lStop;
+} T_MOCK_SERVER;
+
+/* Private variables ---------------------------------------------------------*/
+static T_MOCK_SERVER gtSrv[NUM_DEVS];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Answers the requests of one connection until it closes
+  */
+static void ServeClient (T_MOCK_SERVER *ptSrv, SOCKET hSock)
+{
+	uint8 tu8Req[SARKCMD_TX_SIZE];
+	uint8 tu8Answer[SARKCMD_RX_SIZE];
+	uint32 u32Freq;
+	int iLen = 0;
+	int iRead;
+
+	while (ptSrv->lStop == 0)
+	{
+		iRead = recv(hSock, (char *)&tu8Req[iLen], sizeof(tu8Req) - iLen, 0);
+		if (iRead <= 0)
+			break;
+		iLen += iRead;
+		if (iLen < SARKCMD_TX_SIZE)
+			continue;
+		iLen = 0;
+		InterlockedIncrement(&ptSrv->lRequests);
+		if (ptSrv->dwDelay > 0)
+			Sleep(ptSrv->dwDelay);
+		memset(tu8Answer, 0, sizeof(tu8Answer));
+		if (tu8Req[0] == CMD_SARK_MEAS_RX)
+		{
+			Buf2Int(&u32Freq, &tu8Req[1]);
+			tu8Answer[0] = ANS_SARK_OK;
+			Float2Buf(&tu8Answer[1], u32Freq / 1e6f);
+			Float2Buf(&tu8Answer[5], (float)ptSrv->num);
+		}
+		else
+		{
+			tu8Answer[0] = ANS_SARK_ERR;
+		}
+		send(hSock, (const char *)tu8Answer, sizeof(tu8Answer), 0);
+	}
+	closesocket(hSock);
+}
+
+/**
+  * @brief Accepts the connections of a mock server until stopped
+  */
+static DWORD WINAPI MockServer (LPVOID lpParam)
+{
+	T_MOCK_SERVER *ptSrv = (T_MOCK_SERVER *)lpParam;
+	struct timeval tWait;
+	fd_set tRead;
+
+	while (ptSrv->lStop == 0)
+	{
+		FD_ZERO(&tRead);
+		FD_SET(ptSrv->hListen, &tRead);
+		tWait.tv_sec = 0;
+		tWait.tv_usec = 20000;
+		if (select((int)ptSrv->hListen + 1, &tRead, NULL, NULL, &tWait) > 0)
+			ServeClient(ptSrv, accept(ptSrv->hListen, NULL, NULL));
+	}
+	closesocket(ptSrv->hListen);
+
+	return 0;
+}
+
+/**
+  * @brief Fills a batch of jobs
+  */
+static void InitJobs (T_SARK_JOB *ptJob, int iCount)
+{
+	int ii;
+
+	memset(ptJob, 0, iCount * sizeof(T_SARK_JOB));
+	for (ii = 0; ii < iCount; ii++)
+	{
+		ptJob[ii].u32Freq = 1000000 + 10000 * ii;
+		ptJob[ii].u8Type = JOB_MEAS_RX;
+		ptJob[ii].u8Samples = 1;
+	}
+}
+
+/**
+  * @brief Runs a batch; every job must be measured once, by the device it names
+  */
+static void RunJobs (T_SARK_JOBS *pJobs, int iCount, uint32 *pu32Done, uint32 *pu32Stolen)
+{
+	static T_SARK_JOB tJob[NUM_JOBS];
+	uint32 tu32Done[NUM_DEVS], tu32Stolen[NUM_DEVS];
+	LONG lRequests = 0;
+	int iBad = 0;
+	int ii;
+
+	for (ii = 0; ii < NUM_DEVS; ii++)
+	{
+		CHECK(Sark_Jobs_Stats(pJobs, ii, &tu32Done[ii], &tu32Stolen[ii], NULL) == 1);
+		InterlockedExchange(&gtSrv[ii].lRequests, 0);
+	}
+	InitJobs(tJob, iCount);
+	CHECK(Sark_Jobs_Run(pJobs, tJob, iCount) == 1);
+	for (ii = 0; ii < iCount; ii++)
+	{
+		if (tJob[ii].i8Rc != 1 || tJob[ii].i16Dev < 0 || tJob[ii].i16Dev >= NUM_DEVS)
+		{
+			iBad++;
+			continue;
+		}
+		if (fabs(tJob[ii].tfVal[0] - tJob[ii].u32Freq / 1e6) > 1e-5)
+			iBad++;
+		if (tJob[ii].tfVal[1] != (float)tJob[ii].i16Dev)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+
+	for (ii = 0; ii < NUM_DEVS; ii++)
+	{
+		lRequests += gtSrv[ii].lRequests;
+		CHECK(Sark_Jobs_Stats(pJobs, ii, &pu32Done[ii], &pu32Stolen[ii], NULL) == 1);
+		CHECK(pu32Done[ii] - tu32Done[ii] == (uint32)gtSrv[ii].lRequests);
+		pu32Done[ii] -= tu32Done[ii];
+		pu32Stolen[ii] -= tu32Stolen[ii];
+	}
+	CHECK(lRequests == iCount);
+}
+
+/**
+  * @brief The fast devices take the queue of the slow one
+  */
+static void TestSteal (T_SARK_JOBS *pJobs)
+{
+	uint32 tu32Done[NUM_DEVS], tu32Stolen[NUM_DEVS];
+	float fFast, fSlow;
+
+	/* First run: no latency known, the jobs are shared evenly */
+	RunJobs(pJobs, NUM_JOBS, tu32Done, tu32Stolen);
+	CHECK(tu32Done[SLOW_DEV] < NUM_JOBS / NUM_DEVS / 2);
+	CHECK(tu32Stolen[0] + tu32Stolen[2] > NUM_JOBS / NUM_DEVS / 2);
+	CHECK(tu32Stolen[SLOW_DEV] == 0);
+
+	CHECK(Sark_Jobs_Stats(pJobs, 0, NULL, NULL, &fFast) == 1);
+	CHECK(Sark_Jobs_Stats(pJobs, SLOW_DEV, NULL, NULL, &fSlow) == 1);
+	CHECK(fFast > 0.0f);
+	CHECK(fSlow > fFast);
+
+	/* Later runs share the jobs by the measured speed */
+	RunJobs(pJobs, NUM_JOBS, tu32Done, tu32Stolen);
+	CHECK(tu32Done[SLOW_DEV] < NUM_JOBS / NUM_DEVS / 2);
+}
+
+/**
+  * @brief Batches with fewer jobs than devices leave some devices without range
+  */
+static void TestFewJobs (T_SARK_JOBS *pJobs)
+{
+	uint32 tu32Done[NUM_DEVS], tu32Stolen[NUM_DEVS];
+	int iCount;
+
+	for (iCount = 1; iCount < NUM_DEVS; iCount++)
+	{
+		RunJobs(pJobs, iCount, tu32Done, tu32Stolen);
+		CHECK(tu32Done[0] + tu32Done[1] + tu32Done[2] == (uint32)iCount);
+	}
+}
+
+int main (void)
+{
+	static const int16 ti16Dev[NUM_DEVS] = { 0, 1, 2 };
+	HANDLE thServer[NUM_DEVS];
+	T_SARK_JOBS *pJobs;
+	T_SARK_JOB tJob[1];
+	char szServer[128];
+	int ii;
+
+	szServer[0] = '\0';
+	for (ii = 0; ii < NUM_DEVS; ii++)
+	{
+		memset(&gtSrv[ii], 0, sizeof(gtSrv[ii]));
+		gtSrv[ii].num = ii;
+		gtSrv[ii].dwDelay = ii == SLOW_DEV ? SLOW_MS : 0;
+		gtSrv[ii].hListen = Sock_Listen(PORT_MOCK + ii, 1);
+		if (gtSrv[ii].hListen == INVALID_SOCKET)
+		{
+			printf("test_jobs: port %u in use\n", PORT_MOCK + ii);
+			return 1;
+		}
+		thServer[ii] = CreateThread(NULL, 0, MockServer, &gtSrv[ii], 0, NULL);
+		sprintf(&szServer[strlen(szServer)], "%s127.0.0.1:%u", ii > 0 ? "," : "", PORT_MOCK + ii);
+	}
+	CHECK(Sark_Connect(ITFZ_SOCK, NUM_DEVS, szServer) == NUM_DEVS);
+
+	CHECK(Sark_Jobs_Create(ti16Dev, 0) == NULL);
+
+	/* A fresh pool knows no latency when it meets a short batch */
+	pJobs = Sark_Jobs_Create(ti16Dev, NUM_DEVS);
+	CHECK(pJobs != NULL);
+	CHECK(Sark_Jobs_Run(pJobs, tJob, 0) == -3);
+	TestFewJobs(pJobs);
+	Sark_Jobs_Destroy(pJobs);
+
+	pJobs = Sark_Jobs_Create(ti16Dev, NUM_DEVS);
+	CHECK(pJobs != NULL);
+	TestSteal(pJobs);
+	TestFewJobs(pJobs);
+	Sark_Jobs_Destroy(pJobs);
+
+	for (ii = 0; ii < NUM_DEVS; ii++)
+		Sark_Close(ii);
+	for (ii = 0; ii < NUM_DEVS; ii++)
+	{
+		InterlockedExchange(&gtSrv[ii].lStop, 1);
+		WaitForSingleObject(thServer[ii], INFINITE);
+		CloseHandle(thServer[ii]);
+	}
+	return TEST_RESULT("test_jobs");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,309 @@
+/**
+  ******************************************************************************
+  * @file    test_monitor.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - result ring of the monitor
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "sock_cli.h"
+#include "sark_cmd_defs.h"
+#include "sark_rem_client.h"
+#include "sark_monitor.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PORT_MOCK		18150
+#define MAX_FRAMES		64		/* requests read at once by the mock server */
+#define NUM_POINTS		64
+#define FREQ_START		1000000
+#define FREQ_STEP		10000
+#define NUM_READERS		3
+#define READ_MS			500		/* time the readers race the measurement thread */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Mock device: R is the number of the sweep and X the index of the point.
+   Sweeps cancelled by a stop are counted too, so a monitor sees the sweeps
+   of the mock shifted by a constant */
+typedef struct
+{
+	SOCKET hListen;
+	LONG lSweep;			/* sweeps started; used by the server thread only */
+	volatile LONG lStop;
+} T_MOCK_SERVER;
+
+/* Reads of a reader thread */
+typedef struct
+{
+	T_SARK_MONITOR *pMon;
+	int iReads;
+	int iTorn;				/* reads mixing sweeps */
+	int iBackwards;			/* newest sweeps older than a previous one */
+	int iOverwritten;		/* history reads lapped by the measurement thread */
+} T_READER;
+
+/* Private variables ---------------------------------------------------------*/
+static T_MOCK_SERVER gtSrv;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Answers the requests of one connection until it closes
+  */
+static void ServeClient (T_MOCK_SERVER *ptSrv, SOCKET hSock)
+{
+	uint8 tu8Buf[MAX_FRAMES * SARKCMD_TX_SIZE];
+	uint8 tu8Answer[MAX_FRAMES * SARKCMD_RX_SIZE];
+	uint8 *pu8Req;
+	uint8 *pu8Ans;
+	uint32 u32Freq;
+	int iLen = 0;
+	int iRead;
+	int iFrames;
+	int ii;
+
+	while (ptSrv->lStop == 0)
+	{
+		iRead = recv(hSock, (char *)&tu8Buf[iLen], sizeof(tu8Buf) - iLen, 0);
+		if (iRead <= 0)
+			break;
+		iLen += iRead;
+		iFrames = iLen / SARKCMD_TX_SIZE;
+		memset(tu8Answer, 0, sizeof(tu8Answer));
+		for (ii = 0; ii < iFrames; ii++)
+		{
+			pu8Req = &tu8Buf[ii * SARKCMD_TX_SIZE];
+			pu8Ans = &tu8Answer[ii * SARKCMD_RX_SIZE];
+			Buf2Int(&u32Freq, &pu8Req[1]);
+			if (u32Freq == FREQ_START)
+				ptSrv->lSweep++;
+			pu8Ans[0] = ANS_SARK_OK;
+			Float2Buf(&pu8Ans[1], (float)ptSrv->lSweep);
+			Float2Buf(&pu8Ans[5], (float)((u32Freq - FREQ_START) / FREQ_STEP));
+		}
+		send(hSock, (const char *)tu8Answer, iFrames * SARKCMD_RX_SIZE, 0);
+		iLen -= iFrames * SARKCMD_TX_SIZE;
+		memmove(tu8Buf, &tu8Buf[iFrames * SARKCMD_TX_SIZE], iLen);
+	}
+	closesocket(hSock);
+}
+
+/**
+  * @brief Accepts the connections of the mock server until stopped
+  */
+static DWORD WINAPI MockServer (LPVOID lpParam)
+{
+	T_MOCK_SERVER *ptSrv = (T_MOCK_SERVER *)lpParam;
+	struct timeval tWait;
+	fd_set tRead;
+
+	while (ptSrv->lStop == 0)
+	{
+		FD_ZERO(&tRead);
+		FD_SET(ptSrv->hListen, &tRead);
+		tWait.tv_sec = 0;
+		tWait.tv_usec = 20000;
+		if (select((int)ptSrv->hListen + 1, &tRead, NULL, NULL, &tWait) > 0)
+			ServeClient(ptSrv, accept(ptSrv->hListen, NULL, NULL));
+	}
+	closesocket(ptSrv->hListen);
+
+	return 0;
+}
+
+/**
+  * @brief Tells whether a read holds one sweep of the mock and nothing else
+  */
+static bool WholeSweep (const float *pfR, const float *pfX)
+{
+	int ii;
+
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (pfR[ii] != pfR[0] || pfX[ii] != (float)ii)
+			return false;
+	}
+	return true;
+}
+
+/**
+  * @brief Reads the newest sweep and the one before it as fast as it can
+  */
+static DWORD WINAPI Reader (LPVOID lpParam)
+{
+	T_READER *ptReader = (T_READER *)lpParam;
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	uint32 u32Last = 0;
+	uint32 u32Seq;
+	float fShift = -1;		/* sweep of the mock minus sweep of the monitor */
+	DWORD dwStart = GetTickCount();
+	int rc;
+
+	while (GetTickCount() - dwStart < READ_MS)
+	{
+		if (Sark_Monitor_Latest(ptReader->pMon, &u32Seq, tfR, tfX) != 1)
+			continue;
+		ptReader->iReads++;
+		if (fShift < 0)
+			fShift = tfR[0] - u32Seq;
+		if (!WholeSweep(tfR, tfX) || tfR[0] != u32Seq + fShift)
+			ptReader->iTorn++;
+		if (u32Seq < u32Last)
+			ptReader->iBackwards++;
+		u32Last = u32Seq;
+		if (u32Seq < 2)
+			continue;
+		rc = Sark_Monitor_Read(ptReader->pMon, u32Seq - 1, tfR, tfX);
+		if (rc == -4)
+			ptReader->iOverwritten++;
+		else if (rc != 1 || !WholeSweep(tfR, tfX) || tfR[0] != u32Seq - 1 + fShift)
+			ptReader->iTorn++;
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Readers never see a slot being rewritten
+  */
+static void TestRace (T_SARK_SWEEP *pSweep)
+{
+	T_READER tReader[NUM_READERS];
+	HANDLE thThread[NUM_READERS];
+	T_SARK_MONITOR *pMon;
+	uint32 u32Sweeps, u32Errors;
+	int iLastRc;
+	int iReads = 0;
+	int ii;
+
+	/* Three slots and no pause: the measurement thread laps the readers */
+	pMon = Sark_Monitor_Start(0, pSweep, 3, 0);
+	CHECK(pMon != NULL);
+	memset(tReader, 0, sizeof(tReader));
+	for (ii = 0; ii < NUM_READERS; ii++)
+	{
+		tReader[ii].pMon = pMon;
+		thThread[ii] = CreateThread(NULL, 0, Reader, &tReader[ii], 0, NULL);
+	}
+	WaitForMultipleObjects(NUM_READERS, thThread, TRUE, INFINITE);
+	for (ii = 0; ii < NUM_READERS; ii++)
+	{
+		CloseHandle(thThread[ii]);
+		CHECK(tReader[ii].iTorn == 0);
+		CHECK(tReader[ii].iBackwards == 0);
+		iReads += tReader[ii].iReads;
+	}
+	CHECK(iReads > 0);
+	CHECK(Sark_Monitor_Status(pMon, &u32Sweeps, &u32Errors, &iLastRc) == 1);
+	CHECK(u32Sweeps > 10);
+	CHECK(u32Errors == 0);
+	CHECK(iLastRc == 1);
+	Sark_Monitor_Stop(pMon);
+}
+
+/**
+  * @brief The history holds iSlots-1 sweeps
+  */
+static void TestHistory (T_SARK_SWEEP *pSweep)
+{
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	T_SARK_MONITOR *pMon;
+	uint32 u32Seq = 0;
+	float fShift;
+	int ii;
+
+	CHECK(Sark_Monitor_Start(0, pSweep, 1, 0) == NULL);
+	pMon = Sark_Monitor_Start(0, pSweep, 4, 200);
+	CHECK(pMon != NULL);
+	for (ii = 0; ii < 100 && u32Seq < 5; ii++)
+	{
+		Sleep(20);
+		CHECK(Sark_Monitor_Latest(pMon, &u32Seq, tfR, tfX) >= 0);
+	}
+	CHECK(u32Seq >= 5);
+
+	/* Right after a sweep is published the next one starts 200 ms later */
+	CHECK(Sark_Monitor_Latest(pMon, &u32Seq, tfR, tfX) == 1);
+	fShift = tfR[0] - u32Seq;
+	CHECK(Sark_Monitor_Read(pMon, u32Seq + 1, tfR, tfX) == 0);
+	for (ii = 0; ii < 3; ii++)
+	{
+		CHECK(Sark_Monitor_Read(pMon, u32Seq - ii, tfR, tfX) == 1);
+		CHECK(WholeSweep(tfR, tfX) && tfR[0] == u32Seq - ii + fShift);
+	}
+	CHECK(Sark_Monitor_Read(pMon, u32Seq - 4, tfR, tfX) == -4);
+	CHECK(Sark_Monitor_Read(pMon, 0, tfR, tfX) == 0);
+	CHECK(Sark_Monitor_Read(NULL, u32Seq, tfR, tfX) == -3);
+	Sark_Monitor_Stop(pMon);
+}
+
+int main (void)
+{
+	uint32 tu32Freq[NUM_POINTS];
+	T_SARK_SWEEP *pSweep;
+	HANDLE hServer;
+	char szServer[32];
+	int ii;
+
+	memset(&gtSrv, 0, sizeof(gtSrv));
+	gtSrv.hListen = Sock_Listen(PORT_MOCK, 1);
+	if (gtSrv.hListen == INVALID_SOCKET)
+	{
+		printf("test_monitor: port %u in use\n", PORT_MOCK);
+		return 1;
+	}
+	hServer = CreateThread(NULL, 0, MockServer, &gtSrv, 0, NULL);
+	sprintf(szServer, "127.0.0.1:%u", PORT_MOCK);
+	CHECK(Sark_Connect(ITFZ_SOCK, 1, szServer) == 1);
+
+	for (ii = 0; ii < NUM_POINTS; ii++)
+		tu32Freq[ii] = FREQ_START + FREQ_STEP * ii;
+	pSweep = Sark_Sweep_Create(tu32Freq, NUM_POINTS, TRUE, 1);
+	CHECK(pSweep != NULL);
+
+	TestRace(pSweep);
+	TestHistory(pSweep);
+	Sark_Close(0);
+
+	Sark_Sweep_Destroy(pSweep);
+	InterlockedExchange(&gtSrv.lStop, 1);
+	WaitForSingleObject(hServer, INFINITE);
+	CloseHandle(hServer);
+	return TEST_RESULT("test_monitor");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
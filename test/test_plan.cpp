@@ -0,0 +1,204 @@
+/**
+  ******************************************************************************
+  * @file    test_plan.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - saved sweep plans against the simulator
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sark_cmd_defs.h"
+#include "sark_rem_client.h"
+#include "sark_plan.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PLAN_FILE		"test_plan.tmp"
+#define EVEN_POINTS		40		/* grouped four per request at half precision */
+#define ODD_POINTS		7		/* measured one per request */
+#define NUM_POINTS		(EVEN_POINTS + ODD_POINTS)
+#define HEADER_SIZE		16
+#define MAX_FILE		4096
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Runs a plan on a freshly connected simulator, so the noise repeats
+  */
+static void RunFresh (T_SARK_PLAN *pPlan, float *pfR, float *pfX)
+{
+	int iBad = 0;
+	int ii;
+
+	Sark_Close(0);
+	CHECK(Sark_Connect(ITFZ_SIM, 1, NULL) == 1);
+	CHECK(Sark_Plan_Run(0, pPlan, pfR, pfX) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		/* The load is 50 ohm at resonance and never far from it */
+		if (!(pfR[ii] > 0.0f && pfR[ii] < 60.0f) || fabs(pfX[ii]) > 1000.0f)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+}
+
+/**
+  * @brief Reads a whole file
+  */
+static int ReadFile (const char *pszFile, uint8 *pu8Buf)
+{
+	FILE *pFile;
+	int iLen;
+
+	pFile = fopen(pszFile, "rb");
+	if (pFile == NULL)
+		return -1;
+	iLen = (int)fread(pu8Buf, 1, MAX_FILE, pFile);
+	fclose(pFile);
+
+	return iLen;
+}
+
+/**
+  * @brief Writes a whole file
+  */
+static void WriteFile (const char *pszFile, const uint8 *pu8Buf, int iLen)
+{
+	FILE *pFile;
+
+	pFile = fopen(pszFile, "wb");
+	CHECK(pFile != NULL);
+	if (pFile == NULL)
+		return;
+	CHECK((int)fwrite(pu8Buf, 1, iLen, pFile) == iLen);
+	fclose(pFile);
+}
+
+/**
+  * @brief A loaded plan sends the same requests and decodes the same answers
+  */
+static void TestRoundTrip (const uint32 *pu32Freq, bool bFloat, int iFrames)
+{
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	float tfLoadR[NUM_POINTS], tfLoadX[NUM_POINTS];
+	uint8 tu8Saved[MAX_FILE], tu8Again[MAX_FILE];
+	T_SARK_PLAN *pPlan;
+	T_SARK_PLAN *pLoaded;
+	int iLen;
+
+	pPlan = Sark_Plan_Create(pu32Freq, NUM_POINTS, TRUE, 4, bFloat);
+	CHECK(pPlan != NULL);
+	RunFresh(pPlan, tfR, tfX);
+	CHECK(Sark_Plan_Save(pPlan, PLAN_FILE) == 1);
+	Sark_Plan_Destroy(pPlan);
+
+	pLoaded = Sark_Plan_Load(PLAN_FILE);
+	CHECK(pLoaded != NULL);
+	if (pLoaded == NULL)
+		return;
+	CHECK(Sark_Plan_Points(pLoaded) == NUM_POINTS);
+	RunFresh(pLoaded, tfLoadR, tfLoadX);
+	CHECK(memcmp(tfR, tfLoadR, sizeof(tfR)) == 0);
+	CHECK(memcmp(tfX, tfLoadX, sizeof(tfX)) == 0);
+
+	/* Saving the loaded plan writes the same file */
+	iLen = ReadFile(PLAN_FILE, tu8Saved);
+	CHECK(iLen == HEADER_SIZE + iFrames * SARKCMD_TX_SIZE);
+	CHECK(Sark_Plan_Save(pLoaded, PLAN_FILE) == 1);
+	CHECK(ReadFile(PLAN_FILE, tu8Again) == iLen);
+	CHECK(memcmp(tu8Saved, tu8Again, iLen) == 0);
+	Sark_Plan_Destroy(pLoaded);
+}
+
+/**
+  * @brief Damaged files are rejected
+  */
+static void TestBadFiles (const uint32 *pu32Freq)
+{
+	uint8 tu8File[MAX_FILE];
+	T_SARK_PLAN *pPlan;
+	int iLen;
+
+	pPlan = Sark_Plan_Create(pu32Freq, NUM_POINTS, TRUE, 4, FALSE);
+	CHECK(pPlan != NULL);
+	CHECK(Sark_Plan_Save(pPlan, NULL) == -3);
+	CHECK(Sark_Plan_Save(NULL, PLAN_FILE) == -3);
+	CHECK(Sark_Plan_Save(pPlan, PLAN_FILE) == 1);
+	Sark_Plan_Destroy(pPlan);
+	iLen = ReadFile(PLAN_FILE, tu8File);
+	CHECK(iLen > HEADER_SIZE);
+
+	/* Truncated */
+	WriteFile(PLAN_FILE, tu8File, iLen - 1);
+	CHECK(Sark_Plan_Load(PLAN_FILE) == NULL);
+
+	/* Unknown request */
+	tu8File[HEADER_SIZE] = 0xff;
+	WriteFile(PLAN_FILE, tu8File, iLen);
+	CHECK(Sark_Plan_Load(PLAN_FILE) == NULL);
+
+	/* Not a plan */
+	tu8File[0] = 'X';
+	WriteFile(PLAN_FILE, tu8File, iLen);
+	CHECK(Sark_Plan_Load(PLAN_FILE) == NULL);
+
+	remove(PLAN_FILE);
+	CHECK(Sark_Plan_Load(PLAN_FILE) == NULL);
+	CHECK(Sark_Plan_Load(NULL) == NULL);
+}
+
+int main (void)
+{
+	uint32 tu32Freq[NUM_POINTS];
+	int ii;
+
+	for (ii = 0; ii < EVEN_POINTS; ii++)
+		tu32Freq[ii] = 13000000 + 50000 * ii;
+	for (ii = 0; ii < ODD_POINTS; ii++)
+		tu32Freq[EVEN_POINTS + ii] = 16000000 + 10000 * ii * ii;
+
+	CHECK(Sark_Connect(ITFZ_SIM, 1, NULL) == 1);
+	TestRoundTrip(tu32Freq, FALSE, EVEN_POINTS / 4 + ODD_POINTS);
+	TestRoundTrip(tu32Freq, TRUE, NUM_POINTS);
+	TestBadFiles(tu32Freq);
+	Sark_Close(0);
+
+	return TEST_RESULT("test_plan");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,281 @@
+/**
+  ******************************************************************************
+  * @file    test_proxy.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - proxy serving the simulator to local clients
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include "sock_cli.h"
+#include "shm_cli.h"
+#include "sark_sim.h"
+#include "sark_proxy.h"
+#include "sark_rem_client.h"
+#include "sark_cmd_defs.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PORT_PROXY		18120	/* device 0; device 1 on the next port */
+#define SHM_NAME		"sark_test_proxy"
+#define NUM_CLIENTS		6		/* connections to device 0 */
+#define NUM_REQUESTS	30
+#define BULK_POINTS		20
+#define RES_FREQ_0		14100000	/* resonance of simulated device 0 */
+#define RES_FREQ_1		14200000	/* and of device 1 */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Requests of a client thread */
+typedef struct
+{
+	int16 num;
+	int iFailed;
+} T_CLIENT;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Encodes a measurement request
+  */
+static void MeasRequest (uint8 *tx, uint8 u8Cmd, uint32 u32Freq, int iPoints, uint8 u8Format)
+{
+	memset(tx, 0, SARKCMD_TX_SIZE);
+	tx[0] = u8Cmd;
+	Int2Buf(&tx[1], u32Freq);
+	tx[5] = 1;				/* calibrated */
+	tx[6] = 16;				/* samples */
+	if (u8Cmd == CMD_SARK_MEAS_RX_BULK)
+	{
+		Int2Buf(&tx[7], 1000);
+		tx[11] = (uint8)iPoints;
+		tx[12] = (uint8)(iPoints >> 8);
+		tx[13] = u8Format;
+	}
+}
+
+/**
+  * @brief Tells if a measurement answer shows the load at its resonance
+  */
+static bool AtResonance (const uint8 *rx)
+{
+	float fR, fX;
+
+	Buf2Float(&fR, &rx[1]);
+	Buf2Float(&fX, &rx[5]);
+	return rx[0] == ANS_SARK_OK && fabsf(fR - 50.0f) < 1.0f && fabsf(fX) < 1.0f;
+}
+
+/**
+  * @brief Checks the answers of a device through a transport
+  *
+  * @param  pfSendReceive	transport
+  * @param  pfBulk			bulk exchange of the transport
+  * @param  num				server number of the transport
+  * @param  i16Dev			device served by it
+  */
+static void CheckDevice (int (*pfSendReceive)(int16, uint8 *, uint8 *),
+	int (*pfBulk)(int16, uint8 *, uint8 *, int), int16 num, int16 i16Dev)
+{
+	uint8 tx[SARKCMD_TX_SIZE];
+	uint8 rx[BULK_MAX_FRAMES * SARKCMD_RX_SIZE];
+	uint8 tu8Sim[SARKCMD_RX_SIZE];
+	uint32 u32Res = (i16Dev == 0) ? RES_FREQ_0 : RES_FREQ_1;
+	int iFrames = BULK_POINTS / BULK_PER_FLOAT;
+	float fR;
+	int ii;
+
+	memset(tx, 0, sizeof(tx));
+	tx[0] = CMD_SARK_VERSION;
+	CHECK(pfSendReceive(num, tx, rx) == 1);
+	CHECK(Sim_SendReceive(i16Dev, tx, tu8Sim) == 1);
+	CHECK(memcmp(rx, tu8Sim, SARKCMD_RX_SIZE) == 0);
+
+	MeasRequest(tx, CMD_SARK_MEAS_RX, u32Res, 1, 0);
+	CHECK(pfSendReceive(num, tx, rx) == 1);
+	CHECK(AtResonance(rx));
+
+	MeasRequest(tx, CMD_SARK_MEAS_RX_BULK, u32Res, BULK_POINTS, BULK_FMT_FLOAT);
+	memset(rx, 0, sizeof(rx));
+	CHECK(pfBulk(num, tx, rx, iFrames) == 1);
+	for (ii = 0; ii < iFrames; ii++)
+	{
+		CHECK(rx[ii * SARKCMD_RX_SIZE] == ANS_SARK_OK);
+		CHECK(rx[ii * SARKCMD_RX_SIZE + 1] == ii);
+		Buf2Float(&fR, &rx[ii * SARKCMD_RX_SIZE + 2]);
+		CHECK(fabsf(fR - 50.0f) < 1.0f);
+	}
+
+	/* Not sent to the device */
+	MeasRequest(tx, CMD_SARK_MEAS_RX_BULK, u32Res, BULK_POINTS, 7);
+	CHECK(pfSendReceive(num, tx, rx) == 1);
+	CHECK(rx[0] == ANS_SARK_ERR);
+}
+
+/**
+  * @brief Client thread: NUM_REQUESTS identical measurements, counting the failed ones
+  */
+static DWORD WINAPI Client (LPVOID lpParam)
+{
+	T_CLIENT *ptClient = (T_CLIENT *)lpParam;
+	uint8 tx[SARKCMD_TX_SIZE];
+	uint8 rx[SARKCMD_RX_SIZE];
+	int ii;
+
+	MeasRequest(tx, CMD_SARK_MEAS_RX, RES_FREQ_0, 1, 0);
+	for (ii = 0; ii < NUM_REQUESTS; ii++)
+	{
+		if (Sock_SendReceive(ptClient->num, tx, rx) < 0 || !AtResonance(rx))
+			ptClient->iFailed++;
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Every client gets the answers of the device it is connected to
+  */
+static void TestAnswers (void)
+{
+	CheckDevice(Sock_SendReceive, Sock_SendReceiveBulk, 0, 0);
+	CheckDevice(Sock_SendReceive, Sock_SendReceiveBulk, NUM_CLIENTS, 1);
+}
+
+/**
+  * @brief Clients share a device; identical measurements queued together take one exchange
+  */
+static void TestShared (T_SARK_PROXY *pProxy)
+{
+	T_CLIENT tClient[NUM_CLIENTS];
+	HANDLE hThread[NUM_CLIENTS];
+	uint32 u32Served, u32Coalesced, u32Clients;
+	uint32 u32Before;
+	int ii;
+
+	CHECK(Sark_Proxy_Stats(pProxy, 0, &u32Before, NULL, NULL) == 1);
+	for (ii = 0; ii < NUM_CLIENTS; ii++)
+	{
+		memset(&tClient[ii], 0, sizeof(T_CLIENT));
+		tClient[ii].num = (int16)ii;
+		hThread[ii] = CreateThread(NULL, 0, Client, &tClient[ii], 0, NULL);
+	}
+	WaitForMultipleObjects(NUM_CLIENTS, hThread, TRUE, INFINITE);
+	for (ii = 0; ii < NUM_CLIENTS; ii++)
+	{
+		CHECK(tClient[ii].iFailed == 0);
+		CloseHandle(hThread[ii]);
+	}
+	CHECK(Sark_Proxy_Stats(pProxy, 0, &u32Served, &u32Coalesced, &u32Clients) == 1);
+	CHECK(u32Served - u32Before == NUM_CLIENTS * NUM_REQUESTS);
+	CHECK(u32Coalesced > 0);
+	CHECK(u32Clients == NUM_CLIENTS);
+	CHECK(Sark_Proxy_Stats(pProxy, 1, NULL, NULL, &u32Clients) == 1);
+	CHECK(u32Clients == 1);
+	CHECK(Sark_Proxy_Stats(pProxy, 2, NULL, NULL, NULL) == -3);
+}
+
+/**
+  * @brief The devices are also served on shared memory
+  */
+static void TestShm (T_SARK_PROXY *pProxy)
+{
+	CHECK(Shm_Connect((char *)SHM_NAME "0") < 0);
+	CHECK(Sark_Proxy_Shm(pProxy, SHM_NAME) == 1);
+	CHECK(Sark_Proxy_Shm(pProxy, SHM_NAME) == -3);
+	CHECK(Shm_Connect((char *)SHM_NAME "0," SHM_NAME "1") == 2);
+	CheckDevice(Shm_SendReceive, Shm_SendReceiveBulk, 0, 0);
+	CheckDevice(Shm_SendReceive, Shm_SendReceiveBulk, 1, 1);
+	Shm_Close(0);
+	Shm_Close(1);
+}
+
+/**
+  * @brief A client leaving is seen by the proxy, which stops with clients still connected
+  */
+static void TestStop (T_SARK_PROXY *pProxy)
+{
+	uint8 tx[SARKCMD_TX_SIZE];
+	uint8 rx[SARKCMD_RX_SIZE];
+	uint32 u32Clients = 1;
+	int ii;
+
+	Sock_Close(NUM_CLIENTS);
+	for (ii = 0; ii < 50 && u32Clients != 0; ii++)
+	{
+		Sleep(10);
+		Sark_Proxy_Stats(pProxy, 1, NULL, NULL, &u32Clients);
+	}
+	CHECK(u32Clients == 0);
+
+	Sark_Proxy_Stop(pProxy);
+	memset(tx, 0, sizeof(tx));
+	tx[0] = CMD_SARK_VERSION;
+	CHECK(Sock_SendReceive(0, tx, rx) < 0);
+}
+
+int main (void)
+{
+	T_SARK_PROXY *pProxy;
+	char szServers[256];
+	int iLen = 0;
+	int ii;
+
+	/* The proxy reaches the devices through the device API */
+	CHECK(Sark_Connect(ITFZ_SIM, 2, (char *)"ordered") == 2);
+	pProxy = Sark_Proxy_Start(PORT_PROXY, 2);
+	CHECK(pProxy != NULL);
+	if (pProxy == NULL)
+		return TEST_RESULT("test_proxy");
+	CHECK(Sark_Proxy_Start(PORT_PROXY, 2) == NULL);
+	CHECK(Sark_Proxy_Start(PORT_PROXY + 2, SARK_MAX_DEVICES + 1) == NULL);
+
+	/* NUM_CLIENTS connections to device 0, then one to device 1 */
+	for (ii = 0; ii < NUM_CLIENTS; ii++)
+		iLen += sprintf(&szServers[iLen], "127.0.0.1:%u,", PORT_PROXY);
+	sprintf(&szServers[iLen], "127.0.0.1:%u", PORT_PROXY + 1);
+	CHECK(Sock_Connect(szServers, FALSE) == NUM_CLIENTS + 1);
+
+	TestAnswers();
+	TestShared(pProxy);
+	TestShm(pProxy);
+	TestStop(pProxy);
+	for (ii = 0; ii < NUM_CLIENTS; ii++)
+		Sock_Close((int16)ii);
+
+	return TEST_RESULT("test_proxy");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
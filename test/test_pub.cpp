@@ -0,0 +1,270 @@
+/**
+  ******************************************************************************
+  * @file    test_pub.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - sweep publisher with fast, slow and stalled subscribers
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <winsock2.h>
+#include <stdio.h>
+#include "sark_pub.h"
+#include "sark_sweep.h"
+#include "sark_rem_client.h"
+#include "sark_cmd_defs.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PORT_PUB		18130
+#define NUM_POINTS		200
+#define NUM_SWEEPS		150		/* posted every POST_EVERY ms, for longer than the stall timeout */
+#define POST_EVERY		20
+#define SLOW_READ		100		/* in ms; the slow subscriber waits this long after each sweep */
+#define POST_MAX_US		1000	/* worst time of a post */
+#define SMALL_RCVBUF	4096
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Subscriber */
+typedef struct
+{
+	DWORD dwWait;			/* ms waited after each sweep */
+	SOCKET hSock;
+	int iSweeps;			/* sweeps received */
+	int iBad;				/* messages with unexpected contents */
+	uint32 u32Last;			/* sequence number of the last sweep */
+} T_SUB;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief R and X of a point of a posted sweep
+  */
+static void PointValue (uint32 u32Seq, int iPoint, float *pfR, float *pfX)
+{
+	*pfR = (float)u32Seq + 0.5f * iPoint;
+	*pfX = -(float)iPoint;
+}
+
+/**
+  * @brief Receives a number of bytes
+  *
+  * @retval	FALSE if the connection was closed
+  */
+static bool RecvAll (SOCKET hSock, uint8 *pu8Buf, int iLen)
+{
+	int iResult;
+
+	while (iLen > 0)
+	{
+		iResult = recv(hSock, (char *)pu8Buf, iLen, 0);
+		if (iResult <= 0)
+			return FALSE;
+		pu8Buf += iResult;
+		iLen -= iResult;
+	}
+	return TRUE;
+}
+
+/**
+  * @brief Connects a subscriber
+  *
+  * @param  iRcvBuf		receive buffer size; zero for the default
+  */
+static SOCKET Subscribe (int iRcvBuf)
+{
+	struct sockaddr_in tAddr;
+	SOCKET hSock;
+
+	hSock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (iRcvBuf != 0)
+		setsockopt(hSock, SOL_SOCKET, SO_RCVBUF, (const char *)&iRcvBuf, sizeof(iRcvBuf));
+	memset(&tAddr, 0, sizeof(tAddr));
+	tAddr.sin_family = AF_INET;
+	tAddr.sin_port = htons(PORT_PUB);
+	tAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(hSock, (struct sockaddr *)&tAddr, sizeof(tAddr)) == SOCKET_ERROR)
+	{
+		closesocket(hSock);
+		return INVALID_SOCKET;
+	}
+	return hSock;
+}
+
+/**
+  * @brief Subscriber thread: checks the plan and the sweeps until the last one
+  */
+static DWORD WINAPI Subscriber (LPVOID lpParam)
+{
+	T_SUB *ptSub = (T_SUB *)lpParam;
+	uint8 tu8Msg[PUB_PREFIX_SIZE + 8 + 8 * NUM_POINTS];
+	uint8 *pu8Body = &tu8Msg[PUB_PREFIX_SIZE];
+	uint32 u32Val, u32Seq;
+	uint16 u16Ver;
+	float fR, fX, fVal;
+	int ii;
+
+	/* Plan */
+	if (!RecvAll(ptSub->hSock, tu8Msg, PUB_PREFIX_SIZE + 2 + PUB_FW_SIZE + 2 + 4 + 4 * NUM_POINTS))
+	{
+		ptSub->iBad++;
+		return 0;
+	}
+	Buf2Int(&u32Val, &tu8Msg[4]);
+	Buf2Short(&u16Ver, &pu8Body[0]);
+	if (tu8Msg[0] != PUB_MSG_PLAN || tu8Msg[1] != PUB_FMT_FLOAT || u32Val != 2 + PUB_FW_SIZE + 2 + 4 + 4 * NUM_POINTS
+		|| u16Ver != SARK_PROTO_BULK || strcmp((char *)&pu8Body[2], "SIM 1.0") != 0)
+		ptSub->iBad++;
+	Buf2Int(&u32Val, &pu8Body[2 + PUB_FW_SIZE + 2]);
+	if (u32Val != NUM_POINTS)
+		ptSub->iBad++;
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		Buf2Int(&u32Val, &pu8Body[2 + PUB_FW_SIZE + 2 + 4 + 4 * ii]);
+		if (u32Val != 14000000 + 1000 * (uint32)ii)
+			ptSub->iBad++;
+	}
+
+	/* Sweeps, R column then X column */
+	while (ptSub->u32Last != NUM_SWEEPS && RecvAll(ptSub->hSock, tu8Msg, sizeof(tu8Msg)))
+	{
+		Buf2Int(&u32Val, &tu8Msg[4]);
+		Buf2Int(&u32Seq, &pu8Body[0]);
+		if (tu8Msg[0] != PUB_MSG_SWEEP || u32Val != 8 + 8 * NUM_POINTS || u32Seq <= ptSub->u32Last)
+			ptSub->iBad++;
+		for (ii = 0; ii < NUM_POINTS; ii++)
+		{
+			PointValue(u32Seq, ii, &fR, &fX);
+			Buf2Float(&fVal, &pu8Body[8 + 4 * ii]);
+			if (fVal != fR)
+				ptSub->iBad++;
+			Buf2Float(&fVal, &pu8Body[8 + 4 * (NUM_POINTS + ii)]);
+			if (fVal != fX)
+				ptSub->iBad++;
+		}
+		ptSub->u32Last = u32Seq;
+		ptSub->iSweeps++;
+		Sleep(ptSub->dwWait);
+	}
+
+	return 0;
+}
+
+int main (void)
+{
+	T_SARK_SWEEP *pSweep;
+	T_SARK_PUB *pPub;
+	T_SUB tFast, tSlow;
+	HANDLE hFast, hSlow;
+	SOCKET hStalled;
+	uint32 tu32Freq[NUM_POINTS];
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	uint32 u32Subs, u32Sent, u32Skipped, u32Dropped;
+	LARGE_INTEGER liFreq, liStart, liEnd;
+	LONGLONG llWorst = 0;
+	uint32 u32Seq;
+	int ii;
+
+	CHECK(Sark_Connect(ITFZ_SIM, 1, NULL) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+		tu32Freq[ii] = 14000000 + 1000 * ii;
+	pSweep = Sark_Sweep_Create(tu32Freq, NUM_POINTS, TRUE, 1);
+	pPub = Sark_Pub_Start(PORT_PUB, 0, pSweep, PUB_FMT_FLOAT);
+	CHECK(pPub != NULL);
+	if (pPub == NULL)
+		return TEST_RESULT("test_pub");
+	CHECK(Sark_Pub_Start(PORT_PUB, 0, pSweep, PUB_FMT_FLOAT) == NULL);
+	CHECK(Sark_Pub_Points(pPub) == NUM_POINTS);
+
+	memset(&tFast, 0, sizeof(tFast));
+	memset(&tSlow, 0, sizeof(tSlow));
+	tSlow.dwWait = SLOW_READ;
+	tFast.hSock = Subscribe(0);
+	/* Small buffers, so sweeps wait in the publisher rather than in the
+	   subscriber; the stalled one never reads and fills them at once */
+	tSlow.hSock = Subscribe(SMALL_RCVBUF);
+	hStalled = Subscribe(SMALL_RCVBUF);
+	CHECK(tFast.hSock != INVALID_SOCKET && tSlow.hSock != INVALID_SOCKET && hStalled != INVALID_SOCKET);
+	hFast = CreateThread(NULL, 0, Subscriber, &tFast, 0, NULL);
+	hSlow = CreateThread(NULL, 0, Subscriber, &tSlow, 0, NULL);
+	Sark_Pub_Stats(pPub, &u32Subs, NULL, NULL, NULL);
+	for (ii = 0; ii < 50 && u32Subs < 3; ii++)
+	{
+		Sleep(10);
+		Sark_Pub_Stats(pPub, &u32Subs, NULL, NULL, NULL);
+	}
+	CHECK(u32Subs == 3);
+
+	/* Posting does not wait for the subscribers */
+	QueryPerformanceFrequency(&liFreq);
+	for (u32Seq = 1; u32Seq <= NUM_SWEEPS; u32Seq++)
+	{
+		for (ii = 0; ii < NUM_POINTS; ii++)
+			PointValue(u32Seq, ii, &tfR[ii], &tfX[ii]);
+		QueryPerformanceCounter(&liStart);
+		CHECK(Sark_Pub_Post(pPub, u32Seq, tfR, tfX) == 1);
+		QueryPerformanceCounter(&liEnd);
+		if (liEnd.QuadPart - liStart.QuadPart > llWorst)
+			llWorst = liEnd.QuadPart - liStart.QuadPart;
+		Sleep(POST_EVERY);
+	}
+	CHECK(llWorst * 1000000 / liFreq.QuadPart < POST_MAX_US);
+
+	WaitForSingleObject(hFast, 5000);
+	WaitForSingleObject(hSlow, 5000);
+	CloseHandle(hFast);
+	CloseHandle(hSlow);
+	/* The fast subscriber keeps up, the slow one gets the newest sweeps,
+	   both end with the last one */
+	CHECK(tFast.iBad == 0 && tSlow.iBad == 0);
+	CHECK(tFast.u32Last == NUM_SWEEPS && tSlow.u32Last == NUM_SWEEPS);
+	CHECK(tFast.iSweeps >= NUM_SWEEPS * 9 / 10);
+	CHECK(tSlow.iSweeps < NUM_SWEEPS / 2 && tSlow.iSweeps >= NUM_SWEEPS * POST_EVERY / SLOW_READ / 2);
+	CHECK(Sark_Pub_Stats(pPub, &u32Subs, &u32Sent, &u32Skipped, &u32Dropped) == 1);
+	CHECK(u32Dropped == 1);
+	CHECK(u32Subs == 2);
+	/* Also the few sweeps sent to the stalled subscriber before it was full */
+	CHECK(u32Sent >= (uint32)(tFast.iSweeps + tSlow.iSweeps));
+	CHECK(u32Skipped >= (uint32)(NUM_SWEEPS - tSlow.iSweeps));
+
+	closesocket(tFast.hSock);
+	closesocket(tSlow.hSock);
+	closesocket(hStalled);
+	Sark_Pub_Stop(pPub);
+	Sark_Sweep_Destroy(pSweep);
+	return TEST_RESULT("test_pub");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,237 @@
+/**
+  ******************************************************************************
+  * @file    test_shm.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - shared memory client against a server serving the simulator
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include "shm_cli.h"
+#include "sark_sim.h"
+#include "sark_rem_client.h"
+#include "sark_cmd_defs.h"
+#include "sark_cancel.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define SHM_NAME		"sark_test_shm"
+#define BULK_POINTS		100
+#define CANCEL_AFTER	100		/* in ms; well below the answer timeout */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Server answering from simulated device 0 */
+typedef struct
+{
+	T_SHM_SERVER *pSrv;
+	volatile LONG lDelay;		/* answers this late (ms) */
+	volatile LONG lDetached;	/* detach requests taken */
+	volatile LONG lStop;
+} T_TEST_SERVER;
+
+/* Private variables ---------------------------------------------------------*/
+static T_TEST_SERVER gtSrv;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Number of answer frames of a request
+  */
+static int Frames (const uint8 *tx)
+{
+	int iPer = (tx[13] == BULK_FMT_FLOAT) ? BULK_PER_FLOAT : BULK_PER_HALF;
+
+	if (tx[0] != CMD_SARK_MEAS_RX_BULK)
+		return 1;
+	return ((tx[11] | (tx[12] << 8)) + iPer - 1) / iPer;
+}
+
+/**
+  * @brief Serves the requests of the client until stopped
+  */
+static DWORD WINAPI Server (LPVOID lpParam)
+{
+	T_TEST_SERVER *ptSrv = (T_TEST_SERVER *)lpParam;
+	uint8 tx[SARKCMD_TX_SIZE];
+	uint8 rx[BULK_MAX_FRAMES * SARKCMD_RX_SIZE];
+	uint32 u32Seq;
+	int iFrames;
+	int ii;
+
+	while (ptSrv->lStop == 0)
+	{
+		if (Shm_Server_Recv(ptSrv->pSrv, tx, &u32Seq, 20) <= 0)
+			continue;
+		if (tx[0] == 0xff)
+		{
+			InterlockedIncrement(&ptSrv->lDetached);
+			continue;
+		}
+		iFrames = Frames(tx);
+		Sim_SendReceiveBulk(0, tx, rx, iFrames);
+		if (rx[0] != ANS_SARK_OK)
+			iFrames = 1;
+		Sleep(ptSrv->lDelay);
+		for (ii = 0; ii < iFrames; ii++)
+			CHECK(Shm_Server_Send(ptSrv->pSrv, u32Seq, &rx[ii * SARKCMD_RX_SIZE]) == 1);
+	}
+
+	return 0;
+}
+
+/**
+  * @brief Cancels a token after CANCEL_AFTER
+  */
+static DWORD WINAPI Canceller (LPVOID lpParam)
+{
+	Sleep(CANCEL_AFTER);
+	Sark_Cancel_Set((T_SARK_CANCEL *)lpParam);
+
+	return 0;
+}
+
+/**
+  * @brief Requests are answered through the shared memory as by the simulator
+  */
+static void TestExchange (void)
+{
+	uint8 tx[SARKCMD_TX_SIZE];
+	uint8 rx[SARKCMD_RX_SIZE];
+	uint8 tu8Sim[SARKCMD_RX_SIZE];
+	float tfR[BULK_POINTS], tfX[BULK_POINTS];
+	float fR, fX, fS21re, fS21im;
+	uint16 u16Ver;
+	uint8 tu8FW[SARKCMD_RX_SIZE];
+	int ii;
+
+	memset(tx, 0, sizeof(tx));
+	tx[0] = CMD_SARK_VERSION;
+	CHECK(Shm_SendReceive(0, tx, rx) == 1);
+	CHECK(Sim_SendReceive(0, tx, tu8Sim) == 1);
+	CHECK(memcmp(rx, tu8Sim, SARKCMD_RX_SIZE) == 0);
+	CHECK(Sark_Version(0, &u16Ver, tu8FW) == 1);
+	CHECK(u16Ver == SARK_PROTO_BULK);
+
+	/* The load resonates at 14.1 MHz with 50 ohm */
+	CHECK(Sark_Meas_Rx(0, 14100000, TRUE, 16, &fR, &fX, &fS21re, &fS21im) == 1);
+	CHECK(fabsf(fR - 50.0f) < 1.0f && fabsf(fX) < 1.0f);
+
+	/* Bulk answers are several frames per request */
+	CHECK(Sark_Meas_Rx_Bulk(0, 14100000 - BULK_POINTS / 2 * 1000, 1000, BULK_POINTS, TRUE, 16, TRUE,
+		tfR, tfX) == 1);
+	for (ii = 0; ii < BULK_POINTS; ii++)
+		CHECK(fabsf(tfR[ii] - 50.0f) < 1.0f);
+	CHECK(fabsf(tfX[BULK_POINTS / 2]) < 1.0f);
+	CHECK(tfX[0] < -1.0f && tfX[BULK_POINTS - 1] > 1.0f);
+}
+
+/**
+  * @brief A cancelled request gives up, and its late answer is not taken by the next one
+  */
+static void TestLateAnswer (void)
+{
+	T_SARK_CANCEL *ptCancel = Sark_Cancel_Create();
+	T_CANCEL_SCOPE tScope;
+	HANDLE hThread;
+	DWORD dwTook;
+	uint16 u16Ver;
+	uint8 tu8FW[SARKCMD_RX_SIZE];
+	float fR, fX, fS21re, fS21im;
+
+	InterlockedExchange(&gtSrv.lDelay, 3 * CANCEL_AFTER);
+	Sark_Cancel_Enter(&tScope, ptCancel);
+	hThread = CreateThread(NULL, 0, Canceller, ptCancel, 0, NULL);
+	dwTook = GetTickCount();
+	CHECK(Sark_Meas_Rx(0, 14100000, TRUE, 1, &fR, &fX, &fS21re, &fS21im) < 0);
+	dwTook = GetTickCount() - dwTook;
+	CHECK(dwTook >= CANCEL_AFTER && dwTook < 2 * CANCEL_AFTER);
+	Sark_Cancel_Leave(&tScope);
+	WaitForSingleObject(hThread, INFINITE);
+	CloseHandle(hThread);
+	Sark_Cancel_Destroy(ptCancel);
+
+	InterlockedExchange(&gtSrv.lDelay, 0);
+	CHECK(Sark_Version(0, &u16Ver, tu8FW) == 1);
+	CHECK(u16Ver == SARK_PROTO_BULK);
+}
+
+/**
+  * @brief The server takes a client again after the previous one detached
+  */
+static void TestReattach (void)
+{
+	uint16 u16Ver;
+	uint8 tu8FW[SARKCMD_RX_SIZE];
+	int ii;
+
+	CHECK(Sark_Close(0) == 1);
+	for (ii = 0; ii < 50 && gtSrv.lDetached == 0; ii++)
+		Sleep(10);
+	CHECK(gtSrv.lDetached == 1);
+	CHECK(Sark_Connect(ITFZ_SHM, 1, (char *)SHM_NAME) == 1);
+	CHECK(Sark_Version(0, &u16Ver, tu8FW) == 1);
+	CHECK(Sark_Close(0) == 1);
+}
+
+int main (void)
+{
+	HANDLE hServer;
+
+	CHECK(Sim_Open(1, NULL) == 1);
+	CHECK(Sark_Connect(ITFZ_SHM, 1, (char *)SHM_NAME) < 0);
+
+	memset(&gtSrv, 0, sizeof(gtSrv));
+	gtSrv.pSrv = Shm_Server_Create(SHM_NAME);
+	CHECK(gtSrv.pSrv != NULL);
+	if (gtSrv.pSrv == NULL)
+		return TEST_RESULT("test_shm");
+	CHECK(Shm_Server_Create(SHM_NAME) == NULL);
+	hServer = CreateThread(NULL, 0, Server, &gtSrv, 0, NULL);
+
+	CHECK(Sark_Connect(ITFZ_SHM, 1, (char *)SHM_NAME) == 1);
+	TestExchange();
+	TestLateAnswer();
+	TestReattach();
+
+	InterlockedExchange(&gtSrv.lStop, 1);
+	WaitForSingleObject(hServer, INFINITE);
+	CloseHandle(hServer);
+	Shm_Server_Destroy(gtSrv.pSrv);
+	return TEST_RESULT("test_shm");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
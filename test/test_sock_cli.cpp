@@ -0,0 +1,448 @@
+/**
+  ******************************************************************************
+  * @file    test_sock_cli.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - socket client against local servers
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "sock_cli.h"
+#include "sark_cmd_defs.h"
+#include "sark_cancel.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PORT_UP			18110	/* mock server */
+#define PORT_DOWN		18111	/* nobody listens */
+#define PORT_STALL		18112	/* listens, never accepts */
+#define TIMEOUT_STALL	3000	/* TIMEOUT_CONNECT of sock_cli.cpp */
+#define MAX_CLIENTS		8
+#define NUM_THREADS		4
+#define NUM_REQUESTS	200
+#define CANCEL_AFTER	200		/* in ms; well below the answer and reconnection timeouts */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Connection accepted by the mock server */
+typedef struct
+{
+	SOCKET hSock;
+	uint8 tu8Buf[SARKCMD_TX_SIZE];
+	int iLen;
+} T_MOCK_CLIENT;
+
+/* Mock server: answers every request with its own bytes */
+typedef struct
+{
+	SOCKET hListen;
+	T_MOCK_CLIENT tClient[MAX_CLIENTS];
+	volatile LONG lDrop;		/* closes the connections */
+	volatile LONG lMute;		/* takes the requests without answering them */
+	volatile LONG lStop;
+} T_MOCK_SERVER;
+
+/* Requests of a client thread */
+typedef struct
+{
+	int16 num;
+	int iId;
+	int iFailed;
+	DWORD dwElapsed;
+} T_CLIENT;
+
+/* Private variables ---------------------------------------------------------*/
+static T_MOCK_SERVER gtSrv;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Serves the connections of the mock server until stopped
+  */
+static DWORD WINAPI MockServer (LPVOID lpParam)
+{
+	T_MOCK_SERVER *ptSrv = (T_MOCK_SERVER *)lpParam;
+	T_MOCK_CLIENT *ptClient;
+	uint8 tu8Answer[SARKCMD_RX_SIZE];
+	struct timeval tWait;
+	fd_set tRead;
+	SOCKET hSock;
+	int iMax;
+	int iRead;
+	int ii;
+
+	while (ptSrv->lStop == 0)
+	{
+		if (InterlockedExchange(&ptSrv->lDrop, 0) != 0)
+		{
+			for (ii = 0; ii < MAX_CLIENTS; ii++)
+			{
+				if (ptSrv->tClient[ii].hSock != INVALID_SOCKET)
+					closesocket(ptSrv->tClient[ii].hSock);
+				ptSrv->tClient[ii].hSock = INVALID_SOCKET;
+			}
+		}
+		FD_ZERO(&tRead);
+		FD_SET(ptSrv->hListen, &tRead);
+		iMax = (int)ptSrv->hListen;
+		for (ii = 0; ii < MAX_CLIENTS; ii++)
+		{
+			hSock = ptSrv->tClient[ii].hSock;
+			if (hSock == INVALID_SOCKET)
+				continue;
+			FD_SET(hSock, &tRead);
+			if ((int)hSock > iMax)
+				iMax = (int)hSock;
+		}
+		tWait.tv_sec = 0;
+		tWait.tv_usec = 20000;
+		if (select(iMax + 1, &tRead, NULL, NULL, &tWait) <= 0)
+			continue;
+		if (FD_ISSET(ptSrv->hListen, &tRead))
+		{
+			hSock = accept(ptSrv->hListen, NULL, NULL);
+			for (ii = 0; ii < MAX_CLIENTS && ptSrv->tClient[ii].hSock != INVALID_SOCKET; ii++)
+				;
+			if (ii < MAX_CLIENTS)
+			{
+				ptSrv->tClient[ii].hSock = hSock;
+				ptSrv->tClient[ii].iLen = 0;
+			}
+			else
+				closesocket(hSock);
+		}
+		for (ii = 0; ii < MAX_CLIENTS; ii++)
+		{
+			ptClient = &ptSrv->tClient[ii];
+			if (ptClient->hSock == INVALID_SOCKET || !FD_ISSET(ptClient->hSock, &tRead))
+				continue;
+			iRead = recv(ptClient->hSock, (char *)&ptClient->tu8Buf[ptClient->iLen],
+				SARKCMD_TX_SIZE - ptClient->iLen, 0);
+			if (iRead <= 0)
+			{
+				closesocket(ptClient->hSock);
+				ptClient->hSock = INVALID_SOCKET;
+				continue;
+			}
+			ptClient->iLen += iRead;
+			if (ptClient->iLen < SARKCMD_TX_SIZE)
+				continue;
+			ptClient->iLen = 0;
+			if (ptSrv->lMute != 0)
+				continue;
+			memcpy(tu8Answer, ptClient->tu8Buf, SARKCMD_RX_SIZE);
+			tu8Answer[0] = ANS_SARK_OK;
+			send(ptClient->hSock, (const char *)tu8Answer, SARKCMD_RX_SIZE, 0);
+		}
+	}
+	for (ii = 0; ii < MAX_CLIENTS; ii++)
+	{
+		if (ptSrv->tClient[ii].hSock != INVALID_SOCKET)
+			closesocket(ptSrv->tClient[ii].hSock);
+	}
+	closesocket(ptSrv->hListen);
+
+	return 0;
+}
+
+/**
+  * @brief Sends a request numbered by its sender and checks the answer
+  *
+  * @retval	result of Sock_SendReceive, -3 if the answer is not the right one
+  */
+static int Request (int16 num, int iId, int iSeq)
+{
+	uint8 tx[SARKCMD_TX_SIZE];
+	uint8 rx[SARKCMD_RX_SIZE];
+	int rc;
+
+	memset(tx, 0, sizeof(tx));
+	tx[0] = CMD_SARK_VERSION;
+	tx[1] = (uint8)iId;
+	tx[2] = (uint8)iSeq;
+	tx[3] = (uint8)(iSeq >> 8);
+	memset(rx, 0, sizeof(rx));
+	rc = Sock_SendReceive(num, tx, rx);
+	if (rc > 0 && (rx[0] != ANS_SARK_OK || memcmp(&rx[1], &tx[1], SARKCMD_RX_SIZE - 1) != 0))
+		rc = -3;
+
+	return rc;
+}
+
+/**
+  * @brief Client thread: NUM_REQUESTS requests, counting the failed ones
+  */
+static DWORD WINAPI Client (LPVOID lpParam)
+{
+	T_CLIENT *ptClient = (T_CLIENT *)lpParam;
+	DWORD dwStart = GetTickCount();
+	int ii;
+
+	for (ii = 0; ii < NUM_REQUESTS; ii++)
+	{
+		if (Request(ptClient->num, ptClient->iId, ii) < 0)
+			ptClient->iFailed++;
+	}
+	ptClient->dwElapsed = GetTickCount() - dwStart;
+
+	return 0;
+}
+
+/**
+  * @brief Cancels a token after CANCEL_AFTER
+  */
+static DWORD WINAPI Canceller (LPVOID lpParam)
+{
+	Sleep(CANCEL_AFTER);
+	Sark_Cancel_Set((T_SARK_CANCEL *)lpParam);
+
+	return 0;
+}
+
+/**
+  * @brief Sends a request from an operation cancelled while it waits
+  *
+  * @param  num			server number
+  * @param  pdwTook		return time taken (ms)
+  * @retval	result of the request
+  */
+static int CancelledRequest (int16 num, DWORD *pdwTook)
+{
+	T_SARK_CANCEL *ptCancel = Sark_Cancel_Create();
+	T_CANCEL_SCOPE tScope;
+	HANDLE hThread;
+	DWORD dwStart = GetTickCount();
+	int rc;
+
+	Sark_Cancel_Enter(&tScope, ptCancel);
+	hThread = CreateThread(NULL, 0, Canceller, ptCancel, 0, NULL);
+	rc = Request(num, 0x44, 0);
+	*pdwTook = GetTickCount() - dwStart;
+	CHECK(Sark_Cancel_Pending());
+	Sark_Cancel_Leave(&tScope);
+	WaitForSingleObject(hThread, INFINITE);
+	CloseHandle(hThread);
+	Sark_Cancel_Destroy(ptCancel);
+
+	return rc;
+}
+
+/**
+  * @brief Malformed lists are rejected; servers that do not answer are waited for together
+  */
+static void TestConnectList (void)
+{
+	struct sockaddr_in tAddr;
+	SOCKET hStall, hFill;
+	char szServers[128];
+	DWORD dwTook;
+
+	/* Rejected before connecting, wherever the malformed entry is */
+	sprintf(szServers, "127.0.0.1:0,127.0.0.1:%u", PORT_UP);
+	CHECK(Sock_Connect(szServers, FALSE) == -1);
+	sprintf(szServers, "127.0.0.1:%u,[::1", PORT_UP);
+	CHECK(Sock_Connect(szServers, FALSE) == -1);
+	CHECK(Sock_Connect((char *)"", FALSE) == -1);
+	sprintf(szServers, "127.0.0.1:%u", PORT_DOWN);
+	CHECK(Sock_Connect(szServers, FALSE) == -2);
+
+	/* Connects to a listener that never accepts hang once its queue is full */
+	hStall = Sock_Listen(PORT_STALL, 0);
+	hFill = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	memset(&tAddr, 0, sizeof(tAddr));
+	tAddr.sin_family = AF_INET;
+	tAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	tAddr.sin_port = htons(PORT_STALL);
+	CHECK(hStall != INVALID_SOCKET && connect(hFill, (struct sockaddr *)&tAddr, sizeof(tAddr)) == 0);
+	sprintf(szServers, "127.0.0.1:%u,127.0.0.1:%u,127.0.0.1:%u,127.0.0.1:%u",
+		PORT_STALL, PORT_STALL, PORT_STALL, PORT_UP);
+	dwTook = GetTickCount();
+	CHECK(Sock_Connect(szServers, FALSE) == 4);
+	dwTook = GetTickCount() - dwTook;
+	CHECK(dwTook >= TIMEOUT_STALL - 100 && dwTook < TIMEOUT_STALL + 1000);
+	CHECK(Request(3, 0x33, 1) == 1);
+	Sock_Close(0);
+	Sock_Close(1);
+	Sock_Close(2);
+	Sock_Close(3);
+	closesocket(hFill);
+	closesocket(hStall);
+}
+
+/**
+  * @brief Cancelling ends the blocking waits for an answer and for a reconnection
+  */
+static void TestCancelBlocking (void)
+{
+	DWORD dwTook;
+
+	CHECK(Request(0, 0x44, 1) == 1);
+	InterlockedExchange(&gtSrv.lMute, 1);
+	CHECK(CancelledRequest(0, &dwTook) < 0);
+	CHECK(dwTook >= CANCEL_AFTER && dwTook < CANCEL_AFTER + 300);
+	InterlockedExchange(&gtSrv.lMute, 0);
+	/* The connection was closed, as the answer could come late */
+	CHECK(Request(0, 0x44, 2) == 1);
+
+	/* The backoff between attempts to the server that is down */
+	CHECK(CancelledRequest(1, &dwTook) == -1);
+	CHECK(dwTook >= CANCEL_AFTER && dwTook < CANCEL_AFTER + 300);
+}
+
+/**
+  * @brief Cancelling ends the wait for a request handed to the event loop
+  */
+static void TestCancelLoop (void)
+{
+	DWORD dwTook;
+
+	InterlockedExchange(&gtSrv.lMute, 1);
+	CHECK(CancelledRequest(0, &dwTook) == -1);
+	CHECK(dwTook >= CANCEL_AFTER && dwTook < CANCEL_AFTER + 300);
+	InterlockedExchange(&gtSrv.lMute, 0);
+	CHECK(Request(0, 0x44, 3) == 1);
+}
+
+/**
+  * @brief Requests of several threads share a connection and each gets its answers
+  */
+static void TestConcurrent (void)
+{
+	T_CLIENT tClient[NUM_THREADS];
+	HANDLE hThread[NUM_THREADS];
+	int ii;
+
+	for (ii = 0; ii < NUM_THREADS; ii++)
+	{
+		memset(&tClient[ii], 0, sizeof(T_CLIENT));
+		tClient[ii].num = 0;
+		tClient[ii].iId = ii + 1;
+		hThread[ii] = CreateThread(NULL, 0, Client, &tClient[ii], 0, NULL);
+	}
+	WaitForMultipleObjects(NUM_THREADS, hThread, TRUE, INFINITE);
+	for (ii = 0; ii < NUM_THREADS; ii++)
+	{
+		CHECK(tClient[ii].iFailed == 0);
+		CloseHandle(hThread[ii]);
+	}
+}
+
+/**
+  * @brief A server that is down does not hold up the others
+  *
+  *	Its connection is retried with backoff for seconds, while the requests
+  *	to the server that is up keep being answered at once.
+  */
+static void TestServerDown (void)
+{
+	T_CLIENT tDown;
+	HANDLE hThread;
+	DWORD dwStart, dwWorst = 0, dwTook;
+	int iFailed = 0;
+	int ii = 0;
+
+	memset(&tDown, 0, sizeof(tDown));
+	tDown.num = 1;
+	tDown.iId = 0x55;
+	hThread = CreateThread(NULL, 0, Client, &tDown, 0, NULL);
+	Sleep(50);
+	dwStart = GetTickCount();
+	while (GetTickCount() - dwStart < 1500)
+	{
+		dwTook = GetTickCount();
+		if (Request(0, 0x77, ii++) < 0)
+			iFailed++;
+		dwTook = GetTickCount() - dwTook;
+		if (dwTook > dwWorst)
+			dwWorst = dwTook;
+	}
+	WaitForSingleObject(hThread, INFINITE);
+	CloseHandle(hThread);
+	CHECK(iFailed == 0);
+	CHECK(dwWorst < 200);
+	/* Refused at once, then again after each backoff delay; later requests
+	   fail at once while the next attempt is not due */
+	CHECK(tDown.iFailed == NUM_REQUESTS);
+	CHECK(tDown.dwElapsed >= 1000);
+}
+
+/**
+  * @brief A connection closed by the server is reopened by the loop
+  */
+static void TestReconnect (void)
+{
+	InterlockedExchange(&gtSrv.lDrop, 1);
+	Sleep(100);
+	CHECK(Request(0, 0x66, 1) == 1);
+	CHECK(Request(0, 0x66, 2) == 1);
+}
+
+int main (void)
+{
+	HANDLE hServer;
+	char szServers[64];
+	int ii;
+
+	memset(&gtSrv, 0, sizeof(gtSrv));
+	for (ii = 0; ii < MAX_CLIENTS; ii++)
+		gtSrv.tClient[ii].hSock = INVALID_SOCKET;
+	gtSrv.hListen = Sock_Listen(PORT_UP, MAX_CLIENTS);
+	if (gtSrv.hListen == INVALID_SOCKET)
+	{
+		printf("test_sock_cli: port %u in use\n", PORT_UP);
+		return 1;
+	}
+	hServer = CreateThread(NULL, 0, MockServer, &gtSrv, 0, NULL);
+
+	TestConnectList();
+	sprintf(szServers, "127.0.0.1:%u,127.0.0.1:%u", PORT_UP, PORT_DOWN);
+	CHECK(Sock_Connect(szServers, FALSE) == 2);
+	TestCancelBlocking();
+	CHECK(Sock_Loop_Start() == 1);
+	TestCancelLoop();
+	TestConcurrent();
+	TestServerDown();
+	TestReconnect();
+	CHECK(Sock_Loop_Stop() == 1);
+	Sock_Close(0);
+	Sock_Close(1);
+
+	InterlockedExchange(&gtSrv.lStop, 1);
+	WaitForSingleObject(hServer, INFINITE);
+	CloseHandle(hServer);
+	return TEST_RESULT("test_sock_cli");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,230 @@
+/**
+  ******************************************************************************
+  * @file    test_spectrum.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - spectrum traces against the simulator
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sark_spectrum.h"
+#include "sark_rem_client.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_POINTS		21
+#define NUM_ROWS		10
+#define START_FREQ		7050000
+#define STEP_FREQ		5000
+
+/*
+ * The simulator sees a 0.01 V carrier at 7.1 MHz over a noise floor of
+ * 1e-5 V that varies by up to 35% from reading to reading.
+ */
+#define CARRIER_POINT	10
+#define CARRIER_DB		-40.0f
+#define FLOOR_DB		-100.0f
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static float gfMax[NUM_POINTS];
+static float gfMin[NUM_POINTS];
+static double gdPowSum[NUM_POINTS];
+static int giScans;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Runs one scan and folds its waterfall row into the expected holds
+  */
+static void ScanOne (T_SARK_SPECTRUM *pSpec)
+{
+	float tfLevel[NUM_POINTS];
+	int ii;
+
+	CHECK(Sark_Spectrum_Scan(0, pSpec, 1) == 1);
+	CHECK(Sark_Spectrum_Waterfall(pSpec, 0, tfLevel) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (giScans == 0 || tfLevel[ii] > gfMax[ii])
+			gfMax[ii] = tfLevel[ii];
+		if (giScans == 0 || tfLevel[ii] < gfMin[ii])
+			gfMin[ii] = tfLevel[ii];
+		if (giScans == 0)
+			gdPowSum[ii] = 0;
+		gdPowSum[ii] += pow(10.0, tfLevel[ii] / 10.0);
+	}
+	giScans++;
+}
+
+/**
+  * @brief The traces match the holds of the scanned rows
+  */
+static void CheckTraces (T_SARK_SPECTRUM *pSpec, uint32 u32Newest)
+{
+	float tfLast[NUM_POINTS], tfPeak[NUM_POINTS], tfMin[NUM_POINTS], tfAvg[NUM_POINTS];
+	float tfLevel[NUM_POINTS];
+	uint32 u32Scans = 0;
+	int iBad = 0;
+	int ii;
+
+	CHECK(Sark_Spectrum_Traces(pSpec, tfLast, tfPeak, tfMin, tfAvg, &u32Scans) == 1);
+	CHECK(u32Scans == u32Newest);
+	CHECK(Sark_Spectrum_Waterfall(pSpec, u32Newest, tfLevel) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (tfLast[ii] != tfLevel[ii])
+			iBad++;
+		if (tfPeak[ii] != gfMax[ii] || tfMin[ii] != gfMin[ii])
+			iBad++;
+		if (fabs(tfAvg[ii] - 10.0 * log10(gdPowSum[ii] / giScans)) > 0.01)
+			iBad++;
+		if (tfLast[ii] > tfPeak[ii] || tfLast[ii] < tfMin[ii])
+			iBad++;
+		if (tfAvg[ii] > tfPeak[ii] + 0.01f || tfAvg[ii] < tfMin[ii] - 0.01f)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+}
+
+/**
+  * @brief Nothing is reported before the first scan
+  */
+static void TestEmpty (T_SARK_SPECTRUM *pSpec)
+{
+	float tfLevel[NUM_POINTS];
+
+	CHECK(Sark_Spectrum_Traces(pSpec, NULL, NULL, NULL, NULL, NULL) == 0);
+	CHECK(Sark_Spectrum_Waterfall(pSpec, 0, tfLevel) == 0);
+	CHECK(Sark_Spectrum_Waterfall(pSpec, 0, NULL) == -3);
+	CHECK(Sark_Spectrum_Scan(0, pSpec, 0) == -3);
+	CHECK(Sark_Spectrum_Create(START_FREQ, STEP_FREQ, NUM_POINTS, 1) == NULL);
+}
+
+/**
+  * @brief Peak and min hold every scan, the average sits between them
+  */
+static void TestHold (T_SARK_SPECTRUM *pSpec)
+{
+	float tfPeak[NUM_POINTS], tfMin[NUM_POINTS];
+	int iSpread = 0;
+	int iBad = 0;
+	int ii;
+
+	for (ii = 0; ii < 2 * NUM_ROWS; ii++)
+	{
+		ScanOne(pSpec);
+		CheckTraces(pSpec, (uint32)giScans);
+	}
+
+	CHECK(Sark_Spectrum_Traces(pSpec, NULL, tfPeak, tfMin, NULL, NULL) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (ii == CARRIER_POINT)
+		{
+			if (fabs(tfMin[ii] - CARRIER_DB) > 0.1f)
+				iBad++;
+			continue;
+		}
+		if (tfPeak[ii] > FLOOR_DB + 10.0f || tfMin[ii] < FLOOR_DB - 10.0f)
+			iBad++;
+		/* The floor moves from scan to scan, the holds must follow it */
+		if (tfPeak[ii] > tfMin[ii] + 1.0f)
+			iSpread++;
+	}
+	CHECK(iBad == 0);
+	CHECK(iSpread == NUM_POINTS - 1);
+}
+
+/**
+  * @brief Old rows are overwritten, future rows are not there yet
+  */
+static void TestWaterfall (T_SARK_SPECTRUM *pSpec)
+{
+	float tfLevel[NUM_POINTS];
+	uint32 u32Newest = (uint32)giScans;
+
+	CHECK(Sark_Spectrum_Waterfall(pSpec, u32Newest + 1, tfLevel) == 0);
+	CHECK(Sark_Spectrum_Waterfall(pSpec, u32Newest - NUM_ROWS + 1, tfLevel) == 1);
+	CHECK(Sark_Spectrum_Waterfall(pSpec, u32Newest - NUM_ROWS, tfLevel) == -4);
+	CHECK(Sark_Spectrum_Waterfall(pSpec, 1, tfLevel) == -4);
+}
+
+/**
+  * @brief A reset restarts the holds from the next scan
+  */
+static void TestReset (T_SARK_SPECTRUM *pSpec)
+{
+	float tfLast[NUM_POINTS], tfPeak[NUM_POINTS], tfMin[NUM_POINTS], tfAvg[NUM_POINTS];
+	int iBad = 0;
+	int ii;
+
+	Sark_Spectrum_Reset(pSpec);
+	giScans = 0;
+	ScanOne(pSpec);
+	CHECK(Sark_Spectrum_Traces(pSpec, tfLast, tfPeak, tfMin, tfAvg, NULL) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (tfPeak[ii] != tfLast[ii] || tfMin[ii] != tfLast[ii])
+			iBad++;
+		if (fabs(tfAvg[ii] - tfLast[ii]) > 0.01f)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+
+	ScanOne(pSpec);
+	CheckTraces(pSpec, 2 * NUM_ROWS + 2);
+}
+
+int main (void)
+{
+	T_SARK_SPECTRUM *pSpec;
+
+	CHECK(Sark_Connect(ITFZ_SIM, 1, NULL) == 1);
+	pSpec = Sark_Spectrum_Create(START_FREQ, STEP_FREQ, NUM_POINTS, NUM_ROWS);
+	CHECK(pSpec != NULL);
+
+	TestEmpty(pSpec);
+	TestHold(pSpec);
+	TestWaterfall(pSpec);
+	TestReset(pSpec);
+
+	Sark_Spectrum_Destroy(pSpec);
+	return TEST_RESULT("test_spectrum");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,198 @@
+/**
+  ******************************************************************************
+  * @file    test_split.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - sweeps split across devices
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "sark_split.h"
+#include "sark_rem_client.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_DEVS		3
+#define NUM_POINTS		301
+#define CANCEL_AT		50		/* points reported before cancelling */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Progress seen by the callback */
+typedef struct
+{
+	int tiSeen[NUM_POINTS];	/* times each point was reported */
+	int iReported;
+	volatile LONG lInCall;	/* callbacks running */
+	int iOverlaps;			/* callbacks entered while another was running */
+	T_SARK_CANCEL *ptCancel;	/* set after CANCEL_AT points; NULL: never */
+} T_SEEN;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Records the points reported
+  */
+static void Progress (void *pvUser, int iFirst, int iEnd)
+{
+	T_SEEN *ptSeen = (T_SEEN *)pvUser;
+	int ii;
+
+	if (InterlockedIncrement(&ptSeen->lInCall) != 1)
+		ptSeen->iOverlaps++;
+	for (ii = iFirst; ii < iEnd; ii++)
+	{
+		if (ii >= 0 && ii < NUM_POINTS)
+			ptSeen->tiSeen[ii]++;
+	}
+	ptSeen->iReported += iEnd - iFirst;
+	if (ptSeen->ptCancel != NULL && ptSeen->iReported >= CANCEL_AT)
+		Sark_Cancel_Set(ptSeen->ptCancel);
+	Sleep(1);
+	InterlockedDecrement(&ptSeen->lInCall);
+}
+
+/**
+  * @brief Only one sub-band per device
+  */
+static void TestDevices (T_SARK_SWEEP *pSweep)
+{
+	int16 ti16Dup[NUM_DEVS] = { 0, 1, 0 };
+
+	CHECK(Sark_Split_Create(pSweep, ti16Dup, NUM_DEVS) == NULL);
+}
+
+/**
+  * @brief Every point is stamped and reported once, by its index in the sweep
+  */
+static void TestObserved (T_SARK_SWEEP *pSweep, const int16 *pi16Dev)
+{
+	static T_SEEN tSeen;
+	LONGLONG tllSend[NUM_POINTS], tllRecv[NUM_POINTS];
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	T_SARK_TIMING tTiming;
+	T_SARK_SPLIT *pSplit;
+	int iBad = 0;
+	int ii;
+
+	memset(&tSeen, 0, sizeof(tSeen));
+	memset(&tTiming, 0, sizeof(tTiming));
+	memset(tllSend, 0, sizeof(tllSend));
+	memset(tllRecv, 0, sizeof(tllRecv));
+	tTiming.pllSend = tllSend;
+	tTiming.pllRecv = tllRecv;
+	tTiming.iPoints = NUM_POINTS;
+	CHECK(Sark_Sweep_SetTiming(pSweep, &tTiming) == 1);
+	CHECK(Sark_Sweep_SetProgress(pSweep, Progress, &tSeen, 0, 7) == 1);
+	pSplit = Sark_Split_Create(pSweep, pi16Dev, NUM_DEVS);
+	CHECK(pSplit != NULL);
+	CHECK(Sark_Split_Run(pSplit, tfR, tfX) == 1);
+
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (tSeen.tiSeen[ii] != 1 || tllSend[ii] == 0 || tllRecv[ii] < tllSend[ii])
+			iBad++;
+	}
+	CHECK(iBad == 0);
+	CHECK(tSeen.iReported == NUM_POINTS);
+	CHECK(tSeen.iOverlaps == 0);
+	CHECK(tTiming.dTotal > 0);
+	CHECK(tTiming.dExchange > 0);
+
+	Sark_Split_Destroy(pSplit);
+	Sark_Sweep_SetTiming(pSweep, NULL);
+	Sark_Sweep_SetProgress(pSweep, NULL, NULL, 0, 0);
+}
+
+/**
+  * @brief The token of the sweep stops every device
+  */
+static void TestCancelled (T_SARK_SWEEP *pSweep, const int16 *pi16Dev)
+{
+	static T_SEEN tSeen;
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	T_SARK_CANCEL *ptCancel = Sark_Cancel_Create();
+	T_SARK_SPLIT *pSplit;
+	int iNan = 0;
+	int ii;
+
+	memset(&tSeen, 0, sizeof(tSeen));
+	tSeen.ptCancel = ptCancel;
+	CHECK(Sark_Sweep_SetCancel(pSweep, ptCancel) == 1);
+	CHECK(Sark_Sweep_SetProgress(pSweep, Progress, &tSeen, 0, 1) == 1);
+	pSplit = Sark_Split_Create(pSweep, pi16Dev, NUM_DEVS);
+	CHECK(pSplit != NULL);
+	CHECK(Sark_Split_Run(pSplit, tfR, tfX) == SARK_CANCELLED);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (tfR[ii] != tfR[ii])
+			iNan++;
+	}
+	CHECK(iNan > 0);
+	CHECK(iNan + tSeen.iReported == NUM_POINTS);
+
+	/* A token set beforehand measures nothing */
+	memset(&tSeen, 0, sizeof(tSeen));
+	CHECK(Sark_Split_Run(pSplit, tfR, tfX) == SARK_CANCELLED);
+	CHECK(tSeen.iReported == 0);
+
+	Sark_Split_Destroy(pSplit);
+	Sark_Sweep_SetCancel(pSweep, NULL);
+	Sark_Sweep_SetProgress(pSweep, NULL, NULL, 0, 0);
+	Sark_Cancel_Destroy(ptCancel);
+}
+
+int main (void)
+{
+	uint32 tu32Freq[NUM_POINTS];
+	int16 ti16Dev[NUM_DEVS] = { 2, 0, 1 };
+	T_SARK_SWEEP *pSweep;
+	int ii;
+
+	CHECK(Sark_Connect(ITFZ_SIM, NUM_DEVS, NULL) == NUM_DEVS);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+		tu32Freq[ii] = 13000000 + 10000 * ii;
+	pSweep = Sark_Sweep_Create(tu32Freq, NUM_POINTS, TRUE, 4);
+	CHECK(pSweep != NULL);
+
+	TestDevices(pSweep);
+	TestObserved(pSweep, ti16Dev);
+	TestCancelled(pSweep, ti16Dev);
+
+	Sark_Sweep_Destroy(pSweep);
+	return TEST_RESULT("test_split");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,223 @@
+/**
+  ******************************************************************************
+  * @file    test_sweep.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - adaptive averaging of sweeps against the simulator
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "sark_sweep.h"
+#include "sark_rem_client.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_POINTS		400
+#define REGION_POINTS	20
+#define NUM_REGIONS		(NUM_POINTS / REGION_POINTS)
+#define FIXED_SAMPLES	3
+#define MIN_SAMPLES		2
+#define MAX_SAMPLES		50
+
+/*
+ * The simulator adds noise of 0.2 ohm / sqrt(samples) to both R and X, so
+ * the noise of R and X together is 0.28 ohm / sqrt(samples): a 0.1 ohm
+ * target needs about 8 samples.
+ */
+#define TARGET_NOISE	0.1f
+#define TARGET_SAMPLES	8
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Samples of the first point of every region
+  */
+static void RegionSamples (T_SARK_SWEEP *pSweep, uint8 *pu8Region)
+{
+	uint8 tu8Samples[NUM_POINTS];
+	int ii;
+
+	CHECK(Sark_Sweep_GetSamples(pSweep, tu8Samples) == 1);
+	for (ii = 0; ii < NUM_REGIONS; ii++)
+		pu8Region[ii] = tu8Samples[ii * REGION_POINTS];
+}
+
+/**
+  * @brief Invalid settings are rejected; no target means fixed samples
+  */
+static void TestSettings (T_SARK_SWEEP *pSweep)
+{
+	uint8 tu8Samples[NUM_POINTS];
+	int iBad = 0;
+	int ii;
+
+	CHECK(Sark_Sweep_Adaptive(pSweep, TARGET_NOISE, 0, MAX_SAMPLES, REGION_POINTS) == -3);
+	CHECK(Sark_Sweep_Adaptive(pSweep, TARGET_NOISE, 10, 9, REGION_POINTS) == -3);
+	CHECK(Sark_Sweep_Adaptive(pSweep, TARGET_NOISE, MIN_SAMPLES, MAX_SAMPLES, 0) == -3);
+	CHECK(Sark_Sweep_Adaptive(pSweep, 0, MIN_SAMPLES, MAX_SAMPLES, REGION_POINTS) == 1);
+	CHECK(Sark_Sweep_GetSamples(pSweep, tu8Samples) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (tu8Samples[ii] != FIXED_SAMPLES)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+}
+
+/**
+  * @brief Every region is probed by the first run and settles near the target
+  */
+static void TestLearn (T_SARK_SWEEP *pSweep)
+{
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	uint8 tu8Region[NUM_REGIONS];
+	uint8 tu8Samples[NUM_POINTS];
+	int iSum = 0;
+	int iBad = 0;
+	int ii;
+
+	CHECK(Sark_Sweep_Adaptive(pSweep, TARGET_NOISE, MIN_SAMPLES, MAX_SAMPLES, REGION_POINTS) == 1);
+	RegionSamples(pSweep, tu8Region);
+	for (ii = 0; ii < NUM_REGIONS; ii++)
+	{
+		if (tu8Region[ii] != MIN_SAMPLES)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+
+	CHECK(Sark_Sweep_Run(0, pSweep, tfR, tfX) == 1);
+	CHECK(Sark_Sweep_GetSamples(pSweep, tu8Samples) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		/* A region uses the same samples for all its points */
+		if (tu8Samples[ii] != tu8Samples[ii - ii % REGION_POINTS])
+			iBad++;
+		if (tu8Samples[ii] < MIN_SAMPLES || tu8Samples[ii] > MAX_SAMPLES)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+	RegionSamples(pSweep, tu8Region);
+	for (ii = 0; ii < NUM_REGIONS; ii++)
+		iSum += tu8Region[ii];
+	/* Four readings estimate the noise of a region coarsely, the mean is closer */
+	CHECK(iSum > NUM_REGIONS * TARGET_SAMPLES / 2);
+	CHECK(iSum < NUM_REGIONS * TARGET_SAMPLES * 2);
+}
+
+/**
+  * @brief Later runs re-probe one region each, round robin
+  */
+static void TestReprobe (T_SARK_SWEEP *pSweep)
+{
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	uint8 tu8Before[NUM_REGIONS];
+	uint8 tu8After[NUM_REGIONS];
+	int iRun;
+	int iBad = 0;
+	int iChanged = 0;
+	int ii;
+
+	for (iRun = 1; iRun <= 5; iRun++)
+	{
+		RegionSamples(pSweep, tu8Before);
+		CHECK(Sark_Sweep_Run(0, pSweep, tfR, tfX) == 1);
+		RegionSamples(pSweep, tu8After);
+		for (ii = 0; ii < NUM_REGIONS; ii++)
+		{
+			if (tu8After[ii] == tu8Before[ii])
+				continue;
+			if (ii != iRun)
+				iBad++;
+			iChanged++;
+		}
+	}
+	CHECK(iBad == 0);
+	CHECK(iChanged > 0);
+}
+
+/**
+  * @brief The samples are bounded by the limits
+  */
+static void TestLimits (T_SARK_SWEEP *pSweep)
+{
+	float tfR[NUM_POINTS], tfX[NUM_POINTS];
+	uint8 tu8Region[NUM_REGIONS];
+	int iBad = 0;
+	int ii;
+
+	CHECK(Sark_Sweep_Adaptive(pSweep, 0.001f, MIN_SAMPLES, MAX_SAMPLES, REGION_POINTS) == 1);
+	CHECK(Sark_Sweep_Run(0, pSweep, tfR, tfX) == 1);
+	RegionSamples(pSweep, tu8Region);
+	for (ii = 0; ii < NUM_REGIONS; ii++)
+	{
+		if (tu8Region[ii] != MAX_SAMPLES)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+
+	CHECK(Sark_Sweep_Adaptive(pSweep, 10.0f, MIN_SAMPLES, MAX_SAMPLES, REGION_POINTS) == 1);
+	CHECK(Sark_Sweep_Run(0, pSweep, tfR, tfX) == 1);
+	RegionSamples(pSweep, tu8Region);
+	for (ii = 0; ii < NUM_REGIONS; ii++)
+	{
+		if (tu8Region[ii] != MIN_SAMPLES)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+}
+
+int main (void)
+{
+	uint32 tu32Freq[NUM_POINTS];
+	T_SARK_SWEEP *pSweep;
+	int ii;
+
+	CHECK(Sark_Connect(ITFZ_SIM, 1, NULL) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+		tu32Freq[ii] = 10000000 + 20000 * ii;
+	pSweep = Sark_Sweep_Create(tu32Freq, NUM_POINTS, TRUE, FIXED_SAMPLES);
+	CHECK(pSweep != NULL);
+
+	TestSettings(pSweep);
+	TestLearn(pSweep);
+	TestReprobe(pSweep);
+	TestLimits(pSweep);
+
+	Sark_Sweep_Destroy(pSweep);
+	return TEST_RESULT("test_sweep");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
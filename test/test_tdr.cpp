@@ -0,0 +1,197 @@
+/**
+  ******************************************************************************
+  * @file    test_tdr.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - FFT and time domain reflectometry
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include "sark_fft.h"
+#include "sark_tdr.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FFT_SIZE		64
+#define FFT_IMPULSE		3		/* position of the impulse */
+#define TDR_POINTS		200
+#define TDR_STEP		1000000	/* harmonic sweep, 1 to 200 MHz */
+#define TDR_VF			0.66f
+#define TDR_Z0			50.0f
+#define TDR_FAULT		10.0	/* distance to the open or short (m) */
+#define C0				299792458.0
+
+/* Private variables ---------------------------------------------------------*/
+static float gfRe[FFT_SIZE], gfIm[FFT_SIZE];
+static float gfR[TDR_POINTS], gfX[TDR_POINTS];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Sweep of a lossless line ended in an open or a short
+  *
+  *	Gamma = +-exp(-j 2 w d / (c vf)), Z = Z0 (1 + Gamma) / (1 - Gamma)
+  */
+static void Line (bool bOpen, double dDist)
+{
+	double dPh, dGr, dGi, dDr, dDi, dD2;
+	int ii;
+
+	for (ii = 0; ii < TDR_POINTS; ii++)
+	{
+		dPh = -2.0 * 2.0 * M_PI * (ii + 1.0) * TDR_STEP * dDist / (C0 * TDR_VF);
+		dGr = (bOpen ? 1 : -1) * cos(dPh);
+		dGi = (bOpen ? 1 : -1) * sin(dPh);
+		dDr = 1.0 - dGr;
+		dDi = -dGi;
+		dD2 = dDr * dDr + dDi * dDi;
+		gfR[ii] = (float)(TDR_Z0 * ((1.0 + dGr) * dDr + dGi * dDi) / dD2);
+		gfX[ii] = (float)(TDR_Z0 * (dGi * dDr - (1.0 + dGr) * dDi) / dD2);
+	}
+}
+
+/**
+  * @brief Transforms of an impulse are tones, and back
+  */
+static void TestFftImpulse (void)
+{
+	const T_FFT_PLAN *ptPlan;
+	double dPh;
+	float fErr = 0;
+	int ii;
+
+	CHECK(Fft_Plan(0) == NULL);
+	CHECK(Fft_Plan(48) == NULL);
+	ptPlan = Fft_Plan(FFT_SIZE);
+	CHECK(ptPlan != NULL);
+	if (ptPlan == NULL)
+		return;
+	CHECK(Fft_Plan(FFT_SIZE) == ptPlan);
+
+	memset(gfRe, 0, sizeof(gfRe));
+	memset(gfIm, 0, sizeof(gfIm));
+	gfRe[FFT_IMPULSE] = 1.0f;
+	Fft_Transform(ptPlan, gfRe, gfIm, FALSE);
+	for (ii = 0; ii < FFT_SIZE; ii++)
+	{
+		dPh = -2.0 * M_PI * FFT_IMPULSE * ii / FFT_SIZE;
+		fErr = fmaxf(fErr, fabsf(gfRe[ii] - (float)cos(dPh)));
+		fErr = fmaxf(fErr, fabsf(gfIm[ii] - (float)sin(dPh)));
+	}
+	CHECK(fErr < 1e-5f);
+
+	/* The inverse is not scaled */
+	Fft_Transform(ptPlan, gfRe, gfIm, TRUE);
+	fErr = 0;
+	for (ii = 0; ii < FFT_SIZE; ii++)
+	{
+		fErr = fmaxf(fErr, fabsf(gfRe[ii] - (ii == FFT_IMPULSE ? FFT_SIZE : 0)));
+		fErr = fmaxf(fErr, fabsf(gfIm[ii]));
+	}
+	CHECK(fErr < 1e-4f);
+}
+
+/**
+  * @brief FFT sizes that cannot hold the step response are rejected
+  */
+static void TestCreate (void)
+{
+	T_SARK_TDR *pTdr;
+
+	CHECK(Sark_Tdr_Create(TDR_POINTS, TDR_STEP, 256, TDR_WIN_HANN, TDR_VF, TDR_Z0) == NULL);
+	CHECK(Sark_Tdr_Create(TDR_POINTS, TDR_STEP, 384, TDR_WIN_HANN, TDR_VF, TDR_Z0) == NULL);
+	pTdr = Sark_Tdr_Create(TDR_POINTS, TDR_STEP, 512, TDR_WIN_HANN, TDR_VF, TDR_Z0);
+	CHECK(pTdr != NULL && Sark_Tdr_Size(pTdr) == 512);
+	Sark_Tdr_Destroy(pTdr);
+
+	/* Default: 4x zero padding */
+	pTdr = Sark_Tdr_Create(TDR_POINTS, TDR_STEP, 0, TDR_WIN_HANN, TDR_VF, TDR_Z0);
+	CHECK(pTdr != NULL && Sark_Tdr_Size(pTdr) == 1024);
+	Sark_Tdr_Destroy(pTdr);
+}
+
+/**
+  * @brief An open or a short shows at its distance, with its sign
+  */
+static void TestFault (bool bOpen)
+{
+	T_SARK_TDR *pTdr;
+	float *pfDist, *pfImpulse, *pfStep;
+	int iSize, iPeak;
+	int ii;
+
+	pTdr = Sark_Tdr_Create(TDR_POINTS, TDR_STEP, 0, TDR_WIN_HANN, TDR_VF, TDR_Z0);
+	CHECK(pTdr != NULL);
+	if (pTdr == NULL)
+		return;
+	iSize = Sark_Tdr_Size(pTdr);
+	pfDist = new float[3 * iSize];
+	pfImpulse = &pfDist[iSize];
+	pfStep = &pfDist[2 * iSize];
+
+	Line(bOpen, TDR_FAULT);
+	CHECK(Sark_Tdr_Process(pTdr, gfR, gfX, pfDist, pfImpulse, pfStep) == 1);
+
+	/* Impulse: one full reflection at the fault */
+	iPeak = 0;
+	for (ii = 1; ii < iSize / 2; ii++)
+	{
+		if (pfImpulse[ii] > pfImpulse[iPeak])
+			iPeak = ii;
+	}
+	CHECK(fabs(pfDist[iPeak] - TDR_FAULT) < 2 * pfDist[1]);
+	CHECK(pfImpulse[iPeak] > 0.9f && pfImpulse[iPeak] < 1.05f);
+
+	/* Step: matched before the fault, +1 for an open and -1 for a short after it */
+	ii = (int)(0.5 * TDR_FAULT / pfDist[1]);
+	CHECK(fabsf(pfStep[ii]) < 0.1f);
+	ii = (int)(1.5 * TDR_FAULT / pfDist[1]);
+	CHECK(fabsf(pfStep[ii] - (bOpen ? 1.0f : -1.0f)) < 0.15f);
+
+	delete[] pfDist;
+	Sark_Tdr_Destroy(pTdr);
+}
+
+int main (void)
+{
+	TestFftImpulse();
+	TestCreate();
+	TestFault(TRUE);
+	TestFault(FALSE);
+	return TEST_RESULT("test_tdr");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,201 @@
+/**
+  ******************************************************************************
+  * @file    test_thru.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - thru sweeps against the simulated delay line
+  ******************************************************************************
+  * @copy
+  *
+  *  This file is a part of the "SARK110 Antenna Vector Impedance Analyzer" software
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer software" is free software: you can redistribute it
+  *  and/or modify it under the terms of the GNU General Public License as
+  *  published by the Free Software Foundation, either version 3 of the License,
+  *  or (at your option) any later version.
+  *
+  *  "SARK110 Antenna Vector Impedance Analyzer" software is distributed in the hope that it will be
+  *  useful,  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  *  GNU General Public License for more details.
+  *
+  *  You should have received a copy of the GNU General Public License
+  *  along with "SARK110 Antenna Vector Impedance Analyzer" software.  If not,
+  *  see <http://www.gnu.org/licenses/>.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011-2019 Melchor Varela - EA4FRB </center></h2>
+  *  Melchor Varela, Madrid, Spain.
+  *  melchor.varela@gmail.com
+  */
+
+/** @addtogroup SARK110
+  * @{
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include "sark_thru.h"
+#include "sark_rem_client.h"
+#include "test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_POINTS		201
+#define FREQ_START		1000000		/* Hz */
+#define FREQ_STEP		1000000		/* Hz; the phase wraps twice over the sweep */
+#define SIM_DELAY		10e-9		/* thru of the simulator: 10 ns delay line */
+#define SIM_GAIN_DB		-6.0206f	/* and gain 0.5 */
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Progress seen by the callback */
+typedef struct
+{
+	int tiSeen[NUM_POINTS];	/* times each point was reported */
+	int iCalls;
+} T_SEEN;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief Records the points reported
+  */
+static void Progress (void *pvUser, int iFirst, int iEnd)
+{
+	T_SEEN *ptSeen = (T_SEEN *)pvUser;
+	int ii;
+
+	for (ii = iFirst; ii < iEnd; ii++)
+	{
+		if (ii >= 0 && ii < NUM_POINTS)
+			ptSeen->tiSeen[ii]++;
+	}
+	ptSeen->iCalls++;
+}
+
+/**
+  * @brief Difference of two angles in degrees, -180..180
+  */
+static double AngleDiff (double dA, double dB)
+{
+	double dDiff = fmod(dA - dB, 360.0);
+
+	if (dDiff > 180.0)
+		dDiff -= 360.0;
+	if (dDiff < -180.0)
+		dDiff += 360.0;
+	return dDiff;
+}
+
+/**
+  * @brief Magnitude, wrapped phase and group delay of a linear phase
+  */
+static void TestDelayLine (T_SARK_THRU *pThru, const uint32 *pu32Freq)
+{
+	float tfMagDb[NUM_POINTS], tfPhase[NUM_POINTS], tfDelay[NUM_POINTS];
+	int iBadMag = 0, iBadPhase = 0, iBadDelay = 0;
+	int ii;
+
+	CHECK(Sark_Thru_Run(0, pThru, tfMagDb, tfPhase, tfDelay) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (fabs(tfMagDb[ii] - SIM_GAIN_DB) > 0.01)
+			iBadMag++;
+		if (tfPhase[ii] < -180.0f || tfPhase[ii] > 180.0f ||
+			fabs(AngleDiff(tfPhase[ii], -360.0 * pu32Freq[ii] * SIM_DELAY)) > 0.01)
+			iBadPhase++;
+		/* No 2*pi jumps: constant delay across the wraps and at both ends */
+		if (fabs(tfDelay[ii] - SIM_DELAY) > SIM_DELAY * 1e-3)
+			iBadDelay++;
+	}
+	CHECK(iBadMag == 0);
+	CHECK(iBadPhase == 0);
+	CHECK(iBadDelay == 0);
+}
+
+/**
+  * @brief A run normalized by the same thru is flat
+  */
+static void TestReference (T_SARK_THRU *pThru)
+{
+	float tfMagDb[NUM_POINTS], tfPhase[NUM_POINTS], tfDelay[NUM_POINTS];
+	float tfRefMag[NUM_POINTS], tfRefPh[NUM_POINTS];
+	int iBad = 0;
+	int ii;
+
+	CHECK(Sark_Thru_GetReference(pThru, tfRefMag, tfRefPh) == 0);
+	CHECK(Sark_Thru_Reference(0, pThru) == 1);
+	CHECK(Sark_Thru_GetReference(pThru, tfRefMag, tfRefPh) == 1);
+	CHECK(Sark_Thru_Run(0, pThru, tfMagDb, tfPhase, tfDelay) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (fabs(tfMagDb[ii]) > 0.01 || fabs(tfPhase[ii]) > 0.01 || fabs(tfDelay[ii]) > 1e-12)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+	CHECK(Sark_Thru_SetReference(pThru, NULL, NULL) == 1);
+}
+
+/**
+  * @brief Every point is reported once; a set token stops the measurement
+  */
+static void TestProgressCancel (T_SARK_THRU *pThru)
+{
+	static T_SEEN tSeen;
+	float tfMagDb[NUM_POINTS];
+	T_SARK_CANCEL *ptCancel = Sark_Cancel_Create();
+	int iBad = 0;
+	int ii;
+
+	memset(&tSeen, 0, sizeof(tSeen));
+	CHECK(Sark_Thru_SetProgress(pThru, Progress, &tSeen, 0, 50) == 1);
+	CHECK(Sark_Thru_Run(0, pThru, tfMagDb, NULL, NULL) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+	{
+		if (tSeen.tiSeen[ii] != 1)
+			iBad++;
+	}
+	CHECK(iBad == 0);
+	CHECK(tSeen.iCalls == (NUM_POINTS + 49) / 50);
+
+	memset(&tSeen, 0, sizeof(tSeen));
+	CHECK(Sark_Thru_SetCancel(pThru, ptCancel) == 1);
+	CHECK(Sark_Cancel_Set(ptCancel) == 1);
+	CHECK(Sark_Thru_Run(0, pThru, tfMagDb, NULL, NULL) == SARK_CANCELLED);
+	CHECK(Sark_Thru_Reference(0, pThru) == SARK_CANCELLED);
+	CHECK(Sark_Thru_GetReference(pThru, tfMagDb, tfMagDb) == 0);
+	CHECK(tSeen.iCalls == 0);
+
+	CHECK(Sark_Cancel_Reset(ptCancel) == 1);
+	CHECK(Sark_Thru_Run(0, pThru, tfMagDb, NULL, NULL) == 1);
+	Sark_Thru_SetCancel(pThru, NULL);
+	Sark_Thru_SetProgress(pThru, NULL, NULL, 0, 0);
+	Sark_Cancel_Destroy(ptCancel);
+}
+
+int main (void)
+{
+	uint32 tu32Freq[NUM_POINTS];
+	T_SARK_THRU *pThru;
+	int ii;
+
+	CHECK(Sark_Connect(ITFZ_SIM, 1, NULL) == 1);
+	for (ii = 0; ii < NUM_POINTS; ii++)
+		tu32Freq[ii] = FREQ_START + FREQ_STEP * ii;
+	pThru = Sark_Thru_Create(tu32Freq, NUM_POINTS);
+	CHECK(pThru != NULL);
+
+	TestDelayLine(pThru, tu32Freq);
+	TestReference(pThru);
+	TestProgressCancel(pThru);
+
+	Sark_Thru_Destroy(pThru);
+	return TEST_RESULT("test_thru");
+}
+
+/**
+  * @}
+  */
+
+/************* (C) COPYRIGHT 2011-2019 Melchor Varela - EA4FRB *****END OF FILE****/
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    cfgmgr32.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - device notifications, mocked by the HID tests
+  ******************************************************************************
+  */
+
+#ifndef __TEST_CFGMGR32_H__
+#define __TEST_CFGMGR32_H__
+
+#include "windows.h"
+
+typedef void *HCMNOTIFICATION;
+typedef HCMNOTIFICATION *PHCMNOTIFICATION;
+
+#define CR_SUCCESS				0
+
+typedef enum
+{
+	CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE = 0
+} CM_NOTIFY_FILTER_TYPE;
+
+typedef enum
+{
+	CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL = 0,
+	CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL
+} CM_NOTIFY_ACTION;
+
+typedef struct
+{
+	DWORD cbSize;
+	DWORD Flags;
+	CM_NOTIFY_FILTER_TYPE FilterType;
+	DWORD Reserved;
+	union
+	{
+		struct
+		{
+			GUID ClassGuid;
+		} DeviceInterface;
+	} u;
+} CM_NOTIFY_FILTER, *PCM_NOTIFY_FILTER;
+
+typedef struct
+{
+	CM_NOTIFY_FILTER_TYPE FilterType;
+	DWORD Reserved;
+	union
+	{
+		struct
+		{
+			GUID ClassGuid;
+			WCHAR SymbolicLink[MAX_PATH];
+		} DeviceInterface;
+	} u;
+} CM_NOTIFY_EVENT_DATA, *PCM_NOTIFY_EVENT_DATA;
+
+typedef DWORD (CALLBACK *PCM_NOTIFY_CALLBACK) (HCMNOTIFICATION hNotify, PVOID pvContext,
+	CM_NOTIFY_ACTION eAction, PCM_NOTIFY_EVENT_DATA ptData, DWORD dwSize);
+
+#endif	/* __TEST_CFGMGR32_H__ */
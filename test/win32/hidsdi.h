@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file    hidsdi.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - HID class driver, mocked by the HID tests
+  ******************************************************************************
+  */
+
+#ifndef __TEST_HIDSDI_H__
+#define __TEST_HIDSDI_H__
+
+#include "windows.h"
+
+typedef struct
+{
+	ULONG Size;
+	WORD VendorID;
+	WORD ProductID;
+	WORD VersionNumber;
+} HIDD_ATTRIBUTES;
+
+typedef void *PHIDP_PREPARSED_DATA;
+
+typedef struct
+{
+	WORD Usage;
+	WORD UsagePage;
+	WORD InputReportByteLength;
+	WORD OutputReportByteLength;
+} HIDP_CAPS;
+
+void HidD_GetHidGuid (GUID *ptGuid);
+BOOL HidD_GetAttributes (HANDLE hDev, HIDD_ATTRIBUTES *ptAttr);
+BOOL HidD_GetPreparsedData (HANDLE hDev, PHIDP_PREPARSED_DATA *ppvData);
+BOOL HidD_FreePreparsedData (PHIDP_PREPARSED_DATA pvData);
+BOOL HidP_GetCaps (PHIDP_PREPARSED_DATA pvData, HIDP_CAPS *ptCaps);
+
+#endif	/* __TEST_HIDSDI_H__ */
@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file    setupapi.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - device enumeration, mocked by the HID tests
+  ******************************************************************************
+  */
+
+#ifndef __TEST_SETUPAPI_H__
+#define __TEST_SETUPAPI_H__
+
+#include "windows.h"
+
+typedef void *HDEVINFO;
+
+typedef struct
+{
+	DWORD cbSize;
+	GUID InterfaceClassGuid;
+	DWORD Flags;
+	ULONG_PTR Reserved;
+} SP_DEVICE_INTERFACE_DATA;
+
+typedef struct
+{
+	DWORD cbSize;
+	WCHAR DevicePath[1];
+} SP_DEVICE_INTERFACE_DETAIL_DATA_W;
+
+#define DIGCF_PRESENT			0x02
+#define DIGCF_DEVICEINTERFACE	0x10
+
+HDEVINFO SetupDiGetClassDevsW (const GUID *ptGuid, const WCHAR *pwszEnum, void *pvParent, DWORD dwFlags);
+BOOL SetupDiEnumDeviceInterfaces (HDEVINFO hInfo, void *pvDev, const GUID *ptGuid, DWORD dwIndex,
+	SP_DEVICE_INTERFACE_DATA *ptIface);
+BOOL SetupDiGetDeviceInterfaceDetailW (HDEVINFO hInfo, SP_DEVICE_INTERFACE_DATA *ptIface,
+	SP_DEVICE_INTERFACE_DETAIL_DATA_W *ptDetail, DWORD dwSize, DWORD *pdwRequired, void *pvDev);
+BOOL SetupDiDestroyDeviceInfoList (HDEVINFO hInfo);
+
+#endif	/* __TEST_SETUPAPI_H__ */
@@ -0,0 +1,575 @@
+/**
+  ******************************************************************************
+  * @file    win32.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - Win32 kernel objects on POSIX threads
+  ******************************************************************************
+  *	Every kernel object state change happens under one lock and wakes all
+  *	waiters, which then check their own objects again. Simple rather than
+  *	fast; the tests only need the Win32 semantics. Completion ports are
+  *	kernel objects too; winsock.cpp completes socket operations to them.
+  */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "windows.h"
+
+/* Kernel object */
+typedef enum { OBJ_EVENT = 1, OBJ_THREAD, OBJ_MAPPING, OBJ_PORT } T_OBJ_KIND;
+
+/* Completion packet */
+typedef struct packet
+{
+	DWORD dwBytes;
+	ULONG_PTR ulKey;
+	OVERLAPPED *ptOv;
+	BOOL bOk;
+	struct packet *ptNext;
+} T_PACKET;
+
+typedef struct obj
+{
+	T_OBJ_KIND eKind;
+	int iRefs;
+	char szName[MAX_PATH];		/* named objects are shared between opens */
+	bool bSignaled;				/* event set, or thread ended */
+	bool bManual;
+	LPTHREAD_START_ROUTINE pfStart;
+	LPVOID pvParam;
+	void *pvMem;
+	T_PACKET *ptFirst;			/* completion port queue */
+	T_PACKET *ptLast;
+	struct obj *ptNext;
+} T_OBJ;
+
+/* Handle associated with a completion port */
+typedef struct
+{
+	HANDLE hFile;
+	T_OBJ *ptPort;
+	ULONG_PTR ulKey;
+} T_ASSOC;
+
+#define MAX_ASSOC		256
+
+static pthread_mutex_t gtLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gtChanged = PTHREAD_COND_INITIALIZER;
+static T_OBJ *gptNamed;
+static T_ASSOC gtAssoc[MAX_ASSOC];
+static __thread DWORD gdwLastError;
+
+/* Locks ---------------------------------------------------------------------*/
+static pthread_mutex_t *CsMutex (CRITICAL_SECTION *pcs)
+{
+	pthread_mutexattr_t tAttr;
+	pthread_mutex_t *ptMutex;
+
+	/* Zeroed critical sections are initialized on first use */
+	pthread_mutex_lock(&gtLock);
+	if (pcs->pvImpl == NULL)
+	{
+		ptMutex = new pthread_mutex_t;
+		pthread_mutexattr_init(&tAttr);
+		pthread_mutexattr_settype(&tAttr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(ptMutex, &tAttr);
+		pcs->pvImpl = ptMutex;
+	}
+	pthread_mutex_unlock(&gtLock);
+	return (pthread_mutex_t *)pcs->pvImpl;
+}
+
+void InitializeCriticalSection (CRITICAL_SECTION *pcs) { pcs->pvImpl = NULL; CsMutex(pcs); }
+void EnterCriticalSection (CRITICAL_SECTION *pcs) { pthread_mutex_lock(CsMutex(pcs)); }
+BOOL TryEnterCriticalSection (CRITICAL_SECTION *pcs) { return pthread_mutex_trylock(CsMutex(pcs)) == 0; }
+void LeaveCriticalSection (CRITICAL_SECTION *pcs) { pthread_mutex_unlock(CsMutex(pcs)); }
+
+void DeleteCriticalSection (CRITICAL_SECTION *pcs)
+{
+	if (pcs->pvImpl == NULL)
+		return;
+	pthread_mutex_destroy((pthread_mutex_t *)pcs->pvImpl);
+	delete (pthread_mutex_t *)pcs->pvImpl;
+	pcs->pvImpl = NULL;
+}
+
+static pthread_rwlock_t *SrwLock (SRWLOCK *psrw)
+{
+	pthread_rwlock_t *ptLock;
+
+	pthread_mutex_lock(&gtLock);
+	if (psrw->pvImpl == NULL)
+	{
+		ptLock = new pthread_rwlock_t;
+		pthread_rwlock_init(ptLock, NULL);
+		psrw->pvImpl = ptLock;
+	}
+	pthread_mutex_unlock(&gtLock);
+	return (pthread_rwlock_t *)psrw->pvImpl;
+}
+
+void InitializeSRWLock (SRWLOCK *psrw) { psrw->pvImpl = NULL; }
+void AcquireSRWLockExclusive (SRWLOCK *psrw) { pthread_rwlock_wrlock(SrwLock(psrw)); }
+void ReleaseSRWLockExclusive (SRWLOCK *psrw) { pthread_rwlock_unlock(SrwLock(psrw)); }
+void AcquireSRWLockShared (SRWLOCK *psrw) { pthread_rwlock_rdlock(SrwLock(psrw)); }
+void ReleaseSRWLockShared (SRWLOCK *psrw) { pthread_rwlock_unlock(SrwLock(psrw)); }
+
+/* Atomics -------------------------------------------------------------------*/
+LONG InterlockedIncrement (LONG volatile *pl) { return __sync_add_and_fetch(pl, 1); }
+LONG InterlockedDecrement (LONG volatile *pl) { return __sync_sub_and_fetch(pl, 1); }
+LONG InterlockedExchangeAdd (LONG volatile *pl, LONG l) { return __sync_fetch_and_add(pl, l); }
+LONG InterlockedExchange (LONG volatile *pl, LONG l) { return __atomic_exchange_n(pl, l, __ATOMIC_SEQ_CST); }
+LONGLONG InterlockedExchange64 (LONGLONG volatile *pll, LONGLONG ll) { return __atomic_exchange_n(pll, ll, __ATOMIC_SEQ_CST); }
+
+LONG InterlockedCompareExchange (LONG volatile *pl, LONG lExchange, LONG lComparand)
+{
+	return __sync_val_compare_and_swap(pl, lComparand, lExchange);
+}
+
+LONGLONG InterlockedCompareExchange64 (LONGLONG volatile *pll, LONGLONG llExchange, LONGLONG llComparand)
+{
+	return __sync_val_compare_and_swap(pll, llComparand, llExchange);
+}
+
+/* Time ----------------------------------------------------------------------*/
+void Sleep (DWORD dwMs) { usleep((useconds_t)dwMs * 1000); }
+
+DWORD GetTickCount (void)
+{
+	struct timespec tTs;
+
+	clock_gettime(CLOCK_MONOTONIC, &tTs);
+	return (DWORD)(tTs.tv_sec * 1000 + tTs.tv_nsec / 1000000);
+}
+
+BOOL QueryPerformanceCounter (LARGE_INTEGER *pli)
+{
+	struct timespec tTs;
+
+	clock_gettime(CLOCK_MONOTONIC, &tTs);
+	pli->QuadPart = (LONGLONG)tTs.tv_sec * 1000000000 + tTs.tv_nsec;
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency (LARGE_INTEGER *pli) { pli->QuadPart = 1000000000; return TRUE; }
+DWORD GetLastError (void) { return gdwLastError; }
+void SetLastError (DWORD dwError) { gdwLastError = dwError; }
+
+void GetSystemInfo (SYSTEM_INFO *ptInfo)
+{
+	ptInfo->dwPageSize = (DWORD)sysconf(_SC_PAGESIZE);
+	ptInfo->dwNumberOfProcessors = (DWORD)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+/* Kernel objects ------------------------------------------------------------*/
+
+/* Finds or creates an object; gtLock held */
+static T_OBJ *ObjGet (T_OBJ_KIND eKind, const char *pszName, bool bCreate)
+{
+	T_OBJ *ptObj;
+
+	gdwLastError = ERROR_SUCCESS;
+	for (ptObj = (pszName != NULL) ? gptNamed : NULL; ptObj != NULL; ptObj = ptObj->ptNext)
+	{
+		if (ptObj->eKind == eKind && strcmp(ptObj->szName, pszName) == 0)
+		{
+			ptObj->iRefs++;
+			gdwLastError = ERROR_ALREADY_EXISTS;
+			return ptObj;
+		}
+	}
+	if (!bCreate)
+		return NULL;
+	ptObj = (T_OBJ *)calloc(1, sizeof(T_OBJ));
+	ptObj->eKind = eKind;
+	ptObj->iRefs = 1;
+	if (pszName != NULL)
+	{
+		snprintf(ptObj->szName, sizeof(ptObj->szName), "%s", pszName);
+		ptObj->ptNext = gptNamed;
+		gptNamed = ptObj;
+	}
+	return ptObj;
+}
+
+HANDLE CreateEventA (void *pvAttr, BOOL bManual, BOOL bInitial, const char *pszName)
+{
+	T_OBJ *ptObj;
+
+	(void)pvAttr;
+	pthread_mutex_lock(&gtLock);
+	ptObj = ObjGet(OBJ_EVENT, pszName, true);
+	if (gdwLastError != ERROR_ALREADY_EXISTS)
+	{
+		ptObj->bManual = bManual != FALSE;
+		ptObj->bSignaled = bInitial != FALSE;
+	}
+	pthread_mutex_unlock(&gtLock);
+	return ptObj;
+}
+
+HANDLE CreateEvent (void *pvAttr, BOOL bManual, BOOL bInitial, const char *pszName)
+{
+	return CreateEventA(pvAttr, bManual, bInitial, pszName);
+}
+
+HANDLE OpenEventA (DWORD dwAccess, BOOL bInherit, const char *pszName)
+{
+	T_OBJ *ptObj;
+
+	(void)dwAccess; (void)bInherit;
+	pthread_mutex_lock(&gtLock);
+	ptObj = ObjGet(OBJ_EVENT, pszName, false);
+	pthread_mutex_unlock(&gtLock);
+	return ptObj;
+}
+
+static BOOL EventSet (HANDLE hEvent, bool bSignaled)
+{
+	T_OBJ *ptObj = (T_OBJ *)hEvent;
+
+	if (ptObj == NULL || ptObj->eKind != OBJ_EVENT)
+		return FALSE;
+	pthread_mutex_lock(&gtLock);
+	ptObj->bSignaled = bSignaled;
+	pthread_cond_broadcast(&gtChanged);
+	pthread_mutex_unlock(&gtLock);
+	return TRUE;
+}
+
+BOOL SetEvent (HANDLE hEvent) { return EventSet(hEvent, true); }
+BOOL ResetEvent (HANDLE hEvent) { return EventSet(hEvent, false); }
+
+static void *ThreadMain (void *pvParam)
+{
+	T_OBJ *ptObj = (T_OBJ *)pvParam;
+
+	ptObj->pfStart(ptObj->pvParam);
+	pthread_mutex_lock(&gtLock);
+	ptObj->bSignaled = true;
+	pthread_cond_broadcast(&gtChanged);
+	/* The thread holds a reference to its own object */
+	if (--ptObj->iRefs == 0)
+		free(ptObj);
+	pthread_mutex_unlock(&gtLock);
+	return NULL;
+}
+
+HANDLE CreateThread (void *pvAttr, SIZE_T nStack, LPTHREAD_START_ROUTINE pfStart, LPVOID pvParam,
+	DWORD dwFlags, DWORD *pdwId)
+{
+	T_OBJ *ptObj;
+	pthread_t tThread;
+
+	(void)pvAttr; (void)nStack; (void)dwFlags;
+	pthread_mutex_lock(&gtLock);
+	ptObj = ObjGet(OBJ_THREAD, NULL, true);
+	ptObj->iRefs = 2;
+	ptObj->pfStart = pfStart;
+	ptObj->pvParam = pvParam;
+	pthread_mutex_unlock(&gtLock);
+	if (pthread_create(&tThread, NULL, ThreadMain, ptObj) != 0)
+	{
+		free(ptObj);
+		return NULL;
+	}
+	pthread_detach(tThread);
+	if (pdwId != NULL)
+		*pdwId = 0;
+	return ptObj;
+}
+
+/* Absolute time of a timeout */
+static void Deadline (struct timespec *ptUntil, DWORD dwMs)
+{
+	clock_gettime(CLOCK_REALTIME, ptUntil);
+	if (dwMs == INFINITE)
+		return;
+	ptUntil->tv_sec += dwMs / 1000;
+	ptUntil->tv_nsec += (long)(dwMs % 1000) * 1000000;
+	if (ptUntil->tv_nsec >= 1000000000)
+	{
+		ptUntil->tv_sec++;
+		ptUntil->tv_nsec -= 1000000000;
+	}
+}
+
+/* Checks the objects of a wait and consumes the signals; gtLock held */
+static DWORD WaitCheck (DWORD dwCount, const HANDLE *ph, BOOL bAll)
+{
+	T_OBJ *ptObj;
+	DWORD ii;
+
+	for (ii = 0; ii < dwCount; ii++)
+	{
+		ptObj = (T_OBJ *)ph[ii];
+		if (bAll && !ptObj->bSignaled)
+			return WAIT_TIMEOUT;
+		if (!bAll && ptObj->bSignaled)
+		{
+			if (ptObj->eKind == OBJ_EVENT && !ptObj->bManual)
+				ptObj->bSignaled = false;
+			return WAIT_OBJECT_0 + ii;
+		}
+	}
+	if (!bAll)
+		return WAIT_TIMEOUT;
+	for (ii = 0; ii < dwCount; ii++)
+	{
+		ptObj = (T_OBJ *)ph[ii];
+		if (ptObj->eKind == OBJ_EVENT && !ptObj->bManual)
+			ptObj->bSignaled = false;
+	}
+	return WAIT_OBJECT_0;
+}
+
+DWORD WaitForMultipleObjects (DWORD dwCount, const HANDLE *ph, BOOL bAll, DWORD dwMs)
+{
+	struct timespec tUntil;
+	DWORD dwRc;
+	DWORD ii;
+
+	if (dwCount == 0 || dwCount > MAXIMUM_WAIT_OBJECTS)
+		return WAIT_FAILED;
+	for (ii = 0; ii < dwCount; ii++)
+	{
+		if (ph[ii] == NULL || ph[ii] == INVALID_HANDLE_VALUE)
+			return WAIT_FAILED;
+	}
+	Deadline(&tUntil, dwMs);
+	pthread_mutex_lock(&gtLock);
+	while ((dwRc = WaitCheck(dwCount, ph, bAll)) == WAIT_TIMEOUT)
+	{
+		if (dwMs == INFINITE)
+			pthread_cond_wait(&gtChanged, &gtLock);
+		else if (pthread_cond_timedwait(&gtChanged, &gtLock, &tUntil) == ETIMEDOUT)
+		{
+			dwRc = WaitCheck(dwCount, ph, bAll);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&gtLock);
+	return dwRc;
+}
+
+DWORD WaitForSingleObject (HANDLE h, DWORD dwMs) { return WaitForMultipleObjects(1, &h, FALSE, dwMs); }
+
+BOOL CloseHandle (HANDLE h)
+{
+	T_OBJ *ptObj = (T_OBJ *)h;
+	T_OBJ **pptLink;
+	T_PACKET *ptPacket;
+
+	if (ptObj == NULL || ptObj == INVALID_HANDLE_VALUE)
+		return FALSE;
+	pthread_mutex_lock(&gtLock);
+	if (--ptObj->iRefs == 0)
+	{
+		while (ptObj->ptFirst != NULL)
+		{
+			ptPacket = ptObj->ptFirst;
+			ptObj->ptFirst = ptPacket->ptNext;
+			free(ptPacket);
+		}
+		for (pptLink = &gptNamed; *pptLink != NULL; pptLink = &(*pptLink)->ptNext)
+		{
+			if (*pptLink == ptObj)
+			{
+				*pptLink = ptObj->ptNext;
+				break;
+			}
+		}
+		free(ptObj->pvMem);
+		free(ptObj);
+	}
+	pthread_mutex_unlock(&gtLock);
+	return TRUE;
+}
+
+HANDLE CreateFileMappingA (HANDLE hFile, void *pvAttr, DWORD dwProtect, DWORD dwSizeHigh,
+	DWORD dwSizeLow, const char *pszName)
+{
+	T_OBJ *ptObj;
+
+	(void)hFile; (void)pvAttr; (void)dwProtect;
+	pthread_mutex_lock(&gtLock);
+	ptObj = ObjGet(OBJ_MAPPING, pszName, true);
+	if (ptObj->pvMem == NULL)
+		ptObj->pvMem = calloc(1, ((size_t)dwSizeHigh << 32) | dwSizeLow);
+	pthread_mutex_unlock(&gtLock);
+	return ptObj;
+}
+
+HANDLE OpenFileMappingA (DWORD dwAccess, BOOL bInherit, const char *pszName)
+{
+	T_OBJ *ptObj;
+
+	(void)dwAccess; (void)bInherit;
+	pthread_mutex_lock(&gtLock);
+	ptObj = ObjGet(OBJ_MAPPING, pszName, false);
+	pthread_mutex_unlock(&gtLock);
+	return ptObj;
+}
+
+void *MapViewOfFile (HANDLE hMap, DWORD dwAccess, DWORD dwOffHigh, DWORD dwOffLow, SIZE_T nBytes)
+{
+	(void)dwAccess; (void)dwOffHigh; (void)dwOffLow; (void)nBytes;
+	return ((T_OBJ *)hMap)->pvMem;
+}
+
+BOOL UnmapViewOfFile (const void *pvView) { (void)pvView; return TRUE; }
+
+/* Completion ports --------------------------------------------------------*/
+HANDLE CreateIoCompletionPort (HANDLE hFile, HANDLE hPort, ULONG_PTR ulKey, DWORD dwThreads)
+{
+	T_OBJ *ptObj;
+	int iFree = -1;
+	int ii;
+
+	(void)dwThreads;
+	pthread_mutex_lock(&gtLock);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		ptObj = ObjGet(OBJ_PORT, NULL, true);
+		pthread_mutex_unlock(&gtLock);
+		return ptObj;
+	}
+	for (ii = 0; ii < MAX_ASSOC; ii++)
+	{
+		if (gtAssoc[ii].hFile == hFile)
+			break;
+		if (iFree < 0 && gtAssoc[ii].ptPort == NULL)
+			iFree = ii;
+	}
+	if (ii == MAX_ASSOC)
+		ii = iFree;
+	if (ii >= 0)
+	{
+		gtAssoc[ii].hFile = hFile;
+		gtAssoc[ii].ptPort = (T_OBJ *)hPort;
+		gtAssoc[ii].ulKey = ulKey;
+	}
+	pthread_mutex_unlock(&gtLock);
+	return (ii >= 0) ? hPort : NULL;
+}
+
+/* Queues a packet; gtLock held */
+static void PortQueue (T_OBJ *ptPort, DWORD dwBytes, ULONG_PTR ulKey, OVERLAPPED *ptOv, BOOL bOk)
+{
+	T_PACKET *ptPacket = (T_PACKET *)calloc(1, sizeof(T_PACKET));
+
+	ptPacket->dwBytes = dwBytes;
+	ptPacket->ulKey = ulKey;
+	ptPacket->ptOv = ptOv;
+	ptPacket->bOk = bOk;
+	if (ptPort->ptLast != NULL)
+		ptPort->ptLast->ptNext = ptPacket;
+	else
+		ptPort->ptFirst = ptPacket;
+	ptPort->ptLast = ptPacket;
+	pthread_cond_broadcast(&gtChanged);
+}
+
+BOOL PostQueuedCompletionStatus (HANDLE hPort, DWORD dwBytes, ULONG_PTR ulKey, OVERLAPPED *ptOv)
+{
+	pthread_mutex_lock(&gtLock);
+	PortQueue((T_OBJ *)hPort, dwBytes, ulKey, ptOv, TRUE);
+	pthread_mutex_unlock(&gtLock);
+	return TRUE;
+}
+
+BOOL GetQueuedCompletionStatus (HANDLE hPort, DWORD *pdwBytes, ULONG_PTR *pulKey,
+	OVERLAPPED **pptOv, DWORD dwMs)
+{
+	T_OBJ *ptPort = (T_OBJ *)hPort;
+	T_PACKET *ptPacket;
+	struct timespec tUntil;
+	BOOL bOk;
+
+	Deadline(&tUntil, dwMs);
+	pthread_mutex_lock(&gtLock);
+	while (ptPort->ptFirst == NULL)
+	{
+		if (dwMs == INFINITE)
+			pthread_cond_wait(&gtChanged, &gtLock);
+		else if (pthread_cond_timedwait(&gtChanged, &gtLock, &tUntil) == ETIMEDOUT
+			&& ptPort->ptFirst == NULL)
+		{
+			pthread_mutex_unlock(&gtLock);
+			*pptOv = NULL;
+			gdwLastError = WAIT_TIMEOUT;
+			return FALSE;
+		}
+	}
+	ptPacket = ptPort->ptFirst;
+	ptPort->ptFirst = ptPacket->ptNext;
+	if (ptPort->ptFirst == NULL)
+		ptPort->ptLast = NULL;
+	pthread_mutex_unlock(&gtLock);
+	*pdwBytes = ptPacket->dwBytes;
+	*pulKey = ptPacket->ulKey;
+	*pptOv = ptPacket->ptOv;
+	bOk = ptPacket->bOk;
+	free(ptPacket);
+	if (!bOk)
+		gdwLastError = ERROR_OPERATION_ABORTED;
+	return bOk;
+}
+
+BOOL PortFind (HANDLE hFile, HANDLE *phPort, ULONG_PTR *pulKey)
+{
+	int ii;
+
+	*phPort = NULL;
+	pthread_mutex_lock(&gtLock);
+	for (ii = 0; ii < MAX_ASSOC; ii++)
+	{
+		if (gtAssoc[ii].hFile == hFile && gtAssoc[ii].ptPort != NULL)
+		{
+			*phPort = (HANDLE)gtAssoc[ii].ptPort;
+			*pulKey = gtAssoc[ii].ulKey;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&gtLock);
+	return *phPort != NULL;
+}
+
+void PortComplete (HANDLE hPort, ULONG_PTR ulKey, OVERLAPPED *ptOv, BOOL bOk, DWORD dwBytes)
+{
+	pthread_mutex_lock(&gtLock);
+	PortQueue((T_OBJ *)hPort, dwBytes, ulKey, ptOv, bOk);
+	pthread_mutex_unlock(&gtLock);
+}
+
+void PortForget (HANDLE hFile)
+{
+	int ii;
+
+	pthread_mutex_lock(&gtLock);
+	for (ii = 0; ii < MAX_ASSOC; ii++)
+	{
+		if (gtAssoc[ii].hFile == hFile)
+		{
+			gtAssoc[ii].hFile = NULL;
+			gtAssoc[ii].ptPort = NULL;
+		}
+	}
+	pthread_mutex_unlock(&gtLock);
+}
+
+/* Strings -------------------------------------------------------------------*/
+int lstrlenW (const WCHAR *pwsz) { return (int)wcslen(pwsz); }
+int lstrcmpiW (const WCHAR *pwsz1, const WCHAR *pwsz2) { return wcscasecmp(pwsz1, pwsz2); }
+
+WCHAR *lstrcpynW (WCHAR *pwszDst, const WCHAR *pwszSrc, int iMax)
+{
+	wcsncpy(pwszDst, pwszSrc, iMax - 1);
+	pwszDst[iMax - 1] = L'\0';
+	return pwszDst;
+}
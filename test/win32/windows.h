@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @file    windows.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - Win32 subset on POSIX threads
+  ******************************************************************************
+  *	Only what the DLL sources use is declared. Kernel objects (events,
+  *	threads, file mappings, completion ports) are implemented in win32.cpp,
+  *	sockets in winsock.cpp. Devices are mocked by the tests.
+  */
+
+#ifndef __TEST_WINDOWS_H__
+#define __TEST_WINDOWS_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+/* Types ---------------------------------------------------------------------*/
+typedef int BOOL;
+typedef unsigned char BOOLEAN;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef unsigned int DWORD;			/* 32 bits as on Windows */
+typedef int LONG;
+typedef unsigned int ULONG;
+typedef long long LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef uintptr_t ULONG_PTR;
+typedef uintptr_t DWORD_PTR;
+typedef uintptr_t SIZE_T;
+typedef void *HANDLE;
+typedef void *HMODULE;
+typedef void *PVOID;
+typedef void *LPVOID;
+typedef wchar_t WCHAR;
+typedef DWORD CONFIGRET;
+
+typedef union
+{
+	struct
+	{
+		DWORD LowPart;
+		LONG HighPart;
+	};
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct
+{
+	void *pvImpl;
+} CRITICAL_SECTION, SRWLOCK;
+
+typedef struct
+{
+	ULONG_PTR Internal;
+	ULONG_PTR InternalHigh;
+	DWORD Offset;
+	DWORD OffsetHigh;
+	HANDLE hEvent;
+} OVERLAPPED, *LPOVERLAPPED;
+
+typedef struct
+{
+	DWORD Data1;
+	WORD Data2;
+	WORD Data3;
+	BYTE Data4[8];
+} GUID;
+
+typedef struct
+{
+	DWORD dwPageSize;
+	DWORD dwNumberOfProcessors;
+} SYSTEM_INFO;
+
+typedef DWORD (*LPTHREAD_START_ROUTINE) (LPVOID);
+
+/* Constants -----------------------------------------------------------------*/
+#define WINAPI
+#define CALLBACK
+#define APIENTRY
+#define TRUE					1
+#define FALSE					0
+#define MAX_PATH				260
+#define INFINITE				0xFFFFFFFF
+#define INVALID_HANDLE_VALUE	((HANDLE)(intptr_t)-1)
+#define MAXIMUM_WAIT_OBJECTS	64
+#define WAIT_OBJECT_0			0
+#define WAIT_ABANDONED			0x80
+#define WAIT_TIMEOUT			258
+#define WAIT_FAILED				0xFFFFFFFF
+#define ERROR_SUCCESS			0
+#define ERROR_ALREADY_EXISTS	183
+#define ERROR_OPERATION_ABORTED	995
+#define ERROR_IO_PENDING		997
+#define ERROR_DEVICE_NOT_CONNECTED 1167
+#define SRWLOCK_INIT			{ NULL }
+#define SYNCHRONIZE				0x00100000
+#define EVENT_MODIFY_STATE		0x0002
+#define PAGE_READWRITE			0x04
+#define FILE_MAP_ALL_ACCESS		0x000F001F
+#define GENERIC_READ			0x80000000
+#define GENERIC_WRITE			0x40000000
+#define FILE_SHARE_READ			0x00000001
+#define FILE_SHARE_WRITE		0x00000002
+#define OPEN_EXISTING			3
+#define FILE_FLAG_OVERLAPPED	0x40000000
+
+#define MAKEWORD(a, b)			((WORD)(((BYTE)(a)) | ((WORD)((BYTE)(b))) << 8))
+#define YieldProcessor()		__builtin_ia32_pause()
+#define MemoryBarrier()			__sync_synchronize()
+#define ZeroMemory(p, n)		memset((p), 0, (n))
+
+/* Thread local storage */
+#define __declspec(x)			__declspec_##x
+#define __declspec_thread		__thread
+#define __declspec_dllexport
+
+/* Functions -----------------------------------------------------------------*/
+void InitializeCriticalSection (CRITICAL_SECTION *pcs);
+void DeleteCriticalSection (CRITICAL_SECTION *pcs);
+void EnterCriticalSection (CRITICAL_SECTION *pcs);
+BOOL TryEnterCriticalSection (CRITICAL_SECTION *pcs);
+void LeaveCriticalSection (CRITICAL_SECTION *pcs);
+void InitializeSRWLock (SRWLOCK *psrw);
+void AcquireSRWLockExclusive (SRWLOCK *psrw);
+void ReleaseSRWLockExclusive (SRWLOCK *psrw);
+void AcquireSRWLockShared (SRWLOCK *psrw);
+void ReleaseSRWLockShared (SRWLOCK *psrw);
+
+LONG InterlockedIncrement (LONG volatile *pl);
+LONG InterlockedDecrement (LONG volatile *pl);
+LONG InterlockedExchange (LONG volatile *pl, LONG l);
+LONG InterlockedExchangeAdd (LONG volatile *pl, LONG l);
+LONG InterlockedCompareExchange (LONG volatile *pl, LONG lExchange, LONG lComparand);
+LONGLONG InterlockedExchange64 (LONGLONG volatile *pll, LONGLONG ll);
+LONGLONG InterlockedCompareExchange64 (LONGLONG volatile *pll, LONGLONG llExchange, LONGLONG llComparand);
+
+void Sleep (DWORD dwMs);
+DWORD GetTickCount (void);
+BOOL QueryPerformanceCounter (LARGE_INTEGER *pli);
+BOOL QueryPerformanceFrequency (LARGE_INTEGER *pli);
+DWORD GetLastError (void);
+void SetLastError (DWORD dwError);
+void GetSystemInfo (SYSTEM_INFO *ptInfo);
+
+HANDLE CreateEvent (void *pvAttr, BOOL bManual, BOOL bInitial, const char *pszName);
+HANDLE CreateEventA (void *pvAttr, BOOL bManual, BOOL bInitial, const char *pszName);
+HANDLE OpenEventA (DWORD dwAccess, BOOL bInherit, const char *pszName);
+BOOL SetEvent (HANDLE hEvent);
+BOOL ResetEvent (HANDLE hEvent);
+HANDLE CreateThread (void *pvAttr, SIZE_T nStack, LPTHREAD_START_ROUTINE pfStart, LPVOID pvParam,
+	DWORD dwFlags, DWORD *pdwId);
+DWORD WaitForSingleObject (HANDLE h, DWORD dwMs);
+DWORD WaitForMultipleObjects (DWORD dwCount, const HANDLE *ph, BOOL bAll, DWORD dwMs);
+BOOL CloseHandle (HANDLE h);
+
+HANDLE CreateFileMappingA (HANDLE hFile, void *pvAttr, DWORD dwProtect, DWORD dwSizeHigh,
+	DWORD dwSizeLow, const char *pszName);
+HANDLE OpenFileMappingA (DWORD dwAccess, BOOL bInherit, const char *pszName);
+void *MapViewOfFile (HANDLE hMap, DWORD dwAccess, DWORD dwOffHigh, DWORD dwOffLow, SIZE_T nBytes);
+BOOL UnmapViewOfFile (const void *pvView);
+
+HANDLE CreateIoCompletionPort (HANDLE hFile, HANDLE hPort, ULONG_PTR ulKey, DWORD dwThreads);
+BOOL GetQueuedCompletionStatus (HANDLE hPort, DWORD *pdwBytes, ULONG_PTR *pulKey,
+	OVERLAPPED **pptOv, DWORD dwMs);
+BOOL PostQueuedCompletionStatus (HANDLE hPort, DWORD dwBytes, ULONG_PTR ulKey, OVERLAPPED *ptOv);
+/* Harness only: finds the port of a handle; completes an operation to it; forgets a closed handle */
+BOOL PortFind (HANDLE hFile, HANDLE *phPort, ULONG_PTR *pulKey);
+void PortComplete (HANDLE hPort, ULONG_PTR ulKey, OVERLAPPED *ptOv, BOOL bOk, DWORD dwBytes);
+void PortForget (HANDLE hFile);
+
+/* Device I/O, mocked by the tests that open devices */
+HANDLE CreateFileW (const WCHAR *pwszPath, DWORD dwAccess, DWORD dwShare, void *pvAttr,
+	DWORD dwCreate, DWORD dwFlags, HANDLE hTemplate);
+BOOL ReadFile (HANDLE h, void *pvBuf, DWORD dwLen, DWORD *pdwRead, OVERLAPPED *ptOv);
+BOOL WriteFile (HANDLE h, const void *pvBuf, DWORD dwLen, DWORD *pdwWritten, OVERLAPPED *ptOv);
+BOOL GetOverlappedResult (HANDLE h, OVERLAPPED *ptOv, DWORD *pdwBytes, BOOL bWait);
+BOOL CancelIoEx (HANDLE h, OVERLAPPED *ptOv);
+HMODULE LoadLibraryA (const char *pszName);
+void *GetProcAddress (HMODULE hLib, const char *pszName);
+
+int lstrlenW (const WCHAR *pwsz);
+int lstrcmpiW (const WCHAR *pwsz1, const WCHAR *pwsz2);
+WCHAR *lstrcpynW (WCHAR *pwszDst, const WCHAR *pwszSrc, int iMax);
+
+#endif	/* __TEST_WINDOWS_H__ */
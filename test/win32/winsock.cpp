@@ -0,0 +1,317 @@
+/**
+  ******************************************************************************
+  * @file    winsock.cpp
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - Winsock subset on BSD sockets
+  ******************************************************************************
+  *	An overlapped send is done at once and completed to the port. An
+  *	overlapped receive runs on a thread of its own until data comes or the
+  *	socket is shut down, as closesocket does, so a receive pending on a
+  *	closed socket completes with an error to the port of the socket when
+  *	it was submitted, as on Windows. A socket not associated with a port
+  *	completes to the event of the OVERLAPPED.
+  *	WSAEventSelect signals FD_CONNECT only, from a thread of its own.
+  */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "winsock2.h"
+
+#undef setsockopt
+#undef getsockopt
+
+/* Connect being waited for by WSAEventSelect */
+typedef struct
+{
+	int iFd;
+	HANDLE hEvent;
+	int iSlot;
+	LONG lGen;				/* ends when WSAEventSelect is called again */
+} T_SELECT;
+
+#define MAX_SELECT		64
+
+/* Receive in progress */
+typedef struct
+{
+	int iFd;					/* duplicate, so the number is not reused meanwhile */
+	HANDLE hPort;				/* port of the socket when submitted, if any */
+	ULONG_PTR ulKey;
+	WSABUF tBuf;
+	OVERLAPPED *ptOv;
+} T_RECV;
+
+static pthread_mutex_t gtSelectLock = PTHREAD_MUTEX_INITIALIZER;
+static SOCKET ghSelect[MAX_SELECT];		/* sockets with a connect being waited for */
+static LONG glSelectGen[MAX_SELECT];
+
+/* Ends the wait of WSAEventSelect on a socket; gtSelectLock held */
+static int SelectEnd (SOCKET hSock)
+{
+	int iSlot;
+
+	for (iSlot = 0; iSlot < MAX_SELECT; iSlot++)
+	{
+		if (ghSelect[iSlot] == hSock)
+		{
+			glSelectGen[iSlot]++;
+			ghSelect[iSlot] = 0;
+			return iSlot;
+		}
+	}
+	return -1;
+}
+
+int WSAStartup (WORD wVersion, WSADATA *ptData)
+{
+	/* Writing to a closed connection is an error, not a signal */
+	signal(SIGPIPE, SIG_IGN);
+	ptData->wVersion = wVersion;
+	return 0;
+}
+
+int WSACleanup (void) { return 0; }
+
+int WSAGetLastError (void)
+{
+	switch (errno)
+	{
+	case EAGAIN:
+	case EINPROGRESS:
+		return WSAEWOULDBLOCK;
+	case EINTR:
+		return WSAEINTR;
+	case ECONNRESET:
+	case EPIPE:
+		return WSAECONNRESET;
+	case ETIMEDOUT:
+		return WSAETIMEDOUT;
+	default:
+		return errno;
+	}
+}
+
+int closesocket (SOCKET hSock)
+{
+	pthread_mutex_lock(&gtSelectLock);
+	SelectEnd(hSock);
+	pthread_mutex_unlock(&gtSelectLock);
+	PortForget((HANDLE)hSock);
+	shutdown((int)hSock, SHUT_RDWR);
+	return close((int)hSock);
+}
+
+int ioctlsocket (SOCKET hSock, long lCmd, u_long *pulArg)
+{
+	int iFlags = fcntl((int)hSock, F_GETFL);
+
+	if (lCmd != (long)FIONBIO)
+	{
+		errno = EINVAL;
+		return SOCKET_ERROR;
+	}
+	iFlags = (*pulArg != 0) ? (iFlags | O_NONBLOCK) : (iFlags & ~O_NONBLOCK);
+	return fcntl((int)hSock, F_SETFL, iFlags);
+}
+
+int WsaSetSockOpt (SOCKET hSock, int iLevel, int iName, const char *pcVal, int iLen)
+{
+	struct timeval tTime;
+	DWORD dwMs;
+
+	if (iLevel == SOL_SOCKET && (iName == SO_RCVTIMEO || iName == SO_SNDTIMEO))
+	{
+		memcpy(&dwMs, pcVal, sizeof(dwMs));
+		tTime.tv_sec = dwMs / 1000;
+		tTime.tv_usec = (dwMs % 1000) * 1000;
+		return setsockopt((int)hSock, iLevel, iName, &tTime, sizeof(tTime));
+	}
+	return setsockopt((int)hSock, iLevel, iName, pcVal, (socklen_t)iLen);
+}
+
+int WsaGetSockOpt (SOCKET hSock, int iLevel, int iName, char *pcVal, int *piLen)
+{
+	socklen_t tLen = (socklen_t)*piLen;
+	int iRc;
+
+	iRc = getsockopt((int)hSock, iLevel, iName, pcVal, &tLen);
+	*piLen = (int)tLen;
+	return iRc;
+}
+
+int WSASend (SOCKET hSock, WSABUF *ptBufs, DWORD dwCount, DWORD *pdwSent, DWORD dwFlags,
+	OVERLAPPED *ptOv, void *pvRoutine)
+{
+	HANDLE hPort;
+	ULONG_PTR ulKey;
+	ssize_t iSent;
+
+	(void)dwCount; (void)pdwSent; (void)dwFlags; (void)pvRoutine;
+	if (!PortFind((HANDLE)hSock, &hPort, &ulKey))
+	{
+		errno = EBADF;
+		return SOCKET_ERROR;
+	}
+	iSent = send((int)hSock, ptBufs[0].buf, ptBufs[0].len, MSG_NOSIGNAL);
+	PortComplete(hPort, ulKey, ptOv, iSent > 0, (iSent > 0) ? (DWORD)iSent : 0);
+	errno = WSA_IO_PENDING;
+	return SOCKET_ERROR;
+}
+
+static void *RecvThread (void *pvParam)
+{
+	T_RECV *ptRecv = (T_RECV *)pvParam;
+	struct pollfd tPoll;
+	ssize_t iRead;
+
+	/* Receive timeouts of the socket do not apply to overlapped receives */
+	tPoll.fd = ptRecv->iFd;
+	tPoll.events = POLLIN;
+	do
+	{
+		poll(&tPoll, 1, -1);
+		iRead = recv(ptRecv->iFd, ptRecv->tBuf.buf, ptRecv->tBuf.len, MSG_DONTWAIT);
+	} while (iRead < 0 && (errno == EINTR || errno == EAGAIN));
+	close(ptRecv->iFd);
+	if (ptRecv->hPort != NULL)
+		PortComplete(ptRecv->hPort, ptRecv->ulKey, ptRecv->ptOv, iRead > 0, (iRead > 0) ? (DWORD)iRead : 0);
+	else
+	{
+		ptRecv->ptOv->Internal = (iRead >= 0) ? ERROR_SUCCESS : ERROR_OPERATION_ABORTED;
+		ptRecv->ptOv->InternalHigh = (iRead > 0) ? (ULONG_PTR)iRead : 0;
+		SetEvent(ptRecv->ptOv->hEvent);
+	}
+	free(ptRecv);
+	return NULL;
+}
+
+int WSARecv (SOCKET hSock, WSABUF *ptBufs, DWORD dwCount, DWORD *pdwRecvd, DWORD *pdwFlags,
+	OVERLAPPED *ptOv, void *pvRoutine)
+{
+	T_RECV *ptRecv;
+	pthread_t tThread;
+	int iFd;
+
+	(void)dwCount; (void)pdwRecvd; (void)pdwFlags; (void)pvRoutine;
+	iFd = dup((int)hSock);
+	if (iFd < 0)
+		return SOCKET_ERROR;
+	ptRecv = (T_RECV *)calloc(1, sizeof(T_RECV));
+	ptRecv->iFd = iFd;
+	PortFind((HANDLE)hSock, &ptRecv->hPort, &ptRecv->ulKey);
+	ptRecv->tBuf = ptBufs[0];
+	ptRecv->ptOv = ptOv;
+	if (pthread_create(&tThread, NULL, RecvThread, ptRecv) != 0)
+	{
+		close(iFd);
+		free(ptRecv);
+		errno = EAGAIN;
+		return SOCKET_ERROR;
+	}
+	pthread_detach(tThread);
+	errno = WSA_IO_PENDING;
+	return SOCKET_ERROR;
+}
+
+BOOL WSAGetOverlappedResult (SOCKET hSock, OVERLAPPED *ptOv, DWORD *pdwBytes, BOOL bWait, DWORD *pdwFlags)
+{
+	(void)hSock; (void)pdwFlags;
+	if (bWait)
+		WaitForSingleObject(ptOv->hEvent, INFINITE);
+	*pdwBytes = (DWORD)ptOv->InternalHigh;
+	return ptOv->Internal == ERROR_SUCCESS;
+}
+
+static void *SelectThread (void *pvParam)
+{
+	T_SELECT *ptSel = (T_SELECT *)pvParam;
+	struct pollfd tPoll;
+	bool bEnd;
+	int iReady;
+
+	tPoll.fd = ptSel->iFd;
+	tPoll.events = POLLOUT;
+	for (;;)
+	{
+		iReady = poll(&tPoll, 1, 10);
+		/* Never signaled once the socket is closed or selected again */
+		pthread_mutex_lock(&gtSelectLock);
+		bEnd = (glSelectGen[ptSel->iSlot] != ptSel->lGen);
+		if (!bEnd && iReady > 0)
+		{
+			SetEvent(ptSel->hEvent);
+			bEnd = true;
+		}
+		pthread_mutex_unlock(&gtSelectLock);
+		if (bEnd)
+			break;
+	}
+	close(ptSel->iFd);
+	free(ptSel);
+	return NULL;
+}
+
+int WSAEventSelect (SOCKET hSock, HANDLE hEvent, long lEvents)
+{
+	T_SELECT *ptSel;
+	pthread_t tThread;
+	u_long ulMode = 1;
+	int iSlot;
+
+	if (hEvent != NULL && lEvents != FD_CONNECT)
+	{
+		errno = EINVAL;
+		return SOCKET_ERROR;
+	}
+	pthread_mutex_lock(&gtSelectLock);
+	SelectEnd(hSock);
+	if (hEvent == NULL || lEvents == 0)
+	{
+		pthread_mutex_unlock(&gtSelectLock);
+		return 0;
+	}
+	for (iSlot = 0; iSlot < MAX_SELECT && ghSelect[iSlot] != 0; iSlot++)
+		;
+	if (iSlot == MAX_SELECT)
+	{
+		pthread_mutex_unlock(&gtSelectLock);
+		return SOCKET_ERROR;
+	}
+	ghSelect[iSlot] = hSock;
+	ptSel = (T_SELECT *)calloc(1, sizeof(T_SELECT));
+	ptSel->iFd = dup((int)hSock);
+	ptSel->hEvent = hEvent;
+	ptSel->iSlot = iSlot;
+	ptSel->lGen = glSelectGen[iSlot];
+	pthread_mutex_unlock(&gtSelectLock);
+	ioctlsocket(hSock, FIONBIO, &ulMode);
+	if (pthread_create(&tThread, NULL, SelectThread, ptSel) != 0)
+	{
+		close(ptSel->iFd);
+		free(ptSel);
+		return SOCKET_ERROR;
+	}
+	pthread_detach(tThread);
+	return 0;
+}
+
+int WSAEnumNetworkEvents (SOCKET hSock, HANDLE hEvent, WSANETWORKEVENTS *ptEvents)
+{
+	int iErr = 0;
+	int iLen = sizeof(iErr);
+
+	memset(ptEvents, 0, sizeof(WSANETWORKEVENTS));
+	if (WsaGetSockOpt(hSock, SOL_SOCKET, SO_ERROR, (char *)&iErr, &iLen) != 0)
+		return SOCKET_ERROR;
+	ptEvents->lNetworkEvents = FD_CONNECT;
+	ptEvents->iErrorCode[FD_CONNECT_BIT] = iErr;
+	if (hEvent != NULL)
+		ResetEvent(hEvent);
+	return 0;
+}
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file    winsock2.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - Winsock subset on BSD sockets
+  ******************************************************************************
+  *	Sockets are file descriptors. Error codes are translated by
+  *	WSAGetLastError; overlapped sends and receives, and the completion
+  *	ports they complete to, are emulated in winsock.cpp.
+  */
+
+#ifndef __TEST_WINSOCK2_H__
+#define __TEST_WINSOCK2_H__
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/ioctl.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "windows.h"
+
+/* Types ---------------------------------------------------------------------*/
+typedef intptr_t SOCKET;
+
+typedef struct
+{
+	WORD wVersion;
+} WSADATA;
+
+typedef struct
+{
+	ULONG len;
+	char *buf;
+} WSABUF;
+
+typedef struct
+{
+	long lNetworkEvents;
+	int iErrorCode[10];
+} WSANETWORKEVENTS;
+
+/* Constants -----------------------------------------------------------------*/
+#define INVALID_SOCKET			((SOCKET)-1)
+#define SOCKET_ERROR			(-1)
+#define SD_RECEIVE				SHUT_RD
+#define SD_SEND					SHUT_WR
+#define SD_BOTH					SHUT_RDWR
+#define WSA_IO_PENDING			ERROR_IO_PENDING
+#define WSAEINTR				10004
+#define WSAEWOULDBLOCK			10035
+#define WSAECONNRESET			10054
+#define WSAETIMEDOUT			10060
+#define FD_CONNECT_BIT			4
+#define FD_CONNECT				(1 << FD_CONNECT_BIT)
+
+/* Functions -----------------------------------------------------------------*/
+int WSAStartup (WORD wVersion, WSADATA *ptData);
+int WSACleanup (void);
+int WSAGetLastError (void);
+int closesocket (SOCKET hSock);
+int ioctlsocket (SOCKET hSock, long lCmd, u_long *pulArg);
+int WsaSetSockOpt (SOCKET hSock, int iLevel, int iName, const char *pcVal, int iLen);
+int WsaGetSockOpt (SOCKET hSock, int iLevel, int iName, char *pcVal, int *piLen);
+int WSASend (SOCKET hSock, WSABUF *ptBufs, DWORD dwCount, DWORD *pdwSent, DWORD dwFlags,
+	OVERLAPPED *ptOv, void *pvRoutine);
+int WSARecv (SOCKET hSock, WSABUF *ptBufs, DWORD dwCount, DWORD *pdwRecvd, DWORD *pdwFlags,
+	OVERLAPPED *ptOv, void *pvRoutine);
+BOOL WSAGetOverlappedResult (SOCKET hSock, OVERLAPPED *ptOv, DWORD *pdwBytes, BOOL bWait, DWORD *pdwFlags);
+int WSAEventSelect (SOCKET hSock, HANDLE hEvent, long lEvents);
+int WSAEnumNetworkEvents (SOCKET hSock, HANDLE hEvent, WSANETWORKEVENTS *ptEvents);
+
+/* Timeouts are given in ms and lengths as int */
+#define setsockopt				WsaSetSockOpt
+#define getsockopt				WsaGetSockOpt
+
+#endif	/* __TEST_WINSOCK2_H__ */
@@ -0,0 +1,17 @@
+/**
+  ******************************************************************************
+  * @file    ws2tcpip.h
+  * @author  Melchor Varela - EA4FRB
+  * @version V1.0
+  * @date    19-Oct-2026
+  * @brief   SARK110 DLL tests - Winsock subset on BSD sockets
+  ******************************************************************************
+  *	getaddrinfo comes with netdb.h, see winsock2.h.
+  */
+
+#ifndef __TEST_WS2TCPIP_H__
+#define __TEST_WS2TCPIP_H__
+
+#include "winsock2.h"
+
+#endif	/* __TEST_WS2TCPIP_H__ */